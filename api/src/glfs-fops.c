@@ -414,6 +414,50 @@ out:
 }
 
 
+static off_t
+glfs_seek (struct glfs_fd *glfd, off_t offset, int whence)
+{
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
+	off_t           off = -1;
+	gf_seek_what_t  what = 0;
+	int             ret = -1;
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		errno = EBADFD;
+		goto done;
+	}
+
+	if (whence == SEEK_DATA)
+		what = GF_SEEK_DATA;
+	else
+		what = GF_SEEK_HOLE;
+
+	ret = syncop_seek (subvol, fd, offset, what, &off);
+	if (ret == -1) {
+		off = -1;
+		goto done;
+	}
+
+	glfd->offset = off;
+
+done:
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+out:
+	return off;
+}
+
+
 off_t
 glfs_lseek (struct glfs_fd *glfd, off_t offset, int whence)
 {
@@ -437,6 +481,13 @@ glfs_lseek (struct glfs_fd *glfd, off_t offset, int whence)
 		}
 		glfd->offset = sb.st_size + offset;
 		break;
+	case SEEK_DATA:
+	case SEEK_HOLE:
+		/* -1 with errno ENXIO when there is no such region */
+		return glfs_seek (glfd, offset, whence);
+	default:
+		errno = EINVAL;
+		return -1;
 	}
 
 	return glfd->offset;
@@ -546,6 +597,7 @@ struct glfs_io {
 	struct glfs_fd      *glfd;
 	int                  op;
 	off_t                offset;
+	size_t               len;
 	struct iovec        *iov;
 	int                  count;
 	int                  flags;
@@ -582,6 +634,16 @@ glfs_io_async_task (void *data)
 	case GF_FOP_FTRUNCATE:
 		ret = glfs_ftruncate (gio->glfd, gio->offset);
 		break;
+	case GF_FOP_FALLOCATE:
+		ret = glfs_fallocate (gio->glfd, gio->flags, gio->offset,
+				      gio->len);
+		break;
+	case GF_FOP_DISCARD:
+		ret = glfs_discard (gio->glfd, gio->offset, gio->len);
+		break;
+	case GF_FOP_ZEROFILL:
+		ret = glfs_zerofill (gio->glfd, gio->offset, gio->len);
+		break;
 	case GF_FOP_FSYNC:
 		if (gio->flags)
 			ret = glfs_fdatasync (gio->glfd);
@@ -785,7 +847,8 @@ glfs_pwritev (struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
 
 	size = iov_length (iovec, iovcnt);
 
-	iobuf = iobuf_get2 (subvol->ctx->iobuf_pool, size);
+	iobuf = iobuf_get_page_aligned (subvol->ctx->iobuf_pool, size,
+					GF_IOBUF_PAGE_ALIGN_SIZE);
 	if (!iobuf) {
 		ret = -1;
 		errno = ENOMEM;
@@ -1144,6 +1207,342 @@ glfs_ftruncate_async (struct glfs_fd *glfd, off_t offset,
 }
 
 
+int
+glfs_fallocate (struct glfs_fd *glfd, int keep_size, off_t offset, size_t len)
+{
+	int              ret = -1;
+	xlator_t        *subvol = NULL;
+	fd_t            *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	ret = syncop_fallocate (subvol, fd, keep_size, offset, len);
+out:
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+
+	return ret;
+}
+
+
+int
+glfs_fallocate_async (struct glfs_fd *glfd, int keep_size, off_t offset,
+		      size_t len, glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+	int             ret = 0;
+
+	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
+	if (!gio) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	gio->op     = GF_FOP_FALLOCATE;
+	gio->glfd   = glfd;
+	gio->flags  = keep_size;
+	gio->offset = offset;
+	gio->len    = len;
+	gio->fn     = fn;
+	gio->data   = data;
+
+	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
+			    glfs_io_async_task, glfs_io_async_cbk,
+			    NULL, gio);
+
+	if (ret) {
+		GF_FREE (gio->iov);
+		GF_FREE (gio);
+	}
+
+	return ret;
+}
+
+
+int
+glfs_discard (struct glfs_fd *glfd, off_t offset, size_t len)
+{
+	int              ret = -1;
+	xlator_t        *subvol = NULL;
+	fd_t            *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	ret = syncop_discard (subvol, fd, offset, len);
+out:
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+
+	return ret;
+}
+
+
+int
+glfs_discard_async (struct glfs_fd *glfd, off_t offset, size_t len,
+		    glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+	int             ret = 0;
+
+	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
+	if (!gio) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	gio->op     = GF_FOP_DISCARD;
+	gio->glfd   = glfd;
+	gio->offset = offset;
+	gio->len    = len;
+	gio->fn     = fn;
+	gio->data   = data;
+
+	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
+			    glfs_io_async_task, glfs_io_async_cbk,
+			    NULL, gio);
+
+	if (ret) {
+		GF_FREE (gio->iov);
+		GF_FREE (gio);
+	}
+
+	return ret;
+}
+
+
+int
+glfs_zerofill (struct glfs_fd *glfd, off_t offset, size_t len)
+{
+	int              ret = -1;
+	xlator_t        *subvol = NULL;
+	fd_t            *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	ret = syncop_zerofill (subvol, fd, offset, len);
+out:
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+
+	return ret;
+}
+
+
+int
+glfs_zerofill_async (struct glfs_fd *glfd, off_t offset, size_t len,
+		     glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+	int             ret = 0;
+
+	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
+	if (!gio) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	gio->op     = GF_FOP_ZEROFILL;
+	gio->glfd   = glfd;
+	gio->offset = offset;
+	gio->len    = len;
+	gio->fn     = fn;
+	gio->data   = data;
+
+	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
+			    glfs_io_async_task, glfs_io_async_cbk,
+			    NULL, gio);
+
+	if (ret) {
+		GF_FREE (gio->iov);
+		GF_FREE (gio);
+	}
+
+	return ret;
+}
+
+
+/* copy through the client when the bricks cannot do it themselves */
+static ssize_t
+glfs_copy_file_range_rw (struct glfs_fd *glfd_in, off_t off_in,
+			 struct glfs_fd *glfd_out, off_t off_out, size_t len)
+{
+	char      *buf = NULL;
+	size_t     bufsize = 0;
+	size_t     copied = 0;
+	ssize_t    rd = 0;
+	ssize_t    wr = 0;
+
+	bufsize = min (len, (size_t) GF_UNIT_MB);
+	buf = GF_MALLOC (bufsize, gf_common_mt_char);
+	if (!buf) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	while (copied < len) {
+		rd = glfs_pread (glfd_in, buf, min (bufsize, len - copied),
+				 off_in + copied, 0);
+		if (rd <= 0)
+			break;
+
+		wr = glfs_pwrite (glfd_out, buf, rd, off_out + copied, 0);
+		if (wr <= 0) {
+			rd = -1;
+			break;
+		}
+
+		copied += wr;
+		if (wr < rd)
+			break;
+	}
+
+	GF_FREE (buf);
+
+	if (rd < 0 && copied == 0)
+		return -1;
+
+	return copied;
+}
+
+
+ssize_t
+glfs_copy_file_range (struct glfs_fd *glfd_in, off_t *off_in,
+		      struct glfs_fd *glfd_out, off_t *off_out, size_t len,
+		      unsigned int flags)
+{
+	ssize_t          ret = -1;
+	xlator_t        *subvol = NULL;
+	fd_t            *fd_in = NULL;
+	fd_t            *fd_out = NULL;
+	off_t            pos_in = 0;
+	off_t            pos_out = 0;
+	size_t           copied = 0;
+
+	__glfs_entry_fd (glfd_in);
+
+	if (flags) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pos_in = off_in ? *off_in : glfd_in->offset;
+	pos_out = off_out ? *off_out : glfd_out->offset;
+
+	subvol = glfs_active_subvol (glfd_in->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd_in = glfs_resolve_fd (glfd_in->fs, subvol, glfd_in);
+	fd_out = glfs_resolve_fd (glfd_out->fs, subvol, glfd_out);
+	if (!fd_in || !fd_out) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	/* a single fop copies at most GF_COPY_FILE_RANGE_MAX, keep going
+	   until the whole range is copied or the source runs out */
+	ret = 0;
+	while (copied < len) {
+		ret = syncop_copy_file_range (subvol, fd_in, pos_in + copied,
+					      fd_out, pos_out + copied,
+					      min (len - copied,
+						   (size_t) GF_COPY_FILE_RANGE_MAX),
+					      flags);
+		if (ret <= 0)
+			break;
+		copied += ret;
+	}
+out:
+	if (fd_in)
+		fd_unref (fd_in);
+	if (fd_out)
+		fd_unref (fd_out);
+
+	glfs_subvol_done (glfd_in->fs, subvol);
+
+	/* source and destination live on different bricks, or the brick
+	   cannot copy: move the rest of the data through the client */
+	if (ret < 0 && (errno == EXDEV || errno == ENOTSUP ||
+			errno == EOPNOTSUPP || errno == ENOSYS)) {
+		ret = glfs_copy_file_range_rw (glfd_in, pos_in + copied,
+					       glfd_out, pos_out + copied,
+					       len - copied);
+		if (ret > 0)
+			copied += ret;
+	}
+
+	/* report what got copied before a failure, like write(2) */
+	if (copied > 0)
+		ret = copied;
+
+	if (ret > 0) {
+		if (off_in)
+			*off_in = pos_in + ret;
+		else
+			glfd_in->offset = pos_in + ret;
+
+		if (off_out)
+			*off_out = pos_out + ret;
+		else
+			glfd_out->offset = pos_out + ret;
+	}
+
+	return ret;
+}
+
+
 int
 glfs_access (struct glfs *fs, const char *path, int mode)
 {
@@ -413,6 +413,70 @@ int glfs_ftruncate (glfs_fd_t *fd, off_t length);
 int glfs_ftruncate_async (glfs_fd_t *fd, off_t length, glfs_io_cbk fn,
 			  void *data);
 
+/*
+  SYNOPSIS
+
+  glfs_fallocate, glfs_discard, glfs_zerofill: Change the allocation of a
+  range of an open file without sending its data over the wire.
+
+  DESCRIPTION
+
+  glfs_fallocate() allocates the blocks backing @len bytes from @offset.
+  Unless @keep_size is set, the file is extended when the range ends past
+  the current end of file.
+
+  glfs_discard() deallocates the range, leaving a hole which reads back
+  as zeroes. The size of the file does not change.
+
+  glfs_zerofill() makes the range read back as zeroes, like writing zeroes
+  would, but without transferring them.
+
+  RETURN VALUES
+
+  0: Success.
+  -1: Failure. @errno will be set with the type of failure.
+
+*/
+
+int glfs_fallocate (glfs_fd_t *fd, int keep_size, off_t offset, size_t len);
+int glfs_fallocate_async (glfs_fd_t *fd, int keep_size, off_t offset,
+			  size_t len, glfs_io_cbk fn, void *data);
+
+int glfs_discard (glfs_fd_t *fd, off_t offset, size_t len);
+int glfs_discard_async (glfs_fd_t *fd, off_t offset, size_t len,
+			glfs_io_cbk fn, void *data);
+
+int glfs_zerofill (glfs_fd_t *fd, off_t offset, size_t len);
+int glfs_zerofill_async (glfs_fd_t *fd, off_t offset, size_t len,
+			 glfs_io_cbk fn, void *data);
+
+/*
+  SYNOPSIS
+
+  glfs_copy_file_range: Copy a range of one open file into another.
+
+  DESCRIPTION
+
+  Copies up to @len bytes from @fd_in at *@off_in to @fd_out at *@off_out,
+  with the same semantics as copy_file_range(2). When an offset pointer is
+  NULL, the file offset of that fd is used and advanced instead. @flags
+  must be 0.
+
+  When both files are stored on the same brick the copy is done on the
+  server, and reflinked where the backend filesystem supports it. Otherwise
+  the data is read and written back through the client.
+
+  RETURN VALUES
+
+  >=0: Number of bytes copied.
+  -1: Failure. @errno will be set with the type of failure.
+
+*/
+
+ssize_t glfs_copy_file_range (glfs_fd_t *fd_in, off_t *off_in,
+			      glfs_fd_t *fd_out, off_t *off_out, size_t len,
+			      unsigned int flags);
+
 int glfs_lstat (glfs_t *fs, const char *path, struct stat *buf);
 int glfs_stat (glfs_t *fs, const char *path, struct stat *buf);
 int glfs_fstat (glfs_fd_t *fd, struct stat *buf);
@@ -2399,6 +2399,11 @@ cli_cmd_volume_heal_options_parse (const char **words, int wordcount,
                         ret = -1;
                         goto out;
                 }
+                if (!strcmp (words[4], "count")) {
+                        ret = dict_set_int32 (dict, "heal-op",
+                                              GF_AFR_OP_INDEX_COUNT);
+                        goto done;
+                }
                 if (!strcmp (words[4], "healed")) {
                         ret = dict_set_int32 (dict, "heal-op",
                                               GF_AFR_OP_HEALED_FILES);
@@ -1242,6 +1242,7 @@ gf_cli_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
         uint64_t                 skipped = 0;
         double                   elapsed = 0;
         char                    *size_str = NULL;
+        char                    *rate_str = NULL;
         char                    *task_id_str = NULL;
 
         if (-1 == req->rpc_status) {
@@ -1355,12 +1356,13 @@ gf_cli_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
                 goto out;
         }
 
-        cli_out ("%40s %16s %13s %13s %13s %13s %14s %s", "Node",
+        cli_out ("%40s %16s %13s %13s %13s %13s %14s %16s %s", "Node",
                  "Rebalanced-files", "size", "scanned", "failures", "skipped",
-                 "status", "run time in secs");
-        cli_out ("%40s %16s %13s %13s %13s %13s %14s %16s", "---------",
+                 "status", "run time in secs", "throughput/sec");
+        cli_out ("%40s %16s %13s %13s %13s %13s %14s %16s %14s", "---------",
                  "-----------", "-----------", "-----------", "-----------",
-                 "-----------", "------------", "--------------");
+                 "-----------", "------------", "--------------",
+                 "--------------");
         do {
                 snprintf (key, 256, "node-name-%d", i);
                 ret = dict_get_str (dict, key, &node_name);
@@ -1418,10 +1420,15 @@ gf_cli_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
 
                 status = cli_vol_task_status_str[status_rcd];
                 size_str = gf_uint64_2human_readable(size);
+                rate_str = gf_uint64_2human_readable ((elapsed > 0) ?
+                                                      (uint64_t)(size / elapsed)
+                                                      : 0);
                 cli_out ("%40s %16"PRIu64 " %13s" " %13"PRIu64 " %13"PRIu64
-                         " %13"PRIu64 " %14s %16.2f", node_name, files,
-                         size_str, lookup, failures, skipped, status, elapsed);
+                         " %13"PRIu64 " %14s %16.2f %14s", node_name, files,
+                         size_str, lookup, failures, skipped, status, elapsed,
+                         rate_str);
                 GF_FREE(size_str);
+                GF_FREE(rate_str);
 
                 i++;
         } while (i <= counter);
@@ -6170,7 +6177,7 @@ gf_cli_umount (call_frame_t *frame, xlator_t *this, void *data)
 }
 
 void
-cmd_heal_volume_brick_out (dict_t *dict, int brick)
+cmd_heal_volume_brick_out (dict_t *dict, int brick, gf_xl_afr_op_t heal_op)
 {
         uint64_t        num_entries = 0;
         int             ret = 0;
@@ -6182,6 +6189,7 @@ cmd_heal_volume_brick_out (dict_t *dict, int brick)
         uint32_t        time = 0;
         char            timestr[32] = {0};
         char            *shd_status = NULL;
+        char            *progress = NULL;
 
         snprintf (key, sizeof key, "%d-hostname", brick);
         ret = dict_get_str (dict, key, &hostname);
@@ -6207,6 +6215,15 @@ cmd_heal_volume_brick_out (dict_t *dict, int brick)
                 ret = dict_get_uint64 (dict, key, &num_entries);
                 cli_out ("Number of entries: %"PRIu64, num_entries);
 
+                snprintf (key, sizeof key, "%d-heal-progress", brick);
+                progress = NULL;
+                ret = dict_get_str (dict, key, &progress);
+                if (progress && strlen (progress))
+                        cli_out ("Heal progress: %s", progress);
+
+                /* only the count was asked for */
+                if (heal_op == GF_AFR_OP_INDEX_COUNT)
+                        goto out;
 
                 for (i = 0; i < num_entries; i++) {
                         snprintf (key, sizeof key, "%d-%"PRIu64, brick, i);
@@ -6348,7 +6365,7 @@ gf_cli_heal_volume_cbk (struct rpc_req *req, struct iovec *iov,
         }
 
         for (i = 0; i < brick_count; i++)
-                cmd_heal_volume_brick_out (dict, i);
+                cmd_heal_volume_brick_out (dict, i, heal_op);
         ret = rsp.op_ret;
 
 out:
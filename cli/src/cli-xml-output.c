@@ -3133,6 +3133,14 @@ cli_xml_output_vol_rebalance_status (xmlTextWriterPtr writer, dict_t *dict,
                                                        "%.2f", elapsed);
                 XML_RET_CHECK_AND_GOTO (ret, out);
 
+                /* bytes migrated per second */
+                ret = xmlTextWriterWriteFormatElement (writer,
+                                                   (xmlChar *)"throughput",
+                                                   "%"PRIu64, (elapsed > 0) ?
+                                                   (uint64_t)(size / elapsed) :
+                                                   0);
+                XML_RET_CHECK_AND_GOTO (ret, out);
+
                 if (elapsed > overall_elapsed) {
                     overall_elapsed = elapsed;
                 }
@@ -0,0 +1,116 @@
+#!/bin/sh
+
+# Check that cluster.data-dirty-map does not make data self-heal skip
+# writes that a brick missed before the map was being recorded:
+#
+#  1. write a file with both bricks up
+#  2. overwrite a region with the second brick down and the option off
+#  3. enable the option, overwrite another region, second brick still down
+#  4. bring the brick back, let the lookup trigger self-heal
+#  5. overwrite with the brick down again and heal, this time from the map
+#     the heal in 4 started
+#  6. with the option on and both bricks up, write a second file; no heal
+#     has touched it, the first write finds it in sync and starts its map
+#  7. overwrite a region of it with the second brick down and heal, which
+#     must go by the map
+#
+# The backend copies of a file must be identical after each heal.
+#
+# Needs two started bricks of a replica 2 volume on this host; BRICKS are
+# their remote-subvolume names and DIRS the matching export directories.
+
+host=${HOST:-localhost}
+bricks=${BRICKS:-"/bricks/b1 /bricks/b2"}
+dirs=${DIRS:-${bricks}}
+mnt=${MNT:-/mnt/dirty-map}
+volfile=/tmp/afr-dirty-map-heal.vol
+log=/tmp/afr-dirty-map-heal.log
+file=dirty-map-heal
+file2=dirty-map-heal-2
+
+write_volfile ()
+{
+    dirty_map=$1
+    down=$2
+    i=0
+
+    : > ${volfile}
+    for brick in ${bricks}; do
+        i=$((i + 1))
+        port=""
+        # nothing listens there, so the client never connects
+        [ $i -eq 2 ] && [ "${down}" = "down" ] && port="option remote-port 1"
+        cat >> ${volfile} <<VOL
+volume client-$i
+    type protocol/client
+    option remote-host ${host}
+    option remote-subvolume ${brick}
+    ${port}
+end-volume
+
+VOL
+    done
+
+    cat >> ${volfile} <<VOL
+volume replicate
+    type cluster/replicate
+    option self-heal-daemon off
+    option background-self-heal-count 0
+    option data-dirty-map ${dirty_map}
+    subvolumes client-1 client-2
+end-volume
+VOL
+}
+
+run ()
+{
+    write_volfile $1 $2
+    glusterfs -f ${volfile} -l ${log} -L DEBUG ${mnt} || exit 1
+    sleep 2
+    shift 2
+    "$@"
+    sleep 1
+    umount ${mnt}
+}
+
+check ()
+{
+    f=${1:-${file}}
+    sums=$(for dir in ${dirs}; do md5sum < ${dir}/${f}; done | sort -u)
+    if [ $(echo "${sums}" | wc -l) -ne 1 ]; then
+        echo "FAIL: replicas of ${f} differ after self-heal"
+        exit 1
+    fi
+}
+
+check_map_used ()
+{
+    if ! grep -q "/$1: healing only the regions in the dirty map" ${log}; then
+        echo "FAIL: self-heal of $1 did not use its dirty map"
+        exit 1
+    fi
+}
+
+mkdir -p ${mnt}
+run off up dd if=/dev/urandom of=${mnt}/${file} bs=1M count=8 conv=fsync
+run off down dd if=/dev/urandom of=${mnt}/${file} bs=1M count=1 seek=1 \
+    conv=notrunc,fsync
+run on down dd if=/dev/urandom of=${mnt}/${file} bs=1M count=1 seek=5 \
+    conv=notrunc,fsync
+run on up dd if=${mnt}/${file} of=/dev/null bs=1M
+check
+
+run on down dd if=/dev/urandom of=${mnt}/${file} bs=1M count=1 seek=3 \
+    conv=notrunc,fsync
+run on up dd if=${mnt}/${file} of=/dev/null bs=1M
+check
+
+run on up dd if=/dev/urandom of=${mnt}/${file2} bs=1M count=8 conv=fsync
+run on down dd if=/dev/urandom of=${mnt}/${file2} bs=1M count=1 seek=2 \
+    conv=notrunc,fsync
+: > ${log}
+run on up dd if=${mnt}/${file2} of=/dev/null bs=1M
+check ${file2}
+check_map_used ${file2}
+
+echo "PASS"
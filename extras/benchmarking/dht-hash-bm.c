@@ -0,0 +1,201 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+/*
+ * dht-hash-bm: check gf_dm_hashfn against known hashes, then time it and
+ * compare a linear layout scan against a bisection of sorted range starts,
+ * the way dht_layout_search looks up the subvolume of a name.
+ *
+ * Any change of a hash value moves files to other subvolumes, so the
+ * golden vectors must keep passing.
+ *
+ * gcc -O2 dht-hash-bm.c -lglusterfs -o dht-hash-bm
+ * ./dht-hash-bm [subvolumes] [names]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+
+uint32_t gf_dm_hashfn (const char *msg, int len);
+
+/* hashes depend on byte order and on the signedness of char (for 8-bit
+   names), these are for little-endian hosts */
+static struct {
+        const char *name;
+        uint32_t    signed_char;
+        uint32_t    unsigned_char;
+} golden[] = {
+        { "",                   0x884774a2, 0x884774a2 },
+        { "a",                  0x3a17e4e6, 0x3a17e4e6 },
+        { "ab",                 0xc3af40d9, 0xc3af40d9 },
+        { "abc",                0xba8bd29a, 0xba8bd29a },
+        { "abcd",               0xd89627f6, 0xd89627f6 },
+        { "abcde",              0x0a45ccec, 0x0a45ccec },
+        { "file-1",             0x74375b05, 0x74375b05 },
+        { "0123456789abcde",    0x9fc1c536, 0x9fc1c536 },
+        { "0123456789abcdef",   0x6ecb5ada, 0x6ecb5ada },
+        { "0123456789abcdef0",  0x795ef9c7, 0x795ef9c7 },
+        { "file-00000000000000000123.dat", 0x5b351780, 0x5b351780 },
+        { "a-much-longer-file-name-that-spans-several-quads.tar.gz",
+                                0xd41a6cf7, 0xd41a6cf7 },
+        { "caf\xc3\xa9",        0x9e089967, 0xfdcdd575 },
+        { "\xe6\x96\x87\xe4\xbb\xb6.txt", 0xe85c9fb8, 0xe85c9fb8 },
+        { "x\xff",              0xf078283b, 0x133903ca },
+        { NULL, 0, 0 }
+};
+
+static double
+now (void)
+{
+        struct timeval tv = {0, };
+
+        gettimeofday (&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int
+check_golden (void)
+{
+        uint32_t hash = 0;
+        uint32_t want = 0;
+        int      bad = 0;
+        int      i = 0;
+
+        if (htonl (1) == 1) {
+                printf ("golden vectors are for little-endian hosts, "
+                        "skipped\n");
+                return 0;
+        }
+
+        for (i = 0; golden[i].name; i++) {
+                hash = gf_dm_hashfn (golden[i].name, strlen (golden[i].name));
+                want = ((char) 0x80 < 0) ? golden[i].signed_char :
+                                           golden[i].unsigned_char;
+                if (hash != want) {
+                        printf ("MISMATCH on vector %d: 0x%08x, want "
+                                "0x%08x\n", i, hash, want);
+                        bad++;
+                }
+        }
+        printf ("golden vectors: %d checked, %d mismatches\n", i, bad);
+
+        return bad;
+}
+
+static int
+search_linear (uint32_t *start, uint32_t *stop, int cnt, uint32_t hash)
+{
+        int i = 0;
+
+        for (i = 0; i < cnt; i++) {
+                if (start[i] <= hash && stop[i] >= hash)
+                        return i;
+        }
+        return -1;
+}
+
+static int
+search_bisect (uint32_t *start, int cnt, uint32_t hash)
+{
+        int lo = 0;
+        int hi = cnt;
+        int mid = 0;
+
+        while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+                if (start[mid] <= hash)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        return lo - 1;
+}
+
+int
+main (int argc, char *argv[])
+{
+        uint32_t *start = NULL;
+        uint32_t *stop = NULL;
+        uint32_t *hashes = NULL;
+        char    **names = NULL;
+        uint32_t  chunk = 0;
+        uint64_t  sum = 0;
+        double    t = 0;
+        int       subvols = 256;
+        int       count = 1000000;
+        int       i = 0;
+
+        if (argc > 1)
+                subvols = atoi (argv[1]);
+        if (argc > 2)
+                count = atoi (argv[2]);
+        if (subvols <= 0 || count <= 0) {
+                fprintf (stderr, "usage: %s [subvolumes] [names]\n", argv[0]);
+                return 1;
+        }
+
+        if (check_golden ())
+                return 1;
+
+        start  = calloc (subvols, sizeof (*start));
+        stop   = calloc (subvols, sizeof (*stop));
+        hashes = calloc (count, sizeof (*hashes));
+        names  = calloc (count, sizeof (*names));
+        if (!start || !stop || !hashes || !names) {
+                fprintf (stderr, "out of memory\n");
+                return 1;
+        }
+
+        for (i = 0; i < count; i++) {
+                names[i] = malloc (32);
+                if (!names[i]) {
+                        fprintf (stderr, "out of memory\n");
+                        return 1;
+                }
+                snprintf (names[i], 32, "file-%d.%x", i, i * 7919);
+        }
+
+        /* same split as a freshly created directory */
+        chunk = 0xffffffff / subvols;
+        for (i = 0; i < subvols; i++) {
+                start[i] = i * chunk;
+                stop[i]  = start[i] + chunk - 1;
+        }
+        stop[subvols - 1] = 0xffffffff;
+
+        t = now ();
+        for (i = 0; i < count; i++)
+                hashes[i] = gf_dm_hashfn (names[i], strlen (names[i]));
+        t = now () - t;
+        printf ("gf_dm_hashfn: %.1f ns/name\n", t * 1e9 / count);
+
+        t = now ();
+        for (i = 0; i < count; i++)
+                sum += search_linear (start, stop, subvols, hashes[i]);
+        t = now () - t;
+        printf ("linear search over %d ranges: %.1f ns/name\n", subvols,
+                t * 1e9 / count);
+
+        t = now ();
+        for (i = 0; i < count; i++)
+                sum -= search_bisect (start, subvols, hashes[i]);
+        t = now () - t;
+        printf ("bisection over %d ranges: %.1f ns/name\n", subvols,
+                t * 1e9 / count);
+
+        if (sum) {
+                printf ("MISMATCH between linear search and bisection\n");
+                return 1;
+        }
+
+        return 0;
+}
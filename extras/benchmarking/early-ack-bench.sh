@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# Compare write latency of a replica 3 volume with one slow brick, with
+# and without cluster.quorum-early-ack. The slow brick is simulated by a
+# debug/error-gen write-delay in front of its protocol/client.
+#
+# Needs three started bricks and write-latency built next to this script:
+#   gcc write-latency.c -o write-latency
+
+host=${HOST:-localhost}
+bricks=${BRICKS:-"/bricks/b1 /bricks/b2 /bricks/b3"}
+delay=${DELAY:-20000}           # usecs added to every write on the 3rd brick
+bs=${BS:-4096}
+count=${COUNT:-2000}
+mnt=${MNT:-/mnt/early-ack}
+volfile=/tmp/early-ack-bench.vol
+
+write_volfile ()
+{
+    early_ack=$1
+    subvols=""
+    i=0
+
+    : > ${volfile}
+    for brick in ${bricks}; do
+        i=$((i + 1))
+        cat >> ${volfile} <<VOL
+volume client-$i
+    type protocol/client
+    option remote-host ${host}
+    option remote-subvolume ${brick}
+end-volume
+
+VOL
+        subvols="${subvols} client-$i"
+    done
+
+    cat >> ${volfile} <<VOL
+volume slow-$i
+    type debug/error-gen
+    option write-delay ${delay}
+    subvolumes client-$i
+end-volume
+
+volume replicate
+    type cluster/replicate
+    option quorum-type auto
+    option quorum-early-ack ${early_ack}
+    subvolumes ${subvols% client-$i} slow-$i
+end-volume
+VOL
+}
+
+mkdir -p ${mnt}
+for early_ack in off on; do
+    write_volfile ${early_ack}
+    glusterfs -f ${volfile} ${mnt} || exit 1
+    sleep 2
+    echo "quorum-early-ack ${early_ack}:"
+    ./write-latency ${mnt}/early-ack-bench ${bs} ${count}
+    rm -f ${mnt}/early-ack-bench
+    umount ${mnt}
+done
@@ -0,0 +1,113 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+/*
+ * write-latency: time every pwrite of a sequential write and print the
+ * latency distribution.
+ *
+ * gcc write-latency.c -o write-latency
+ * ./write-latency <file> [block-size] [count]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+static int
+cmp_usec (const void *a, const void *b)
+{
+        unsigned long long x = *(const unsigned long long *) a;
+        unsigned long long y = *(const unsigned long long *) b;
+
+        return (x > y) - (x < y);
+}
+
+static unsigned long long
+percentile (unsigned long long *lat, long count, double pct)
+{
+        long idx = (long) (pct / 100.0 * (count - 1) + 0.5);
+
+        return lat[idx];
+}
+
+int
+main (int argc, char *argv[])
+{
+        unsigned long long *lat   = NULL;
+        unsigned long long  total = 0;
+        struct timeval      start = {0, };
+        struct timeval      end   = {0, };
+        size_t              bs    = 4096;
+        long                count = 10000;
+        long                i     = 0;
+        char               *buf   = NULL;
+        ssize_t             ret   = 0;
+        int                 fd    = -1;
+
+        if (argc < 2) {
+                fprintf (stderr, "usage: %s <file> [block-size] [count]\n",
+                         argv[0]);
+                return 1;
+        }
+        if (argc > 2)
+                bs = strtoul (argv[2], NULL, 0);
+        if (argc > 3)
+                count = strtol (argv[3], NULL, 0);
+        if (!bs || count <= 0) {
+                fprintf (stderr, "bad block-size or count\n");
+                return 1;
+        }
+
+        buf = malloc (bs);
+        lat = calloc (count, sizeof (*lat));
+        if (!buf || !lat) {
+                fprintf (stderr, "out of memory\n");
+                return 1;
+        }
+        memset (buf, 0xa5, bs);
+
+        fd = open (argv[1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+                fprintf (stderr, "open %s: %s\n", argv[1], strerror (errno));
+                return 1;
+        }
+
+        for (i = 0; i < count; i++) {
+                gettimeofday (&start, NULL);
+                ret = pwrite (fd, buf, bs, (off_t) i * bs);
+                gettimeofday (&end, NULL);
+                if (ret != bs) {
+                        fprintf (stderr, "pwrite: %s\n",
+                                 (ret < 0) ? strerror (errno) : "short write");
+                        close (fd);
+                        return 1;
+                }
+                lat[i] = (end.tv_sec - start.tv_sec) * 1000000ULL +
+                         end.tv_usec - start.tv_usec;
+                total += lat[i];
+        }
+        close (fd);
+
+        qsort (lat, count, sizeof (*lat), cmp_usec);
+
+        printf ("writes %ld x %zu bytes, latency in usecs\n", count, bs);
+        printf ("avg %llu min %llu p50 %llu p90 %llu p99 %llu p99.9 %llu "
+                "max %llu\n", total / count, lat[0],
+                percentile (lat, count, 50), percentile (lat, count, 90),
+                percentile (lat, count, 99), percentile (lat, count, 99.9),
+                lat[count - 1]);
+
+        free (lat);
+        free (buf);
+        return 0;
+}
@@ -2131,6 +2131,292 @@ out:
 }
 
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame, fop_fallocate_t fn,
+                    fd_t *fd, int32_t keep_size, off_t offset,
+                    size_t len, dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.fallocate = fn;
+
+        if (fd)
+                stub->args.fd = fd_ref (fd);
+
+        stub->args.flags = keep_size;
+        stub->args.offset = offset;
+        stub->args.size = len;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame, fop_fallocate_cbk_t fn,
+                        int32_t op_ret, int32_t op_errno,
+                        struct iatt *statpre, struct iatt *statpost,
+                        dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.fallocate = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args_cbk.prestat = *statpre;
+        if (statpost)
+                stub->args_cbk.poststat = *statpost;
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame, fop_discard_t fn,
+                  fd_t *fd, off_t offset, size_t len,
+                  dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.discard = fn;
+
+        if (fd)
+                stub->args.fd = fd_ref (fd);
+
+        stub->args.offset = offset;
+        stub->args.size = len;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame, fop_discard_cbk_t fn,
+                      int32_t op_ret, int32_t op_errno,
+                      struct iatt *statpre, struct iatt *statpost,
+                      dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.discard = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args_cbk.prestat = *statpre;
+        if (statpost)
+                stub->args_cbk.poststat = *statpost;
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame, fop_zerofill_t fn,
+                   fd_t *fd, off_t offset, size_t len,
+                   dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.zerofill = fn;
+
+        if (fd)
+                stub->args.fd = fd_ref (fd);
+
+        stub->args.offset = offset;
+        stub->args.size = len;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame, fop_zerofill_cbk_t fn,
+                       int32_t op_ret, int32_t op_errno,
+                       struct iatt *statpre, struct iatt *statpost,
+                       dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.zerofill = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args_cbk.prestat = *statpre;
+        if (statpost)
+                stub->args_cbk.poststat = *statpost;
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame, fop_seek_t fn, fd_t *fd,
+               off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.seek = fn;
+
+        if (fd)
+                stub->args.fd = fd_ref (fd);
+
+        stub->args.offset = offset;
+        stub->args.what = what;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame, fop_seek_cbk_t fn,
+                   int32_t op_ret, int32_t op_errno, off_t offset,
+                   dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.seek = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+        stub->args_cbk.offset = offset;
+
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_copy_file_range_stub (call_frame_t *frame, fop_copy_file_range_t fn,
+                          fd_t *fd_in, off_t off_in, fd_t *fd_out,
+                          off_t off_out, size_t len, uint32_t flags,
+                          dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_COPY_FILE_RANGE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.copy_file_range = fn;
+
+        if (fd_in)
+                stub->args.fd = fd_ref (fd_in);
+        if (fd_out)
+                stub->args.fd_dst = fd_ref (fd_out);
+
+        stub->args.offset = off_in;
+        stub->args.off_dst = off_out;
+        stub->args.size = len;
+        stub->args.flags = flags;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+
+call_stub_t *
+fop_copy_file_range_cbk_stub (call_frame_t *frame,
+                              fop_copy_file_range_cbk_t fn,
+                              int32_t op_ret, int32_t op_errno,
+                              struct iatt *stbuf, struct iatt *prebuf_dst,
+                              struct iatt *postbuf_dst, dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_COPY_FILE_RANGE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.copy_file_range = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+
+        if (stbuf)
+                stub->args_cbk.stat = *stbuf;
+        if (prebuf_dst)
+                stub->args_cbk.prestat = *prebuf_dst;
+        if (postbuf_dst)
+                stub->args_cbk.poststat = *postbuf_dst;
+
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
 static void
 call_resume_wind (call_stub_t *stub)
 {
@@ -2347,6 +2633,35 @@ call_resume_wind (call_stub_t *stub)
 				   stub->args.fd, &stub->args.stat,
 				   stub->args.valid, stub->args.xdata);
                 break;
+        case GF_FOP_FALLOCATE:
+                stub->fn.fallocate (stub->frame, stub->frame->this,
+                                    stub->args.fd, stub->args.flags,
+                                    stub->args.offset, stub->args.size,
+                                    stub->args.xdata);
+                break;
+        case GF_FOP_DISCARD:
+                stub->fn.discard (stub->frame, stub->frame->this,
+                                  stub->args.fd, stub->args.offset,
+                                  stub->args.size, stub->args.xdata);
+                break;
+        case GF_FOP_ZEROFILL:
+                stub->fn.zerofill (stub->frame, stub->frame->this,
+                                   stub->args.fd, stub->args.offset,
+                                   stub->args.size, stub->args.xdata);
+                break;
+        case GF_FOP_SEEK:
+                stub->fn.seek (stub->frame, stub->frame->this,
+                               stub->args.fd, stub->args.offset,
+                               stub->args.what, stub->args.xdata);
+                break;
+        case GF_FOP_COPY_FILE_RANGE:
+                stub->fn.copy_file_range (stub->frame, stub->frame->this,
+                                          stub->args.fd, stub->args.offset,
+                                          stub->args.fd_dst,
+                                          stub->args.off_dst,
+                                          stub->args.size, stub->args.flags,
+                                          stub->args.xdata);
+                break;
         default:
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
                                   "Invalid value of FOP (%d)",
@@ -2541,6 +2856,27 @@ call_resume_unwind (call_stub_t *stub)
 		STUB_UNWIND (stub, fsetattr, &stub->args_cbk.prestat,
 			     &stub->args_cbk.poststat, stub->args_cbk.xdata);
                 break;
+        case GF_FOP_FALLOCATE:
+                STUB_UNWIND (stub, fallocate, &stub->args_cbk.prestat,
+                             &stub->args_cbk.poststat, stub->args_cbk.xdata);
+                break;
+        case GF_FOP_DISCARD:
+                STUB_UNWIND (stub, discard, &stub->args_cbk.prestat,
+                             &stub->args_cbk.poststat, stub->args_cbk.xdata);
+                break;
+        case GF_FOP_ZEROFILL:
+                STUB_UNWIND (stub, zerofill, &stub->args_cbk.prestat,
+                             &stub->args_cbk.poststat, stub->args_cbk.xdata);
+                break;
+        case GF_FOP_SEEK:
+                STUB_UNWIND (stub, seek, stub->args_cbk.offset,
+                             stub->args_cbk.xdata);
+                break;
+        case GF_FOP_COPY_FILE_RANGE:
+                STUB_UNWIND (stub, copy_file_range, &stub->args_cbk.stat,
+                             &stub->args_cbk.prestat,
+                             &stub->args_cbk.poststat, stub->args_cbk.xdata);
+                break;
         default:
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
                                   "Invalid value of FOP (%d)",
@@ -2562,6 +2898,9 @@ call_stub_wipe_args (call_stub_t *stub)
 	if (stub->args.fd)
 		fd_unref (stub->args.fd);
 
+	if (stub->args.fd_dst)
+		fd_unref (stub->args.fd_dst);
+
 	GF_FREE ((char *)stub->args.linkname);
 
 	GF_FREE (stub->args.vector);
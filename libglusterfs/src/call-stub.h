@@ -69,6 +69,11 @@ typedef struct {
 		fop_fxattrop_t fxattrop;
 		fop_setattr_t setattr;
 		fop_fsetattr_t fsetattr;
+		fop_fallocate_t fallocate;
+		fop_discard_t discard;
+		fop_zerofill_t zerofill;
+		fop_seek_t seek;
+		fop_copy_file_range_t copy_file_range;
 	} fn;
 
 	union {
@@ -113,6 +118,11 @@ typedef struct {
 		fop_fxattrop_cbk_t fxattrop;
 		fop_setattr_cbk_t setattr;
 		fop_fsetattr_cbk_t fsetattr;
+		fop_fallocate_cbk_t fallocate;
+		fop_discard_cbk_t discard;
+		fop_zerofill_cbk_t zerofill;
+		fop_seek_cbk_t seek;
+		fop_copy_file_range_cbk_t copy_file_range;
 	} fn_cbk;
 
 	struct {
@@ -142,6 +152,9 @@ typedef struct {
 		gf_xattrop_flags_t optype;
 		int valid;
 		struct iatt stat;
+		gf_seek_what_t what;
+		fd_t *fd_dst; // @fd_out in copy_file_range()
+		off_t off_dst; // @off_out in copy_file_range()
 		dict_t *xdata;
 	} args;
 
@@ -167,6 +180,7 @@ typedef struct {
 		gf_dirent_t entries;
 		uint32_t weak_checksum;
 		uint8_t *strong_checksum;
+		off_t offset;
 		dict_t *xdata;
 	} args_cbk;
 } call_stub_t;
@@ -713,6 +727,84 @@ fop_fsetattr_cbk_stub (call_frame_t *frame,
                        struct iatt *statpre,
                        struct iatt *statpost, dict_t *xdata);
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t keep_size, off_t offset,
+                    size_t len, dict_t *xdata);
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *statpre,
+                        struct iatt *statpost, dict_t *xdata);
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len, dict_t *xdata);
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *statpre,
+                      struct iatt *statpost, dict_t *xdata);
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   off_t offset,
+                   size_t len, dict_t *xdata);
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *statpre,
+                       struct iatt *statpost, dict_t *xdata);
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame,
+               fop_seek_t fn,
+               fd_t *fd,
+               off_t offset,
+               gf_seek_what_t what, dict_t *xdata);
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame,
+                   fop_seek_cbk_t fn,
+                   int32_t op_ret,
+                   int32_t op_errno,
+                   off_t offset, dict_t *xdata);
+
+call_stub_t *
+fop_copy_file_range_stub (call_frame_t *frame,
+                          fop_copy_file_range_t fn,
+                          fd_t *fd_in,
+                          off_t off_in,
+                          fd_t *fd_out,
+                          off_t off_out,
+                          size_t len,
+                          uint32_t flags, dict_t *xdata);
+
+call_stub_t *
+fop_copy_file_range_cbk_stub (call_frame_t *frame,
+                              fop_copy_file_range_cbk_t fn,
+                              int32_t op_ret,
+                              int32_t op_errno,
+                              struct iatt *stbuf,
+                              struct iatt *prebuf_dst,
+                              struct iatt *postbuf_dst, dict_t *xdata);
+
 void call_resume (call_stub_t *stub);
 void call_stub_destroy (call_stub_t *stub);
 void call_unwind_error (call_stub_t *stub, int op_ret, int op_errno);
@@ -52,6 +52,27 @@ gf_rsync_weak_checksum (unsigned char *buf, size_t len)
         return csum;
 }
 
+/*
+ * Slide the weak checksum of a 'len' byte window one byte on: 'out' leaves
+ * it at the front, 'in' joins it at the back. Only the low 16 bits of both
+ * sums are kept in the checksum, which is all they need.
+ */
+
+uint32_t
+gf_rsync_weak_checksum_roll (uint32_t csum, unsigned char out,
+                             unsigned char in, size_t len)
+{
+        uint32_t s1, s2;
+
+        s1 = csum & 0xffff;
+        s2 = csum >> 16;
+
+        s1 = s1 - out + in;
+        s2 = s2 - (uint32_t) len * out + s1;
+
+        return (s1 & 0xffff) + (s2 << 16);
+}
+
 
 /*
  * The "strong" checksum required for the rsync algorithm,
@@ -63,3 +84,90 @@ gf_rsync_strong_checksum (unsigned char *data, size_t len, unsigned char *md5)
 {
         MD5(data, len, md5);
 }
+
+
+/*
+ * The keyed strong checksum: SipHash-2-4 with a 128 bit result, by
+ * Jean-Philippe Aumasson and Daniel J. Bernstein. It is several times
+ * faster than MD5. Without the key nobody can build two blocks with the
+ * same checksum, so whoever compares them picks a random key for every
+ * run of comparisons and has the bricks use it. Words are read as little
+ * endian so that hosts of either byte order agree.
+ */
+
+#define GF_ROTL64(x, b) (uint64_t) (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define GF_SIPROUND                                                     \
+        do {                                                            \
+                v0 += v1; v1 = GF_ROTL64 (v1, 13); v1 ^= v0;            \
+                v0 = GF_ROTL64 (v0, 32);                                \
+                v2 += v3; v3 = GF_ROTL64 (v3, 16); v3 ^= v2;            \
+                v0 += v3; v3 = GF_ROTL64 (v3, 21); v3 ^= v0;            \
+                v2 += v1; v1 = GF_ROTL64 (v1, 17); v1 ^= v2;            \
+                v2 = GF_ROTL64 (v2, 32);                                \
+        } while (0)
+
+static inline uint64_t
+gf_get_le64 (const unsigned char *p)
+{
+        return ((uint64_t) p[0]) | ((uint64_t) p[1] << 8) |
+               ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+               ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) |
+               ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static inline void
+gf_put_le64 (unsigned char *p, uint64_t v)
+{
+        int i = 0;
+
+        for (i = 0; i < 8; i++)
+                p[i] = (unsigned char) (v >> (8 * i));
+}
+
+void
+gf_rsync_keyed_checksum (const unsigned char *key, const unsigned char *data,
+                         size_t len, unsigned char *sum)
+{
+        uint64_t        k0 = gf_get_le64 (key);
+        uint64_t        k1 = gf_get_le64 (key + 8);
+        uint64_t        v0 = 0x736f6d6570736575ULL ^ k0;
+        uint64_t        v1 = 0x646f72616e646f6dULL ^ k1 ^ 0xee;
+        uint64_t        v2 = 0x6c7967656e657261ULL ^ k0;
+        uint64_t        v3 = 0x7465646279746573ULL ^ k1;
+        uint64_t        m  = 0;
+        size_t          left = len & 7;
+        const unsigned char *end = data + len - left;
+        int             i  = 0;
+
+        for (; data != end; data += 8) {
+                m = gf_get_le64 (data);
+                v3 ^= m;
+                GF_SIPROUND;
+                GF_SIPROUND;
+                v0 ^= m;
+        }
+
+        m = ((uint64_t) len) << 56;
+        for (i = left - 1; i >= 0; i--)
+                m |= ((uint64_t) data[i]) << (8 * i);
+
+        v3 ^= m;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        v0 ^= m;
+
+        v2 ^= 0xee;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        gf_put_le64 (sum, v0 ^ v1 ^ v2 ^ v3);
+
+        v1 ^= 0xdd;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        GF_SIPROUND;
+        gf_put_le64 (sum + 8, v0 ^ v1 ^ v2 ^ v3);
+}
@@ -11,10 +11,24 @@
 #ifndef __CHECKSUM_H__
 #define __CHECKSUM_H__
 
+/* size of the digest written by gf_rsync_strong_checksum (), an MD5, and
+   by gf_rsync_keyed_checksum () */
+#define GF_RSYNC_STRONG_CHECKSUM_LENGTH 16
+/* size of the key of gf_rsync_keyed_checksum () */
+#define GF_RSYNC_CHECKSUM_KEY_LENGTH    16
+
 uint32_t
 gf_rsync_weak_checksum (unsigned char *buf, size_t len);
 
+uint32_t
+gf_rsync_weak_checksum_roll (uint32_t csum, unsigned char out,
+                             unsigned char in, size_t len);
+
 void
 gf_rsync_strong_checksum (unsigned char *buf, size_t len, unsigned char *sum);
 
+void
+gf_rsync_keyed_checksum (const unsigned char *key, const unsigned char *buf,
+                         size_t len, unsigned char *sum);
+
 #endif /* __CHECKSUM_H__ */
@@ -32,6 +32,7 @@
 #include <linux/limits.h>
 #include <sys/xattr.h>
 #include <endian.h>
+#include <linux/falloc.h>
 
 
 #ifndef HAVE_LLISTXATTR
@@ -388,6 +389,28 @@ int gf_mkostemp (char *tmpl, int suffixlen, int flags);
 #define IXDR_PUT_U_LONG(buf, v)       IXDR_PUT_LONG(buf, (long)(v))
 #endif
 
+/* flags of the fallocate fop, same values as the linux ones */
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE     0x01
+#endif
+
+#ifndef FALLOC_FL_PUNCH_HOLE
+#define FALLOC_FL_PUNCH_HOLE    0x02
+#endif
+
+#ifndef FALLOC_FL_ZERO_RANGE
+#define FALLOC_FL_ZERO_RANGE    0x10
+#endif
+
+/* lseek(2) whence values for sparse files; kernels or filesystems which
+   do not know about them fail with EINVAL */
+#ifndef SEEK_DATA
+#define SEEK_DATA 3
+#endif
+#ifndef SEEK_HOLE
+#define SEEK_HOLE 4
+#endif
+
 #if defined(__GNUC__) && !defined(RELAX_POISONING)
 /* Use run API, see run.h */
 #pragma GCC poison system popen
@@ -454,6 +454,56 @@ default_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                       struct iatt *post, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, pre, post,
+                             xdata);
+        return 0;
+}
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                     struct iatt *post, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, pre, post,
+                             xdata);
+        return 0;
+}
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                      struct iatt *post, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, pre, post,
+                             xdata);
+        return 0;
+}
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset,
+                  dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset, xdata);
+        return 0;
+}
+
+int32_t
+default_copy_file_range_cbk (call_frame_t *frame, void *cookie,
+                             xlator_t *this, int32_t op_ret, int32_t op_errno,
+                             struct iatt *stbuf, struct iatt *prebuf_dst,
+                             struct iatt *postbuf_dst, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (copy_file_range, frame, op_ret, op_errno, stbuf,
+                             prebuf_dst, postbuf_dst, xdata);
+        return 0;
+}
+
 int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data)
@@ -862,6 +912,58 @@ default_fsetattr_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return 0;
 }
 
+int32_t
+default_fallocate_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          int32_t keep_size, off_t offset, size_t len,
+                          dict_t *xdata)
+{
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                    offset, len, xdata);
+        return 0;
+}
+
+int32_t
+default_discard_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, size_t len, dict_t *xdata)
+{
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->discard, fd, offset, len,
+                    xdata);
+        return 0;
+}
+
+int32_t
+default_zerofill_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         off_t offset, size_t len, dict_t *xdata)
+{
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->zerofill, fd, offset, len,
+                    xdata);
+        return 0;
+}
+
+int32_t
+default_seek_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+        STACK_WIND (frame, default_seek_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->seek, fd, offset, what, xdata);
+        return 0;
+}
+
+int32_t
+default_copy_file_range_resume (call_frame_t *frame, xlator_t *this,
+                                fd_t *fd_in, off_t off_in, fd_t *fd_out,
+                                off_t off_out, size_t len, uint32_t flags,
+                                dict_t *xdata)
+{
+        STACK_WIND (frame, default_copy_file_range_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->copy_file_range, fd_in, off_in,
+                    fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
 /* FOPS */
 
 int32_t
@@ -1266,6 +1368,58 @@ default_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return 0;
 }
 
+int32_t
+default_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len,
+                   dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                         offset, len, xdata);
+        return 0;
+}
+
+int32_t
+default_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len, dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->discard, fd, offset, len,
+                         xdata);
+        return 0;
+}
+
+int32_t
+default_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, size_t len, dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->zerofill, fd, offset, len,
+                         xdata);
+        return 0;
+}
+
+int32_t
+default_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->seek, fd, offset, what,
+                         xdata);
+        return 0;
+}
+
+int32_t
+default_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                         off_t off_in, fd_t *fd_out, off_t off_out,
+                         size_t len, uint32_t flags, dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD (this),
+                         FIRST_CHILD (this)->fops->copy_file_range, fd_in,
+                         off_in, fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
 
 int32_t
 default_forget (xlator_t *this, inode_t *inode)
@@ -1325,6 +1479,39 @@ default_notify (xlator_t *this, int32_t event, void *data, ...)
                 }
         }
         break;
+        case GF_EVENT_UPCALL:
+        {
+                xlator_list_t *parent = this->parents;
+
+                /* data is the upcall itself, pass it on unchanged */
+                while (parent) {
+                        if (parent->xlator->init_succeeded)
+                                xlator_notify (parent->xlator, event,
+                                               data, NULL);
+                        parent = parent->next;
+                }
+        }
+        break;
+        case GF_EVENT_STATFS_PUSH:
+        {
+                xlator_list_t    *parent = this->parents;
+                gf_statfs_push_t  push   = {0, };
+
+                if (!data)
+                        break;
+
+                /* parents learn the usage came through us */
+                push = *(gf_statfs_push_t *)data;
+                push.subvol = this;
+
+                while (parent) {
+                        if (parent->xlator->init_succeeded)
+                                xlator_notify (parent->xlator, event,
+                                               &push, NULL);
+                        parent = parent->next;
+                }
+        }
+        break;
         case GF_EVENT_CHILD_CONNECTING:
         case GF_EVENT_CHILD_MODIFIED:
         case GF_EVENT_CHILD_DOWN:
@@ -243,6 +243,40 @@ int32_t default_fsetattr (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid, dict_t *xdata);
 
+int32_t default_fallocate (call_frame_t *frame,
+                           xlator_t *this,
+                           fd_t *fd,
+                           int32_t keep_size,
+                           off_t offset,
+                           size_t len, dict_t *xdata);
+
+int32_t default_discard (call_frame_t *frame,
+                         xlator_t *this,
+                         fd_t *fd,
+                         off_t offset,
+                         size_t len, dict_t *xdata);
+
+int32_t default_zerofill (call_frame_t *frame,
+                          xlator_t *this,
+                          fd_t *fd,
+                          off_t offset,
+                          size_t len, dict_t *xdata);
+
+int32_t default_seek (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t *fd,
+                      off_t offset,
+                      gf_seek_what_t what, dict_t *xdata);
+
+int32_t default_copy_file_range (call_frame_t *frame,
+                                 xlator_t *this,
+                                 fd_t *fd_in,
+                                 off_t off_in,
+                                 fd_t *fd_out,
+                                 off_t off_out,
+                                 size_t len,
+                                 uint32_t flags, dict_t *xdata);
+
 /* Resume */
 int32_t default_getspec_resume (call_frame_t *frame,
                                 xlator_t *this,
@@ -453,6 +487,40 @@ int32_t default_fsetattr_resume (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid, dict_t *xdata);
 
+int32_t default_fallocate_resume (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  int32_t keep_size,
+                                  off_t offset,
+                                  size_t len, dict_t *xdata);
+
+int32_t default_discard_resume (call_frame_t *frame,
+                                xlator_t *this,
+                                fd_t *fd,
+                                off_t offset,
+                                size_t len, dict_t *xdata);
+
+int32_t default_zerofill_resume (call_frame_t *frame,
+                                 xlator_t *this,
+                                 fd_t *fd,
+                                 off_t offset,
+                                 size_t len, dict_t *xdata);
+
+int32_t default_seek_resume (call_frame_t *frame,
+                             xlator_t *this,
+                             fd_t *fd,
+                             off_t offset,
+                             gf_seek_what_t what, dict_t *xdata);
+
+int32_t default_copy_file_range_resume (call_frame_t *frame,
+                                        xlator_t *this,
+                                        fd_t *fd_in,
+                                        off_t off_in,
+                                        fd_t *fd_out,
+                                        off_t off_out,
+                                        size_t len,
+                                        uint32_t flags, dict_t *xdata);
+
 /* _cbk */
 
 int32_t
@@ -663,6 +731,32 @@ default_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                       int32_t op_ret, int32_t op_errno, struct iatt *statpre,
                       struct iatt *statpost, dict_t *xdata);
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                       struct iatt *post, dict_t *xdata);
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                     struct iatt *post, dict_t *xdata);
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                      struct iatt *post, dict_t *xdata);
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset,
+                  dict_t *xdata);
+
+int32_t
+default_copy_file_range_cbk (call_frame_t *frame, void *cookie,
+                             xlator_t *this, int32_t op_ret, int32_t op_errno,
+                             struct iatt *stbuf, struct iatt *prebuf_dst,
+                             struct iatt *postbuf_dst, dict_t *xdata);
+
 int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data);
@@ -105,14 +105,36 @@
 
 #define GLUSTERFS_OPEN_FD_COUNT "glusterfs.open-fd-count"
 #define GLUSTERFS_INODELK_COUNT "glusterfs.inodelk-count"
+/* set in xdata of an inodelk whose holder is willing to give the lock up
+ * when another client waits for it */
+#define GF_INODELK_RECALL_KEY "glusterfs.inodelk-recall"
+/* set by a brick in the xdata of statfs replies when it pushes its usage
+ * to clients whenever it changes noticeably */
+#define GF_STATFS_PUSH_KEY "glusterfs.statfs-push"
+/* GF_RSYNC_CHECKSUM_KEY_LENGTH bytes in the xdata of rchecksum asking for
+ * the keyed strong checksum instead of the MD5. Bricks which honour it
+ * set it in the reply xdata */
+#define GF_RCHECKSUM_KEY "glusterfs.rchecksum-key"
 #define GLUSTERFS_ENTRYLK_COUNT "glusterfs.entrylk-count"
 #define GLUSTERFS_POSIXLK_COUNT "glusterfs.posixlk-count"
 #define GLUSTERFS_PARENT_ENTRYLK "glusterfs.parent-entrylk"
 #define QUOTA_SIZE_KEY "trusted.glusterfs.quota.size"
 #define GFID_TO_PATH_KEY "glusterfs.gfid2path"
+/* gfid of the virtual directory listing every directory and data file of a
+ * brick by path, see posix_crawl_fill(). Only given to, and usable by,
+ * frames with GF_CLIENT_PID_DEFRAG */
+#define GF_XATTR_BRICK_CRAWL_GFID "glusterfs.brick-crawl-gfid"
 
 /* Index xlator related */
 #define GF_XATTROP_INDEX_GFID "glusterfs.xattrop_index_gfid"
+#define GF_XATTROP_INDEX_COUNT "glusterfs.xattrop_index_count"
+/* GF_XATTROP_INDEX_PAGE[.<gfid>] returns the gfids following <gfid> in the
+ * sorted index summary, packed 16 bytes each */
+#define GF_XATTROP_INDEX_PAGE "glusterfs.xattrop_index_page"
+
+/* set in xdata of an (f)xattrop which protocol/client may merge with other
+ * xattrops to the same brick into one XATTROP_BATCH request */
+#define GF_XATTROP_BATCH_KEY "glusterfs.xattrop-batch"
 
 #define GF_GFIDLESS_LOOKUP "gfidless-lookup"
 /* replace-brick and pump related internal xattrs */
@@ -146,6 +168,10 @@
 
 #define GF_UUID_BUF_SIZE 50
 
+/* most a single copy_file_range fop copies, the byte count travels back in
+ * an int32 op_ret; callers wanting more loop */
+#define GF_COPY_FILE_RANGE_MAX   (1024 * 1024 * 1024)
+
 #define GF_REBALANCE_TID_KEY     "rebalance-id"
 #define GF_REMOVE_BRICK_TID_KEY  "remove-brick-id"
 #define GF_REPLACE_BRICK_TID_KEY "replace-brick-id"
@@ -198,6 +224,11 @@ typedef enum {
         GF_FOP_RELEASEDIR,
         GF_FOP_GETSPEC,
         GF_FOP_FREMOVEXATTR,
+        GF_FOP_FALLOCATE,
+        GF_FOP_DISCARD,
+        GF_FOP_ZEROFILL,
+        GF_FOP_SEEK,
+        GF_FOP_COPY_FILE_RANGE,
         GF_FOP_MAXVALUE,
 } glusterfs_fop_t;
 
@@ -266,6 +297,13 @@ typedef enum {
         GF_XATTROP_AND_ARRAY
 } gf_xattrop_flags_t;
 
+/* what the seek fop looks for. These go over the wire and are not the
+   values of lseek's SEEK_DATA/SEEK_HOLE, posix translates them */
+typedef enum {
+        GF_SEEK_DATA,
+        GF_SEEK_HOLE
+} gf_seek_what_t;
+
 
 #define GF_SET_IF_NOT_PRESENT 0x1 /* default behaviour */
 #define GF_SET_OVERWRITE      0x2 /* Overwrite with the buf given */
@@ -429,6 +467,8 @@ typedef enum {
         GF_EVENT_AUTH_FAILED,
         GF_EVENT_VOLUME_DEFRAG,
         GF_EVENT_PARENT_DOWN,
+        GF_EVENT_UPCALL,
+        GF_EVENT_STATFS_PUSH,
         GF_EVENT_MAXVAL,
 } glusterfs_event_t;
 
@@ -441,6 +481,24 @@ struct gf_flock {
         gf_lkowner_t l_owner;
 };
 
+/* data of GF_EVENT_UPCALL: the holder of an inodelk is asked to release
+ * it. On the brick 'client' is the frame->root->trans of the holder and
+ * travels up to protocol/server; on the client side it is NULL. */
+typedef struct gf_upcall_recall {
+        void          *client;
+        unsigned char  gfid[16];
+        const char    *domain;
+        gf_lkowner_t   owner;
+} gf_upcall_recall_t;
+
+/* data of GF_EVENT_STATFS_PUSH: the usage of a brick. 'subvol' is set to
+ * the sender at every hop, so the receiver sees which of its children the
+ * usage belongs to. */
+typedef struct gf_statfs_push {
+        void           *subvol;
+        struct statvfs  buf;
+} gf_statfs_push_t;
+
 #define GF_MUST_CHECK __attribute__((warn_unused_result))
 /*
  * Some macros (e.g. ALLOC_OR_GOTO) set variables in function scope, but the
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifndef _CONFIG_H
 #define _CONFIG_H
@@ -89,34 +90,42 @@ uint32_t SuperFastHash (const char * data, int32_t len) {
 
 
 /* Davies-Meyer hashing function implementation
+ *
+ * The rounds are unrolled so that the round constants fold and the state
+ * stays in registers; names are hashed on every lookup and create.
  */
-static int
-dm_round (int rounds, uint32_t *array, uint32_t *h0, uint32_t *h1)
+#define DM_STEP(k) do {                                                 \
+                b0 += ((b1 << 4) + a0) ^ (b1 + (uint32_t) (DM_DELTA * (k))) \
+                        ^ ((b1 >> 5) + a1);                             \
+                b1 += ((b0 << 4) + a2) ^ (b0 + (uint32_t) (DM_DELTA * (k))) \
+                        ^ ((b0 >> 5) + a3);                             \
+        } while (0)
+
+static inline void
+dm_round (int rounds, const uint32_t *array, uint32_t *h0, uint32_t *h1)
 {
-        uint32_t sum = 0;
-        int      n = 0;
-        uint32_t b0  = 0;
-        uint32_t b1  = 0;
-
-        b0 = *h0;
-        b1 = *h1;
-
-        n = rounds;
-
-        do {
-                sum += DM_DELTA;
-                b0  += ((b1 << 4) + array[0])
-                        ^ (b1 + sum)
-                        ^ ((b1 >> 5) + array[1]);
-                b1  += ((b0 << 4) + array[2])
-                        ^ (b0 + sum)
-                        ^ ((b0 >> 5) + array[3]);
-        } while (--n);
+        uint32_t b0 = *h0;
+        uint32_t b1 = *h1;
+        uint32_t a0 = array[0];
+        uint32_t a1 = array[1];
+        uint32_t a2 = array[2];
+        uint32_t a3 = array[3];
+
+        DM_STEP (1);
+        DM_STEP (2);
+        DM_STEP (3);
+        DM_STEP (4);
+        DM_STEP (5);
+        DM_STEP (6);
+        if (rounds == DM_FULLROUNDS) {
+                DM_STEP (7);
+                DM_STEP (8);
+                DM_STEP (9);
+                DM_STEP (10);
+        }
 
         *h0 += b0;
         *h1 += b1;
-
-        return 0;
 }
 
 
@@ -138,50 +147,33 @@ gf_dm_hashfn (const char *msg, int len)
         uint32_t  h1 = 0x542e1a94;
         uint32_t  array[4];
         uint32_t  pad = 0;
-        int       i = 0;
+        int       left = len;
         int       j = 0;
-        int       full_quads = 0;
-        int       full_words = 0;
-        int       full_bytes = 0;
-        uint32_t *intmsg = NULL;
-        int       word = 0;
-
 
-        intmsg = (uint32_t *) msg;
         pad = __pad (len);
 
-        full_bytes   = len;
-        full_words   = len / 4;
-        full_quads   = len / 16;
-
-        for (i = 0; i < full_quads; i++) {
-                for (j = 0; j < 4; j++) {
-                        word     = *intmsg;
-                        array[j] = word;
-                        intmsg++;
-                        full_words--;
-                        full_bytes -= 4;
-                }
-                dm_round (DM_PARTROUNDS, &array[0], &h0, &h1);
+        /* words are taken in host byte order, as they always were */
+        for (; left >= 16; left -= 16, msg += 16) {
+                memcpy (array, msg, sizeof (array));
+                dm_round (DM_PARTROUNDS, array, &h0, &h1);
         }
 
         for (j = 0; j < 4; j++) {
-                if (full_words) {
-                        word     = *intmsg;
-                        array[j] = word;
-                        intmsg++;
-                        full_words--;
-                        full_bytes -= 4;
-                } else {
-                        array[j] = pad;
-                        while (full_bytes) {
-                                array[j] <<= 8;
-                                array[j] |= msg[len - full_bytes];
-                                full_bytes--;
-                        }
+                if (left >= 4) {
+                        memcpy (&array[j], msg, sizeof (array[j]));
+                        msg += 4;
+                        left -= 4;
+                        continue;
+                }
+                /* the tail bytes go in as (signed) char, keep it that way
+                   or names with 8-bit characters hash differently */
+                array[j] = pad;
+                for (; left; left--, msg++) {
+                        array[j] <<= 8;
+                        array[j] |= *msg;
                 }
         }
-        dm_round (DM_FULLROUNDS, &array[0], &h0, &h1);
+        dm_round (DM_FULLROUNDS, array, &h0, &h1);
 
         return h0 ^ h1;
 }
@@ -617,6 +617,51 @@ unlock:
         return iobuf;
 }
 
+/* iobuf whose ptr is aligned to @align_size (a power of two), so that
+   data received into it can be handed to an O_DIRECT fd without a
+   bounce copy. arena pages of a size multiple of @align_size are aligned
+   already (arenas are mmap()ed), other requests are padded and realigned.
+*/
+struct iobuf *
+iobuf_get_page_aligned (struct iobuf_pool *iobuf_pool, size_t page_size,
+                        size_t align_size)
+{
+        struct iobuf       *iobuf        = NULL;
+        size_t              rounded_size = 0;
+
+        GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
+
+        if (page_size == 0)
+                page_size = iobuf_pool->default_page_size;
+
+        rounded_size = gf_iobuf_get_pagesize (page_size);
+        if ((rounded_size != -1) && ((rounded_size % align_size) == 0)) {
+                iobuf = iobuf_get2 (iobuf_pool, page_size);
+                if (iobuf &&
+                    ((unsigned long) iobuf->ptr % align_size) == 0)
+                        goto out;
+
+                if (iobuf)
+                        iobuf_unref (iobuf);
+        }
+
+        iobuf = iobuf_get2 (iobuf_pool, page_size + align_size);
+        if (!iobuf)
+                goto out;
+
+        /* stdalloc iobufs already remember their allocation in free_ptr,
+           arena iobufs get their ptr restored from it in __iobuf_put() */
+        LOCK (&iobuf->lock);
+        {
+                if (!iobuf->free_ptr)
+                        iobuf->free_ptr = iobuf->ptr;
+                iobuf->ptr = GF_ALIGN_BUF (iobuf->ptr, align_size);
+        }
+        UNLOCK (&iobuf->lock);
+out:
+        return iobuf;
+}
+
 struct iobuf *
 iobuf_get (struct iobuf_pool *iobuf_pool)
 {
@@ -674,6 +719,12 @@ __iobuf_put (struct iobuf *iobuf, struct iobuf_arena *iobuf_arena)
                 return;
         }
 
+        if (iobuf->free_ptr) {
+                /* realigned by iobuf_get_page_aligned () */
+                iobuf->ptr = iobuf->free_ptr;
+                iobuf->free_ptr = NULL;
+        }
+
         if (iobuf_arena->passive_cnt == 0) {
                 list_del (&iobuf_arena->list);
                 list_add_tail (&iobuf_arena->list, &iobuf_pool->arenas[index]);
@@ -36,6 +36,9 @@
 
 #define GF_IOBUF_ALIGN_SIZE 512
 
+/* alignment which satisfies O_DIRECT on any backend */
+#define GF_IOBUF_PAGE_ALIGN_SIZE 4096
+
 /* one allocatable unit for the consumers of the IOBUF API */
 /* each unit hosts @page_size bytes of memory */
 struct iobuf;
@@ -69,7 +72,8 @@ struct iobuf {
         void                *ptr;  /* usable memory region by the consumer */
 
         void                *free_ptr; /* in case of stdalloc, this is the
-                                          one to be freed */
+                                          one to be freed. for realigned
+                                          arena iobufs, the original ptr */
 };
 
 
@@ -158,4 +162,8 @@ void   iobuf_stats_dump (struct iobuf_pool *iobuf_pool);
 
 struct iobuf *
 iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size);
+
+struct iobuf *
+iobuf_get_page_aligned (struct iobuf_pool *iobuf_pool, size_t page_size,
+                        size_t align_size);
 #endif /* !_IOBUF_H_ */
@@ -2143,3 +2143,162 @@ syncop_lk (xlator_t *subvol, fd_t *fd, int cmd, struct gf_flock *flock)
 
         return args.op_ret;
 }
+
+
+int
+syncop_inodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int op_ret, int op_errno, dict_t *xdata)
+{
+        struct syncargs *args = NULL;
+
+        args = cookie;
+
+        args->op_ret   = op_ret;
+        args->op_errno = op_errno;
+
+        __wake (args);
+
+        return 0;
+}
+
+
+int
+syncop_inodelk (xlator_t *subvol, const char *volume, loc_t *loc, int cmd,
+                struct gf_flock *lock)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_inodelk_cbk, subvol->fops->inodelk,
+                volume, loc, cmd, lock, NULL);
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
+
+
+int
+syncop_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int op_ret, int op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf, dict_t *xdata)
+{
+        struct syncargs *args = NULL;
+
+        args = cookie;
+
+        args->op_ret   = op_ret;
+        args->op_errno = op_errno;
+
+        __wake (args);
+
+        return 0;
+}
+
+
+int
+syncop_fallocate (xlator_t *subvol, fd_t *fd, int32_t keep_size,
+                  off_t offset, size_t len)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_fallocate_cbk,
+                subvol->fops->fallocate, fd, keep_size, offset, len, NULL);
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
+
+
+int
+syncop_discard (xlator_t *subvol, fd_t *fd, off_t offset, size_t len)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_fallocate_cbk,
+                subvol->fops->discard, fd, offset, len, NULL);
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
+
+
+int
+syncop_zerofill (xlator_t *subvol, fd_t *fd, off_t offset, size_t len)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_fallocate_cbk,
+                subvol->fops->zerofill, fd, offset, len, NULL);
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
+
+
+int
+syncop_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int op_ret, int op_errno, off_t offset, dict_t *xdata)
+{
+        struct syncargs *args = NULL;
+
+        args = cookie;
+
+        args->op_ret   = op_ret;
+        args->op_errno = op_errno;
+        args->offset   = offset;
+
+        __wake (args);
+
+        return 0;
+}
+
+
+int
+syncop_seek (xlator_t *subvol, fd_t *fd, off_t offset, gf_seek_what_t what,
+             off_t *off)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_seek_cbk, subvol->fops->seek,
+                fd, offset, what, NULL);
+
+        if (args.op_ret == 0 && off)
+                *off = args.offset;
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
+
+
+int
+syncop_copy_file_range_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int op_ret, int op_errno, struct iatt *stbuf,
+                            struct iatt *prebuf_dst, struct iatt *postbuf_dst,
+                            dict_t *xdata)
+{
+        struct syncargs *args = NULL;
+
+        args = cookie;
+
+        args->op_ret   = op_ret;
+        args->op_errno = op_errno;
+
+        __wake (args);
+
+        return 0;
+}
+
+
+int
+syncop_copy_file_range (xlator_t *subvol, fd_t *fd_in, off_t off_in,
+                        fd_t *fd_out, off_t off_out, size_t len,
+                        uint32_t flags)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_copy_file_range_cbk,
+                subvol->fops->copy_file_range, fd_in, off_in, fd_out,
+                off_out, len, flags, NULL);
+
+        errno = args.op_errno;
+        return args.op_ret;
+}
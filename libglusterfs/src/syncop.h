@@ -137,6 +137,7 @@ struct syncargs {
         char               *buffer;
         dict_t             *xdata;
 	struct gf_flock     flock;
+        off_t               offset;
 
         /* some more _cbk needs */
         uuid_t              uuid;
@@ -395,5 +396,17 @@ int syncop_access (xlator_t *subvol, loc_t *loc, int32_t mask);
 int syncop_rename (xlator_t *subvol, loc_t *oldloc, loc_t *newloc);
 
 int syncop_lk (xlator_t *subvol, fd_t *fd, int cmd, struct gf_flock *flock);
+int syncop_inodelk (xlator_t *subvol, const char *volume, loc_t *loc, int cmd,
+                    struct gf_flock *lock);
+
+int syncop_fallocate (xlator_t *subvol, fd_t *fd, int32_t keep_size,
+                      off_t offset, size_t len);
+int syncop_discard (xlator_t *subvol, fd_t *fd, off_t offset, size_t len);
+int syncop_zerofill (xlator_t *subvol, fd_t *fd, off_t offset, size_t len);
+int syncop_seek (xlator_t *subvol, fd_t *fd, off_t offset, gf_seek_what_t what,
+                 off_t *off);
+int syncop_copy_file_range (xlator_t *subvol, fd_t *fd_in, off_t off_in,
+                            fd_t *fd_out, off_t off_out, size_t len,
+                            uint32_t flags);
 
 #endif /* _SYNCOP_H */
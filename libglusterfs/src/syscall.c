@@ -19,6 +19,11 @@
 #include <sys/types.h>
 #include <utime.h>
 #include <sys/time.h>
+#ifdef GF_LINUX_HOST_OS
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
 
 int
 sys_lstat (const char *path, struct stat *buf)
@@ -458,3 +463,59 @@ sys_access (const char *pathname, int mode)
 {
         return access (pathname, mode);
 }
+
+
+int
+sys_fallocate (int fd, int mode, off_t offset, off_t len)
+{
+#ifdef GF_LINUX_HOST_OS
+        return fallocate (fd, mode, offset, len);
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+}
+
+
+ssize_t
+sys_copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+                     size_t len, unsigned int flags)
+{
+#if defined(GF_LINUX_HOST_OS) && defined(__NR_copy_file_range)
+        /* called through syscall(2), older glibc have no wrapper */
+        loff_t in  = *off_in;
+        loff_t out = *off_out;
+        ssize_t ret = -1;
+
+        ret = syscall (__NR_copy_file_range, fd_in, &in, fd_out, &out, len,
+                       flags);
+        if (ret > 0) {
+                *off_in  = in;
+                *off_out = out;
+        }
+        return ret;
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+}
+
+
+int
+sys_clone_range (int fd_in, off_t off_in, int fd_out, off_t off_out,
+                 off_t len)
+{
+#if defined(GF_LINUX_HOST_OS) && defined(FICLONERANGE)
+        struct file_clone_range range = {0, };
+
+        range.src_fd      = fd_in;
+        range.src_offset  = off_in;
+        range.src_length  = len;
+        range.dest_offset = off_out;
+
+        return ioctl (fd_out, FICLONERANGE, &range);
+#else
+        errno = EOPNOTSUPP;
+        return -1;
+#endif
+}
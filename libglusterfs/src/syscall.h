@@ -74,6 +74,17 @@ sys_truncate (const char *path, off_t length);
 int
 sys_ftruncate (int fd, off_t length);
 
+int
+sys_fallocate (int fd, int mode, off_t offset, off_t len);
+
+ssize_t
+sys_copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+                     size_t len, unsigned int flags);
+
+int
+sys_clone_range (int fd_in, off_t off_in, int fd_out, off_t off_out,
+                 off_t len);
+
 int
 sys_utimes (const char *filename, const struct timeval times[2]);
 
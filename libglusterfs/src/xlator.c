@@ -79,6 +79,11 @@ fill_defaults (xlator_t *xl)
         SET_DEFAULT_FOP (fxattrop);
         SET_DEFAULT_FOP (setattr);
         SET_DEFAULT_FOP (fsetattr);
+        SET_DEFAULT_FOP (fallocate);
+        SET_DEFAULT_FOP (discard);
+        SET_DEFAULT_FOP (zerofill);
+        SET_DEFAULT_FOP (seek);
+        SET_DEFAULT_FOP (copy_file_range);
 
         SET_DEFAULT_FOP (getspec);
 
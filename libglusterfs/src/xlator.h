@@ -152,6 +152,51 @@ typedef int32_t (*fop_ftruncate_cbk_t) (call_frame_t *frame,
                                         struct iatt *prebuf,
                                         struct iatt *postbuf, dict_t *xdata);
 
+typedef int32_t (*fop_fallocate_cbk_t) (call_frame_t *frame,
+                                        void *cookie,
+                                        xlator_t *this,
+                                        int32_t op_ret,
+                                        int32_t op_errno,
+                                        struct iatt *preop_stbuf,
+                                        struct iatt *postop_stbuf,
+                                        dict_t *xdata);
+
+typedef int32_t (*fop_discard_cbk_t) (call_frame_t *frame,
+                                      void *cookie,
+                                      xlator_t *this,
+                                      int32_t op_ret,
+                                      int32_t op_errno,
+                                      struct iatt *preop_stbuf,
+                                      struct iatt *postop_stbuf,
+                                      dict_t *xdata);
+
+typedef int32_t (*fop_zerofill_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       struct iatt *preop_stbuf,
+                                       struct iatt *postop_stbuf,
+                                       dict_t *xdata);
+
+typedef int32_t (*fop_seek_cbk_t) (call_frame_t *frame,
+                                   void *cookie,
+                                   xlator_t *this,
+                                   int32_t op_ret,
+                                   int32_t op_errno,
+                                   off_t offset,
+                                   dict_t *xdata);
+
+typedef int32_t (*fop_copy_file_range_cbk_t) (call_frame_t *frame,
+                                              void *cookie,
+                                              xlator_t *this,
+                                              int32_t op_ret,
+                                              int32_t op_errno,
+                                              struct iatt *stbuf,
+                                              struct iatt *prebuf_dst,
+                                              struct iatt *postbuf_dst,
+                                              dict_t *xdata);
+
 typedef int32_t (*fop_access_cbk_t) (call_frame_t *frame,
                                      void *cookie,
                                      xlator_t *this,
@@ -440,6 +485,42 @@ typedef int32_t (*fop_ftruncate_t) (call_frame_t *frame,
                                     fd_t *fd,
                                     off_t offset, dict_t *xdata);
 
+typedef int32_t (*fop_fallocate_t) (call_frame_t *frame,
+                                    xlator_t *this,
+                                    fd_t *fd,
+                                    int32_t keep_size,
+                                    off_t offset,
+                                    size_t len, dict_t *xdata);
+
+typedef int32_t (*fop_discard_t) (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  off_t offset,
+                                  size_t len, dict_t *xdata);
+
+typedef int32_t (*fop_zerofill_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   fd_t *fd,
+                                   off_t offset,
+                                   size_t len, dict_t *xdata);
+
+typedef int32_t (*fop_seek_t) (call_frame_t *frame,
+                               xlator_t *this,
+                               fd_t *fd,
+                               off_t offset,
+                               gf_seek_what_t what,
+                               dict_t *xdata);
+
+typedef int32_t (*fop_copy_file_range_t) (call_frame_t *frame,
+                                          xlator_t *this,
+                                          fd_t *fd_in,
+                                          off_t off_in,
+                                          fd_t *fd_out,
+                                          off_t off_out,
+                                          size_t len,
+                                          uint32_t flags,
+                                          dict_t *xdata);
+
 typedef int32_t (*fop_access_t) (call_frame_t *frame,
                                  xlator_t *this,
                                  loc_t *loc,
@@ -678,6 +759,11 @@ struct xlator_fops {
         fop_setattr_t        setattr;
         fop_fsetattr_t       fsetattr;
         fop_getspec_t        getspec;
+        fop_fallocate_t      fallocate;
+        fop_discard_t        discard;
+        fop_zerofill_t       zerofill;
+        fop_seek_t           seek;
+        fop_copy_file_range_t copy_file_range;
 
         /* these entries are used for a typechecking hack in STACK_WIND _only_ */
         fop_lookup_cbk_t         lookup_cbk;
@@ -722,6 +808,11 @@ struct xlator_fops {
         fop_setattr_cbk_t        setattr_cbk;
         fop_fsetattr_cbk_t       fsetattr_cbk;
         fop_getspec_cbk_t        getspec_cbk;
+        fop_fallocate_cbk_t      fallocate_cbk;
+        fop_discard_cbk_t        discard_cbk;
+        fop_zerofill_cbk_t       zerofill_cbk;
+        fop_seek_cbk_t           seek_cbk;
+        fop_copy_file_range_cbk_t copy_file_range_cbk;
 };
 
 typedef int32_t (*cbk_forget_t) (xlator_t *this,
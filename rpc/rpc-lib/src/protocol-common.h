@@ -56,6 +56,12 @@ enum gf_fop_procnum {
         GFS3_OP_RELEASE,
         GFS3_OP_RELEASEDIR,
         GFS3_OP_FREMOVEXATTR,
+        GFS3_OP_FALLOCATE,
+        GFS3_OP_DISCARD,
+        GFS3_OP_ZEROFILL,
+        GFS3_OP_SEEK,
+        GFS3_OP_COPY_FILE_RANGE,
+        GFS3_OP_XATTROP_BATCH,
         GFS3_OP_MAXVALUE,
 } ;
 
@@ -114,6 +120,8 @@ enum gf_cbk_procnum {
         GF_CBK_FETCHSPEC,
         GF_CBK_INO_FLUSH,
         GF_CBK_EVENT_NOTIFY,
+        GF_CBK_INODELK_RECALL,
+        GF_CBK_STATFS_PUSH,
         GF_CBK_MAXVALUE,
 };
 
@@ -205,7 +213,8 @@ typedef enum {
         GF_AFR_OP_INDEX_SUMMARY,
         GF_AFR_OP_HEALED_FILES,
         GF_AFR_OP_HEAL_FAILED_FILES,
-        GF_AFR_OP_SPLIT_BRAIN_FILES
+        GF_AFR_OP_SPLIT_BRAIN_FILES,
+        GF_AFR_OP_INDEX_COUNT
 } gf_xl_afr_op_t ;
 
 typedef enum {
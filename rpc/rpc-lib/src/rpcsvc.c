@@ -861,6 +861,7 @@ rpcsvc_callback_submit (rpcsvc_t *rpc, rpc_transport_t *trans,
                         struct iovec *proghdr, int proghdrcount)
 {
         struct iobuf          *request_iob = NULL;
+        struct iobref         *iobref      = NULL;
         struct iovec           rpchdr      = {0,};
         rpc_transport_req_t    req;
         int                    ret         = -1;
@@ -889,10 +890,26 @@ rpcsvc_callback_submit (rpcsvc_t *rpc, rpc_transport_t *trans,
                 goto out;
         }
 
+        /* the transport may queue the message and write it out after we
+         * return, so the program header is copied behind the rpc header
+         * (the record was sized for both) and the buffer is handed over
+         * in an iobref instead of being owned by the caller.
+         */
+        if (proghdr) {
+                iov_unload ((char *)rpchdr.iov_base + rpchdr.iov_len,
+                            proghdr, proghdrcount);
+                rpchdr.iov_len += proglen;
+        }
+
+        iobref = iobref_new ();
+        if (!iobref)
+                goto out;
+
+        iobref_add (iobref, request_iob);
+
         req.msg.rpchdr = &rpchdr;
         req.msg.rpchdrcount = 1;
-        req.msg.proghdr = proghdr;
-        req.msg.proghdrcount = proghdrcount;
+        req.msg.iobref = iobref;
 
         ret = rpc_transport_submit_request (trans, &req);
         if (ret == -1) {
@@ -904,7 +921,11 @@ rpcsvc_callback_submit (rpcsvc_t *rpc, rpc_transport_t *trans,
         ret = 0;
 
 out:
-        iobuf_unref (request_iob);
+        if (iobref)
+                iobref_unref (iobref);
+
+        if (request_iob)
+                iobuf_unref (request_iob);
 
         return ret;
 }
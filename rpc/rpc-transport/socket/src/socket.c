@@ -1304,7 +1304,11 @@ sp_state_read_proghdr_xdata:
                 if (in->payload_vector.iov_base == NULL) {
 
                         size = RPC_FRAGSIZE (in->fraghdr) - frag->bytes_read;
-                        iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+                        /* land write payloads page aligned, so that
+                           O_DIRECT bricks need no bounce buffer */
+                        iobuf = iobuf_get_page_aligned (this->ctx->iobuf_pool,
+                                                        size,
+                                                        GF_IOBUF_PAGE_ALIGN_SIZE);
                         if (!iobuf) {
                                 ret = -1;
                                 break;
@@ -1514,7 +1518,9 @@ __socket_read_accepted_successful_reply (rpc_transport_t *this)
 
                         size = (RPC_FRAGSIZE (in->fraghdr) - frag->bytes_read);
 
-                        iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+                        iobuf = iobuf_get_page_aligned (this->ctx->iobuf_pool,
+                                                        size,
+                                                        GF_IOBUF_PAGE_ALIGN_SIZE);
                         if (iobuf == NULL) {
                                 ret = -1;
                                 goto out;
@@ -1109,6 +1109,182 @@ struct gf_event_notify_rsp {
 };
 typedef struct gf_event_notify_rsp gf_event_notify_rsp;
 
+struct gfs3_fallocate_req {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	u_quad_t offset;
+	u_quad_t size;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_fallocate_req gfs3_fallocate_req;
+
+struct gfs3_fallocate_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_fallocate_rsp gfs3_fallocate_rsp;
+
+struct gfs3_discard_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_discard_req gfs3_discard_req;
+
+struct gfs3_discard_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_discard_rsp gfs3_discard_rsp;
+
+struct gfs3_zerofill_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_zerofill_req gfs3_zerofill_req;
+
+struct gfs3_zerofill_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_zerofill_rsp gfs3_zerofill_rsp;
+
+struct gfs3_seek_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	int what;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_seek_req gfs3_seek_req;
+
+struct gfs3_seek_rsp {
+	int op_ret;
+	int op_errno;
+	u_quad_t offset;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_seek_rsp gfs3_seek_rsp;
+
+struct gfs3_copy_file_range_req {
+	char gfid1[16];
+	char gfid2[16];
+	quad_t fd_in;
+	quad_t fd_out;
+	u_quad_t off_in;
+	u_quad_t off_out;
+	u_quad_t size;
+	u_int flags;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_copy_file_range_req gfs3_copy_file_range_req;
+
+struct gfs3_copy_file_range_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt stat;
+	struct gf_iatt prestat;
+	struct gf_iatt poststat;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_copy_file_range_rsp gfs3_copy_file_range_rsp;
+
+struct gfs3_xattrop_batch_entry {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	struct {
+		u_int dict_len;
+		char *dict_val;
+	} dict;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_xattrop_batch_entry gfs3_xattrop_batch_entry;
+
+struct gfs3_xattrop_batch_req {
+	struct {
+		u_int entries_len;
+		struct gfs3_xattrop_batch_entry *entries_val;
+	} entries;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_xattrop_batch_req gfs3_xattrop_batch_req;
+
+struct gfs3_xattrop_batch_rsp {
+	int op_ret;
+	int op_errno;
+	struct {
+		u_int entries_len;
+		struct gfs3_xattrop_rsp *entries_val;
+	} entries;
+	struct {
+		u_int xdata_len;
+		char *xdata_val;
+	} xdata;
+};
+typedef struct gfs3_xattrop_batch_rsp gfs3_xattrop_batch_rsp;
+
+struct gfs3_inodelk_recall_req {
+	char gfid[16];
+	char *domain;
+	struct {
+		u_int lk_owner_len;
+		char *lk_owner_val;
+	} lk_owner;
+};
+typedef struct gfs3_inodelk_recall_req gfs3_inodelk_recall_req;
+
 /* the xdr functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -1204,6 +1380,20 @@ extern  bool_t xdr_gf_set_lk_ver_rsp (XDR *, gf_set_lk_ver_rsp*);
 extern  bool_t xdr_gf_set_lk_ver_req (XDR *, gf_set_lk_ver_req*);
 extern  bool_t xdr_gf_event_notify_req (XDR *, gf_event_notify_req*);
 extern  bool_t xdr_gf_event_notify_rsp (XDR *, gf_event_notify_rsp*);
+extern  bool_t xdr_gfs3_fallocate_req (XDR *, gfs3_fallocate_req*);
+extern  bool_t xdr_gfs3_fallocate_rsp (XDR *, gfs3_fallocate_rsp*);
+extern  bool_t xdr_gfs3_discard_req (XDR *, gfs3_discard_req*);
+extern  bool_t xdr_gfs3_discard_rsp (XDR *, gfs3_discard_rsp*);
+extern  bool_t xdr_gfs3_zerofill_req (XDR *, gfs3_zerofill_req*);
+extern  bool_t xdr_gfs3_zerofill_rsp (XDR *, gfs3_zerofill_rsp*);
+extern  bool_t xdr_gfs3_seek_req (XDR *, gfs3_seek_req*);
+extern  bool_t xdr_gfs3_seek_rsp (XDR *, gfs3_seek_rsp*);
+extern  bool_t xdr_gfs3_copy_file_range_req (XDR *, gfs3_copy_file_range_req*);
+extern  bool_t xdr_gfs3_copy_file_range_rsp (XDR *, gfs3_copy_file_range_rsp*);
+extern  bool_t xdr_gfs3_xattrop_batch_entry (XDR *, gfs3_xattrop_batch_entry*);
+extern  bool_t xdr_gfs3_xattrop_batch_req (XDR *, gfs3_xattrop_batch_req*);
+extern  bool_t xdr_gfs3_xattrop_batch_rsp (XDR *, gfs3_xattrop_batch_rsp*);
+extern  bool_t xdr_gfs3_inodelk_recall_req (XDR *, gfs3_inodelk_recall_req*);
 
 #else /* K&R C */
 extern bool_t xdr_gf_statfs ();
@@ -1298,6 +1488,20 @@ extern bool_t xdr_gf_set_lk_ver_rsp ();
 extern bool_t xdr_gf_set_lk_ver_req ();
 extern bool_t xdr_gf_event_notify_req ();
 extern bool_t xdr_gf_event_notify_rsp ();
+extern bool_t xdr_gfs3_fallocate_req ();
+extern bool_t xdr_gfs3_fallocate_rsp ();
+extern bool_t xdr_gfs3_discard_req ();
+extern bool_t xdr_gfs3_discard_rsp ();
+extern bool_t xdr_gfs3_zerofill_req ();
+extern bool_t xdr_gfs3_zerofill_rsp ();
+extern bool_t xdr_gfs3_seek_req ();
+extern bool_t xdr_gfs3_seek_rsp ();
+extern bool_t xdr_gfs3_copy_file_range_req ();
+extern bool_t xdr_gfs3_copy_file_range_rsp ();
+extern bool_t xdr_gfs3_xattrop_batch_entry ();
+extern bool_t xdr_gfs3_xattrop_batch_req ();
+extern bool_t xdr_gfs3_xattrop_batch_rsp ();
+extern bool_t xdr_gfs3_inodelk_recall_req ();
 
 #endif /* K&R C */
 
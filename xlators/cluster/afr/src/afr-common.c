@@ -208,6 +208,7 @@ afr_inode_ctx_destroy (afr_inode_ctx_t *ctx)
         if (!ctx)
                 return;
         GF_FREE (ctx->fresh_children);
+        GF_FREE (ctx->lagging);
         GF_FREE (ctx);
 }
 
@@ -236,6 +237,12 @@ __afr_inode_ctx_get (inode_t *inode, xlator_t *this)
                                          gf_afr_mt_int32_t);
         if (!ctx->fresh_children)
                 goto fail;
+        ctx->lagging = GF_CALLOC (priv->child_count, sizeof (*ctx->lagging),
+                                  gf_afr_mt_int32_t);
+        if (!ctx->lagging)
+                goto fail;
+        INIT_LIST_HEAD (&ctx->early_acks);
+        INIT_LIST_HEAD (&ctx->ack_waiters);
         ret = __inode_ctx_put (inode, this, (uint64_t)ctx);
         if (ret) {
                 gf_log_callingfn (this->name, GF_LOG_ERROR, "failed to "
@@ -438,6 +445,14 @@ afr_inode_set_ctx_params (xlator_t *this, inode_t *inode,
                 case AFR_INODE_SET_OPENDIR_DONE:
                         afr_inode_ctx_set_opendir_done (ctx);
                         break;
+                case AFR_INODE_SET_READ_CHILD:
+                        /* the child may have gone stale meanwhile */
+                        read_child = params->u.read_ctx.read_child;
+                        if (afr_is_child_present (ctx->fresh_children,
+                                                  priv->child_count,
+                                                  read_child))
+                                afr_inode_ctx_set_read_child (ctx, read_child);
+                        break;
                 default:
                         GF_ASSERT (0);
                         break;
@@ -488,6 +503,18 @@ afr_inode_set_read_ctx (xlator_t *this, inode_t *inode, int32_t read_child,
         afr_inode_set_ctx_params (this, inode, &params);
 }
 
+void
+afr_inode_set_read_child (xlator_t *this, inode_t *inode, int32_t read_child)
+{
+        afr_inode_params_t params = {0};
+
+        GF_ASSERT (read_child >= 0);
+
+        params.op = AFR_INODE_SET_READ_CHILD;
+        params.u.read_ctx.read_child = read_child;
+        afr_inode_set_ctx_params (this, inode, &params);
+}
+
 void
 afr_inode_rm_stale_children (xlator_t *this, inode_t *inode,
                              int32_t *stale_children)
@@ -661,6 +688,126 @@ afr_set_read_ctx_from_policy (xlator_t *this, inode_t *inode,
                                         fresh_children);
 }
 
+void
+afr_child_load_start (xlator_t *this, int32_t child, struct timeval *start)
+{
+        afr_private_t   *priv = NULL;
+
+        priv = this->private;
+        if (!priv->read_least_load)
+                return;
+
+        gettimeofday (start, NULL);
+
+        LOCK (&priv->read_child_lock);
+        {
+                priv->child_load[child].inflight++;
+        }
+        UNLOCK (&priv->read_child_lock);
+}
+
+/* Latency is folded into a moving average with a weight of 1/8 for the
+ * new sample, like TCP does for its RTT estimate. Failed replies only
+ * release their in-flight slot: an error returned quickly by a sick
+ * brick must not make it look fast.
+ */
+void
+afr_child_load_end (xlator_t *this, int32_t child, struct timeval *start,
+                    int32_t op_ret)
+{
+        afr_private_t    *priv    = NULL;
+        afr_child_load_t *load    = NULL;
+        struct timeval    now     = {0, };
+        uint64_t          sample  = 0;
+
+        priv = this->private;
+        if (!start->tv_sec && !start->tv_usec)
+                return;
+
+        gettimeofday (&now, NULL);
+        sample = (now.tv_sec - start->tv_sec) * 1000000 +
+                 (now.tv_usec - start->tv_usec);
+
+        LOCK (&priv->read_child_lock);
+        {
+                load = &priv->child_load[child];
+                if (load->inflight > 0)
+                        load->inflight--;
+
+                if (op_ret >= 0) {
+                        if (!load->latency)
+                                load->latency = sample;
+                        else
+                                load->latency = (load->latency * 7 +
+                                                 sample) / 8;
+                        load->sampled = now.tv_sec;
+                }
+        }
+        UNLOCK (&priv->read_child_lock);
+
+        start->tv_sec = start->tv_usec = 0;
+}
+
+/* Picks the readable child with the least expected wait, which is its
+ * average latency scaled by the reads already queued on it. The current
+ * read child is kept unless another one beats it by read_hysteresis
+ * percent, so that two children of similar speed do not flap.
+ */
+int32_t
+afr_least_loaded_read_child (xlator_t *this, int32_t *fresh_children,
+                             unsigned char *child_up, int32_t read_child)
+{
+        afr_private_t    *priv       = NULL;
+        afr_child_load_t *load       = NULL;
+        int32_t           best       = -1;
+        uint64_t          best_score = 0;
+        uint64_t          cur_score  = 0;
+        uint64_t          score      = 0;
+        uint64_t          latency    = 0;
+        time_t            idle       = 0;
+        time_t            now        = 0;
+        int32_t           child      = -1;
+        int               i          = 0;
+
+        priv = this->private;
+        now = time (NULL);
+
+        LOCK (&priv->read_child_lock);
+        {
+                for (i = 0; i < priv->child_count; i++) {
+                        child = fresh_children[i];
+                        if (child < 0)
+                                break;
+                        if (!child_up[child])
+                                continue;
+
+                        load = &priv->child_load[child];
+                        latency = load->latency;
+                        idle = (now - load->sampled) /
+                                AFR_CHILD_LOAD_DECAY_SECS;
+                        if (idle > 0)
+                                latency >>= min (idle, 63);
+
+                        score = (latency + 1) * (load->inflight + 1);
+                        if (child == read_child)
+                                cur_score = score;
+                        if ((best < 0) || (score < best_score)) {
+                                best = child;
+                                best_score = score;
+                        }
+                }
+        }
+        UNLOCK (&priv->read_child_lock);
+
+        if ((best < 0) || (best == read_child) || !cur_score)
+                goto out;
+
+        if (best_score * 100 >= cur_score * (100 - priv->read_hysteresis))
+                best = read_child;
+out:
+        return (best < 0) ? read_child : best;
+}
+
 /* afr_next_call_child ()
  * This is a common function used by all the read-type fops
  * This function should not be called with the inode's read_children array.
@@ -817,6 +964,16 @@ afr_local_sh_cleanup (afr_local_t *local, xlator_t *this)
 
         GF_FREE (sh->checksum);
 
+        GF_FREE (sh->delta_weak);
+        GF_FREE (sh->delta_strong);
+        GF_FREE (sh->delta_dirty);
+        GF_FREE (sh->delta_ops);
+        if (sh->delta_iobref)
+                iobref_unref (sh->delta_iobref);
+        GF_FREE (sh->dirty_map);
+
+        afr_sh_entry_merge_destroy (sh->entry_merge);
+
         GF_FREE (sh->write_needed);
         if (sh->healing_fd)
                 fd_unref (sh->healing_fd);
@@ -857,6 +1014,8 @@ void
 afr_local_cleanup (afr_local_t *local, xlator_t *this)
 {
         afr_private_t * priv = NULL;
+        afr_read_stripe_t *stripe = NULL;
+        int             i    = 0;
 
         if (!local)
                 return;
@@ -948,6 +1107,21 @@ afr_local_cleanup (afr_local_t *local, xlator_t *this)
                 GF_FREE (local->cont.writev.vector);
         }
 
+        { /* readv */
+                for (i = 0; i < local->cont.readv.stripe_count; i++) {
+                        stripe = &local->cont.readv.stripes[i];
+                        GF_FREE (stripe->vector);
+                        if (stripe->iobref)
+                                iobref_unref (stripe->iobref);
+                }
+                GF_FREE (local->cont.readv.stripes);
+        }
+
+        { /* copy_file_range */
+                if (local->cont.copy_file_range.fd_in)
+                        fd_unref (local->cont.copy_file_range.fd_in);
+        }
+
         { /* setxattr */
                 if (local->cont.setxattr.dict)
                         dict_unref (local->cont.setxattr.dict);
@@ -2455,6 +2629,8 @@ __afr_fd_ctx_set (xlator_t *this, fd_t *fd)
 
 	pthread_mutex_init (&fd_ctx->delay_lock, NULL);
         INIT_LIST_HEAD (&fd_ctx->entries);
+        INIT_LIST_HEAD (&fd_ctx->lease_list);
+        fd_ctx->lease_fd = fd;
         fd_ctx->call_child = -1;
 
         ret = __fd_ctx_set (fd, this, (uint64_t)(long) fd_ctx);
@@ -2571,8 +2747,11 @@ afr_cleanup_fd_ctx (xlator_t *this, fd_t *fd)
 {
         uint64_t        ctx = 0;
         afr_fd_ctx_t    *fd_ctx = NULL;
+        afr_private_t   *priv = NULL;
         int             ret = 0;
 
+        priv = this->private;
+
         ret = fd_ctx_get (fd, this, &ctx);
         if (ret < 0)
                 goto out;
@@ -2593,6 +2772,14 @@ afr_cleanup_fd_ctx (xlator_t *this, fd_t *fd)
 
 		pthread_mutex_destroy (&fd_ctx->delay_lock);
 
+                if (!list_empty (&fd_ctx->lease_list)) {
+                        LOCK (&priv->lock);
+                        {
+                                list_del_init (&fd_ctx->lease_list);
+                        }
+                        UNLOCK (&priv->lock);
+                }
+
                 GF_FREE (fd_ctx);
         }
 
@@ -3591,6 +3778,19 @@ afr_priv_dump (xlator_t *this)
         gf_proc_dump_write("read_child", "%d", priv->read_child);
         gf_proc_dump_write("favorite_child", "%d", priv->favorite_child);
         gf_proc_dump_write("wait_count", "%u", priv->wait_count);
+        gf_proc_dump_write("read_least_load", "%d", priv->read_least_load);
+        if (priv->child_load) {
+                LOCK (&priv->read_child_lock);
+                for (i = 0; i < priv->child_count; i++) {
+                        sprintf (key, "read_latency_usec[%d]", i);
+                        gf_proc_dump_write(key, "%"PRIu64,
+                                           priv->child_load[i].latency);
+                        sprintf (key, "reads_inflight[%d]", i);
+                        gf_proc_dump_write(key, "%d",
+                                           priv->child_load[i].inflight);
+                }
+                UNLOCK (&priv->read_child_lock);
+        }
 
         return 0;
 }
@@ -3641,6 +3841,18 @@ afr_notify (xlator_t *this, int32_t event,
         if (!priv)
                 return 0;
 
+        /* recalls are not about a child, data is the recall itself */
+        if (event == GF_EVENT_UPCALL) {
+                if (data)
+                        afr_inodelk_recall (this, data);
+                return 0;
+        }
+
+        /* usage pushed by one of the bricks, the replicas hold the same
+           data so it stands for the whole subvolume */
+        if (event == GF_EVENT_STATFS_PUSH)
+                return default_notify (this, event, data);
+
         /*
          * We need to reset this in case children come up in "staggered"
          * fashion, so that we discover a late-arriving local subvolume.  Note
@@ -4154,6 +4366,259 @@ out:
         return _gf_false;
 }
 
+/* same rule as afr_have_quorum, for the children set in @success */
+gf_boolean_t
+afr_quorum_met (afr_private_t *priv, unsigned char *success)
+{
+        unsigned int count = 0;
+        unsigned int quorum = 0;
+        int          i = 0;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (success[i])
+                        count++;
+        }
+
+        quorum = priv->quorum_count;
+        if (quorum != AFR_QUORUM_AUTO)
+                return (count >= quorum);
+
+        if (count >= priv->child_count / 2 + 1)
+                return _gf_true;
+
+        if (((priv->child_count % 2) == 0) &&
+            (count == priv->child_count / 2) && success[0])
+                return _gf_true;
+
+        return _gf_false;
+}
+
+
+/* Writes acknowledged once a quorum of children wrote them finish on the
+ * other children in the background. Until they do, fops which change
+ * the same range wait, so that a child never sees them in another order
+ * than the application issued them.
+ */
+static gf_boolean_t
+__afr_early_ack_overlaps (afr_inode_ctx_t *ctx, off_t start, off_t end)
+{
+        afr_early_ack_t *ack = NULL;
+
+        list_for_each_entry (ack, &ctx->early_acks, list) {
+                if ((start < ack->end) && (ack->start < end))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+gf_boolean_t
+afr_early_ack_pending (xlator_t *this, inode_t *inode)
+{
+        afr_inode_ctx_t *ctx     = NULL;
+        gf_boolean_t     pending = _gf_false;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (ctx)
+                        pending = !list_empty (&ctx->early_acks);
+        }
+        UNLOCK (&inode->lock);
+
+        return pending;
+}
+
+
+/* queues @stub if [start, end) overlaps a write still in flight */
+gf_boolean_t
+afr_early_ack_wait (xlator_t *this, inode_t *inode, off_t start, off_t end,
+                    call_stub_t *stub)
+{
+        afr_inode_ctx_t  *ctx    = NULL;
+        afr_ack_waiter_t *waiter = NULL;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (!ctx || !__afr_early_ack_overlaps (ctx, start, end))
+                        goto unlock;
+
+                waiter = GF_CALLOC (1, sizeof (*waiter),
+                                    gf_afr_mt_ack_waiter_t);
+                if (!waiter)
+                        goto unlock;
+
+                waiter->start = start;
+                waiter->end   = end;
+                waiter->stub  = stub;
+                list_add_tail (&waiter->list, &ctx->ack_waiters);
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        return (waiter != NULL);
+}
+
+
+void
+afr_early_ack_start (xlator_t *this, inode_t *inode, afr_early_ack_t *ack,
+                     unsigned char *lagging)
+{
+        afr_private_t   *priv = NULL;
+        afr_inode_ctx_t *ctx  = NULL;
+        int              i    = 0;
+
+        priv = this->private;
+
+        INIT_LIST_HEAD (&ack->list);
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (!ctx)
+                        goto unlock;
+
+                for (i = 0; i < priv->child_count; i++) {
+                        if (lagging[i])
+                                ctx->lagging[i]++;
+                }
+                list_add_tail (&ack->list, &ctx->early_acks);
+        }
+unlock:
+        UNLOCK (&inode->lock);
+}
+
+
+void
+afr_early_ack_reply (xlator_t *this, inode_t *inode, afr_early_ack_t *ack,
+                     int child)
+{
+        afr_inode_ctx_t *ctx = NULL;
+
+        LOCK (&inode->lock);
+        {
+                if (list_empty (&ack->list))
+                        goto unlock;
+
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (ctx && ctx->lagging[child])
+                        ctx->lagging[child]--;
+        }
+unlock:
+        UNLOCK (&inode->lock);
+}
+
+
+void
+afr_early_ack_done (xlator_t *this, inode_t *inode, afr_early_ack_t *ack)
+{
+        afr_inode_ctx_t  *ctx    = NULL;
+        afr_ack_waiter_t *waiter = NULL;
+        afr_ack_waiter_t *tmp    = NULL;
+        struct list_head  resume;
+
+        INIT_LIST_HEAD (&resume);
+
+        LOCK (&inode->lock);
+        {
+                if (list_empty (&ack->list))
+                        goto unlock;
+
+                list_del_init (&ack->list);
+
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (!ctx)
+                        goto unlock;
+
+                list_for_each_entry_safe (waiter, tmp, &ctx->ack_waiters,
+                                          list) {
+                        if (__afr_early_ack_overlaps (ctx, waiter->start,
+                                                      waiter->end))
+                                continue;
+                        list_move_tail (&waiter->list, &resume);
+                }
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        list_for_each_entry_safe (waiter, tmp, &resume, list) {
+                list_del_init (&waiter->list);
+                call_resume (waiter->stub);
+                GF_FREE (waiter);
+        }
+}
+
+
+/* whether @child has not answered a write which was acknowledged already,
+   or with @child == -1 whether any child has not */
+gf_boolean_t
+afr_early_ack_lagging (xlator_t *this, inode_t *inode, int child)
+{
+        afr_private_t   *priv    = NULL;
+        afr_inode_ctx_t *ctx     = NULL;
+        gf_boolean_t     lagging = _gf_false;
+        int              i       = 0;
+
+        priv = this->private;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (!ctx)
+                        goto unlock;
+
+                for (i = 0; i < priv->child_count; i++) {
+                        if ((child == -1 || child == i) && ctx->lagging[i])
+                                lagging = _gf_true;
+                }
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        return lagging;
+}
+
+/* whether a pre-op started the dirty map of 'inode' since data-dirty-map
+   was last turned on */
+gf_boolean_t
+afr_dirty_map_started (xlator_t *this, inode_t *inode)
+{
+        afr_private_t   *priv    = this->private;
+        afr_inode_ctx_t *ctx     = NULL;
+        gf_boolean_t     started = _gf_false;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (ctx)
+                        started = (ctx->dirty_map_started ==
+                                   priv->dirty_map_off_gen);
+        }
+        UNLOCK (&inode->lock);
+
+        return started;
+}
+
+void
+afr_dirty_map_set_started (xlator_t *this, inode_t *inode,
+                           gf_boolean_t started)
+{
+        afr_private_t   *priv = this->private;
+        afr_inode_ctx_t *ctx  = NULL;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __afr_inode_ctx_get (inode, this);
+                if (ctx)
+                        ctx->dirty_map_started = started ?
+                                                 priv->dirty_map_off_gen : 0;
+        }
+        UNLOCK (&inode->lock);
+}
+
+
 void
 afr_priv_destroy (afr_private_t *priv)
 {
@@ -4169,6 +4634,7 @@ afr_priv_destroy (afr_private_t *priv)
 //                if (priv->shd.timer && priv->shd.timer[i])
 //                        gf_timer_call_cancel (this->ctx, priv->shd.timer[i]);
         GF_FREE (priv->shd.timer);
+        GF_FREE (priv->shd.progress);
 
         if (priv->shd.healed)
                 eh_destroy (priv->shd.healed);
@@ -4180,6 +4646,7 @@ afr_priv_destroy (afr_private_t *priv)
                 eh_destroy (priv->shd.split_brain);
 
         GF_FREE (priv->last_event);
+        GF_FREE (priv->child_load);
         if (priv->pending_key) {
                 for (i = 0; i < priv->child_count; i++)
                         GF_FREE (priv->pending_key[i]);
@@ -1767,6 +1767,9 @@ afr_readv_cbk (call_frame_t *frame, void *cookie,
 
         read_child = (long) cookie;
 
+        afr_child_load_end (this, local->cont.readv.call_child,
+                            &local->cont.readv.start, op_ret);
+
         if (op_ret == -1) {
                 last_index = &local->cont.readv.last_index;
                 fresh_children = local->fresh_children;
@@ -1779,6 +1782,10 @@ afr_readv_cbk (call_frame_t *frame, void *cookie,
 
                 unwind = 0;
 
+                local->cont.readv.call_child = next_call_child;
+                afr_child_load_start (this, next_call_child,
+                                      &local->cont.readv.start);
+
                 STACK_WIND_COOKIE (frame, afr_readv_cbk,
                                    (void *) (long) read_child,
                                    children[next_call_child],
@@ -1799,6 +1806,210 @@ out:
 }
 
 
+/* Striped reads: a large read of a file which is clean on every child is
+ * split into one chunk per readable child and the chunks are read in
+ * parallel. If any chunk fails, the whole range is read again from the
+ * read child, with the usual failover.
+ */
+int
+afr_readv_stripe_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t     *priv     = NULL;
+        afr_local_t       *local    = NULL;
+        afr_read_stripe_t *stripe   = NULL;
+        struct iovec      *vector   = NULL;
+        struct iobref     *iobref   = NULL;
+        int32_t            count    = 0;
+        int32_t            op_ret   = 0;
+        int32_t            op_errno = 0;
+        int                i        = 0;
+        int                last     = 0;
+        int                call_child = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        for (i = 0; i < local->cont.readv.stripe_count; i++) {
+                stripe = &local->cont.readv.stripes[i];
+                if (stripe->op_ret < 0)
+                        goto fallback;
+        }
+
+        /* a short chunk is the end of file, ignore what follows it */
+        for (last = 0; last < local->cont.readv.stripe_count; last++) {
+                stripe = &local->cont.readv.stripes[last];
+                count += stripe->count;
+                if ((size_t) stripe->op_ret < stripe->size)
+                        break;
+        }
+        if (last == local->cont.readv.stripe_count)
+                last--;
+
+        vector = GF_CALLOC (count ? count : 1, sizeof (*vector),
+                            gf_afr_mt_iovec);
+        iobref = iobref_new ();
+        if (!vector || !iobref) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        count = 0;
+        for (i = 0; i <= last; i++) {
+                stripe = &local->cont.readv.stripes[i];
+                memcpy (&vector[count], stripe->vector,
+                        stripe->count * sizeof (*vector));
+                count += stripe->count;
+                op_ret += stripe->op_ret;
+                if (stripe->iobref)
+                        iobref_merge (iobref, stripe->iobref);
+        }
+
+unwind:
+        AFR_STACK_UNWIND (readv, frame, op_ret, op_errno, vector, count,
+                          &local->cont.readv.stripes[last].buf, iobref, NULL);
+
+        GF_FREE (vector);
+        if (iobref)
+                iobref_unref (iobref);
+        return 0;
+
+fallback:
+        call_child = local->cont.readv.call_child;
+
+        gf_log (this->name, GF_LOG_DEBUG, "striped read of %s failed (%s), "
+                "reading from %s", uuid_utoa (local->fd->inode->gfid),
+                strerror (stripe->op_errno), priv->children[call_child]->name);
+
+        STACK_WIND_COOKIE (frame, afr_readv_cbk,
+                           (void *) (long) call_child,
+                           priv->children[call_child],
+                           priv->children[call_child]->fops->readv,
+                           local->fd, local->cont.readv.size,
+                           local->cont.readv.offset,
+                           local->cont.readv.flags, NULL);
+        return 0;
+}
+
+
+int32_t
+afr_readv_stripe_cbk (call_frame_t *frame, void *cookie,
+                      xlator_t *this, int32_t op_ret, int32_t op_errno,
+                      struct iovec *vector, int32_t count, struct iatt *buf,
+                      struct iobref *iobref, dict_t *xdata)
+{
+        afr_local_t       *local    = NULL;
+        afr_read_stripe_t *stripe   = NULL;
+        int                call_count = -1;
+
+        local  = frame->local;
+        stripe = &local->cont.readv.stripes[(long) cookie];
+
+        stripe->op_ret   = op_ret;
+        stripe->op_errno = op_errno;
+        if (op_ret >= 0) {
+                stripe->vector = iov_dup (vector, count);
+                if (!stripe->vector && count) {
+                        stripe->op_ret   = -1;
+                        stripe->op_errno = ENOMEM;
+                }
+                stripe->count = count;
+                if (buf)
+                        stripe->buf = *buf;
+                if (iobref)
+                        stripe->iobref = iobref_ref (iobref);
+        }
+
+        LOCK (&frame->lock);
+        {
+                call_count = --local->call_count;
+        }
+        UNLOCK (&frame->lock);
+
+        if (call_count == 0)
+                afr_readv_stripe_done (frame, this);
+
+        return 0;
+}
+
+
+/* returns 0 if the read has been wound in stripes */
+int
+afr_readv_striped (call_frame_t *frame, xlator_t *this, dict_t *xdata)
+{
+        afr_private_t     *priv       = NULL;
+        afr_local_t       *local      = NULL;
+        afr_fd_ctx_t      *fd_ctx     = NULL;
+        afr_read_stripe_t *stripe     = NULL;
+        int32_t           *readable   = NULL;
+        int                nreadable  = 0;
+        size_t             chunk      = 0;
+        size_t             size       = 0;
+        off_t              offset     = 0;
+        int                child      = 0;
+        int                call_count = 0;
+        int                i          = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        /* only while no child has pending changes for the file */
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->fresh_children[i] == -1)
+                        return -1;
+        }
+
+        fd_ctx = afr_fd_ctx_get (local->fd, this);
+
+        readable = alloca (priv->child_count * sizeof (*readable));
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->child_up[i])
+                        continue;
+                if (afr_is_fd_fixable (local->fd) &&
+                    (!fd_ctx || fd_ctx->opened_on[i] != AFR_FD_OPENED))
+                        continue;
+                readable[nreadable++] = i;
+        }
+        if (nreadable < 2)
+                return -1;
+
+        size = local->cont.readv.size;
+        chunk = (size + nreadable - 1) / nreadable;
+        chunk = (chunk + GF_IOBUF_PAGE_ALIGN_SIZE - 1) &
+                ~((size_t) GF_IOBUF_PAGE_ALIGN_SIZE - 1);
+        call_count = (size + chunk - 1) / chunk;
+
+        local->cont.readv.stripes = GF_CALLOC (call_count, sizeof (*stripe),
+                                               gf_afr_mt_read_stripe_t);
+        if (!local->cont.readv.stripes)
+                return -1;
+
+        local->cont.readv.stripe_count = call_count;
+        local->call_count = call_count;
+
+        offset = local->cont.readv.offset;
+        for (i = 0; i < call_count; i++) {
+                stripe = &local->cont.readv.stripes[i];
+                stripe->offset = offset + i * chunk;
+                stripe->size = min (chunk, size - i * chunk);
+        }
+
+        /* the last wind may free local, do not touch it afterwards */
+        for (i = 0; i < call_count; i++) {
+                stripe = &local->cont.readv.stripes[i];
+                child = readable[i];
+                STACK_WIND_COOKIE (frame, afr_readv_stripe_cbk,
+                                   (void *) (long) i,
+                                   priv->children[child],
+                                   priv->children[child]->fops->readv,
+                                   local->fd, stripe->size, stripe->offset,
+                                   local->cont.readv.flags, xdata);
+        }
+
+        return 0;
+}
+
+
 int32_t
 afr_readv (call_frame_t *frame, xlator_t *this,
            fd_t *fd, size_t size, off_t offset, uint32_t flags, dict_t *xdata)
@@ -1810,6 +2021,7 @@ afr_readv (call_frame_t *frame, xlator_t *this,
         int32_t         op_errno   = 0;
         int32_t         read_child = -1;
         int             ret        = -1;
+        gf_boolean_t    lagging    = _gf_false;
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
@@ -1847,14 +2059,43 @@ afr_readv (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        /* a child still finishing early acknowledged writes may serve
+           stale data, stay on the read child which was moved off it */
+        lagging = (priv->quorum_early_ack &&
+                   afr_early_ack_lagging (this, fd->inode, -1));
+
+        if (priv->read_least_load && !lagging) {
+                read_child = afr_least_loaded_read_child (this,
+                                                          local->fresh_children,
+                                                          local->child_up,
+                                                          call_child);
+                if (read_child != call_child) {
+                        /* make the choice sticky for the hysteresis */
+                        afr_inode_set_read_child (this, fd->inode,
+                                                  read_child);
+                        call_child = read_child;
+                        local->cont.readv.last_index = -1;
+                }
+        }
+
         local->fd                    = fd_ref (fd);
 
         local->cont.readv.size       = size;
         local->cont.readv.offset     = offset;
         local->cont.readv.flags      = flags;
+        local->cont.readv.call_child = call_child;
 
         afr_open_fd_fix (fd, this);
 
+        if (priv->parallel_reads && !lagging &&
+            (size >= priv->parallel_read_min_size) &&
+            (afr_readv_striped (frame, this, xdata) == 0)) {
+                ret = 0;
+                goto out;
+        }
+
+        afr_child_load_start (this, call_child, &local->cont.readv.start);
+
         STACK_WIND_COOKIE (frame, afr_readv_cbk,
                            (void *) (long) call_child,
                            children[call_child],
@@ -1871,3 +2112,127 @@ out:
 }
 
 /* }}} */
+
+/* {{{ seek */
+
+/* seek follows the same read child as readv, so the extents reported
+ * describe the copy that reads are actually served from. ENXIO is a
+ * valid answer ("nothing more after offset") and is not retried. */
+
+int32_t
+afr_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset, dict_t *xdata)
+{
+        afr_private_t  *priv            = NULL;
+        afr_local_t    *local           = NULL;
+        xlator_t      **children        = NULL;
+        int             unwind          = 1;
+        int32_t         next_call_child = -1;
+        int32_t         read_child      = -1;
+
+        priv     = this->private;
+        children = priv->children;
+        local    = frame->local;
+
+        read_child = (long) cookie;
+
+        if ((op_ret == -1) && (op_errno != ENXIO)) {
+                next_call_child = afr_next_call_child (local->fresh_children,
+                                                       local->child_up,
+                                                       priv->child_count,
+                                                       &local->cont.seek.last_index,
+                                                       read_child);
+                if (next_call_child < 0)
+                        goto out;
+
+                unwind = 0;
+
+                STACK_WIND_COOKIE (frame, afr_seek_cbk,
+                                   (void *) (long) read_child,
+                                   children[next_call_child],
+                                   children[next_call_child]->fops->seek,
+                                   local->fd, local->cont.seek.offset,
+                                   local->cont.seek.what, NULL);
+        }
+
+out:
+        if (unwind) {
+                AFR_STACK_UNWIND (seek, frame, op_ret, op_errno, offset,
+                                  xdata);
+        }
+
+        return 0;
+}
+
+
+int32_t
+afr_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+          gf_seek_what_t what, dict_t *xdata)
+{
+        afr_private_t  *priv       = NULL;
+        afr_local_t    *local      = NULL;
+        xlator_t      **children   = NULL;
+        int             call_child = 0;
+        int32_t         op_errno   = 0;
+        int32_t         read_child = -1;
+        int             ret        = -1;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        priv     = this->private;
+        children = priv->children;
+
+        if (afr_is_split_brain (this, fd->inode)) {
+                op_errno = EIO;
+                goto out;
+        }
+
+        AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
+        local = frame->local;
+
+        ret = afr_local_init (local, priv, &op_errno);
+        if (ret < 0)
+                goto out;
+
+        local->fresh_children = afr_children_create (priv->child_count);
+        if (!local->fresh_children) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        read_child = afr_inode_get_read_ctx (this, fd->inode,
+                                             local->fresh_children);
+        ret = afr_get_call_child (this, local->child_up, read_child,
+                                  local->fresh_children,
+                                  &call_child,
+                                  &local->cont.seek.last_index);
+        if (ret < 0) {
+                op_errno = -ret;
+                goto out;
+        }
+
+        local->fd               = fd_ref (fd);
+        local->cont.seek.offset = offset;
+        local->cont.seek.what   = what;
+
+        afr_open_fd_fix (fd, this);
+
+        STACK_WIND_COOKIE (frame, afr_seek_cbk,
+                           (void *) (long) call_child,
+                           children[call_child],
+                           children[call_child]->fops->seek,
+                           fd, offset, what, xdata);
+
+        ret = 0;
+out:
+        if (ret < 0) {
+                AFR_STACK_UNWIND (seek, frame, -1, op_errno, 0, NULL);
+        }
+        return 0;
+}
+
+/* }}} */
+
@@ -127,6 +127,85 @@ afr_writev_handle_short_writes (call_frame_t *frame, xlator_t *this)
         }
 }
 
+/*
+ * With quorum-early-ack the application is answered as soon as a quorum
+ * of children wrote the whole buffer. The remaining children finish in
+ * the background; the range stays registered on the inode until they do,
+ * and the read child is moved away from a child which has not caught up.
+ * Called with frame->lock held, returns the fop frame to unwind.
+ */
+static call_frame_t *
+__afr_writev_early_ack (call_frame_t *frame, xlator_t *this, int read_child)
+{
+        afr_local_t   *local     = NULL;
+        afr_private_t *priv      = NULL;
+        call_frame_t  *fop_frame = NULL;
+        unsigned char *written   = NULL;
+        unsigned char *lagging   = NULL;
+        size_t         size      = 0;
+        int            i         = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        if (!priv->quorum_early_ack || !priv->quorum_count)
+                return NULL;
+
+        if (local->transaction.early_acked ||
+            !local->transaction.main_frame || (local->call_count <= 1))
+                return NULL;
+
+        size = iov_length (local->cont.writev.vector,
+                           local->cont.writev.count);
+
+        written = alloca (priv->child_count);
+        lagging = alloca (priv->child_count);
+        memset (written, 0, priv->child_count);
+        memset (lagging, 0, priv->child_count);
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->transaction.pre_op[i])
+                        continue;
+                if (!local->replies[i].valid)
+                        lagging[i] = 1;
+                else if (local->replies[i].op_ret == size)
+                        written[i] = 1;
+        }
+
+        if (!afr_quorum_met (priv, written))
+                return NULL;
+
+        local->transaction.early_acked = _gf_true;
+        /* the children behind must see the post-op right away */
+        local->delayed_post_op = _gf_false;
+
+        if (local->fd->flags & O_APPEND) {
+                local->transaction.early_ack.start = 0;
+                local->transaction.early_ack.end   = AFR_EARLY_ACK_EOF;
+        } else {
+                local->transaction.early_ack.start = local->cont.writev.offset;
+                local->transaction.early_ack.end   =
+                        local->cont.writev.offset + size;
+        }
+        afr_early_ack_start (this, local->fd->inode,
+                             &local->transaction.early_ack, lagging);
+
+        if ((read_child >= 0) && lagging[read_child]) {
+                for (i = 0; i < priv->child_count; i++) {
+                        if (written[i]) {
+                                afr_inode_set_read_child (this,
+                                                          local->fd->inode, i);
+                                break;
+                        }
+                }
+        }
+
+        fop_frame = local->transaction.main_frame;
+        local->transaction.main_frame = NULL;
+        afr_writev_copy_outvars (frame, fop_frame);
+
+        return fop_frame;
+}
+
 int
 afr_writev_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -134,9 +213,11 @@ afr_writev_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 {
         afr_local_t *   local = NULL;
         call_frame_t    *fop_frame = NULL;
+        call_frame_t    *ack_frame = NULL;
         int child_index = (long) cookie;
         int call_count  = -1;
         int read_child  = 0;
+        gf_boolean_t straggler = _gf_false;
 
         local = frame->local;
 
@@ -144,6 +225,8 @@ afr_writev_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         LOCK (&frame->lock);
         {
+                straggler = local->transaction.early_acked;
+
                 if (child_index == read_child) {
                         local->read_child_returned = _gf_true;
                 }
@@ -169,14 +252,32 @@ afr_writev_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 			}
 			local->success_count++;
 		}
+
+                ack_frame = __afr_writev_early_ack (frame, this, read_child);
         }
         UNLOCK (&frame->lock);
 
+        if (straggler)
+                afr_early_ack_reply (this, local->fd->inode,
+                                     &local->transaction.early_ack,
+                                     child_index);
+
+        if (ack_frame)
+                afr_writev_unwind (ack_frame, this);
+
         call_count = afr_frame_return (frame);
 
         if (call_count == 0) {
 
                 afr_writev_handle_short_writes (frame, this);
+
+                if (local->transaction.early_acked) {
+                        /* the application has its answer already */
+                        afr_early_ack_done (this, local->fd->inode,
+                                            &local->transaction.early_ack);
+                        local->transaction.resume (frame, this);
+                        return 0;
+                }
                 /*
                  * Generally inode-write fops do transaction.unwind then
                  * transaction.resume, but writev needs to make sure that
@@ -456,6 +557,12 @@ afr_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         QUORUM_CHECK(writev,out);
 
+        AFR_EARLY_ACK_WAIT (writev,
+                            (fd->flags & O_APPEND) ? 0 : offset,
+                            (fd->flags & O_APPEND) ? AFR_EARLY_ACK_EOF :
+                            offset + iov_length (vector, count), out,
+                            vector, count, offset, flags, iobref, xdata);
+
         AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
         local = frame->local;
 
@@ -913,6 +1020,9 @@ afr_ftruncate (call_frame_t *frame, xlator_t *this,
         }
         QUORUM_CHECK(ftruncate,out);
 
+        AFR_EARLY_ACK_WAIT (ftruncate, offset, AFR_EARLY_ACK_EOF, out,
+                            offset, xdata);
+
         AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
         local = frame->local;
 
@@ -941,6 +1051,1053 @@ out:
 
 /* }}} */
 
+/* {{{ fallocate */
+
+
+int
+afr_fallocate_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *   local = NULL;
+        call_frame_t   *main_frame = NULL;
+
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                if (local->transaction.main_frame)
+                        main_frame = local->transaction.main_frame;
+                local->transaction.main_frame = NULL;
+        }
+        UNLOCK (&frame->lock);
+
+        if (main_frame) {
+                AFR_STACK_UNWIND (fallocate, main_frame, local->op_ret,
+                                  local->op_errno,
+                                  &local->cont.fallocate.prebuf,
+                                  &local->cont.fallocate.postbuf,
+                                  NULL);
+        }
+        return 0;
+}
+
+
+int
+afr_fallocate_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                        struct iatt *postbuf, dict_t *xdata)
+{
+        afr_local_t *   local = NULL;
+        afr_private_t * priv  = NULL;
+        int child_index = (long) cookie;
+        int call_count  = -1;
+        int need_unwind = 0;
+        int read_child  = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        read_child = afr_inode_get_read_ctx (this, local->fd->inode, NULL);
+
+        LOCK (&frame->lock);
+        {
+                if (child_index == read_child) {
+                        local->read_child_returned = _gf_true;
+                }
+
+                if (afr_fop_failed (op_ret, op_errno))
+                        afr_transaction_fop_failed (frame, this, child_index);
+
+                if (op_ret != -1) {
+                        if (local->success_count == 0) {
+                                local->op_ret = op_ret;
+                                local->cont.fallocate.prebuf  = *prebuf;
+                                local->cont.fallocate.postbuf = *postbuf;
+                        }
+
+                        if (child_index == read_child) {
+                                local->cont.fallocate.prebuf  = *prebuf;
+                                local->cont.fallocate.postbuf = *postbuf;
+                        }
+
+                        local->success_count++;
+
+                        if ((local->success_count >= priv->wait_count)
+                            && local->read_child_returned) {
+                                need_unwind = 1;
+                        }
+                }
+                local->op_errno = op_errno;
+        }
+        UNLOCK (&frame->lock);
+
+        if (need_unwind)
+                local->transaction.unwind (frame, this);
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+        }
+
+        return 0;
+}
+
+
+int
+afr_fallocate_wind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+        afr_private_t *priv = NULL;
+        int call_count = -1;
+        int i = 0;
+
+        local = frame->local;
+        priv = this->private;
+
+        call_count = afr_pre_op_done_children_count (local->transaction.pre_op,
+                                                     priv->child_count);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+                return 0;
+        }
+
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->transaction.pre_op[i]) {
+                        STACK_WIND_COOKIE (frame, afr_fallocate_wind_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fallocate,
+                                           local->fd,
+                                           local->cont.fallocate.mode,
+                                           local->cont.fallocate.offset,
+                                           local->cont.fallocate.len,
+                                           NULL);
+
+                        if (!--call_count)
+                                break;
+                }
+        }
+
+        return 0;
+}
+
+
+int
+afr_fallocate_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        local->transaction.unwind (frame, this);
+
+        AFR_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+int
+afr_do_fallocate (call_frame_t *frame, xlator_t *this)
+{
+        call_frame_t * transaction_frame = NULL;
+        afr_local_t *  local             = NULL;
+        int op_ret   = -1;
+        int op_errno = 0;
+
+        local = frame->local;
+
+        transaction_frame = copy_frame (frame);
+        if (!transaction_frame) {
+                goto out;
+        }
+
+        transaction_frame->local = local;
+        frame->local = NULL;
+
+        local->op = GF_FOP_FALLOCATE;
+
+        local->transaction.fop    = afr_fallocate_wind;
+        local->transaction.done   = afr_fallocate_done;
+        local->transaction.unwind = afr_fallocate_unwind;
+
+        local->transaction.main_frame = frame;
+
+        local->transaction.start   = local->cont.fallocate.offset;
+        local->transaction.len     = local->cont.fallocate.len;
+
+        op_ret = afr_transaction (transaction_frame, this, AFR_DATA_TRANSACTION);
+        if (op_ret < 0) {
+            op_errno = -op_ret;
+            goto out;
+        }
+
+        op_ret = 0;
+out:
+        if (op_ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (fallocate, frame, op_ret, op_errno, NULL,
+                                  NULL, NULL);
+        }
+
+        return 0;
+}
+
+
+int
+afr_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t mode, off_t offset, size_t len, dict_t *xdata)
+{
+        afr_private_t * priv  = NULL;
+        afr_local_t   * local = NULL;
+        call_frame_t   *transaction_frame = NULL;
+        int ret = -1;
+        int op_errno = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv = this->private;
+
+        if (afr_is_split_brain (this, fd->inode)) {
+                op_errno = EIO;
+                goto out;
+        }
+        QUORUM_CHECK(fallocate,out);
+
+        AFR_EARLY_ACK_WAIT (fallocate, offset, offset + len, out,
+                            mode, offset, len, xdata);
+
+        AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
+        local = frame->local;
+
+        ret = afr_local_init (local, priv, &op_errno);
+        if (ret < 0)
+                goto out;
+
+        local->cont.fallocate.mode    = mode;
+        local->cont.fallocate.offset  = offset;
+        local->cont.fallocate.len     = len;
+
+        local->fd = fd_ref (fd);
+
+        afr_open_fd_fix (fd, this);
+
+        afr_do_fallocate (frame, this);
+
+        ret = 0;
+out:
+        if (ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL, NULL);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
+/* {{{ discard */
+
+
+int
+afr_discard_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *   local = NULL;
+        call_frame_t   *main_frame = NULL;
+
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                if (local->transaction.main_frame)
+                        main_frame = local->transaction.main_frame;
+                local->transaction.main_frame = NULL;
+        }
+        UNLOCK (&frame->lock);
+
+        if (main_frame) {
+                AFR_STACK_UNWIND (discard, main_frame, local->op_ret,
+                                  local->op_errno,
+                                  &local->cont.discard.prebuf,
+                                  &local->cont.discard.postbuf,
+                                  NULL);
+        }
+        return 0;
+}
+
+
+int
+afr_discard_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf, dict_t *xdata)
+{
+        afr_local_t *   local = NULL;
+        afr_private_t * priv  = NULL;
+        int child_index = (long) cookie;
+        int call_count  = -1;
+        int need_unwind = 0;
+        int read_child  = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        read_child = afr_inode_get_read_ctx (this, local->fd->inode, NULL);
+
+        LOCK (&frame->lock);
+        {
+                if (child_index == read_child) {
+                        local->read_child_returned = _gf_true;
+                }
+
+                if (afr_fop_failed (op_ret, op_errno))
+                        afr_transaction_fop_failed (frame, this, child_index);
+
+                if (op_ret != -1) {
+                        if (local->success_count == 0) {
+                                local->op_ret = op_ret;
+                                local->cont.discard.prebuf  = *prebuf;
+                                local->cont.discard.postbuf = *postbuf;
+                        }
+
+                        if (child_index == read_child) {
+                                local->cont.discard.prebuf  = *prebuf;
+                                local->cont.discard.postbuf = *postbuf;
+                        }
+
+                        local->success_count++;
+
+                        if ((local->success_count >= priv->wait_count)
+                            && local->read_child_returned) {
+                                need_unwind = 1;
+                        }
+                }
+                local->op_errno = op_errno;
+        }
+        UNLOCK (&frame->lock);
+
+        if (need_unwind)
+                local->transaction.unwind (frame, this);
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+        }
+
+        return 0;
+}
+
+
+int
+afr_discard_wind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+        afr_private_t *priv = NULL;
+        int call_count = -1;
+        int i = 0;
+
+        local = frame->local;
+        priv = this->private;
+
+        call_count = afr_pre_op_done_children_count (local->transaction.pre_op,
+                                                     priv->child_count);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+                return 0;
+        }
+
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->transaction.pre_op[i]) {
+                        STACK_WIND_COOKIE (frame, afr_discard_wind_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->discard,
+                                           local->fd,
+                                           local->cont.discard.offset,
+                                           local->cont.discard.len,
+                                           NULL);
+
+                        if (!--call_count)
+                                break;
+                }
+        }
+
+        return 0;
+}
+
+
+int
+afr_discard_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        local->transaction.unwind (frame, this);
+
+        AFR_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+int
+afr_do_discard (call_frame_t *frame, xlator_t *this)
+{
+        call_frame_t * transaction_frame = NULL;
+        afr_local_t *  local             = NULL;
+        int op_ret   = -1;
+        int op_errno = 0;
+
+        local = frame->local;
+
+        transaction_frame = copy_frame (frame);
+        if (!transaction_frame) {
+                goto out;
+        }
+
+        transaction_frame->local = local;
+        frame->local = NULL;
+
+        local->op = GF_FOP_DISCARD;
+
+        local->transaction.fop    = afr_discard_wind;
+        local->transaction.done   = afr_discard_done;
+        local->transaction.unwind = afr_discard_unwind;
+
+        local->transaction.main_frame = frame;
+
+        local->transaction.start   = local->cont.discard.offset;
+        local->transaction.len     = local->cont.discard.len;
+
+        op_ret = afr_transaction (transaction_frame, this, AFR_DATA_TRANSACTION);
+        if (op_ret < 0) {
+            op_errno = -op_ret;
+            goto out;
+        }
+
+        op_ret = 0;
+out:
+        if (op_ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (discard, frame, op_ret, op_errno, NULL,
+                                  NULL, NULL);
+        }
+
+        return 0;
+}
+
+
+int
+afr_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len, dict_t *xdata)
+{
+        afr_private_t * priv  = NULL;
+        afr_local_t   * local = NULL;
+        call_frame_t   *transaction_frame = NULL;
+        int ret = -1;
+        int op_errno = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv = this->private;
+
+        if (afr_is_split_brain (this, fd->inode)) {
+                op_errno = EIO;
+                goto out;
+        }
+        QUORUM_CHECK(discard,out);
+
+        AFR_EARLY_ACK_WAIT (discard, offset, offset + len, out,
+                            offset, len, xdata);
+
+        AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
+        local = frame->local;
+
+        ret = afr_local_init (local, priv, &op_errno);
+        if (ret < 0)
+                goto out;
+
+        local->cont.discard.offset  = offset;
+        local->cont.discard.len     = len;
+
+        local->fd = fd_ref (fd);
+
+        afr_open_fd_fix (fd, this);
+
+        afr_do_discard (frame, this);
+
+        ret = 0;
+out:
+        if (ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL, NULL);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
+/* {{{ zerofill */
+
+
+int
+afr_zerofill_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *   local = NULL;
+        call_frame_t   *main_frame = NULL;
+
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                if (local->transaction.main_frame)
+                        main_frame = local->transaction.main_frame;
+                local->transaction.main_frame = NULL;
+        }
+        UNLOCK (&frame->lock);
+
+        if (main_frame) {
+                AFR_STACK_UNWIND (zerofill, main_frame, local->op_ret,
+                                  local->op_errno,
+                                  &local->cont.zerofill.prebuf,
+                                  &local->cont.zerofill.postbuf,
+                                  NULL);
+        }
+        return 0;
+}
+
+
+int
+afr_zerofill_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                       struct iatt *postbuf, dict_t *xdata)
+{
+        afr_local_t *   local = NULL;
+        afr_private_t * priv  = NULL;
+        int child_index = (long) cookie;
+        int call_count  = -1;
+        int need_unwind = 0;
+        int read_child  = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        read_child = afr_inode_get_read_ctx (this, local->fd->inode, NULL);
+
+        LOCK (&frame->lock);
+        {
+                if (child_index == read_child) {
+                        local->read_child_returned = _gf_true;
+                }
+
+                if (afr_fop_failed (op_ret, op_errno))
+                        afr_transaction_fop_failed (frame, this, child_index);
+
+                if (op_ret != -1) {
+                        if (local->success_count == 0) {
+                                local->op_ret = op_ret;
+                                local->cont.zerofill.prebuf  = *prebuf;
+                                local->cont.zerofill.postbuf = *postbuf;
+                        }
+
+                        if (child_index == read_child) {
+                                local->cont.zerofill.prebuf  = *prebuf;
+                                local->cont.zerofill.postbuf = *postbuf;
+                        }
+
+                        local->success_count++;
+
+                        if ((local->success_count >= priv->wait_count)
+                            && local->read_child_returned) {
+                                need_unwind = 1;
+                        }
+                }
+                local->op_errno = op_errno;
+        }
+        UNLOCK (&frame->lock);
+
+        if (need_unwind)
+                local->transaction.unwind (frame, this);
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+        }
+
+        return 0;
+}
+
+
+int
+afr_zerofill_wind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+        afr_private_t *priv = NULL;
+        int call_count = -1;
+        int i = 0;
+
+        local = frame->local;
+        priv = this->private;
+
+        call_count = afr_pre_op_done_children_count (local->transaction.pre_op,
+                                                     priv->child_count);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+                return 0;
+        }
+
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->transaction.pre_op[i]) {
+                        STACK_WIND_COOKIE (frame, afr_zerofill_wind_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->zerofill,
+                                           local->fd,
+                                           local->cont.zerofill.offset,
+                                           local->cont.zerofill.len,
+                                           NULL);
+
+                        if (!--call_count)
+                                break;
+                }
+        }
+
+        return 0;
+}
+
+
+int
+afr_zerofill_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        local->transaction.unwind (frame, this);
+
+        AFR_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+int
+afr_do_zerofill (call_frame_t *frame, xlator_t *this)
+{
+        call_frame_t * transaction_frame = NULL;
+        afr_local_t *  local             = NULL;
+        int op_ret   = -1;
+        int op_errno = 0;
+
+        local = frame->local;
+
+        transaction_frame = copy_frame (frame);
+        if (!transaction_frame) {
+                goto out;
+        }
+
+        transaction_frame->local = local;
+        frame->local = NULL;
+
+        local->op = GF_FOP_ZEROFILL;
+
+        local->transaction.fop    = afr_zerofill_wind;
+        local->transaction.done   = afr_zerofill_done;
+        local->transaction.unwind = afr_zerofill_unwind;
+
+        local->transaction.main_frame = frame;
+
+        local->transaction.start   = local->cont.zerofill.offset;
+        local->transaction.len     = local->cont.zerofill.len;
+
+        op_ret = afr_transaction (transaction_frame, this, AFR_DATA_TRANSACTION);
+        if (op_ret < 0) {
+            op_errno = -op_ret;
+            goto out;
+        }
+
+        op_ret = 0;
+out:
+        if (op_ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (zerofill, frame, op_ret, op_errno, NULL,
+                                  NULL, NULL);
+        }
+
+        return 0;
+}
+
+
+int
+afr_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, size_t len, dict_t *xdata)
+{
+        afr_private_t * priv  = NULL;
+        afr_local_t   * local = NULL;
+        call_frame_t   *transaction_frame = NULL;
+        int ret = -1;
+        int op_errno = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv = this->private;
+
+        if (afr_is_split_brain (this, fd->inode)) {
+                op_errno = EIO;
+                goto out;
+        }
+        QUORUM_CHECK(zerofill,out);
+
+        AFR_EARLY_ACK_WAIT (zerofill, offset, offset + len, out,
+                            offset, len, xdata);
+
+        AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
+        local = frame->local;
+
+        ret = afr_local_init (local, priv, &op_errno);
+        if (ret < 0)
+                goto out;
+
+        local->cont.zerofill.offset  = offset;
+        local->cont.zerofill.len     = len;
+
+        local->fd = fd_ref (fd);
+
+        afr_open_fd_fix (fd, this);
+
+        afr_do_zerofill (frame, this);
+
+        ret = 0;
+out:
+        if (ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL, NULL);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
+/* {{{ copy_file_range */
+
+/* Each brick copies from its own replica of the source, which only gives
+ * identical destinations when every replica of the source is good. */
+static gf_boolean_t
+afr_copy_source_is_fresh (xlator_t *this, inode_t *inode,
+                          unsigned char *child_up)
+{
+        afr_private_t *priv           = NULL;
+        int32_t       *fresh_children = NULL;
+        gf_boolean_t   fresh          = _gf_false;
+        int            i              = 0;
+
+        priv = this->private;
+
+        fresh_children = afr_children_create (priv->child_count);
+        if (!fresh_children)
+                goto out;
+
+        afr_inode_get_read_ctx (this, inode, fresh_children);
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (child_up[i] &&
+                    !afr_is_child_present (fresh_children, priv->child_count,
+                                           i))
+                        goto out;
+        }
+
+        fresh = _gf_true;
+out:
+        GF_FREE (fresh_children);
+
+        return fresh;
+}
+
+
+int
+afr_copy_file_range_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *   local = NULL;
+        call_frame_t   *main_frame = NULL;
+
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                if (local->transaction.main_frame)
+                        main_frame = local->transaction.main_frame;
+                local->transaction.main_frame = NULL;
+        }
+        UNLOCK (&frame->lock);
+
+        if (main_frame) {
+                AFR_STACK_UNWIND (copy_file_range, main_frame, local->op_ret,
+                                  local->op_errno,
+                                  &local->cont.copy_file_range.stbuf,
+                                  &local->cont.copy_file_range.prebuf,
+                                  &local->cont.copy_file_range.postbuf,
+                                  NULL);
+        }
+        return 0;
+}
+
+
+int
+afr_copy_file_range_wind_cbk (call_frame_t *frame, void *cookie,
+                              xlator_t *this, int32_t op_ret,
+                              int32_t op_errno, struct iatt *stbuf,
+                              struct iatt *prebuf, struct iatt *postbuf,
+                              dict_t *xdata)
+{
+        afr_local_t *   local = NULL;
+        afr_private_t * priv  = NULL;
+        int child_index = (long) cookie;
+        int call_count  = -1;
+        int need_unwind = 0;
+        int read_child  = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        read_child = afr_inode_get_read_ctx (this, local->fd->inode, NULL);
+
+        LOCK (&frame->lock);
+        {
+                if (child_index == read_child) {
+                        local->read_child_returned = _gf_true;
+                }
+
+                if (afr_fop_failed (op_ret, op_errno))
+                        afr_transaction_fop_failed (frame, this, child_index);
+
+                if (op_ret != -1) {
+                        if ((local->success_count == 0) ||
+                            (child_index == read_child)) {
+                                local->op_ret = op_ret;
+                                local->cont.copy_file_range.stbuf   = *stbuf;
+                                local->cont.copy_file_range.prebuf  = *prebuf;
+                                local->cont.copy_file_range.postbuf = *postbuf;
+                        }
+
+                        local->success_count++;
+
+                        if ((local->success_count >= priv->wait_count)
+                            && local->read_child_returned) {
+                                need_unwind = 1;
+                        }
+                }
+                local->op_errno = op_errno;
+        }
+        UNLOCK (&frame->lock);
+
+        if (need_unwind)
+                local->transaction.unwind (frame, this);
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+        }
+
+        return 0;
+}
+
+
+int
+afr_copy_file_range_wind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+        afr_private_t *priv = NULL;
+        int call_count = -1;
+        int i = 0;
+
+        local = frame->local;
+        priv = this->private;
+
+        call_count = afr_pre_op_done_children_count (local->transaction.pre_op,
+                                                     priv->child_count);
+
+        if (call_count == 0) {
+                local->transaction.resume (frame, this);
+                return 0;
+        }
+
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->transaction.pre_op[i]) {
+                        STACK_WIND_COOKIE (frame, afr_copy_file_range_wind_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->copy_file_range,
+                                           local->cont.copy_file_range.fd_in,
+                                           local->cont.copy_file_range.off_in,
+                                           local->fd,
+                                           local->cont.copy_file_range.off_out,
+                                           local->cont.copy_file_range.len,
+                                           local->cont.copy_file_range.flags,
+                                           NULL);
+
+                        if (!--call_count)
+                                break;
+                }
+        }
+
+        return 0;
+}
+
+
+int
+afr_copy_file_range_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        local->transaction.unwind (frame, this);
+
+        AFR_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+int
+afr_do_copy_file_range (call_frame_t *frame, xlator_t *this)
+{
+        call_frame_t * transaction_frame = NULL;
+        afr_local_t *  local             = NULL;
+        int op_ret   = -1;
+        int op_errno = 0;
+
+        local = frame->local;
+
+        transaction_frame = copy_frame (frame);
+        if (!transaction_frame) {
+                goto out;
+        }
+
+        transaction_frame->local = local;
+        frame->local = NULL;
+
+        local->op = GF_FOP_COPY_FILE_RANGE;
+
+        local->transaction.fop    = afr_copy_file_range_wind;
+        local->transaction.done   = afr_copy_file_range_done;
+        local->transaction.unwind = afr_copy_file_range_unwind;
+
+        local->transaction.main_frame = frame;
+
+        local->transaction.start   = local->cont.copy_file_range.off_out;
+        local->transaction.len     = local->cont.copy_file_range.len;
+
+        op_ret = afr_transaction (transaction_frame, this, AFR_DATA_TRANSACTION);
+        if (op_ret < 0) {
+            op_errno = -op_ret;
+            goto out;
+        }
+
+        op_ret = 0;
+out:
+        if (op_ret < 0) {
+                if (transaction_frame)
+                        AFR_STACK_DESTROY (transaction_frame);
+                AFR_STACK_UNWIND (copy_file_range, frame, op_ret, op_errno,
+                                  NULL, NULL, NULL, NULL);
+        }
+
+        return 0;
+}
+
+
+int
+afr_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                     off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                     uint32_t flags, dict_t *xdata)
+{
+        afr_private_t * priv  = NULL;
+        afr_local_t   * local = NULL;
+        int ret = -1;
+        int op_errno = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv = this->private;
+
+        if (afr_is_split_brain (this, fd_out->inode) ||
+            afr_is_split_brain (this, fd_in->inode)) {
+                op_errno = EIO;
+                goto out;
+        }
+        QUORUM_CHECK(copy_file_range,out);
+
+        AFR_LOCAL_ALLOC_OR_GOTO (frame->local, out);
+        local = frame->local;
+
+        ret = afr_local_init (local, priv, &op_errno);
+        if (ret < 0)
+                goto out;
+
+        /* a source still waiting for heal is copied the slow way, through
+           reads from a good copy and replicated writes */
+        if (!afr_copy_source_is_fresh (this, fd_in->inode, local->child_up)) {
+                ret = -1;
+                op_errno = EXDEV;
+                goto out;
+        }
+
+        local->cont.copy_file_range.fd_in   = fd_ref (fd_in);
+        local->cont.copy_file_range.off_in  = off_in;
+        local->cont.copy_file_range.off_out = off_out;
+        local->cont.copy_file_range.len     = len;
+        local->cont.copy_file_range.flags   = flags;
+
+        local->fd = fd_ref (fd_out);
+
+        afr_open_fd_fix (fd_in, this);
+        afr_open_fd_fix (fd_out, this);
+
+        afr_do_copy_file_range (frame, this);
+
+        ret = 0;
+out:
+        if (ret < 0) {
+                AFR_STACK_UNWIND (copy_file_range, frame, -1, op_errno, NULL,
+                                  NULL, NULL, NULL);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
 /* {{{ setattr */
 
 int
@@ -737,6 +737,8 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
                                         piggyback = 1;
                                 } else {
                                         fd_ctx->lock_acquired[i]--;
+                                        /* a recall was for this lock */
+                                        fd_ctx->lease_recalled = _gf_false;
                                 }
                         }
                         UNLOCK (&local->fd->lock);
@@ -1487,6 +1489,8 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
         struct              gf_flock full_flock = {0,};
         struct              gf_flock *flock_use = NULL;
         int                 piggyback = 0;
+        dict_t              *xdata     = NULL;
+        dict_t              *xdata_use = NULL;
 
         local    = frame->local;
         int_lock = &local->internal_lock;
@@ -1528,6 +1532,18 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                         goto out;
                 }
 
+                /* let the bricks recall the eager lock from us when
+                   somebody else wants it */
+                if (local->transaction.eager_lock_on &&
+                    priv->eager_lock_recall) {
+                        xdata = dict_new ();
+                        if (xdata &&
+                            dict_set_int8 (xdata, GF_INODELK_RECALL_KEY, 1)) {
+                                dict_unref (xdata);
+                                xdata = NULL;
+                        }
+                }
+
                 /* Send non-blocking inodelk calls only on up children
                    and where the fd has been opened */
                 for (i = 0; i < priv->child_count; i++) {
@@ -1535,6 +1551,7 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                                 continue;
 
                         flock_use = &flock;
+                        xdata_use = NULL;
                         if (!local->transaction.eager_lock_on) {
                                 goto wind;
                         }
@@ -1562,6 +1579,7 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                                 continue;
                         }
                         flock_use = &full_flock;
+                        xdata_use = xdata;
                 wind:
                         AFR_TRACE_INODELK_IN (frame, this,
                                               AFR_INODELK_NB_TRANSACTION,
@@ -1572,11 +1590,14 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                                            priv->children[i],
                                            priv->children[i]->fops->finodelk,
                                            this->name, local->fd,
-                                           F_SETLK, flock_use, NULL);
+                                           F_SETLK, flock_use, xdata_use);
 
                         if (!--call_count)
                                 break;
                 }
+
+                if (xdata)
+                        dict_unref (xdata);
         } else {
                 call_count = internal_lock_count (frame, this);
                 int_lock->lk_call_count = call_count;
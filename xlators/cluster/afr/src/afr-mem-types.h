@@ -42,6 +42,13 @@ enum gf_afr_mem_types_ {
         gf_afr_mt_time_t,
         gf_afr_mt_pos_data_t,
 	gf_afr_mt_reply_t,
+        gf_afr_mt_child_load_t,
+        gf_afr_mt_read_stripe_t,
+        gf_afr_mt_shd_progress_t,
+        gf_afr_mt_shd_heal_item_t,
+        gf_afr_mt_entry_merge_t,
+        gf_afr_mt_ack_waiter_t,
+        gf_afr_mt_sh_delta_op_t,
         gf_afr_mt_end
 };
 #endif
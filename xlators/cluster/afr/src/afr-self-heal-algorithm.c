@@ -9,7 +9,6 @@
 */
 
 
-#include <openssl/md5.h>
 #include "glusterfs.h"
 #include "afr.h"
 #include "xlator.h"
@@ -25,6 +24,7 @@
 #include "compat-errno.h"
 #include "compat.h"
 #include "byte-order.h"
+#include "checksum.h"
 
 #include "afr-transaction.h"
 #include "afr-self-heal.h"
@@ -63,6 +63,8 @@ sh_private_cleanup (call_frame_t *frame, xlator_t *this)
         sh    = &local->self_heal;
 
         sh_priv = sh->private;
+        if (sh_priv && sh_priv->key_xdata)
+                dict_unref (sh_priv->key_xdata);
         GF_FREE (sh_priv);
 }
 
@@ -90,6 +92,8 @@ sh_loop_driver_done (call_frame_t *sh_frame, xlator_t *this,
         afr_sh_algo_private_t   *sh_priv      = NULL;
         int32_t                 total_blocks = 0;
         int32_t                 diff_blocks  = 0;
+        uint64_t                delta_bytes  = 0;
+        uint64_t                reused_bytes = 0;
 
         local        = sh_frame->local;
         sh           = &local->self_heal;
@@ -97,6 +101,8 @@ sh_loop_driver_done (call_frame_t *sh_frame, xlator_t *this,
         if (sh_priv) {
                 total_blocks = sh_priv->total_blocks;
                 diff_blocks  = sh_priv->diff_blocks;
+                delta_bytes  = sh_priv->delta_bytes;
+                reused_bytes = sh_priv->reused_bytes;
         }
 
         sh_private_cleanup (sh_frame, this);
@@ -110,7 +116,15 @@ sh_loop_driver_done (call_frame_t *sh_frame, xlator_t *this,
                 local->self_heal.algo_abort_cbk (sh_frame, this);
         } else {
                 GF_ASSERT (last_loop_frame);
-                if (diff_blocks == total_blocks) {
+                if (!strcmp (sh->algo->name, "delta")) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "delta self-heal on %s: completed. "
+                                "(%d blocks of %d were different, %"PRIu64
+                                " bytes written, %"PRIu64" bytes reused "
+                                "from the sinks)", local->loc.path,
+                                diff_blocks, total_blocks, delta_bytes,
+                                reused_bytes);
+                } else if (diff_blocks == total_blocks) {
                         gf_log (this->name, GF_LOG_DEBUG, "full self-heal "
                                 "completed on %s",local->loc.path);
                 } else {
@@ -229,7 +243,8 @@ sh_loop_frame_create (call_frame_t *sh_frame, xlator_t *this,
                                                gf_afr_mt_char);
         if (!new_loop_sh->write_needed)
                 goto out;
-        new_loop_sh->checksum = GF_CALLOC (priv->child_count, MD5_DIGEST_LENGTH,
+        new_loop_sh->checksum = GF_CALLOC (priv->child_count,
+                                           GF_RSYNC_STRONG_CHECKSUM_LENGTH,
                                            gf_afr_mt_uint8_t);
         if (!new_loop_sh->checksum)
                 goto out;
@@ -283,6 +298,31 @@ out:
         return 0;
 }
 
+/* first block at or after @offset that overlaps a region set in the
+   dirty map, if the heal has one */
+static off_t
+sh_dirty_map_next (afr_self_heal_t *sh, off_t offset)
+{
+        off_t   region = 0;
+        off_t   last   = 0;
+
+        if (!sh->dirty_map)
+                return offset;
+
+        for (; offset < sh->file_size; offset += sh->block_size) {
+                last = (offset + sh->block_size - 1) >>
+                       AFR_DIRTY_MAP_REGION_SHIFT;
+                for (region = offset >> AFR_DIRTY_MAP_REGION_SHIFT;
+                     region <= last; region++) {
+                        if (sh->dirty_map[(region % AFR_DIRTY_MAP_BITS) / 8] &
+                            (1 << (region % 8)))
+                                return offset;
+                }
+        }
+
+        return offset;
+}
+
 static int
 sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
                 gf_boolean_t is_first_call, call_frame_t *old_loop_frame)
@@ -293,25 +333,30 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
         gf_boolean_t                is_driver_done = _gf_false;
         blksize_t                   block_size     = 0;
         int                         loop           = 0;
-        off_t                       offset         = 0;
-        afr_private_t               *priv          = NULL;
+        int                         i              = 0;
+        off_t                       *offsets       = NULL;
 
-        priv    = this->private;
         local   = sh_frame->local;
         sh      = &local->self_heal;
         sh_priv = sh->private;
 
+        offsets = alloca (sh_priv->window * sizeof (*offsets));
+
         LOCK (&sh_priv->lock);
         {
                 if (!is_first_call)
                         sh_priv->loops_running--;
-                offset = sh_priv->offset;
                 block_size = sh->block_size;
                 while ((!sh->eof_reached) && (0 == sh->op_failed) &&
-                       (sh_priv->loops_running < priv->data_self_heal_window_size)
+                       (sh_priv->loops_running < sh_priv->window)
                        && (sh_priv->offset < sh->file_size)) {
 
-                        loop++;
+                        sh_priv->offset = sh_dirty_map_next (sh,
+                                                             sh_priv->offset);
+                        if (sh_priv->offset >= sh->file_size)
+                                break;
+
+                        offsets[loop++] = sh_priv->offset;
                         sh_priv->offset += block_size;
                         sh_priv->loops_running++;
 
@@ -337,7 +382,7 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
 
         //If we have more loops to form we should finish previous loop after
         //the next loop lock
-        while (loop--) {
+        for (i = 0; i < loop; i++) {
                 if (sh->op_failed) {
                         // op failed in other loop, stop spawning more loops
                         if (old_loop_frame) {
@@ -347,11 +392,11 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
                         sh_loop_driver (sh_frame, this, _gf_false, NULL);
                 } else {
                         gf_log (this->name, GF_LOG_TRACE, "spawning a loop "
-                                "for offset %"PRId64, offset);
+                                "for offset %"PRId64, offsets[i]);
 
-                        sh_loop_start (sh_frame, this, offset, old_loop_frame);
+                        sh_loop_start (sh_frame, this, offsets[i],
+                                       old_loop_frame);
                         old_loop_frame = NULL;
-                        offset += block_size;
                 }
         }
 
@@ -468,7 +513,7 @@ sh_prune_writes_needed (call_frame_t *sh_frame, call_frame_t *loop_frame,
         sh_local   = sh_frame->local;
         sh         = &sh_local->self_heal;
 
-        if (!strcmp (sh->algo->name, "diff"))
+        if (strcmp (sh->algo->name, "full"))
                 return;
 
         loop_local = loop_frame->local;
@@ -567,7 +612,7 @@ out:
 
 
 static int
-sh_loop_read (call_frame_t *loop_frame, xlator_t *this)
+sh_loop_readv (call_frame_t *loop_frame, xlator_t *this)
 {
         afr_private_t           *priv       = NULL;
         afr_local_t             *loop_local   = NULL;
@@ -588,166 +633,1410 @@ sh_loop_read (call_frame_t *loop_frame, xlator_t *this)
 }
 
 
+/* The block at loop_sh->offset is known to be a hole on the source. Treat
+ * it exactly like a zero-filled read, without moving the zeroes over the
+ * wire: sinks that have nothing there keep their hole, the others still
+ * get the zeroes written through the regular read path. */
 static int
-sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
-                      int32_t op_ret, int32_t op_errno,
-                      uint32_t weak_checksum, uint8_t *strong_checksum,
-                      dict_t *xdata)
+sh_loop_skip_hole (call_frame_t *loop_frame, xlator_t *this)
 {
-        afr_private_t                 *priv         = NULL;
-        afr_local_t                   *loop_local   = NULL;
-        afr_self_heal_t               *loop_sh      = NULL;
-        call_frame_t                  *sh_frame     = NULL;
-        afr_local_t                   *sh_local     = NULL;
-        afr_self_heal_t               *sh           = NULL;
-        afr_sh_algo_private_t         *sh_priv      = NULL;
-        int                           child_index  = 0;
-        int                           call_count   = 0;
-        int                           i            = 0;
-        int                           write_needed = 0;
+        afr_private_t           *priv       = NULL;
+        afr_local_t             *loop_local = NULL;
+        afr_self_heal_t         *loop_sh    = NULL;
 
-        priv  = this->private;
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_prune_writes_needed (loop_sh->sh_frame, loop_frame, priv);
+
+        if (sh_number_of_writes_needed (loop_sh->write_needed,
+                                        priv->child_count) == 0) {
+                gf_log (this->name, GF_LOG_TRACE, "skipping hole at offset "
+                        "%"PRId64" of %s", loop_sh->offset,
+                        loop_local->loc.path);
+                sh_loop_return (loop_sh->sh_frame, this, loop_frame, 0, 0);
+                return 0;
+        }
+
+        return sh_loop_readv (loop_frame, this);
+}
+
+
+static int
+sh_loop_seek_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset,
+                  dict_t *xdata)
+{
+        afr_local_t             *loop_local = NULL;
+        afr_self_heal_t         *loop_sh    = NULL;
+        afr_local_t             *sh_local   = NULL;
+        afr_sh_algo_private_t   *sh_priv    = NULL;
+        off_t                    hole_end   = 0;
+        off_t                    block_end  = 0;
 
         loop_local = loop_frame->local;
         loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+        sh_priv    = sh_local->self_heal.private;
+
+        if (op_ret == 0)
+                hole_end = offset;
+        else if (op_errno == ENXIO)
+                /* no data from here till the end of the file */
+                hole_end = sh_local->self_heal.file_size;
+        else
+                /* seek not supported (or failed), read as before */
+                return sh_loop_readv (loop_frame, this);
+
+        block_end = min (loop_sh->offset + loop_sh->block_size,
+                         sh_local->self_heal.file_size);
+        if (hole_end < block_end)
+                return sh_loop_readv (loop_frame, this);
 
-        sh_frame = loop_sh->sh_frame;
-        sh_local = sh_frame->local;
+        LOCK (&sh_priv->lock);
+        {
+                sh_priv->hole_start = loop_sh->offset;
+                sh_priv->hole_end   = hole_end;
+        }
+        UNLOCK (&sh_priv->lock);
+
+        return sh_loop_skip_hole (loop_frame, this);
+}
+
+
+static int
+sh_loop_read (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv       = NULL;
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        afr_local_t             *sh_local     = NULL;
+        afr_self_heal_t         *sh           = NULL;
+        afr_sh_algo_private_t   *sh_priv      = NULL;
+        gf_boolean_t             in_hole      = _gf_false;
+
+        priv     = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_local = loop_sh->sh_frame->local;
         sh       = &sh_local->self_heal;
+        sh_priv  = sh->private;
 
-        sh_priv = sh->private;
+        /* holes are only preserved by the full algorithm, see
+           sh_prune_writes_needed() */
+        if (!loop_sh->file_has_holes || strcmp (sh->algo->name, "full"))
+                return sh_loop_readv (loop_frame, this);
 
-        child_index = (long) cookie;
+        LOCK (&sh_priv->lock);
+        {
+                if ((loop_sh->offset >= sh_priv->hole_start) &&
+                    (loop_sh->offset + loop_sh->block_size <=
+                     sh_priv->hole_end))
+                        in_hole = _gf_true;
+        }
+        UNLOCK (&sh_priv->lock);
 
-        if (op_ret < 0) {
-                gf_log (this->name, GF_LOG_ERROR,
-                        "checksum on %s failed on subvolume %s (%s)",
-                        sh_local->loc.path, priv->children[child_index]->name,
-                        strerror (op_errno));
-                sh->op_failed = 1;
-        } else {
-                memcpy (loop_sh->checksum + child_index * MD5_DIGEST_LENGTH,
-                        strong_checksum, MD5_DIGEST_LENGTH);
+        if (in_hole)
+                return sh_loop_skip_hole (loop_frame, this);
+
+        STACK_WIND_COOKIE (loop_frame, sh_loop_seek_cbk,
+                           (void *) (long) loop_sh->source,
+                           priv->children[loop_sh->source],
+                           priv->children[loop_sh->source]->fops->seek,
+                           loop_sh->healing_fd, loop_sh->offset,
+                           GF_SEEK_DATA, NULL);
+
+        return 0;
+}
+
+
+/* The "delta" algorithm: once the checksum of a window differs, compare it
+ * again in AFR_SH_DELTA_BLOCK_SIZE blocks and heal only the blocks that
+ * differ. The span of them is read from the source and, like rsync,
+ * searched with the rolling weak checksum for data a sink holds in some
+ * block of the window, at any offset; those are copied on the sink itself
+ * and only the rest is written to it. Sinks are healed in place: the
+ * copies go first, ordered so that none reads a range an earlier one
+ * wrote, and a copy which cannot be ordered so is written instead. If a
+ * sink cannot copy, the blocks are written run by run as read. */
+
+/* whether the checksums of a window, asked from 'count' bricks, can be
+   compared. A brick which does not know the key answers with the MD5, so
+   the key is not sent for the rest of the heal */
+static gf_boolean_t
+sh_checksums_comparable (xlator_t *this, afr_sh_algo_private_t *sh_priv,
+                         afr_self_heal_t *loop_sh, int count)
+{
+        if (!loop_sh->delta_keyed || (loop_sh->delta_keyed_replies == count))
+                return _gf_true;
+
+        LOCK (&sh_priv->lock);
+        {
+                if (sh_priv->keyed)
+                        gf_log (this->name, GF_LOG_INFO, "%d of %d bricks "
+                                "do not support keyed checksums, using MD5",
+                                count - loop_sh->delta_keyed_replies, count);
+                sh_priv->keyed = _gf_false;
         }
+        UNLOCK (&sh_priv->lock);
 
-        call_count = afr_frame_return (loop_frame);
+        return (loop_sh->delta_keyed_replies == 0);
+}
 
-        if (call_count == 0) {
-                for (i = 0; i < priv->child_count; i++) {
-                        if (sh->sources[i] || !sh_local->child_up[i])
-                                continue;
+static void
+sh_checksum_reply_keyed (call_frame_t *loop_frame, dict_t *xdata)
+{
+        afr_local_t             *loop_local  = NULL;
 
-                        if (memcmp (loop_sh->checksum + (i * MD5_DIGEST_LENGTH),
-                                    loop_sh->checksum + (sh->source * MD5_DIGEST_LENGTH),
-                                    MD5_DIGEST_LENGTH)) {
-                                /*
-                                  Checksums differ, so this block
-                                  must be written to this sink
-                                */
+        if (!xdata || !dict_get (xdata, GF_RCHECKSUM_KEY))
+                return;
 
-                                gf_log (this->name, GF_LOG_DEBUG,
-                                        "checksum on subvolume %s at offset %"
-                                        PRId64" differs from that on source",
-                                        priv->children[i]->name, loop_sh->offset);
+        loop_local = loop_frame->local;
+        LOCK (&loop_frame->lock);
+        {
+                loop_local->self_heal.delta_keyed_replies++;
+        }
+        UNLOCK (&loop_frame->lock);
+}
 
-                                write_needed = loop_sh->write_needed[i] = 1;
-                        }
-                }
+static dict_t *
+sh_checksum_xdata (afr_self_heal_t *loop_sh, afr_sh_algo_private_t *sh_priv)
+{
+        loop_sh->delta_keyed = sh_priv->keyed;
+        loop_sh->delta_keyed_replies = 0;
+
+        return sh_priv->keyed ? sh_priv->key_xdata : NULL;
+}
+
+static int
+sh_delta_next_range (call_frame_t *loop_frame, xlator_t *this);
+
+static int
+sh_delta_write_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                    struct iatt *postbuf, dict_t *xdata)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        call_frame_t            *sh_frame    = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        afr_sh_algo_private_t   *sh_priv     = NULL;
+        int                     call_count   = 0;
+        int                     child_index  = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
 
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+        sh_priv  = sh->private;
+
+        child_index = (long) cookie;
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "write to %s failed on subvolume %s (%s)",
+                        sh_local->loc.path,
+                        priv->children[child_index]->name,
+                        strerror (op_errno));
+
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, op_errno);
+        } else if (op_ret < loop_local->cont.writev.vector->iov_len) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "incomplete write to %s on subvolume %s "
+                        "(expected %lu, returned %d)", sh_local->loc.path,
+                        priv->children[child_index]->name,
+                        loop_local->cont.writev.vector->iov_len, op_ret);
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, EIO);
+        } else {
                 LOCK (&sh_priv->lock);
                 {
-                        sh_priv->total_blocks++;
-                        if (write_needed)
-                                sh_priv->diff_blocks++;
+                        sh_priv->delta_bytes += op_ret;
                 }
                 UNLOCK (&sh_priv->lock);
+        }
 
-                if (write_needed && !sh->op_failed) {
-                        sh_loop_read (loop_frame, this);
-                } else {
+        call_count = afr_frame_return (loop_frame);
+
+        if (call_count == 0) {
+                GF_FREE (loop_local->cont.writev.vector);
+                loop_local->cont.writev.vector = NULL;
+                iobref_unref (loop_local->cont.writev.iobref);
+                loop_local->cont.writev.iobref = NULL;
+
+                if (sh->op_failed)
                         sh_loop_return (sh_frame, this, loop_frame,
-                                        op_ret, op_errno);
-                }
+                                        -1, loop_sh->op_errno);
+                else
+                        sh_delta_next_range (loop_frame, this);
         }
 
         return 0;
 }
 
 static int
-sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
+sh_delta_read_cbk (call_frame_t *loop_frame, void *cookie,
+                   xlator_t *this, int32_t op_ret, int32_t op_errno,
+                   struct iovec *vector, int32_t count, struct iatt *buf,
+                   struct iobref *iobref, dict_t *xdata)
 {
-        afr_private_t           *priv         = NULL;
-        afr_local_t             *loop_local   = NULL;
-        afr_self_heal_t         *loop_sh      = NULL;
-        int                     call_count    = 0;
-        int                     i             = 0;
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        call_frame_t            *sh_frame    = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        int                     call_count   = 0;
+        int                     i            = 0;
 
-        priv         = this->private;
-        loop_local   = loop_frame->local;
-        loop_sh      = &loop_local->self_heal;
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
 
-        call_count = loop_sh->active_sinks + 1;  /* sinks and source */
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
 
-        loop_local->call_count = call_count;
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "read failed on %d "
+                        "for %s reason :%s", sh->source,
+                        sh_local->loc.path, strerror (op_errno));
+                sh->op_failed = 1;
+                sh_loop_return (sh_frame, this, loop_frame, op_ret, op_errno);
+                goto out;
+        }
 
-        STACK_WIND_COOKIE (loop_frame, sh_diff_checksum_cbk,
-                           (void *) (long) loop_sh->source,
-                           priv->children[loop_sh->source],
-                           priv->children[loop_sh->source]->fops->rchecksum,
-                           loop_sh->healing_fd,
-                           loop_sh->offset, loop_sh->block_size, NULL);
+        call_count = sh_number_of_writes_needed (loop_sh->write_needed,
+                                                 priv->child_count);
+        if ((op_ret == 0) || (call_count == 0)) {
+                /* source shrank under us, the trim takes care of it */
+                sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+                goto out;
+        }
+
+        loop_local->call_count = call_count;
+        loop_local->cont.writev.vector = iov_dup (vector, count);
+        loop_local->cont.writev.iobref = iobref_ref (iobref);
 
         for (i = 0; i < priv->child_count; i++) {
-                if (loop_sh->sources[i] || !loop_local->child_up[i])
+                if (!loop_sh->write_needed[i])
                         continue;
-
-                STACK_WIND_COOKIE (loop_frame, sh_diff_checksum_cbk,
+                STACK_WIND_COOKIE (loop_frame, sh_delta_write_cbk,
                                    (void *) (long) i,
                                    priv->children[i],
-                                   priv->children[i]->fops->rchecksum,
-                                   loop_sh->healing_fd,
-                                   loop_sh->offset, loop_sh->block_size, NULL);
+                                   priv->children[i]->fops->writev,
+                                   loop_sh->healing_fd, vector, count,
+                                   loop_sh->delta_offset, 0, iobref, NULL);
 
                 if (!--call_count)
                         break;
         }
 
+out:
         return 0;
 }
 
+static gf_boolean_t
+sh_delta_block_dirty (afr_self_heal_t *loop_sh, int block, int child_count)
+{
+        int i = 0;
+
+        for (i = 0; i < child_count; i++) {
+                if (loop_sh->delta_dirty[block * child_count + i])
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+/* reads the next run of differing blocks from the source and writes it to
+   the sinks it differs on */
 static int
-sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
+sh_delta_next_range (call_frame_t *loop_frame, xlator_t *this)
 {
-        afr_private_t           *priv         = NULL;
-        afr_local_t             *loop_local   = NULL;
-        afr_self_heal_t         *loop_sh      = NULL;
-        int                     i             = 0;
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        int                     start        = 0;
+        int                     end          = 0;
+        int                     i            = 0;
+        int                     j            = 0;
 
-        priv         = this->private;
-        loop_local   = loop_frame->local;
-        loop_sh      = &loop_local->self_heal;
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        for (start = loop_sh->delta_next; start < loop_sh->delta_blocks;
+             start++) {
+                if (sh_delta_block_dirty (loop_sh, start, priv->child_count))
+                        break;
+        }
+
+        if (start == loop_sh->delta_blocks) {
+                sh_loop_return (loop_sh->sh_frame, this, loop_frame, 0, 0);
+                return 0;
+        }
+
+        for (end = start + 1; end < loop_sh->delta_blocks; end++) {
+                if (!sh_delta_block_dirty (loop_sh, end, priv->child_count))
+                        break;
+        }
 
         for (i = 0; i < priv->child_count; i++) {
-                if (loop_sh->sources[i] || !loop_local->child_up[i])
-                        continue;
-                loop_sh->write_needed[i] = 1;
+                loop_sh->write_needed[i] = 0;
+                for (j = start; j < end; j++) {
+                        if (loop_sh->delta_dirty[j * priv->child_count + i])
+                                loop_sh->write_needed[i] = 1;
+                }
         }
-        sh_loop_read (loop_frame, this);
+
+        loop_sh->delta_next = end;
+        loop_sh->delta_offset = loop_sh->offset +
+                                ((off_t) start * AFR_SH_DELTA_BLOCK_SIZE);
+
+        gf_log (this->name, GF_LOG_TRACE, "copying blocks %d-%d at offset %"
+                PRId64" of %s", start, end - 1, loop_sh->delta_offset,
+                loop_local->loc.path);
+
+        STACK_WIND_COOKIE (loop_frame, sh_delta_read_cbk,
+                           (void *) (long) loop_sh->source,
+                           priv->children[loop_sh->source],
+                           priv->children[loop_sh->source]->fops->readv,
+                           loop_sh->healing_fd,
+                           (end - start) * AFR_SH_DELTA_BLOCK_SIZE,
+                           loop_sh->delta_offset, 0, NULL);
+
         return 0;
 }
 
-afr_sh_algo_private_t*
-afr_sh_priv_init ()
+
+static void
+sh_delta_ops_finish (call_frame_t *loop_frame, xlator_t *this)
 {
-        afr_sh_algo_private_t   *sh_priv = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
 
-        sh_priv = GF_CALLOC (1, sizeof (*sh_priv),
-                             gf_afr_mt_afr_private_t);
-        if (!sh_priv)
-                goto out;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+
+        GF_FREE (loop_sh->delta_ops);
+        loop_sh->delta_ops = NULL;
+        loop_sh->delta_op_count = 0;
+        if (loop_sh->delta_iobref)
+                iobref_unref (loop_sh->delta_iobref);
+        loop_sh->delta_iobref = NULL;
+        loop_sh->delta_buf = NULL;
+
+        if (sh_local->self_heal.op_failed)
+                sh_loop_return (loop_sh->sh_frame, this, loop_frame,
+                                -1, loop_sh->op_errno);
+        else
+                sh_loop_return (loop_sh->sh_frame, this, loop_frame, 0, 0);
+}
 
-        LOCK_INIT (&sh_priv->lock);
-out:
+static int
+sh_delta_ops_resume (call_frame_t *loop_frame, xlator_t *this);
+
+static int
+sh_delta_op_write_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                       struct iatt *postbuf, dict_t *xdata)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        afr_sh_algo_private_t   *sh_priv     = NULL;
+        afr_sh_delta_op_t       *op          = NULL;
+        int                     call_count   = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+        sh         = &sh_local->self_heal;
+        sh_priv    = sh->private;
+
+        op = &loop_sh->delta_ops[(long) cookie];
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "write to %s failed on subvolume %s (%s)",
+                        sh_local->loc.path, priv->children[op->child]->name,
+                        strerror (op_errno));
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, op_errno);
+        } else if (op_ret < (int32_t) op->len) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "incomplete write to %s on subvolume %s "
+                        "(expected %zu, returned %d)", sh_local->loc.path,
+                        priv->children[op->child]->name, op->len, op_ret);
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, EIO);
+        } else {
+                LOCK (&sh_priv->lock);
+                {
+                        sh_priv->delta_bytes += op_ret;
+                }
+                UNLOCK (&sh_priv->lock);
+        }
+
+        call_count = afr_frame_return (loop_frame);
+        if (call_count == 0)
+                sh_delta_ops_finish (loop_frame, this);
+
+        return 0;
+}
+
+static int
+sh_delta_op_copy_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                      struct iatt *prebuf_dst, struct iatt *postbuf_dst,
+                      dict_t *xdata)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        afr_sh_algo_private_t   *sh_priv     = NULL;
+        afr_sh_delta_op_t       *op          = NULL;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+        sh         = &sh_local->self_heal;
+        sh_priv    = sh->private;
+
+        op = &loop_sh->delta_ops[(long) cookie];
+
+        afr_frame_return (loop_frame);
+
+        if ((op_ret == -1) && (op_errno == ENOTCONN)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "copy within %s failed on subvolume %s (%s)",
+                        sh_local->loc.path, priv->children[op->child]->name,
+                        strerror (op_errno));
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, op_errno);
+                sh_delta_ops_finish (loop_frame, this);
+                goto out;
+        }
+
+        if (op_ret < (int32_t) op->len) {
+                /* write the source's bytes instead, a real error shows
+                   again there */
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "copy within %s on subvolume %s returned %d (%s), "
+                        "writing instead", sh_local->loc.path,
+                        priv->children[op->child]->name, op_ret,
+                        (op_ret < 0) ? strerror (op_errno) : "short copy");
+                op->copy = _gf_false;
+                LOCK (&sh_priv->lock);
+                {
+                        sh_priv->no_copy = _gf_true;
+                }
+                UNLOCK (&sh_priv->lock);
+        } else {
+                LOCK (&sh_priv->lock);
+                {
+                        sh_priv->reused_bytes += op_ret;
+                }
+                UNLOCK (&sh_priv->lock);
+        }
+
+        loop_sh->delta_next++;
+        sh_delta_ops_resume (loop_frame, this);
+out:
+        return 0;
+}
+
+static void
+sh_delta_op_wind (call_frame_t *loop_frame, xlator_t *this, int k)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_sh_delta_op_t       *op          = NULL;
+        struct iovec            vector       = {0, };
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        op         = &loop_sh->delta_ops[k];
+
+        if (op->copy) {
+                STACK_WIND_COOKIE (loop_frame, sh_delta_op_copy_cbk,
+                                   (void *) (long) k,
+                                   priv->children[op->child],
+                                   priv->children[op->child]->fops->copy_file_range,
+                                   loop_sh->healing_fd, op->src,
+                                   loop_sh->healing_fd, op->offset,
+                                   op->len, 0, NULL);
+                return;
+        }
+
+        vector.iov_base = loop_sh->delta_buf + op->data;
+        vector.iov_len  = op->len;
+        STACK_WIND_COOKIE (loop_frame, sh_delta_op_write_cbk,
+                           (void *) (long) k,
+                           priv->children[op->child],
+                           priv->children[op->child]->fops->writev,
+                           loop_sh->healing_fd, &vector, 1, op->offset, 0,
+                           loop_sh->delta_iobref, NULL);
+}
+
+/* the copies one at a time in their order, then all the writes at once */
+static int
+sh_delta_ops_resume (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_sh_algo_private_t   *sh_priv     = NULL;
+        afr_sh_delta_op_t       *ops         = NULL;
+        int                     writes       = 0;
+        int                     k            = 0;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+        sh_priv    = sh_local->self_heal.private;
+        ops        = loop_sh->delta_ops;
+
+        for (; (loop_sh->delta_next < loop_sh->delta_op_count) &&
+               ops[loop_sh->delta_next].copy; loop_sh->delta_next++) {
+                if (sh_priv->no_copy) {
+                        ops[loop_sh->delta_next].copy = _gf_false;
+                        continue;
+                }
+
+                loop_local->call_count = 1;
+                sh_delta_op_wind (loop_frame, this, loop_sh->delta_next);
+                return 0;
+        }
+
+        for (k = 0; k < loop_sh->delta_op_count; k++) {
+                if (!ops[k].copy)
+                        writes++;
+        }
+
+        if (!writes) {
+                sh_delta_ops_finish (loop_frame, this);
+                return 0;
+        }
+
+        loop_local->call_count = writes;
+        for (k = 0; k < loop_sh->delta_op_count; k++) {
+                if (ops[k].copy)
+                        continue;
+                sh_delta_op_wind (loop_frame, this, k);
+                if (!--writes)
+                        break;
+        }
+
+        return 0;
+}
+
+static gf_boolean_t
+sh_delta_overlaps (off_t a, size_t alen, off_t b, size_t blen)
+{
+        return (a < b + (off_t) blen) && (b < a + (off_t) alen);
+}
+
+static void
+sh_delta_add_op (afr_self_heal_t *loop_sh, int child, gf_boolean_t copy,
+                 off_t src, size_t data, size_t len)
+{
+        afr_sh_delta_op_t       *op          = NULL;
+        off_t                   offset       = 0;
+
+        if (!len)
+                return;
+
+        offset = loop_sh->delta_offset + data;
+
+        if (loop_sh->delta_op_count) {
+                op = &loop_sh->delta_ops[loop_sh->delta_op_count - 1];
+                if ((op->child == child) && (op->copy == copy) &&
+                    (op->offset + op->len == offset) &&
+                    (!copy || ((op->src + op->len == src) &&
+                               !sh_delta_overlaps (op->src, op->len + len,
+                                                   op->offset,
+                                                   op->len + len)))) {
+                        op->len += len;
+                        return;
+                }
+        }
+
+        op = &loop_sh->delta_ops[loop_sh->delta_op_count++];
+        op->child  = child;
+        op->copy   = copy;
+        op->src    = src;
+        op->offset = offset;
+        op->data   = data;
+        op->len    = len;
+}
+
+/* whether copying 'len' bytes from 'src' to 'offset' of 'child' can run
+   after the copies [first, count) to it, which move data down, did */
+static gf_boolean_t
+sh_delta_copy_safe (afr_self_heal_t *loop_sh, int first, off_t src,
+                    off_t offset, size_t len)
+{
+        afr_sh_delta_op_t       *op          = NULL;
+        int                     k            = 0;
+
+        for (k = first; k < loop_sh->delta_op_count; k++) {
+                op = &loop_sh->delta_ops[k];
+                if (op->copy && (op->src > op->offset) &&
+                    sh_delta_overlaps (src, len, op->offset, op->len))
+                        return _gf_false;
+        }
+
+        return !sh_delta_overlaps (src, len, offset, len);
+}
+
+/* Copies moving data down run in the order found, those moving it up in
+   the reverse one, after all of the former. Copies moving data up whose
+   source one of the copies before them overwrites are written instead. */
+static void
+sh_delta_order_copies (afr_self_heal_t *loop_sh, int first)
+{
+        afr_sh_delta_op_t       *op          = NULL;
+        afr_sh_delta_op_t       *other       = NULL;
+        int                     k            = 0;
+        int                     l            = 0;
+
+        for (k = loop_sh->delta_op_count - 1; k >= first; k--) {
+                op = &loop_sh->delta_ops[k];
+                if (!op->copy || (op->src > op->offset))
+                        continue;
+
+                for (l = first; l < loop_sh->delta_op_count; l++) {
+                        other = &loop_sh->delta_ops[l];
+                        if ((l == k) || !other->copy)
+                                continue;
+                        if (((other->src > other->offset) || (l > k)) &&
+                            sh_delta_overlaps (op->src, op->len,
+                                               other->offset, other->len))
+                                break;
+                }
+
+                if (l < loop_sh->delta_op_count)
+                        op->copy = _gf_false;
+        }
+}
+
+typedef struct {
+        uint32_t weak;
+        int      block;
+} sh_delta_candidate_t;
+
+static int
+sh_delta_candidate_cmp (const void *a, const void *b)
+{
+        const sh_delta_candidate_t *ca = a;
+        const sh_delta_candidate_t *cb = b;
+
+        if (ca->weak != cb->weak)
+                return (ca->weak < cb->weak) ? -1 : 1;
+        return ca->block - cb->block;
+}
+
+/* the block of the sink among 'cands' holding 'data' which can be copied
+   to 'offset', or -1 */
+static int
+sh_delta_match (afr_self_heal_t *loop_sh, afr_sh_algo_private_t *sh_priv,
+                int child, int child_count, int first,
+                sh_delta_candidate_t *cands, int ncands, uint32_t weak,
+                unsigned char *data, off_t offset)
+{
+        unsigned char   strong[GF_RSYNC_STRONG_CHECKSUM_LENGTH] = {0};
+        gf_boolean_t    have_strong = _gf_false;
+        off_t           src         = 0;
+        int             lo          = 0;
+        int             hi          = ncands;
+        int             mid         = 0;
+        int             idx         = 0;
+
+        while (lo < hi) {
+                mid = (lo + hi) / 2;
+                if (cands[mid].weak < weak)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+
+        for (; (lo < ncands) && (cands[lo].weak == weak); lo++) {
+                src = loop_sh->offset +
+                      (off_t) cands[lo].block * AFR_SH_DELTA_BLOCK_SIZE;
+                if ((src == offset) ||
+                    ((src > offset) &&
+                     !sh_delta_copy_safe (loop_sh, first, src, offset,
+                                          AFR_SH_DELTA_BLOCK_SIZE)))
+                        continue;
+
+                if (!have_strong) {
+                        if (loop_sh->delta_keyed)
+                                gf_rsync_keyed_checksum (sh_priv->key, data,
+                                                         AFR_SH_DELTA_BLOCK_SIZE,
+                                                         strong);
+                        else
+                                gf_rsync_strong_checksum (data,
+                                                          AFR_SH_DELTA_BLOCK_SIZE,
+                                                          strong);
+                        have_strong = _gf_true;
+                }
+
+                idx = cands[lo].block * child_count + child;
+                if (!memcmp (strong, loop_sh->delta_strong +
+                             (idx * GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                             GF_RSYNC_STRONG_CHECKSUM_LENGTH))
+                        return cands[lo].block;
+        }
+
+        return -1;
+}
+
+/* Splits the 'size' bytes at loop_sh->delta_buf, read from the source at
+   loop_sh->delta_offset, into the copies and writes each sink needs, the
+   copies first and in the order they must run in. */
+static int
+sh_delta_search (call_frame_t *loop_frame, xlator_t *this, size_t size)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_sh_algo_private_t   *sh_priv     = NULL;
+        sh_delta_candidate_t    *cands       = NULL;
+        afr_sh_delta_op_t       *ops         = NULL;
+        unsigned char           *data        = NULL;
+        size_t                  bs           = AFR_SH_DELTA_BLOCK_SIZE;
+        size_t                  pos          = 0;
+        size_t                  lit          = 0;
+        uint32_t                weak         = 0;
+        gf_boolean_t            have_weak    = _gf_false;
+        int                     start        = 0;
+        int                     first        = 0;
+        int                     ncands       = 0;
+        int                     sinks        = 0;
+        int                     block        = 0;
+        int                     count        = 0;
+        int                     ret          = -1;
+        int                     i            = 0;
+        int                     k            = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+        sh_priv    = sh_local->self_heal.private;
+        data       = (unsigned char *) loop_sh->delta_buf;
+        start      = (loop_sh->delta_offset - loop_sh->offset) / bs;
+
+        sinks = sh_number_of_writes_needed (loop_sh->write_needed,
+                                            priv->child_count);
+        cands = GF_CALLOC (loop_sh->delta_blocks, sizeof (*cands),
+                           gf_afr_mt_int32_t);
+        loop_sh->delta_ops = GF_CALLOC (sinks * 3 * (size / bs + 2),
+                                        sizeof (*loop_sh->delta_ops),
+                                        gf_afr_mt_sh_delta_op_t);
+        ops = GF_CALLOC (sinks * 3 * (size / bs + 2), sizeof (*ops),
+                         gf_afr_mt_sh_delta_op_t);
+        if (!cands || !loop_sh->delta_ops || !ops)
+                goto out;
+        loop_sh->delta_op_count = 0;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!loop_sh->write_needed[i])
+                        continue;
+
+                /* whole blocks of the sink in the window */
+                ncands = 0;
+                for (block = 0; block < loop_sh->delta_blocks; block++) {
+                        if (loop_sh->offset + (off_t) (block + 1) * bs >
+                            sh_local->self_heal.file_size)
+                                break;
+                        cands[ncands].weak = loop_sh->delta_weak[block *
+                                                priv->child_count + i];
+                        cands[ncands].block = block;
+                        ncands++;
+                }
+                qsort (cands, ncands, sizeof (*cands), sh_delta_candidate_cmp);
+
+                first = loop_sh->delta_op_count;
+                lit = 0;
+                pos = 0;
+                have_weak = _gf_false;
+                while (pos < size) {
+                        block = start + (pos / bs);
+                        if (!(pos % bs) &&
+                            !loop_sh->delta_dirty[block * priv->child_count
+                                                  + i]) {
+                                /* the sink already has this block */
+                                sh_delta_add_op (loop_sh, i, _gf_false, 0,
+                                                 lit, pos - lit);
+                                pos = min (pos + bs, size);
+                                lit = pos;
+                                have_weak = _gf_false;
+                                continue;
+                        }
+
+                        if (!ncands || (pos + bs > size)) {
+                                pos = min ((pos / bs + 1) * bs, size);
+                                have_weak = _gf_false;
+                                continue;
+                        }
+
+                        if (!have_weak) {
+                                weak = gf_rsync_weak_checksum (data + pos, bs);
+                                have_weak = _gf_true;
+                        }
+
+                        block = sh_delta_match (loop_sh, sh_priv, i,
+                                                priv->child_count, first,
+                                                cands, ncands, weak,
+                                                data + pos,
+                                                loop_sh->delta_offset + pos);
+                        if (block >= 0) {
+                                sh_delta_add_op (loop_sh, i, _gf_false, 0,
+                                                 lit, pos - lit);
+                                sh_delta_add_op (loop_sh, i, _gf_true,
+                                                 loop_sh->offset +
+                                                 (off_t) block * bs, pos, bs);
+                                pos += bs;
+                                lit = pos;
+                                have_weak = _gf_false;
+                                continue;
+                        }
+
+                        if (pos + bs < size)
+                                weak = gf_rsync_weak_checksum_roll (weak,
+                                                data[pos], data[pos + bs], bs);
+                        else
+                                have_weak = _gf_false;
+                        pos++;
+                }
+                sh_delta_add_op (loop_sh, i, _gf_false, 0, lit, size - lit);
+                sh_delta_order_copies (loop_sh, first);
+
+                for (k = first; k < loop_sh->delta_op_count; k++) {
+                        if (loop_sh->delta_ops[k].copy &&
+                            (loop_sh->delta_ops[k].src >
+                             loop_sh->delta_ops[k].offset))
+                                ops[count++] = loop_sh->delta_ops[k];
+                }
+                for (k = loop_sh->delta_op_count - 1; k >= first; k--) {
+                        if (loop_sh->delta_ops[k].copy &&
+                            (loop_sh->delta_ops[k].src <
+                             loop_sh->delta_ops[k].offset))
+                                ops[count++] = loop_sh->delta_ops[k];
+                }
+        }
+
+        for (k = 0; k < loop_sh->delta_op_count; k++) {
+                if (!loop_sh->delta_ops[k].copy)
+                        ops[count++] = loop_sh->delta_ops[k];
+        }
+
+        GF_FREE (loop_sh->delta_ops);
+        loop_sh->delta_ops = ops;
+        ops = NULL;
+        ret = 0;
+out:
+        GF_FREE (cands);
+        GF_FREE (ops);
+        if (ret) {
+                GF_FREE (loop_sh->delta_ops);
+                loop_sh->delta_ops = NULL;
+                loop_sh->delta_op_count = 0;
+        }
+
+        return ret;
+}
+
+static int
+sh_delta_span_read_cbk (call_frame_t *loop_frame, void *cookie,
+                        xlator_t *this, int32_t op_ret, int32_t op_errno,
+                        struct iovec *vector, int32_t count, struct iatt *buf,
+                        struct iobref *iobref, dict_t *xdata)
+{
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        call_frame_t            *sh_frame    = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        struct iobuf            *iobuf       = NULL;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "read failed on %d "
+                        "for %s reason :%s", sh->source,
+                        sh_local->loc.path, strerror (op_errno));
+                sh->op_failed = 1;
+                sh_loop_return (sh_frame, this, loop_frame, op_ret, op_errno);
+                goto out;
+        }
+
+        if (op_ret == 0) {
+                /* source shrank under us, the trim takes care of it */
+                sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+                goto out;
+        }
+
+        /* the search wants the span in one piece */
+        if (count == 1) {
+                loop_sh->delta_buf = vector[0].iov_base;
+                loop_sh->delta_iobref = iobref_ref (iobref);
+        } else {
+                iobuf = iobuf_get2 (this->ctx->iobuf_pool, op_ret);
+                loop_sh->delta_iobref = iobref_new ();
+                if (iobuf && loop_sh->delta_iobref) {
+                        iov_unload (iobuf_ptr (iobuf), vector, count);
+                        iobref_add (loop_sh->delta_iobref, iobuf);
+                        loop_sh->delta_buf = iobuf_ptr (iobuf);
+                }
+                if (iobuf)
+                        iobuf_unref (iobuf);
+        }
+
+        if (!loop_sh->delta_buf || sh_delta_search (loop_frame, this, op_ret)) {
+                if (loop_sh->delta_iobref)
+                        iobref_unref (loop_sh->delta_iobref);
+                loop_sh->delta_iobref = NULL;
+                loop_sh->delta_buf = NULL;
+
+                loop_sh->delta_next = 0;
+                sh_delta_next_range (loop_frame, this);
+                goto out;
+        }
+
+        loop_sh->delta_next = 0;
+        sh_delta_ops_resume (loop_frame, this);
+out:
+        return 0;
+}
+
+/* reads all of the window from its first to its last differing block */
+static int
+sh_delta_read_span (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        int                     start        = -1;
+        int                     end          = 0;
+        int                     i            = 0;
+        int                     j            = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        for (j = 0; j < loop_sh->delta_blocks; j++) {
+                if (!sh_delta_block_dirty (loop_sh, j, priv->child_count))
+                        continue;
+                if (start < 0)
+                        start = j;
+                end = j + 1;
+        }
+
+        if (start < 0) {
+                sh_loop_return (loop_sh->sh_frame, this, loop_frame, 0, 0);
+                return 0;
+        }
+
+        for (i = 0; i < priv->child_count; i++) {
+                loop_sh->write_needed[i] = 0;
+                for (j = start; j < end; j++) {
+                        if (loop_sh->delta_dirty[j * priv->child_count + i])
+                                loop_sh->write_needed[i] = 1;
+                }
+        }
+
+        loop_sh->delta_offset = loop_sh->offset +
+                                ((off_t) start * AFR_SH_DELTA_BLOCK_SIZE);
+
+        STACK_WIND_COOKIE (loop_frame, sh_delta_span_read_cbk,
+                           (void *) (long) loop_sh->source,
+                           priv->children[loop_sh->source],
+                           priv->children[loop_sh->source]->fops->readv,
+                           loop_sh->healing_fd,
+                           (end - start) * AFR_SH_DELTA_BLOCK_SIZE,
+                           loop_sh->delta_offset, 0, NULL);
+
+        return 0;
+}
+
+static int
+sh_delta_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno,
+                       uint32_t weak_checksum, uint8_t *strong_checksum,
+                       dict_t *xdata)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        call_frame_t            *sh_frame    = NULL;
+        afr_local_t             *sh_local    = NULL;
+        afr_self_heal_t         *sh          = NULL;
+        int                     idx          = 0;
+        int                     src          = 0;
+        int                     call_count   = 0;
+        int                     i            = 0;
+        int                     j            = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+
+        idx = (long) cookie;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "checksum on %s failed on subvolume %s (%s)",
+                        sh_local->loc.path,
+                        priv->children[idx % priv->child_count]->name,
+                        strerror (op_errno));
+                sh->op_failed = 1;
+                afr_sh_set_error (loop_sh, op_errno);
+        } else {
+                loop_sh->delta_weak[idx] = weak_checksum;
+                memcpy (loop_sh->delta_strong +
+                        (idx * GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                        strong_checksum, GF_RSYNC_STRONG_CHECKSUM_LENGTH);
+                sh_checksum_reply_keyed (loop_frame, xdata);
+        }
+
+        call_count = afr_frame_return (loop_frame);
+        if (call_count)
+                goto out;
+
+        if (sh->op_failed) {
+                sh_loop_return (sh_frame, this, loop_frame,
+                                -1, loop_sh->op_errno);
+                goto out;
+        }
+
+        if (!sh_checksums_comparable (this, sh->private, loop_sh,
+                                      loop_sh->delta_blocks *
+                                      (1 + sh_number_of_writes_needed (
+                                              loop_sh->write_needed,
+                                              priv->child_count)))) {
+                sh_loop_read (loop_frame, this);
+                goto out;
+        }
+        /* what the search has to compute to compare with the sinks */
+        loop_sh->delta_keyed = loop_sh->delta_keyed &&
+                               loop_sh->delta_keyed_replies;
+
+        /* the weak checksum rejects most differing blocks on its own */
+        for (j = 0; j < loop_sh->delta_blocks; j++) {
+                src = j * priv->child_count + loop_sh->source;
+                for (i = 0; i < priv->child_count; i++) {
+                        idx = j * priv->child_count + i;
+                        if (!loop_sh->write_needed[i])
+                                continue;
+                        if ((loop_sh->delta_weak[idx] !=
+                             loop_sh->delta_weak[src]) ||
+                            memcmp (loop_sh->delta_strong +
+                                    (idx * GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                                    loop_sh->delta_strong +
+                                    (src * GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                                    GF_RSYNC_STRONG_CHECKSUM_LENGTH))
+                                loop_sh->delta_dirty[idx] = 1;
+                }
+        }
+
+        if (((afr_sh_algo_private_t *) sh->private)->no_copy) {
+                loop_sh->delta_next = 0;
+                sh_delta_next_range (loop_frame, this);
+        } else {
+                sh_delta_read_span (loop_frame, this);
+        }
+out:
+        return 0;
+}
+
+static int
+sh_delta_checksum (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv        = NULL;
+        afr_local_t             *loop_local  = NULL;
+        afr_self_heal_t         *loop_sh     = NULL;
+        afr_local_t             *sh_local    = NULL;
+        dict_t                  *xdata       = NULL;
+        off_t                   len          = 0;
+        int                     nblocks      = 0;
+        int                     call_count   = 0;
+        int                     idx          = 0;
+        int                     i            = 0;
+        int                     j            = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+        sh_local   = loop_sh->sh_frame->local;
+
+        len = min (loop_sh->block_size,
+                   sh_local->self_heal.file_size - loop_sh->offset);
+        nblocks = (len + AFR_SH_DELTA_BLOCK_SIZE - 1) /
+                  AFR_SH_DELTA_BLOCK_SIZE;
+        if (nblocks <= 1)
+                /* nothing to gain over copying the whole window */
+                return sh_loop_read (loop_frame, this);
+
+        loop_sh->delta_weak = GF_CALLOC (nblocks * priv->child_count,
+                                         sizeof (*loop_sh->delta_weak),
+                                         gf_afr_mt_int32_t);
+        loop_sh->delta_strong = GF_CALLOC (nblocks * priv->child_count,
+                                           GF_RSYNC_STRONG_CHECKSUM_LENGTH,
+                                           gf_afr_mt_uint8_t);
+        loop_sh->delta_dirty = GF_CALLOC (nblocks * priv->child_count,
+                                          sizeof (*loop_sh->delta_dirty),
+                                          gf_afr_mt_char);
+        if (!loop_sh->delta_weak || !loop_sh->delta_strong ||
+            !loop_sh->delta_dirty)
+                return sh_loop_read (loop_frame, this);
+
+        loop_sh->delta_blocks = nblocks;
+        call_count = nblocks * (1 + sh_number_of_writes_needed (
+                                        loop_sh->write_needed,
+                                        priv->child_count));
+        loop_local->call_count = call_count;
+        xdata = sh_checksum_xdata (loop_sh, sh_local->self_heal.private);
+
+        for (j = 0; j < nblocks; j++) {
+                for (i = 0; i < priv->child_count; i++) {
+                        if ((i != loop_sh->source) &&
+                            !loop_sh->write_needed[i])
+                                continue;
+                        idx = j * priv->child_count + i;
+                        STACK_WIND_COOKIE (loop_frame, sh_delta_checksum_cbk,
+                                           (void *) (long) idx,
+                                           priv->children[i],
+                                           priv->children[i]->fops->rchecksum,
+                                           loop_sh->healing_fd,
+                                           loop_sh->offset +
+                                           ((off_t) j *
+                                            AFR_SH_DELTA_BLOCK_SIZE),
+                                           AFR_SH_DELTA_BLOCK_SIZE, xdata);
+
+                        if (!--call_count)
+                                goto out;
+                }
+        }
+out:
+        return 0;
+}
+
+
+static int
+sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno,
+                      uint32_t weak_checksum, uint8_t *strong_checksum,
+                      dict_t *xdata)
+{
+        afr_private_t                 *priv         = NULL;
+        afr_local_t                   *loop_local   = NULL;
+        afr_self_heal_t               *loop_sh      = NULL;
+        call_frame_t                  *sh_frame     = NULL;
+        afr_local_t                   *sh_local     = NULL;
+        afr_self_heal_t               *sh           = NULL;
+        afr_sh_algo_private_t         *sh_priv      = NULL;
+        int                           child_index  = 0;
+        int                           call_count   = 0;
+        int                           i            = 0;
+        int                           write_needed = 0;
+        gf_boolean_t                  comparable   = _gf_false;
+
+        priv  = this->private;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+
+        sh_priv = sh->private;
+
+        child_index = (long) cookie;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "checksum on %s failed on subvolume %s (%s)",
+                        sh_local->loc.path, priv->children[child_index]->name,
+                        strerror (op_errno));
+                sh->op_failed = 1;
+        } else {
+                memcpy (loop_sh->checksum +
+                        child_index * GF_RSYNC_STRONG_CHECKSUM_LENGTH,
+                        strong_checksum, GF_RSYNC_STRONG_CHECKSUM_LENGTH);
+                sh_checksum_reply_keyed (loop_frame, xdata);
+        }
+
+        call_count = afr_frame_return (loop_frame);
+
+        if (call_count == 0) {
+                comparable = sh_checksums_comparable (this, sh_priv, loop_sh,
+                                                      loop_sh->active_sinks
+                                                      + 1);
+                for (i = 0; i < priv->child_count; i++) {
+                        if (sh->sources[i] || !sh_local->child_up[i])
+                                continue;
+
+                        if (!comparable || memcmp (loop_sh->checksum +
+                                    (i * GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                                    loop_sh->checksum + (sh->source *
+                                    GF_RSYNC_STRONG_CHECKSUM_LENGTH),
+                                    GF_RSYNC_STRONG_CHECKSUM_LENGTH)) {
+                                /*
+                                  Checksums differ, so this block
+                                  must be written to this sink
+                                */
+
+                                gf_log (this->name, GF_LOG_DEBUG,
+                                        "checksum on subvolume %s at offset %"
+                                        PRId64" differs from that on source",
+                                        priv->children[i]->name, loop_sh->offset);
+
+                                write_needed = loop_sh->write_needed[i] = 1;
+                        }
+                }
+
+                LOCK (&sh_priv->lock);
+                {
+                        sh_priv->total_blocks++;
+                        if (write_needed)
+                                sh_priv->diff_blocks++;
+                }
+                UNLOCK (&sh_priv->lock);
+
+                if (write_needed && !sh->op_failed) {
+                        if (!strcmp (sh->algo->name, "delta"))
+                                sh_delta_checksum (loop_frame, this);
+                        else
+                                sh_loop_read (loop_frame, this);
+                } else {
+                        sh_loop_return (sh_frame, this, loop_frame,
+                                        op_ret, op_errno);
+                }
+        }
+
+        return 0;
+}
+
+static int
+sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv         = NULL;
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        afr_local_t             *sh_local     = NULL;
+        dict_t                  *xdata        = NULL;
+        int                     call_count    = 0;
+        int                     i             = 0;
+
+        priv         = this->private;
+        loop_local   = loop_frame->local;
+        loop_sh      = &loop_local->self_heal;
+        sh_local     = loop_sh->sh_frame->local;
+
+        call_count = loop_sh->active_sinks + 1;  /* sinks and source */
+
+        loop_local->call_count = call_count;
+        xdata = sh_checksum_xdata (loop_sh, sh_local->self_heal.private);
+
+        STACK_WIND_COOKIE (loop_frame, sh_diff_checksum_cbk,
+                           (void *) (long) loop_sh->source,
+                           priv->children[loop_sh->source],
+                           priv->children[loop_sh->source]->fops->rchecksum,
+                           loop_sh->healing_fd,
+                           loop_sh->offset, loop_sh->block_size, xdata);
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (loop_sh->sources[i] || !loop_local->child_up[i])
+                        continue;
+
+                STACK_WIND_COOKIE (loop_frame, sh_diff_checksum_cbk,
+                                   (void *) (long) i,
+                                   priv->children[i],
+                                   priv->children[i]->fops->rchecksum,
+                                   loop_sh->healing_fd,
+                                   loop_sh->offset, loop_sh->block_size, xdata);
+
+                if (!--call_count)
+                        break;
+        }
+
+        return 0;
+}
+
+static int
+sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv         = NULL;
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        int                     i             = 0;
+
+        priv         = this->private;
+        loop_local   = loop_frame->local;
+        loop_sh      = &loop_local->self_heal;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (loop_sh->sources[i] || !loop_local->child_up[i])
+                        continue;
+                loop_sh->write_needed[i] = 1;
+        }
+        sh_loop_read (loop_frame, this);
+        return 0;
+}
+
+afr_sh_algo_private_t*
+afr_sh_priv_init ()
+{
+        afr_sh_algo_private_t   *sh_priv = NULL;
+
+        sh_priv = GF_CALLOC (1, sizeof (*sh_priv),
+                             gf_afr_mt_afr_private_t);
+        if (!sh_priv)
+                goto out;
+
+        LOCK_INIT (&sh_priv->lock);
+
+        uuid_generate (sh_priv->key);
+        sh_priv->key_xdata = dict_new ();
+        if (sh_priv->key_xdata &&
+            !dict_set_static_bin (sh_priv->key_xdata, GF_RCHECKSUM_KEY,
+                                  sh_priv->key, sizeof (sh_priv->key)))
+                sh_priv->keyed = _gf_true;
+out:
         return sh_priv;
 }
 
@@ -780,6 +2069,7 @@ afr_sh_start_loops (call_frame_t *sh_frame, xlator_t *this,
         afr_self_heal_t         *sh      = NULL;
         int                     ret      = 0;
         afr_private_t           *priv    = NULL;
+        uint32_t                window   = 0;
 
         local = sh_frame->local;
         sh    = &local->self_heal;
@@ -796,6 +2086,11 @@ afr_sh_start_loops (call_frame_t *sh_frame, xlator_t *this,
                 ret = -1;
                 goto out;
         }
+        sh->private->window = priv->data_self_heal_window_size;
+        if (local->xattr_req &&
+            !dict_get_uint32 (local->xattr_req, AFR_SH_WINDOW_KEY, &window) &&
+            (window > sh->private->window))
+                sh->private->window = window;
         sh_loop_driver (sh_frame, this, _gf_true, first_loop_frame);
         ret = 0;
 out:
@@ -820,8 +2115,16 @@ afr_sh_algo_full (call_frame_t *sh_frame, xlator_t *this)
         return 0;
 }
 
+int
+afr_sh_algo_delta (call_frame_t *sh_frame, xlator_t *this)
+{
+        afr_sh_start_loops (sh_frame, this, sh_diff_checksum);
+        return 0;
+}
+
 struct afr_sh_algorithm afr_self_heal_algorithms[] = {
         {.name = "full",  .fn = afr_sh_algo_full},
         {.name = "diff",  .fn = afr_sh_algo_diff},
+        {.name = "delta", .fn = afr_sh_algo_delta},
         {0, 0},
 };
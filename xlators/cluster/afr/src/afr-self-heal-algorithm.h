@@ -11,6 +11,8 @@
 #ifndef __AFR_SELF_HEAL_ALGORITHM_H__
 #define __AFR_SELF_HEAL_ALGORITHM_H__
 
+#include "checksum.h"
+
 typedef int (*afr_sh_algo_fn) (call_frame_t *frame,
                                xlator_t *this);
 
@@ -19,14 +21,52 @@ struct afr_sh_algorithm {
         afr_sh_algo_fn fn;
 };
 
-extern struct afr_sh_algorithm afr_self_heal_algorithms[3];
+extern struct afr_sh_algorithm afr_self_heal_algorithms[4];
+
+/* granularity at which the "delta" algorithm compares and copies a
+   window whose checksum differs */
+#define AFR_SH_DELTA_BLOCK_SIZE (4 * GF_UNIT_KB)
+
+/* one write the "delta" algorithm makes to a sink to heal a run of blocks:
+   either the source's bytes, or a block the sink already holds elsewhere
+   in the window, copied there on the sink itself */
+typedef struct {
+        int child;
+        gf_boolean_t copy;
+        off_t src;             /* sink offset copied from */
+        off_t offset;
+        size_t len;
+        size_t data;           /* offset of the source's bytes in the run */
+} afr_sh_delta_op_t;
+
 typedef struct {
         gf_lock_t lock;
         unsigned int loops_running;
+        /* loops to run at once, data-self-heal-window-size unless the
+           heal was asked for more */
+        unsigned int window;
         off_t offset;
 
         int32_t total_blocks;
         int32_t diff_blocks;
+        /* bytes the "delta" algorithm wrote to the sinks, and bytes it
+           instead copied from elsewhere on the sink */
+        uint64_t delta_bytes;
+        uint64_t reused_bytes;
+
+        /* key of the keyed strong checksum the bricks are asked for,
+           random for every heal; cleared 'keyed' when a brick does not
+           know the key and checksums are back to MD5 */
+        unsigned char key[GF_RSYNC_CHECKSUM_KEY_LENGTH];
+        dict_t *key_xdata;
+        gf_boolean_t keyed;
+        /* a sink failed to copy, don't search for blocks to copy */
+        gf_boolean_t no_copy;
+
+        /* last range [hole_start, hole_end) the source reported as a
+           hole, so neighbouring loops need not ask again */
+        off_t hole_start;
+        off_t hole_end;
 } afr_sh_algo_private_t;
 
 #endif /* __AFR_SELF_HEAL_ALGORITHM_H__ */
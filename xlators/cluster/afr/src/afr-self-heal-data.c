@@ -155,6 +155,96 @@ afr_sh_data_close (call_frame_t *frame, xlator_t *this)
         return 0;
 }
 
+int
+afr_sh_data_dirty_map_clear_cbk (call_frame_t *frame, void *cookie,
+                                 xlator_t *this, int32_t op_ret,
+                                 int32_t op_errno, dict_t *xdata)
+{
+        afr_local_t   *local       = NULL;
+        afr_private_t *priv        = NULL;
+        int            child_index = (long) cookie;
+
+        local = frame->local;
+        priv = this->private;
+
+        if ((op_ret == -1) && (op_errno != ENODATA) && (op_errno != ENOATTR))
+                gf_log (this->name, GF_LOG_DEBUG, "%s: resetting the dirty map "
+                        "failed on %s: %s", local->loc.path,
+                        priv->children[child_index]->name,
+                        strerror (op_errno));
+
+        if (afr_frame_return (frame) == 0)
+                afr_sh_data_finish (frame, this);
+
+        return 0;
+}
+
+/* every child is in sync and the full file lock is still held, so no write
+   can race with forgetting the dirty regions. The map restarts here, with
+   AFR_DIRTY_MAP_STARTED and no AFR_DIRTY_MAP_INVALID: from now on every
+   write that misses a child is recorded in it. */
+int
+afr_sh_data_dirty_map_clear (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t     *local      = NULL;
+        afr_private_t   *priv       = NULL;
+        afr_self_heal_t *sh         = NULL;
+        dict_t          *xattr      = NULL;
+        char            *map        = NULL;
+        int              ret        = -1;
+        int              i          = 0;
+        int              call_count = 0;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        priv  = this->private;
+
+        if (priv->data_dirty_map) {
+                xattr = dict_new ();
+                map = GF_CALLOC (1, AFR_DIRTY_MAP_XATTR_SIZE, gf_afr_mt_char);
+                if (xattr && map) {
+                        map[0] = AFR_DIRTY_MAP_STARTED;
+                        ret = dict_set_bin (xattr, AFR_DIRTY_MAP_KEY, map,
+                                            AFR_DIRTY_MAP_XATTR_SIZE);
+                }
+                if (ret) {
+                        GF_FREE (map);
+                        if (xattr)
+                                dict_unref (xattr);
+                        xattr = NULL;
+                }
+        }
+
+        call_count = priv->child_count;
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (xattr)
+                        STACK_WIND_COOKIE (frame,
+                                           afr_sh_data_dirty_map_clear_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fsetxattr,
+                                           sh->healing_fd, xattr, 0, NULL);
+                else
+                        STACK_WIND_COOKIE (frame,
+                                           afr_sh_data_dirty_map_clear_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fremovexattr,
+                                           sh->healing_fd, AFR_DIRTY_MAP_KEY,
+                                           NULL);
+
+                if (!--call_count)
+                        break;
+        }
+
+        if (xattr)
+                dict_unref (xattr);
+
+        return 0;
+}
+
 int
 afr_sh_data_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                          int32_t op_ret, int32_t op_errno, struct iatt *statpre,
@@ -183,7 +273,10 @@ afr_sh_data_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         call_count = afr_frame_return (frame);
 
         if (call_count == 0) {
-                afr_sh_data_finish (frame, this);
+                if (local->self_heal.dirty_map_clear)
+                        afr_sh_data_dirty_map_clear (frame, this);
+                else
+                        afr_sh_data_finish (frame, this);
         }
 
         return 0;
@@ -623,6 +716,88 @@ out:
         return ret;
 }
 
+/* The dirty map of the source covers everything the sinks missed only if
+ * every such write went through its post-op: the sources must not blame
+ * themselves (an interrupted transaction) and must blame every sink. Empty
+ * sinks need the whole file anyway. The map itself must also have been
+ * started while the file was in sync, which afr_sh_data_dirty_map_cbk
+ * checks. */
+static gf_boolean_t
+afr_sh_data_dirty_map_usable (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        afr_self_heal_t *sh    = &local->self_heal;
+        int             i      = 0;
+
+        if (!priv->data_dirty_map)
+                return _gf_false;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (sh->sources[i]) {
+                        if (sh->pending_matrix[i][i])
+                                return _gf_false;
+                        continue;
+                }
+                if (!local->child_up[i])
+                        continue;
+                if (!sh->pending_matrix[sh->source][i] ||
+                    !sh->buf[i].ia_size)
+                        return _gf_false;
+        }
+
+        return _gf_true;
+}
+
+int
+afr_sh_data_dirty_map_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno, dict_t *dict,
+                           dict_t *xdata)
+{
+        afr_local_t     *local = frame->local;
+        afr_self_heal_t *sh    = &local->self_heal;
+        data_t          *data  = NULL;
+
+        if (op_ret == 0)
+                data = dict_get (dict, AFR_DIRTY_MAP_KEY);
+
+        if (data && (data->len == AFR_DIRTY_MAP_XATTR_SIZE) &&
+            (data->data[0] & AFR_DIRTY_MAP_STARTED) &&
+            !(data->data[0] & AFR_DIRTY_MAP_INVALID)) {
+                sh->dirty_map = memdup (data->data + AFR_DIRTY_MAP_HDR_SIZE,
+                                        AFR_DIRTY_MAP_SIZE);
+                if (sh->dirty_map)
+                        gf_log (this->name, GF_LOG_DEBUG, "%s: healing only "
+                                "the regions in the dirty map",
+                                local->loc.path);
+        } else if (data) {
+                gf_log (this->name, GF_LOG_DEBUG, "%s: dirty map was not "
+                        "started from an in-sync file or was given up on, "
+                        "healing all of it", local->loc.path);
+        }
+
+        afr_sh_data_trim_sinks (frame, this);
+        return 0;
+}
+
+static void
+afr_sh_data_dirty_map_get (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        afr_self_heal_t *sh    = &local->self_heal;
+
+        if (!afr_sh_data_dirty_map_usable (frame, this)) {
+                afr_sh_data_trim_sinks (frame, this);
+                return;
+        }
+
+        STACK_WIND (frame, afr_sh_data_dirty_map_cbk,
+                    priv->children[sh->source],
+                    priv->children[sh->source]->fops->fgetxattr,
+                    sh->healing_fd, AFR_DIRTY_MAP_KEY, NULL);
+}
+
 void
 afr_sh_data_fix (call_frame_t *frame, xlator_t *this)
 {
@@ -663,7 +838,7 @@ afr_sh_data_fix (call_frame_t *frame, xlator_t *this)
                 sh->active_sinks);
 
         sh->actual_sh_started = _gf_true;
-        afr_sh_data_trim_sinks (frame, this);
+        afr_sh_data_dirty_map_get (frame, this);
 }
 
 int
@@ -741,6 +916,7 @@ afr_sh_data_fxattrop_fstat_done (call_frame_t *frame, xlator_t *this)
                         if (old_sources[i] && sh->sources[i])
                                 tstamp_source = i;
                 }
+                sh->dirty_map_clear = (nsources == priv->child_count);
                 afr_sh_data_setattr (frame, this, &sh->buf[tstamp_source]);
         } else {
                 if (nsources == 0) {
@@ -637,7 +637,6 @@ afr_sh_entry_expunge_entry (call_frame_t *frame, xlator_t *this,
 
         active_src = sh->active_source;
         source = sh->source;
-        sh->expunge_done = afr_sh_entry_expunge_entry_done;
 
         name = entry->d_name;
 
@@ -746,6 +745,7 @@ afr_sh_entry_expunge_readdir_cbk (call_frame_t *frame, void *cookie,
 
         sh->offset = last_offset;
         local->call_count = entry_count;
+        sh->expunge_done = afr_sh_entry_expunge_entry_done;
 
         list_for_each_entry (entry, &entries->list, list) {
                 afr_sh_entry_expunge_entry (frame, this, entry);
@@ -1870,7 +1870,6 @@ afr_sh_entry_impunge_entry (call_frame_t *frame, xlator_t *this,
         sh = &local->self_heal;
 
         active_src = sh->active_source;
-        sh->impunge_done = afr_sh_entry_impunge_entry_done;
 
         if ((strcmp (entry->d_name, ".") == 0)
             || (strcmp (entry->d_name, "..") == 0)) {
@@ -1969,6 +1968,7 @@ afr_sh_entry_impunge_readdir_cbk (call_frame_t *frame, void *cookie,
 
         sh->offset = last_offset;
         local->call_count = entry_count;
+        sh->impunge_done = afr_sh_entry_impunge_entry_done;
 
         list_for_each_entry (entry, &entries->list, list) {
                 afr_sh_entry_impunge_entry (frame, this, entry);
@@ -2040,6 +2040,737 @@ afr_sh_entry_impunge_all (call_frame_t *frame, xlator_t *this)
 }
 
 
+/* "merge" entry self-heal: instead of looking up every name of every
+ * child on the other children, the listings of all children are read in
+ * parallel, sorted by name and merged, and the expunge and impunge fops
+ * are only sent for names that are not the same on all of them. Up to
+ * entry-self-heal-merge-limit names are sorted in memory; above that they
+ * are written to a temporary file as sorted runs which are merged from
+ * there.
+ */
+
+#define AFR_SH_ENTRY_MERGE_BATCH 64
+
+typedef struct {
+        char            *name;
+        uuid_t           gfid;
+        ia_type_t        type;
+        int              child;
+} afr_entry_rec_t;
+
+/* on disk: child, type, gfid, name length, name */
+#define AFR_ENTRY_REC_HDR_SIZE   20
+
+typedef struct {
+        off_t            start;
+        off_t            pos;
+        off_t            end;
+        gf_boolean_t     valid;
+        afr_entry_rec_t  rec;
+        char             name[NAME_MAX + 1];
+} afr_entry_run_t;
+
+typedef struct {
+        char             name[NAME_MAX + 1];
+        uuid_t           gfid;
+        ia_type_t        type;
+        int              child;
+} afr_entry_merge_op_t;
+
+struct afr_entry_merge {
+        pthread_mutex_t       mutex;
+        off_t                *offset;       /* readdir offset of each child */
+        gf_boolean_t          failed;
+
+        afr_entry_rec_t      *recs;
+        size_t                count;
+        size_t                size;
+        size_t                limit;
+        size_t                next;         /* merge position in recs */
+
+        FILE                 *spill;
+        afr_entry_run_t      *runs;
+        int                   nruns;
+
+        /* the name being merged and what each child has under it */
+        char                  name[NAME_MAX + 1];
+        unsigned char        *present;
+        uuid_t               *gfid;
+        ia_type_t            *type;
+
+        gf_boolean_t          expunge;      /* which of the two passes */
+        afr_entry_merge_op_t *ops;
+        int                   nops;
+};
+
+
+static void
+afr_entry_recs_free (afr_entry_merge_t *merge)
+{
+        size_t i = 0;
+
+        for (i = 0; i < merge->count; i++)
+                GF_FREE (merge->recs[i].name);
+
+        merge->count = 0;
+}
+
+
+void
+afr_sh_entry_merge_destroy (afr_entry_merge_t *merge)
+{
+        if (!merge)
+                return;
+
+        afr_entry_recs_free (merge);
+        GF_FREE (merge->recs);
+
+        if (merge->spill)
+                fclose (merge->spill);
+
+        GF_FREE (merge->runs);
+        GF_FREE (merge->offset);
+        GF_FREE (merge->present);
+        GF_FREE (merge->gfid);
+        GF_FREE (merge->type);
+        GF_FREE (merge->ops);
+        pthread_mutex_destroy (&merge->mutex);
+        GF_FREE (merge);
+}
+
+
+static afr_entry_merge_t *
+afr_sh_entry_merge_new (xlator_t *this)
+{
+        afr_private_t     *priv  = NULL;
+        afr_entry_merge_t *merge = NULL;
+
+        priv = this->private;
+
+        merge = GF_CALLOC (1, sizeof (*merge), gf_afr_mt_entry_merge_t);
+        if (!merge)
+                return NULL;
+
+        pthread_mutex_init (&merge->mutex, NULL);
+        merge->limit = priv->entry_merge_limit;
+
+        merge->offset = GF_CALLOC (priv->child_count, sizeof (*merge->offset),
+                                   gf_afr_mt_entry_merge_t);
+        merge->present = GF_CALLOC (priv->child_count,
+                                    sizeof (*merge->present),
+                                    gf_afr_mt_entry_merge_t);
+        merge->gfid = GF_CALLOC (priv->child_count, sizeof (*merge->gfid),
+                                 gf_afr_mt_entry_merge_t);
+        merge->type = GF_CALLOC (priv->child_count, sizeof (*merge->type),
+                                 gf_afr_mt_entry_merge_t);
+        merge->ops = GF_CALLOC (AFR_SH_ENTRY_MERGE_BATCH * priv->child_count,
+                                sizeof (*merge->ops),
+                                gf_afr_mt_entry_merge_t);
+
+        if (!merge->offset || !merge->present || !merge->gfid ||
+            !merge->type || !merge->ops) {
+                afr_sh_entry_merge_destroy (merge);
+                return NULL;
+        }
+
+        return merge;
+}
+
+
+static int
+afr_entry_rec_cmp (const void *a, const void *b)
+{
+        const afr_entry_rec_t *r1 = a;
+        const afr_entry_rec_t *r2 = b;
+        int                    ret = 0;
+
+        ret = strcmp (r1->name, r2->name);
+        if (ret)
+                return ret;
+
+        return r1->child - r2->child;
+}
+
+
+/* sorts the records in memory and appends them to the spill file as a
+   new run */
+static int
+afr_entry_merge_spill (afr_entry_merge_t *merge)
+{
+        afr_entry_run_t *runs = NULL;
+        afr_entry_rec_t *rec  = NULL;
+        unsigned char    hdr[AFR_ENTRY_REC_HDR_SIZE];
+        uint16_t         len  = 0;
+        off_t            start = 0;
+        size_t           i    = 0;
+
+        if (!merge->spill) {
+                merge->spill = tmpfile ();
+                if (!merge->spill)
+                        return -1;
+        }
+
+        runs = GF_REALLOC (merge->runs, (merge->nruns + 1) * sizeof (*runs));
+        if (!runs)
+                return -1;
+        merge->runs = runs;
+
+        qsort (merge->recs, merge->count, sizeof (*merge->recs),
+               afr_entry_rec_cmp);
+
+        if (fseeko (merge->spill, 0, SEEK_END))
+                return -1;
+        start = ftello (merge->spill);
+
+        for (i = 0; i < merge->count; i++) {
+                rec = &merge->recs[i];
+                len = strlen (rec->name);
+
+                hdr[0] = rec->child;
+                hdr[1] = rec->type;
+                memcpy (&hdr[2], rec->gfid, 16);
+                memcpy (&hdr[18], &len, sizeof (len));
+
+                if (fwrite (hdr, sizeof (hdr), 1, merge->spill) != 1 ||
+                    fwrite (rec->name, len, 1, merge->spill) != 1)
+                        return -1;
+        }
+
+        memset (&runs[merge->nruns], 0, sizeof (*runs));
+        runs[merge->nruns].start = start;
+        runs[merge->nruns].end = ftello (merge->spill);
+        merge->nruns++;
+
+        afr_entry_recs_free (merge);
+
+        return 0;
+}
+
+
+static int
+afr_entry_merge_add (afr_entry_merge_t *merge, int child, gf_dirent_t *entry)
+{
+        afr_entry_rec_t *recs = NULL;
+        afr_entry_rec_t *rec  = NULL;
+        size_t           size = 0;
+
+        if (strlen (entry->d_name) > NAME_MAX)
+                return -1;
+
+        if (merge->count == merge->limit) {
+                if (afr_entry_merge_spill (merge))
+                        return -1;
+        }
+
+        if (merge->count == merge->size) {
+                size = merge->size ? merge->size * 2 : 1024;
+                if (size > merge->limit)
+                        size = merge->limit;
+
+                recs = GF_REALLOC (merge->recs, size * sizeof (*recs));
+                if (!recs)
+                        return -1;
+                merge->recs = recs;
+                merge->size = size;
+        }
+
+        rec = &merge->recs[merge->count];
+        rec->name = gf_strdup (entry->d_name);
+        if (!rec->name)
+                return -1;
+
+        uuid_copy (rec->gfid, entry->d_stat.ia_gfid);
+        rec->type  = entry->d_stat.ia_type;
+        rec->child = child;
+        merge->count++;
+
+        return 0;
+}
+
+
+static int
+afr_entry_run_next (afr_entry_merge_t *merge, afr_entry_run_t *run)
+{
+        unsigned char hdr[AFR_ENTRY_REC_HDR_SIZE];
+        uint16_t      len = 0;
+
+        run->valid = _gf_false;
+        if (run->pos >= run->end)
+                return 0;
+
+        if (fseeko (merge->spill, run->pos, SEEK_SET) ||
+            fread (hdr, sizeof (hdr), 1, merge->spill) != 1)
+                return -1;
+
+        memcpy (&len, &hdr[18], sizeof (len));
+        if (len > NAME_MAX ||
+            fread (run->name, len, 1, merge->spill) != 1)
+                return -1;
+
+        run->name[len]  = '\0';
+        run->rec.name   = run->name;
+        run->rec.child  = hdr[0];
+        run->rec.type   = hdr[1];
+        memcpy (run->rec.gfid, &hdr[2], 16);
+
+        run->pos += sizeof (hdr) + len;
+        run->valid = _gf_true;
+
+        return 0;
+}
+
+
+static int
+afr_entry_merge_rewind (afr_entry_merge_t *merge)
+{
+        int i = 0;
+
+        merge->next = 0;
+
+        for (i = 0; i < merge->nruns; i++) {
+                merge->runs[i].pos = merge->runs[i].start;
+                if (afr_entry_run_next (merge, &merge->runs[i]))
+                        return -1;
+        }
+
+        return 0;
+}
+
+
+static afr_entry_rec_t *
+afr_entry_merge_peek (afr_entry_merge_t *merge, int *run)
+{
+        afr_entry_rec_t *min = NULL;
+        int              i   = 0;
+
+        if (!merge->spill) {
+                if (merge->next < merge->count)
+                        return &merge->recs[merge->next];
+                return NULL;
+        }
+
+        for (i = 0; i < merge->nruns; i++) {
+                if (!merge->runs[i].valid)
+                        continue;
+                if (min && afr_entry_rec_cmp (&merge->runs[i].rec, min) >= 0)
+                        continue;
+                min = &merge->runs[i].rec;
+                *run = i;
+        }
+
+        return min;
+}
+
+
+/* reads the records of the next name into merge->name, present, gfid
+   and type. Returns 1 if there was one, 0 at the end, -1 on errors. */
+static int
+afr_entry_merge_group (afr_entry_merge_t *merge, int child_count)
+{
+        afr_entry_rec_t *rec = NULL;
+        int              run = -1;
+
+        rec = afr_entry_merge_peek (merge, &run);
+        if (!rec)
+                return 0;
+
+        strcpy (merge->name, rec->name);
+        memset (merge->present, 0, child_count * sizeof (*merge->present));
+
+        while (rec && !strcmp (rec->name, merge->name)) {
+                merge->present[rec->child] = 1;
+                uuid_copy (merge->gfid[rec->child], rec->gfid);
+                merge->type[rec->child] = rec->type;
+
+                if (!merge->spill)
+                        merge->next++;
+                else if (afr_entry_run_next (merge, &merge->runs[run]))
+                        return -1;
+
+                rec = afr_entry_merge_peek (merge, &run);
+        }
+
+        return 1;
+}
+
+
+/* children the directory was opened on, see afr_sh_entry_open */
+static gf_boolean_t
+afr_sh_entry_merge_child (afr_local_t *local, int child)
+{
+        afr_self_heal_t *sh = &local->self_heal;
+
+        if (child == sh->source)
+                return _gf_true;
+
+        return (!sh->sources[child] && local->child_up[child]);
+}
+
+
+static gf_boolean_t
+afr_sh_entry_merge_differs (afr_local_t *local, afr_entry_merge_t *merge,
+                            int child_count)
+{
+        int first = -1;
+        int i     = 0;
+
+        for (i = 0; i < child_count; i++) {
+                if (!afr_sh_entry_merge_child (local, i))
+                        continue;
+                if (!merge->present[i] || uuid_is_null (merge->gfid[i]))
+                        return _gf_true;
+                if (first == -1) {
+                        first = i;
+                        continue;
+                }
+                if (uuid_compare (merge->gfid[i], merge->gfid[first]) ||
+                    merge->type[i] != merge->type[first])
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+static void
+afr_sh_entry_merge_add_op (afr_entry_merge_t *merge, int child)
+{
+        afr_entry_merge_op_t *op = &merge->ops[merge->nops++];
+
+        strcpy (op->name, merge->name);
+        uuid_copy (op->gfid, merge->gfid[child]);
+        op->type  = merge->type[child];
+        op->child = child;
+}
+
+
+int
+afr_sh_entry_merge_next (call_frame_t *frame, xlator_t *this);
+
+
+int
+afr_sh_entry_merge_expunge_done (call_frame_t *frame, xlator_t *this,
+                                 int active_src, int32_t op_ret,
+                                 int32_t op_errno)
+{
+        int call_count = 0;
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0)
+                afr_sh_entry_merge_next (frame, this);
+
+        return 0;
+}
+
+
+int
+afr_sh_entry_merge_impunge_done (call_frame_t *frame, xlator_t *this,
+                                 int32_t op_ret, int32_t op_errno)
+{
+        afr_local_t     *local = NULL;
+        afr_self_heal_t *sh = NULL;
+        int              call_count = 0;
+
+        local = frame->local;
+        sh = &local->self_heal;
+
+        if (op_ret < 0)
+                sh->entries_skipped = _gf_true;
+
+        call_count = afr_frame_return (frame);
+
+        if (call_count == 0)
+                afr_sh_entry_merge_next (frame, this);
+
+        return 0;
+}
+
+
+/* picks the next batch of names which differ and sends the expunges
+   (first pass) or impunges (second pass) for them */
+int
+afr_sh_entry_merge_next (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t        *priv  = NULL;
+        afr_local_t          *local = NULL;
+        afr_self_heal_t      *sh    = NULL;
+        afr_entry_merge_t    *merge = NULL;
+        afr_entry_merge_op_t *op    = NULL;
+        gf_dirent_t          *entry = NULL;
+        gf_boolean_t          expunge = _gf_false;
+        int                   source = -1;
+        int                   nops  = 0;
+        int                   ret   = 0;
+        int                   i     = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        merge = sh->entry_merge;
+        source = sh->source;
+
+        merge->nops = 0;
+
+        while (merge->nops < AFR_SH_ENTRY_MERGE_BATCH) {
+                ret = afr_entry_merge_group (merge, priv->child_count);
+                if (ret <= 0)
+                        break;
+
+                if (!afr_sh_entry_merge_differs (local, merge,
+                                                 priv->child_count))
+                        continue;
+
+                if (merge->expunge) {
+                        /* names the source does not have, or has with
+                           another gfid */
+                        for (i = 0; i < priv->child_count; i++) {
+                                if (i == source || !merge->present[i] ||
+                                    !afr_sh_entry_merge_child (local, i))
+                                        continue;
+                                if (merge->present[source] &&
+                                    !uuid_compare (merge->gfid[i],
+                                                   merge->gfid[source]))
+                                        continue;
+                                afr_sh_entry_merge_add_op (merge, i);
+                        }
+                        continue;
+                }
+
+                /* impunge looks the name up on all children, so it is
+                   enough to start it from one that has it */
+                for (i = 0; i < priv->child_count; i++) {
+                        if (source != -1 && i != source)
+                                continue;
+                        if (!merge->present[i] ||
+                            !afr_sh_entry_merge_child (local, i))
+                                continue;
+                        afr_sh_entry_merge_add_op (merge, i);
+                        break;
+                }
+        }
+
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "%s: reading merged "
+                        "entries failed", local->loc.path);
+                sh->op_failed = 1;
+                afr_sh_entry_finish (frame, this);
+                return 0;
+        }
+
+        if (!merge->nops) {
+                if (!merge->expunge) {
+                        afr_sh_entry_erase_pending (frame, this);
+                        return 0;
+                }
+
+                gf_log (this->name, GF_LOG_TRACE, "%s: expunge done, "
+                        "impunging differing entries", local->loc.path);
+
+                merge->expunge = _gf_false;
+                if (afr_entry_merge_rewind (merge)) {
+                        sh->op_failed = 1;
+                        afr_sh_entry_finish (frame, this);
+                        return 0;
+                }
+
+                return afr_sh_entry_merge_next (frame, this);
+        }
+
+        /* the last completion starts the next batch and reuses ops */
+        nops    = merge->nops;
+        expunge = merge->expunge;
+        local->call_count = nops;
+        sh->expunge_done = afr_sh_entry_merge_expunge_done;
+        sh->impunge_done = afr_sh_entry_merge_impunge_done;
+
+        for (i = 0; i < nops; i++) {
+                op = &merge->ops[i];
+
+                entry = gf_dirent_for_name (op->name);
+                if (!entry) {
+                        if (expunge)
+                                afr_sh_entry_merge_expunge_done (frame, this,
+                                                                 op->child,
+                                                                 -1, ENOMEM);
+                        else
+                                afr_sh_entry_merge_impunge_done (frame, this,
+                                                                 -1, ENOMEM);
+                        continue;
+                }
+
+                uuid_copy (entry->d_stat.ia_gfid, op->gfid);
+                entry->d_stat.ia_type = op->type;
+                sh->active_source = op->child;
+
+                if (expunge)
+                        afr_sh_entry_expunge_entry (frame, this, entry);
+                else
+                        afr_sh_entry_impunge_entry (frame, this, entry);
+
+                GF_FREE (entry);
+        }
+
+        return 0;
+}
+
+
+int
+afr_sh_entry_merge_listed (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t       *local = NULL;
+        afr_self_heal_t   *sh    = NULL;
+        afr_entry_merge_t *merge = NULL;
+        int                ret   = 0;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        merge = sh->entry_merge;
+
+        if (!merge->failed) {
+                if (merge->spill) {
+                        ret = afr_entry_merge_spill (merge);
+                        if (!ret)
+                                ret = afr_entry_merge_rewind (merge);
+                } else {
+                        qsort (merge->recs, merge->count,
+                               sizeof (*merge->recs), afr_entry_rec_cmp);
+                }
+        }
+
+        if (merge->failed || ret) {
+                gf_log (this->name, GF_LOG_INFO, "%s: could not merge "
+                        "directory listings, healing all entries",
+                        local->loc.path);
+                afr_sh_entry_merge_destroy (merge);
+                sh->entry_merge = NULL;
+
+                sh->active_source = -1;
+                afr_sh_entry_expunge_all (frame, this);
+                return 0;
+        }
+
+        gf_log (this->name, GF_LOG_DEBUG, "%s: merging listings (%d runs "
+                "spilled)", local->loc.path, merge->nruns);
+
+        merge->expunge = (sh->source != -1);
+
+        return afr_sh_entry_merge_next (frame, this);
+}
+
+
+int
+afr_sh_entry_merge_readdir_cbk (call_frame_t *frame, void *cookie,
+                                xlator_t *this, int32_t op_ret,
+                                int32_t op_errno, gf_dirent_t *entries,
+                                dict_t *xdata)
+{
+        afr_private_t     *priv  = NULL;
+        afr_local_t       *local = NULL;
+        afr_self_heal_t   *sh    = NULL;
+        afr_entry_merge_t *merge = NULL;
+        gf_dirent_t       *entry = NULL;
+        gf_boolean_t       failed = _gf_false;
+        off_t              last_offset = 0;
+        int                child = (long) cookie;
+        int                call_count = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        merge = sh->entry_merge;
+
+        if (op_ret < 0)
+                gf_log (this->name, GF_LOG_INFO, "readdir of %s on subvolume "
+                        "%s failed (%s)", local->loc.path,
+                        priv->children[child]->name, strerror (op_errno));
+
+        pthread_mutex_lock (&merge->mutex);
+        {
+                if (op_ret < 0)
+                        merge->failed = _gf_true;
+
+                if (op_ret > 0 && !merge->failed) {
+                        list_for_each_entry (entry, &entries->list, list) {
+                                last_offset = entry->d_off;
+                                if (!strcmp (entry->d_name, ".") ||
+                                    !strcmp (entry->d_name, ".."))
+                                        continue;
+                                if (afr_entry_merge_add (merge, child,
+                                                         entry)) {
+                                        merge->failed = _gf_true;
+                                        break;
+                                }
+                        }
+                }
+
+                failed = merge->failed;
+        }
+        pthread_mutex_unlock (&merge->mutex);
+
+        if (op_ret <= 0 || failed) {
+                call_count = afr_frame_return (frame);
+                if (call_count == 0)
+                        afr_sh_entry_merge_listed (frame, this);
+                return 0;
+        }
+
+        merge->offset[child] = last_offset;
+
+        STACK_WIND_COOKIE (frame, afr_sh_entry_merge_readdir_cbk,
+                           (void *) (long) child, priv->children[child],
+                           priv->children[child]->fops->readdirp,
+                           sh->healing_fd, sh->block_size,
+                           merge->offset[child], NULL);
+
+        return 0;
+}
+
+
+int
+afr_sh_entry_merge_start (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t     *priv  = NULL;
+        afr_local_t       *local = NULL;
+        afr_self_heal_t   *sh    = NULL;
+        int                call_count = 0;
+        int                i     = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+
+        sh->entry_merge = afr_sh_entry_merge_new (this);
+        if (!sh->entry_merge) {
+                sh->active_source = -1;
+                afr_sh_entry_expunge_all (frame, this);
+                return 0;
+        }
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (afr_sh_entry_merge_child (local, i))
+                        call_count++;
+        }
+
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!afr_sh_entry_merge_child (local, i))
+                        continue;
+
+                STACK_WIND_COOKIE (frame, afr_sh_entry_merge_readdir_cbk,
+                                   (void *) (long) i, priv->children[i],
+                                   priv->children[i]->fops->readdirp,
+                                   sh->healing_fd, sh->block_size, 0, NULL);
+
+                if (!--call_count)
+                        break;
+        }
+
+        return 0;
+}
+
+
 int
 afr_sh_entry_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                           int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
@@ -2084,6 +2815,12 @@ afr_sh_entry_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         "fd for %s opened, commencing sync",
                         local->loc.path);
 
+                if (priv->entry_self_heal_algorithm &&
+                    !strcmp (priv->entry_self_heal_algorithm, "merge")) {
+                        afr_sh_entry_merge_start (frame, this);
+                        return 0;
+                }
+
                 sh->active_source = -1;
                 afr_sh_entry_expunge_all (frame, this);
         }
@@ -23,6 +23,9 @@
 int
 afr_self_heal_entry (call_frame_t *frame, xlator_t *this);
 
+void
+afr_sh_entry_merge_destroy (afr_entry_merge_t *merge);
+
 int
 afr_self_heal_data (call_frame_t *frame, xlator_t *this);
 
@@ -25,7 +25,8 @@ typedef enum {
 
 typedef enum {
         HEAL = 1,
-        INFO
+        INFO,
+        COUNT
 } shd_crawl_op;
 
 typedef struct shd_dump {
@@ -45,6 +46,41 @@ typedef struct shd_pos_ {
         afr_child_pos_t pos;
 } shd_pos_t;
 
+/* index entries are healed in this order */
+typedef enum {
+        SHD_HEAL_PRIO_DIR = 0,
+        SHD_HEAL_PRIO_SMALL,
+        SHD_HEAL_PRIO_LARGE,
+} shd_heal_prio_t;
+
+#define SHD_HEAL_SMALL_FILE_SIZE (1 * GF_UNIT_MB)
+#define AFR_INDEX_PAGE_RETRIES 3
+
+typedef struct shd_heal_item_ {
+        uuid_t           gfid;
+        shd_heal_prio_t  prio;
+} shd_heal_item_t;
+
+/* the pending entries of the whole index, read before any is healed so
+   that they can be healed in order */
+typedef struct shd_heal_queue_ {
+        shd_heal_item_t  *items;
+        int              count;
+        int              size;
+} shd_heal_queue_t;
+
+/* a batch of index entries healed by shd-max-threads synctasks */
+typedef struct shd_heal_batch_ {
+        afr_crawl_data_t *crawl_data;
+        loc_t            *parentloc;
+        shd_heal_item_t  *items;
+        int              count;
+        int              next;
+        gf_boolean_t     stop;
+        gf_lock_t        lock;
+        syncbarrier_t    barrier;
+} shd_heal_batch_t;
+
 typedef int
 (*afr_crawl_done_cbk_t)  (int ret, call_frame_t *sync_frame, void *crawl_data);
 
@@ -57,6 +93,9 @@ afr_start_crawl (xlator_t *this, int idx, afr_crawl_type_t crawl,
 static int
 _crawl_directory (fd_t *fd, loc_t *loc, afr_crawl_data_t *crawl_data);
 
+gf_boolean_t
+_crawl_proceed (xlator_t *this, int child, int crawl_flags, char **reason);
+
 /* For calling straight through (e.g. already in a synctask). */
 int
 afr_find_child_position (xlator_t *this, int child, afr_child_pos_t *pos);
@@ -302,6 +341,142 @@ out:
         return ret;
 }
 
+/* forget the paths listed for @child from the @from'th on */
+static void
+_del_paths_from_dict (xlator_t *this, dict_t *output, int child,
+                      uint64_t from)
+{
+        uint64_t        count = 0;
+        uint64_t        i = 0;
+        char            key[256] = {0};
+        int             xl_id = 0;
+
+        if (dict_get_int32 (output, this->name, &xl_id))
+                return;
+
+        snprintf (key, sizeof (key), "%d-%d-count", xl_id, child);
+        if (dict_get_uint64 (output, key, &count))
+                return;
+
+        for (i = from; i < count; i++) {
+                snprintf (key, sizeof (key), "%d-%d-%"PRIu64, xl_id, child,
+                          i);
+                dict_del (output, key);
+        }
+
+        snprintf (key, sizeof (key), "%d-%d-count", xl_id, child);
+        if (!from || dict_set_uint64 (output, key, from))
+                dict_del (output, key);
+}
+
+/*
+ * The index xlator keeps a live count of the entries of its xattrop index
+ * and a sorted summary of their gfids. The count answers right away and
+ * the summary is read a page at a time, so paths are resolved only for
+ * what is listed. A page that fails is asked for again from the same
+ * cursor; if it keeps failing, what was listed is dropped and -1 returned
+ * as when the brick does not provide them, so that the full crawl that
+ * follows starts clean.
+ */
+static int
+_get_index_summary_on_subvol (xlator_t *this, int child, dict_t *output,
+                              int xl_id, gf_boolean_t count_only)
+{
+        afr_private_t   *priv = NULL;
+        xlator_t        *readdir_xl = NULL;
+        dict_t          *xattr = NULL;
+        loc_t           rootloc = {0};
+        loc_t           childloc = {0};
+        char            key[256] = {0};
+        char            *path = NULL;
+        unsigned char   *page = NULL;
+        uuid_t          cursor = {0};
+        uint64_t        count = 0;
+        uint64_t        listed = 0;
+        int             retries = 0;
+        int             len = 0;
+        int             i = 0;
+        int             ret = -1;
+
+        priv = this->private;
+        readdir_xl = priv->children[child];
+        afr_build_root_loc (this, &rootloc);
+
+        ret = syncop_getxattr (readdir_xl, &rootloc, &xattr,
+                               GF_XATTROP_INDEX_COUNT);
+        if (ret < 0)
+                goto out;
+        ret = dict_get_uint64 (xattr, GF_XATTROP_INDEX_COUNT, &count);
+        dict_unref (xattr);
+        xattr = NULL;
+        if (ret)
+                goto out;
+
+        if (count_only) {
+                snprintf (key, sizeof (key), "%d-%d-count", xl_id, child);
+                ret = dict_set_uint64 (output, key, count);
+                goto out;
+        }
+
+        snprintf (key, sizeof (key), "%d-%d-count", xl_id, child);
+        if (dict_get_uint64 (output, key, &listed))
+                listed = 0;
+
+        snprintf (key, sizeof (key), "%s", GF_XATTROP_INDEX_PAGE);
+        while (_crawl_proceed (this, child, 0, NULL)) {
+                ret = syncop_getxattr (readdir_xl, &rootloc, &xattr, key);
+                if (ret < 0) {
+                        /* ENODATA is the end of the summary */
+                        if (errno == ENODATA) {
+                                ret = 0;
+                                break;
+                        }
+                        if (++retries < AFR_INDEX_PAGE_RETRIES)
+                                continue;
+                        gf_log (this->name, GF_LOG_WARNING, "reading the index "
+                                "summary of %s failed (%s)", readdir_xl->name,
+                                strerror (errno));
+                        _del_paths_from_dict (this, output, child, listed);
+                        break;
+                }
+                retries = 0;
+                ret = dict_get_ptr_and_len (xattr, GF_XATTROP_INDEX_PAGE,
+                                            (void **) &page, &len);
+                if (ret || (len < sizeof (uuid_t))) {
+                        ret = 0;
+                        break;
+                }
+
+                for (i = 0; i + sizeof (uuid_t) <= len; i += sizeof (uuid_t)) {
+                        uuid_copy (childloc.gfid, page + i);
+                        childloc.inode = inode_new (priv->root_inode->table);
+                        if (!childloc.inode ||
+                            _loc_assign_gfid_path (&childloc)) {
+                                loc_wipe (&childloc);
+                                continue;
+                        }
+                        path = NULL;
+                        /* healed or removed since the summary was built */
+                        if (!_get_path_from_gfid_loc (this, readdir_xl,
+                                                      &childloc, &path, NULL) &&
+                            _add_path_to_dict (this, output, child, path,
+                                               NULL, _gf_true))
+                                GF_FREE (path);
+                        loc_wipe (&childloc);
+                }
+                uuid_copy (cursor, page + len - sizeof (uuid_t));
+                snprintf (key, sizeof (key), "%s.%s", GF_XATTROP_INDEX_PAGE,
+                          uuid_utoa (cursor));
+                dict_unref (xattr);
+                xattr = NULL;
+        }
+out:
+        if (xattr)
+                dict_unref (xattr);
+        loc_wipe (&rootloc);
+        return ret;
+}
+
 void
 _crawl_post_sh_action (xlator_t *this, loc_t *parent, loc_t *child,
                        int32_t op_ret, int32_t op_errno, dict_t *xattr_rsp,
@@ -401,9 +576,10 @@ out:
         return ret;
 }
 
-int
-_self_heal_entry (xlator_t *this, afr_crawl_data_t *crawl_data, gf_dirent_t *entry,
-                  loc_t *child, loc_t *parent, struct iatt *iattr)
+static int
+_self_heal_entry_xdata (xlator_t *this, afr_crawl_data_t *crawl_data,
+                        loc_t *child, loc_t *parent, struct iatt *iattr,
+                        dict_t *xattr_req)
 {
         struct iatt      parentbuf = {0};
         int              ret = 0;
@@ -411,7 +587,7 @@ _self_heal_entry (xlator_t *this, afr_crawl_data_t *crawl_data, gf_dirent_t *ent
 
         gf_log (this->name, GF_LOG_DEBUG, "lookup %s", child->path);
 
-        ret = syncop_lookup (this, child, NULL,
+        ret = syncop_lookup (this, child, xattr_req,
                              iattr, &xattr_rsp, &parentbuf);
         _crawl_post_sh_action (this, parent, child, ret, errno, xattr_rsp,
                                crawl_data);
@@ -423,6 +599,120 @@ _self_heal_entry (xlator_t *this, afr_crawl_data_t *crawl_data, gf_dirent_t *ent
         return ret;
 }
 
+int
+_self_heal_entry (xlator_t *this, afr_crawl_data_t *crawl_data, gf_dirent_t *entry,
+                  loc_t *child, loc_t *parent, struct iatt *iattr)
+{
+        return _self_heal_entry_xdata (this, crawl_data, child, parent, iattr,
+                                       NULL);
+}
+
+static void
+_shd_progress_update (xlator_t *this, int child, uint64_t queued,
+                      uint64_t healed)
+{
+        afr_private_t      *priv = this->private;
+        afr_shd_progress_t *progress = NULL;
+
+        if (!priv->shd.progress)
+                return;
+
+        progress = &priv->shd.progress[child];
+        LOCK (&priv->lock);
+        {
+                progress->queued += queued;
+                progress->healed += healed;
+        }
+        UNLOCK (&priv->lock);
+}
+
+static void
+_shd_progress_crawl (xlator_t *this, int child, gf_boolean_t start)
+{
+        afr_private_t      *priv = this->private;
+        afr_shd_progress_t *progress = NULL;
+
+        if (!priv->shd.progress)
+                return;
+
+        progress = &priv->shd.progress[child];
+        LOCK (&priv->lock);
+        {
+                if (start) {
+                        progress->started = time (NULL);
+                        progress->finished = 0;
+                        progress->queued = 0;
+                        progress->healed = 0;
+                } else {
+                        progress->finished = time (NULL);
+                }
+        }
+        UNLOCK (&priv->lock);
+}
+
+/* "healed N entries in Ts (R/s), ETA for P pending entries: Ts" */
+static int
+_add_heal_progress_to_dict (xlator_t *this, dict_t *output, int xl_id,
+                            int child)
+{
+        afr_private_t      *priv = this->private;
+        afr_shd_progress_t progress = {0};
+        char               key[256] = {0};
+        char               *str = NULL;
+        uint64_t           pending = 0;
+        time_t             elapsed = 0;
+        double             rate = 0;
+        int                ret = -1;
+
+        if (!priv->shd.progress)
+                goto out;
+
+        LOCK (&priv->lock);
+        {
+                progress = priv->shd.progress[child];
+        }
+        UNLOCK (&priv->lock);
+
+        if (!progress.started)
+                goto out;
+
+        elapsed = (progress.finished ? progress.finished : time (NULL)) -
+                  progress.started;
+        if (elapsed > 0)
+                rate = (double) progress.healed / elapsed;
+
+        snprintf (key, sizeof (key), "%d-%d-count", xl_id, child);
+        ret = dict_get_uint64 (output, key, &pending);
+        if (ret)
+                pending = 0;
+
+        if (progress.finished)
+                ret = gf_asprintf (&str, "last crawl healed %"PRIu64" entries "
+                                   "in %lds (%.1f/s)", progress.healed,
+                                   (long) elapsed, rate);
+        else if (rate > 0)
+                ret = gf_asprintf (&str, "healing with %u threads, %"PRIu64
+                                   " of %"PRIu64" entries done in %lds "
+                                   "(%.1f/s), ETA %lds",
+                                   priv->shd.max_threads, progress.healed,
+                                   progress.queued, (long) elapsed, rate,
+                                   (long) (pending / rate));
+        else
+                ret = gf_asprintf (&str, "healing with %u threads, %"PRIu64
+                                   " of %"PRIu64" entries done in %lds",
+                                   priv->shd.max_threads, progress.healed,
+                                   progress.queued, (long) elapsed);
+        if (ret < 0)
+                goto out;
+
+        snprintf (key, sizeof (key), "%d-%d-heal-progress", xl_id, child);
+        ret = dict_set_dynstr (output, key, str);
+        if (ret)
+                GF_FREE (str);
+out:
+        return ret;
+}
+
 static int
 afr_crawl_done  (int ret, call_frame_t *sync_frame, void *data)
 {
@@ -530,10 +820,17 @@ _do_crawl_op_on_local_subvols (xlator_t *this, afr_crawl_type_t crawl,
                                                                  crawl);
                                 } else if (output) {
                                         status = "";
-                                        afr_start_crawl (this, i, INDEX,
+                                        ret = _get_index_summary_on_subvol
+                                                (this, i, output, xl_id,
+                                                 (op == COUNT));
+                                        if (ret)
+                                                afr_start_crawl (this, i, INDEX,
                                                          _add_summary_to_dict,
                                                          output, _gf_false, 0,
                                                          NULL);
+                                        _add_heal_progress_to_dict (this,
+                                                                    output,
+                                                                    xl_id, i);
                                 }
                         }
                         if (output) {
@@ -567,6 +864,12 @@ _get_index_summary_on_local_subvols (xlator_t *this, dict_t *output)
         return _do_crawl_op_on_local_subvols (this, INDEX, INFO, output);
 }
 
+int
+_get_index_count_on_local_subvols (xlator_t *this, dict_t *output)
+{
+        return _do_crawl_op_on_local_subvols (this, INDEX, COUNT, output);
+}
+
 int
 _add_all_subvols_eh_to_dict (xlator_t *this, eh_t *eh, dict_t *dict)
 {
@@ -617,6 +920,10 @@ afr_xl_op (xlator_t *this, dict_t *input, dict_t *output)
                 (void)_get_index_summary_on_local_subvols (this, output);
                 ret = 0;
                 break;
+        case GF_AFR_OP_INDEX_COUNT:
+                (void)_get_index_count_on_local_subvols (this, output);
+                ret = 0;
+                break;
         case GF_AFR_OP_HEALED_FILES:
                 ret = _add_all_subvols_eh_to_dict (this, shd->healed, output);
                 break;
@@ -918,6 +1225,290 @@ out:
         return ret;
 }
 
+static int
+_shd_heal_item_cmp (const void *a, const void *b)
+{
+        const shd_heal_item_t *ia = a;
+        const shd_heal_item_t *ib = b;
+
+        return (int) ia->prio - (int) ib->prio;
+}
+
+static int
+_shd_heal_item_loc (xlator_t *this, shd_heal_item_t *item, loc_t *loc)
+{
+        afr_private_t    *priv = this->private;
+
+        loc->inode = inode_new (priv->root_inode->table);
+        if (!loc->inode)
+                return -1;
+        uuid_copy (loc->gfid, item->gfid);
+        return _loc_assign_gfid_path (loc);
+}
+
+/* Large files come last. When fewer of them are left in the batch than
+   there are healers, each is healed with a proportionally larger window,
+   so that more of its ranges are healed in parallel by the idle healers'
+   share. */
+static dict_t *
+_shd_heal_window_xdata (xlator_t *this, shd_heal_batch_t *batch, int idx)
+{
+        afr_private_t    *priv = this->private;
+        dict_t           *xdata = NULL;
+        int              share = 0;
+
+        if (batch->items[idx].prio != SHD_HEAL_PRIO_LARGE)
+                return NULL;
+
+        share = priv->shd.max_threads / (batch->count - idx);
+        if (share <= 1)
+                return NULL;
+
+        xdata = dict_new ();
+        if (xdata && dict_set_uint32 (xdata, AFR_SH_WINDOW_KEY,
+                                      priv->data_self_heal_window_size *
+                                      share)) {
+                dict_unref (xdata);
+                xdata = NULL;
+        }
+
+        return xdata;
+}
+
+static int
+_shd_heal_worker (void *data)
+{
+        shd_heal_batch_t *batch = data;
+        afr_crawl_data_t *crawl_data = batch->crawl_data;
+        xlator_t         *this = THIS;
+        struct iatt      iattr = {0};
+        loc_t            loc = {0};
+        dict_t           *xdata = NULL;
+        int              idx = -1;
+
+        while (1) {
+                LOCK (&batch->lock);
+                {
+                        if (batch->stop || (batch->next >= batch->count))
+                                idx = -1;
+                        else
+                                idx = batch->next++;
+                }
+                UNLOCK (&batch->lock);
+                if (idx < 0)
+                        break;
+
+                if (!_crawl_proceed (this, crawl_data->child,
+                                     crawl_data->crawl_flags, NULL)) {
+                        LOCK (&batch->lock);
+                        {
+                                batch->stop = _gf_true;
+                        }
+                        UNLOCK (&batch->lock);
+                        break;
+                }
+
+                if (!_shd_heal_item_loc (this, &batch->items[idx], &loc)) {
+                        xdata = _shd_heal_window_xdata (this, batch, idx);
+                        memset (&iattr, 0, sizeof (iattr));
+                        _self_heal_entry_xdata (this, crawl_data, &loc,
+                                                batch->parentloc, &iattr,
+                                                xdata);
+                        if (xdata)
+                                dict_unref (xdata);
+                }
+                loc_wipe (&loc);
+                _shd_progress_update (this, crawl_data->child, 0, 1);
+        }
+
+        return 0;
+}
+
+static int
+_shd_heal_worker_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        shd_heal_batch_t *batch = data;
+
+        STACK_DESTROY (sync_frame->root);
+        syncbarrier_wake (&batch->barrier);
+        return 0;
+}
+
+/* heals the batch with up to shd-max-threads synctasks, waits for them */
+static int
+_shd_heal_batch (xlator_t *this, shd_heal_batch_t *batch)
+{
+        afr_private_t   *priv = this->private;
+        call_frame_t    *frame = NULL;
+        int             workers = 0;
+        int             spawned = 0;
+        int             ret = 0;
+        int             i = 0;
+
+        batch->next = 0;
+        workers = min (priv->shd.max_threads, batch->count);
+        for (i = 0; i < workers; i++) {
+                frame = create_frame (this, this->ctx->pool);
+                if (!frame)
+                        break;
+                afr_set_lk_owner (frame, this, frame->root);
+                afr_set_low_priority (frame);
+
+                ret = synctask_new (this->ctx->env, _shd_heal_worker,
+                                    _shd_heal_worker_done, frame, batch);
+                if (ret) {
+                        STACK_DESTROY (frame->root);
+                        break;
+                }
+                spawned++;
+        }
+
+        /* no healer could be started, heal from the crawler itself */
+        if (!spawned)
+                _shd_heal_worker (batch);
+        else
+                syncbarrier_wait (&batch->barrier, spawned);
+
+        return batch->stop ? -1 : 0;
+}
+
+/* decides what to heal first from the stat the index readdirp returned,
+   and looks the entry up on the local brick only when that is missing */
+static int
+_shd_heal_item_init (xlator_t *this, afr_crawl_data_t *crawl_data,
+                     loc_t *parentloc, gf_dirent_t *entry,
+                     shd_heal_item_t *item)
+{
+        struct iatt      iattr = {0};
+        struct iatt      parent = {0};
+        loc_t            loc = {0};
+        char             gfid_str[64] = {0};
+        int              ret = -1;
+
+        ret = afr_crawl_build_child_loc (this, &loc, parentloc, entry,
+                                         crawl_data);
+        if (ret)
+                goto out;
+        uuid_copy (item->gfid, loc.gfid);
+
+        if (entry->d_stat.ia_type != IA_INVAL) {
+                iattr = entry->d_stat;
+                goto prio;
+        }
+
+        ret = syncop_lookup (crawl_data->readdir_xl, &loc, NULL, &iattr,
+                             NULL, &parent);
+        if (ret < 0) {
+                if (errno == ENOENT) {
+                        _remove_stale_index (this, crawl_data->readdir_xl,
+                                             parentloc,
+                                             uuid_utoa_r (loc.gfid,
+                                                          gfid_str));
+                        goto out;
+                }
+                /* let the heal find out what is wrong with it */
+                item->prio = SHD_HEAL_PRIO_LARGE;
+                ret = 0;
+                goto out;
+        }
+prio:
+        if (IA_ISDIR (iattr.ia_type))
+                item->prio = SHD_HEAL_PRIO_DIR;
+        else if (iattr.ia_size <= SHD_HEAL_SMALL_FILE_SIZE)
+                item->prio = SHD_HEAL_PRIO_SMALL;
+        else
+                item->prio = SHD_HEAL_PRIO_LARGE;
+        ret = 0;
+out:
+        loc_wipe (&loc);
+        return ret;
+}
+
+/* adds a page of the index to the queue */
+static int
+_shd_heal_queue_add (xlator_t *this, loc_t *parentloc, gf_dirent_t *entries,
+                     off_t *offset, afr_crawl_data_t *crawl_data,
+                     shd_heal_queue_t *queue)
+{
+        afr_private_t    *priv = this->private;
+        gf_dirent_t      *entry = NULL;
+        shd_heal_item_t  *items = NULL;
+        int              size = 0;
+
+        list_for_each_entry (entry, &entries->list, list) {
+                if (!_crawl_proceed (this, crawl_data->child,
+                                     crawl_data->crawl_flags, NULL))
+                        return -1;
+                if (IS_ENTRY_CWD (entry->d_name) ||
+                    IS_ENTRY_PARENT (entry->d_name)) {
+                        *offset = entry->d_off;
+                        continue;
+                }
+
+                if (queue->count == queue->size) {
+                        size = queue->size ? (queue->size * 2) :
+                                             priv->shd.wait_qlength;
+                        if (queue->items)
+                                items = GF_REALLOC (queue->items,
+                                                    size * sizeof (*items));
+                        else
+                                items = GF_CALLOC (size, sizeof (*items),
+                                                   gf_afr_mt_shd_heal_item_t);
+                        if (!items) {
+                                gf_log (this->name, GF_LOG_WARNING,
+                                        "out of memory queueing %d index "
+                                        "entries, healing those first",
+                                        queue->count);
+                                return -1;
+                        }
+                        queue->items = items;
+                        queue->size = size;
+                }
+
+                *offset = entry->d_off;
+                if (_shd_heal_item_init (this, crawl_data, parentloc, entry,
+                                         &queue->items[queue->count]))
+                        continue;
+                queue->count++;
+        }
+
+        return 0;
+}
+
+/* heals the whole queue in order, shd-wait-qlength entries at a time */
+static int
+_shd_heal_queue_dispatch (xlator_t *this, loc_t *parentloc,
+                          shd_heal_queue_t *queue,
+                          afr_crawl_data_t *crawl_data)
+{
+        afr_private_t    *priv = this->private;
+        shd_heal_batch_t batch = {0};
+        int              done = 0;
+        int              ret = 0;
+
+        qsort (queue->items, queue->count, sizeof (*queue->items),
+               _shd_heal_item_cmp);
+        _shd_progress_update (this, crawl_data->child, queue->count, 0);
+
+        batch.crawl_data = crawl_data;
+        batch.parentloc = parentloc;
+        LOCK_INIT (&batch.lock);
+        syncbarrier_init (&batch.barrier);
+
+        for (done = 0; done < queue->count; done += batch.count) {
+                batch.items = queue->items + done;
+                batch.count = min ((int) priv->shd.wait_qlength,
+                                   queue->count - done);
+                ret = _shd_heal_batch (this, &batch);
+                if (ret)
+                        break;
+        }
+
+        syncbarrier_destroy (&batch.barrier);
+        LOCK_DESTROY (&batch.lock);
+        return ret;
+}
+
 static int
 _process_entries (xlator_t *this, loc_t *parentloc, gf_dirent_t *entries,
                   off_t *offset, afr_crawl_data_t *crawl_data)
@@ -982,14 +1573,21 @@ static int
 _crawl_directory (fd_t *fd, loc_t *loc, afr_crawl_data_t *crawl_data)
 {
         xlator_t        *this = NULL;
+        afr_private_t   *priv = NULL;
         off_t           offset   = 0;
         gf_dirent_t     entries;
         int             ret = 0;
         gf_boolean_t    free_entries = _gf_false;
+        gf_boolean_t    parallel = _gf_false;
+        shd_heal_queue_t queue = {0};
         xlator_t        *readdir_xl = crawl_data->readdir_xl;
 
         INIT_LIST_HEAD (&entries.list);
         this = THIS;
+        priv = this->private;
+        parallel = (crawl_data->crawl == INDEX) &&
+                   (crawl_data->process_entry == _self_heal_entry) &&
+                   (priv->shd.max_threads > 1);
 
         GF_ASSERT (loc->inode);
 
@@ -1000,12 +1598,9 @@ _crawl_directory (fd_t *fd, loc_t *loc, afr_crawl_data_t *crawl_data)
                         uuid_utoa (loc->gfid));
 
         while (1) {
-                if (crawl_data->crawl == FULL)
-                        ret = syncop_readdirp (readdir_xl, fd, 131072, offset,
-                                               NULL, &entries);
-                else
-                        ret = syncop_readdir (readdir_xl, fd, 131072, offset,
-                                              &entries);
+                /* the index fills in the stat of the indexed files */
+                ret = syncop_readdirp (readdir_xl, fd, 131072, offset,
+                                       NULL, &entries);
                 if (ret <= 0)
                         break;
                 ret = 0;
@@ -1017,17 +1612,30 @@ _crawl_directory (fd_t *fd, loc_t *loc, afr_crawl_data_t *crawl_data)
                         goto out;
                 }
                 if (list_empty (&entries.list))
-                        goto out;
+                        break;
 
-                ret = _process_entries (this, loc, &entries, &offset,
-                                        crawl_data);
+                if (parallel)
+                        ret = _shd_heal_queue_add (this, loc, &entries,
+                                                   &offset, crawl_data,
+                                                   &queue);
+                else
+                        ret = _process_entries (this, loc, &entries, &offset,
+                                                crawl_data);
                 gf_dirent_free (&entries);
                 free_entries = _gf_false;
+                if (parallel && ret)
+                        break;
         }
+
+        if (queue.count &&
+            _crawl_proceed (this, crawl_data->child, crawl_data->crawl_flags,
+                            NULL))
+                _shd_heal_queue_dispatch (this, loc, &queue, crawl_data);
         ret = 0;
 out:
         if (free_entries)
                 gf_dirent_free (&entries);
+        GF_FREE (queue.items);
         return ret;
 }
 
@@ -1109,6 +1717,7 @@ afr_dir_crawl (void *data)
         fd_t                *fd = NULL;
         loc_t               dirloc = {0};
         afr_crawl_data_t    *crawl_data = data;
+        gf_boolean_t        heal = _gf_false;
 
         this = THIS;
 
@@ -1116,6 +1725,9 @@ afr_dir_crawl (void *data)
                              NULL))
                 goto out;
 
+        heal = ((crawl_data->crawl == INDEX) &&
+                (crawl_data->process_entry == _self_heal_entry));
+
         readdir_xl = afr_crawl_readdir_xl_get (this, crawl_data);
         if (!readdir_xl)
                 goto out;
@@ -1129,7 +1741,13 @@ afr_dir_crawl (void *data)
         if (ret)
                 goto out;
 
+        if (heal)
+                _shd_progress_crawl (this, crawl_data->child, _gf_true);
+
         ret = _crawl_directory (fd, &dirloc, crawl_data);
+
+        if (heal)
+                _shd_progress_crawl (this, crawl_data->child, _gf_false);
         if (ret)
                 gf_log (this->name, GF_LOG_ERROR, "Crawl failed on %s",
                         readdir_xl->name);
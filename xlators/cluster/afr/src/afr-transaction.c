@@ -574,6 +574,430 @@ afr_set_postop_dict (afr_local_t *local, xlator_t *this, dict_t *xattr,
                         "failed to set pending entry");
 }
 
+/* Dirty map: when a data transaction missed a child, the regions it wrote
+ * are ORed into AFR_DIRTY_MAP_KEY on the children it succeeded on, before
+ * the post-op leaves the pending count of the missed child behind. Data
+ * self-heal then only looks at those regions (see afr-self-heal-data.c).
+ * The OR never sets the header, so heal trusts the map only if it was
+ * started from an in-sync file: by a previous heal, or by the first pre-op
+ * that finds nothing pending on any child. A source that fails to record
+ * the map marks it invalid instead, and so do writes that miss a child
+ * while the option is off, so heal never trusts an incomplete one. Both
+ * the start and the invalidation are ORed in, so neither can undo the
+ * other or a concurrent record. */
+
+int
+afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this);
+
+static void
+afr_dirty_map_fill (afr_local_t *local, unsigned char *map)
+{
+        off_t   region = 0;
+        off_t   last   = 0;
+        size_t  len    = 0;
+
+        if (local->op != GF_FOP_WRITE) {
+                /* truncate and friends, let heal look at the whole file */
+                memset (map, 0xff, AFR_DIRTY_MAP_SIZE);
+                return;
+        }
+
+        len = iov_length (local->cont.writev.vector, local->cont.writev.count);
+        if (!len)
+                return;
+
+        region = local->cont.writev.offset >> AFR_DIRTY_MAP_REGION_SHIFT;
+        last = (local->cont.writev.offset + len - 1) >>
+               AFR_DIRTY_MAP_REGION_SHIFT;
+        if (last - region >= AFR_DIRTY_MAP_BITS) {
+                memset (map, 0xff, AFR_DIRTY_MAP_SIZE);
+                return;
+        }
+
+        for (; region <= last; region++)
+                map[(region % AFR_DIRTY_MAP_BITS) / 8] |= 1 << (region % 8);
+}
+
+static gf_boolean_t
+afr_dirty_map_needed (call_frame_t *frame, xlator_t *this, int *sources)
+{
+        afr_private_t   *priv   = this->private;
+        afr_local_t     *local  = frame->local;
+        afr_fd_ctx_t    *fdctx  = NULL;
+        gf_boolean_t    missed  = _gf_false;
+        int             index   = 0;
+        int             i       = 0;
+
+        *sources = 0;
+        if ((local->transaction.type != AFR_DATA_TRANSACTION) ||
+            local->transaction.dirty_map_done)
+                return _gf_false;
+
+        index = afr_index_for_transaction_type (local->transaction.type);
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->transaction.pre_op[i] && local->pending[i][index])
+                        (*sources)++;
+                else
+                        missed = _gf_true;
+        }
+
+        if (!missed || !*sources)
+                return _gf_false;
+
+        if (priv->data_dirty_map || !local->fd)
+                return _gf_true;
+
+        /* with the option off a map left from earlier only needs to go
+           once per fd, until the option is turned on and off again */
+        fdctx = afr_fd_ctx_get (local->fd, this);
+        if (!fdctx)
+                return _gf_true;
+
+        LOCK (&local->fd->lock);
+        {
+                if (fdctx->dirty_map_dropped == priv->dirty_map_off_gen)
+                        missed = _gf_false;
+                fdctx->dirty_map_dropped = priv->dirty_map_off_gen;
+        }
+        UNLOCK (&local->fd->lock);
+
+        return missed;
+}
+
+static void
+afr_dirty_map_mark_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t     *local = frame->local;
+
+        if (afr_frame_return (frame))
+                return;
+
+        local->transaction.dirty_map_done = _gf_true;
+        afr_changelog_post_op_now (frame, this);
+}
+
+static int
+afr_dirty_map_drop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        int             child  = (long) cookie;
+
+        if ((op_ret < 0) && (op_errno != ENODATA) && (op_errno != ENOATTR))
+                gf_log (this->name, GF_LOG_ERROR, "%s: failed to drop the "
+                        "dirty map on %s (%s)", local->loc.path,
+                        priv->children[child]->name, strerror (op_errno));
+
+        afr_dirty_map_mark_done (frame, this);
+        return 0;
+}
+
+static int
+afr_dirty_map_invalidate_cbk (call_frame_t *frame, void *cookie,
+                              xlator_t *this, int32_t op_ret, int32_t op_errno,
+                              dict_t *xattr, dict_t *xdata)
+{
+        return afr_dirty_map_drop_cbk (frame, cookie, this, op_ret, op_errno,
+                                       xdata);
+}
+
+/* a map with only the header set, ORed into the one on the children */
+static dict_t *
+afr_dirty_map_header (char flags)
+{
+        dict_t          *xattr = NULL;
+        char            *map   = NULL;
+
+        xattr = dict_new ();
+        map = GF_CALLOC (1, AFR_DIRTY_MAP_XATTR_SIZE, gf_afr_mt_char);
+        if (!xattr || !map)
+                goto err;
+
+        map[0] = flags;
+        if (dict_set_bin (xattr, AFR_DIRTY_MAP_KEY, map,
+                          AFR_DIRTY_MAP_XATTR_SIZE))
+                goto err;
+
+        return xattr;
+err:
+        GF_FREE (map);
+        if (xattr)
+                dict_unref (xattr);
+        return NULL;
+}
+
+static void
+afr_dirty_map_drop (call_frame_t *frame, xlator_t *this, int child)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        inode_t         *inode = NULL;
+        dict_t          *xattr = NULL;
+
+        inode = local->fd ? local->fd->inode : local->loc.inode;
+        if (inode)
+                afr_dirty_map_set_started (this, inode, _gf_false);
+
+        xattr = afr_dirty_map_header (AFR_DIRTY_MAP_INVALID);
+        if (xattr && local->fd)
+                STACK_WIND_COOKIE (frame, afr_dirty_map_invalidate_cbk,
+                                   (void *) (long) child, priv->children[child],
+                                   priv->children[child]->fops->fxattrop,
+                                   local->fd, GF_XATTROP_OR_ARRAY, xattr,
+                                   NULL);
+        else if (xattr)
+                STACK_WIND_COOKIE (frame, afr_dirty_map_invalidate_cbk,
+                                   (void *) (long) child, priv->children[child],
+                                   priv->children[child]->fops->xattrop,
+                                   &local->loc, GF_XATTROP_OR_ARRAY, xattr,
+                                   NULL);
+        else if (local->fd)
+                STACK_WIND_COOKIE (frame, afr_dirty_map_drop_cbk,
+                                   (void *) (long) child, priv->children[child],
+                                   priv->children[child]->fops->fremovexattr,
+                                   local->fd, AFR_DIRTY_MAP_KEY, NULL);
+        else
+                STACK_WIND_COOKIE (frame, afr_dirty_map_drop_cbk,
+                                   (void *) (long) child, priv->children[child],
+                                   priv->children[child]->fops->removexattr,
+                                   &local->loc, AFR_DIRTY_MAP_KEY, NULL);
+
+        if (xattr)
+                dict_unref (xattr);
+}
+
+static int
+afr_dirty_map_mark_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xattr,
+                        dict_t *xdata)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        int             child  = (long) cookie;
+
+        if ((op_ret < 0) && !child_went_down (op_ret, op_errno)) {
+                gf_log (this->name, GF_LOG_ERROR, "%s: failed to record "
+                        "dirty regions on %s (%s)", local->loc.path,
+                        priv->children[child]->name, strerror (op_errno));
+                afr_dirty_map_drop (frame, this, child);
+                return 0;
+        }
+
+        afr_dirty_map_mark_done (frame, this);
+        return 0;
+}
+
+static void
+afr_dirty_map_mark (call_frame_t *frame, xlator_t *this, int call_count)
+{
+        afr_private_t   *priv   = this->private;
+        afr_local_t     *local  = frame->local;
+        unsigned char   *map    = NULL;
+        dict_t          *xattr  = NULL;
+        int             index   = 0;
+        int             ret     = -1;
+        int             i       = 0;
+
+        index = afr_index_for_transaction_type (local->transaction.type);
+        local->call_count = call_count;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->transaction.pre_op[i] || !local->pending[i][index])
+                        continue;
+
+                if (!priv->data_dirty_map) {
+                        afr_dirty_map_drop (frame, this, i);
+                        if (!--call_count)
+                                break;
+                        continue;
+                }
+
+                ret = -1;
+                xattr = dict_new ();
+                map = GF_CALLOC (1, AFR_DIRTY_MAP_XATTR_SIZE, gf_afr_mt_char);
+                if (xattr && map) {
+                        afr_dirty_map_fill (local,
+                                            map + AFR_DIRTY_MAP_HDR_SIZE);
+                        ret = dict_set_bin (xattr, AFR_DIRTY_MAP_KEY, map,
+                                            AFR_DIRTY_MAP_XATTR_SIZE);
+                }
+                if (ret) {
+                        GF_FREE (map);
+                        afr_dirty_map_drop (frame, this, i);
+                } else if (local->fd) {
+                        STACK_WIND_COOKIE (frame, afr_dirty_map_mark_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fxattrop,
+                                           local->fd, GF_XATTROP_OR_ARRAY,
+                                           xattr, NULL);
+                } else {
+                        STACK_WIND_COOKIE (frame, afr_dirty_map_mark_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->xattrop,
+                                           &local->loc, GF_XATTROP_OR_ARRAY,
+                                           xattr, NULL);
+                }
+                if (xattr)
+                        dict_unref (xattr);
+
+                if (!--call_count)
+                        break;
+        }
+}
+
+/* whether the pre-op about to go out may start the dirty map */
+static gf_boolean_t
+afr_dirty_map_start_wanted (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        inode_t         *inode = NULL;
+        int             i      = 0;
+
+        if (!priv->data_dirty_map ||
+            (local->transaction.type != AFR_DATA_TRANSACTION))
+                return _gf_false;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->child_up[i])
+                        return _gf_false;
+        }
+
+        inode = local->fd ? local->fd->inode : local->loc.inode;
+        if (!inode)
+                return _gf_false;
+
+        return !afr_dirty_map_started (this, inode);
+}
+
+/* The pre-op reply of 'child' holds the changelogs after the pre-op added
+   to them: nothing was pending before it if they hold only that. */
+static gf_boolean_t
+afr_dirty_map_pre_op_clean (afr_private_t *priv, afr_local_t *local,
+                            dict_t *xattr)
+{
+        int32_t         *pending = NULL;
+        int             len      = 0;
+        int             index    = 0;
+        int             i        = 0;
+
+        if (!xattr)
+                return _gf_false;
+
+        index = afr_index_for_transaction_type (local->transaction.type);
+        for (i = 0; i < priv->child_count; i++) {
+                if (dict_get_ptr_and_len (xattr, priv->pending_key[i],
+                                          (void **) &pending, &len) ||
+                    (len != AFR_NUM_CHANGE_LOGS * sizeof (int32_t)))
+                        return _gf_false;
+                if (pending[index] != local->pending[i][index])
+                        return _gf_false;
+        }
+
+        return _gf_true;
+}
+
+static int
+afr_dirty_map_start_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, dict_t *xattr,
+                         dict_t *xdata)
+{
+        afr_private_t   *priv  = this->private;
+        afr_local_t     *local = frame->local;
+        inode_t         *inode = NULL;
+        int             child  = (long) cookie;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_DEBUG, "%s: failed to start the "
+                        "dirty map on %s (%s)", local->loc.path,
+                        priv->children[child]->name, strerror (op_errno));
+                local->transaction.dirty_map_start = _gf_false;
+        }
+
+        if (afr_frame_return (frame))
+                return 0;
+
+        /* children where it failed start at the next in-sync pre-op */
+        inode = local->fd ? local->fd->inode : local->loc.inode;
+        if (local->transaction.dirty_map_start)
+                afr_dirty_map_set_started (this, inode, _gf_true);
+
+        afr_transaction_perform_fop (frame, this);
+        return 0;
+}
+
+/* Every child took the pre-op and none had anything pending: the file is in
+ * sync and the map may start recording. Regions left in it from before are
+ * kept, they only make the next heal look at more. */
+static void
+afr_dirty_map_start (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv   = this->private;
+        afr_local_t     *local  = frame->local;
+        dict_t          *xattr  = NULL;
+        int             i       = 0;
+
+        if (afr_pre_op_done_children_count (local->transaction.pre_op,
+                                            priv->child_count) <
+            priv->child_count) {
+                afr_transaction_perform_fop (frame, this);
+                return;
+        }
+
+        xattr = afr_dirty_map_header (AFR_DIRTY_MAP_STARTED);
+        if (!xattr) {
+                afr_transaction_perform_fop (frame, this);
+                return;
+        }
+
+        local->call_count = priv->child_count;
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->fd)
+                        STACK_WIND_COOKIE (frame, afr_dirty_map_start_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fxattrop,
+                                           local->fd, GF_XATTROP_OR_ARRAY,
+                                           xattr, NULL);
+                else
+                        STACK_WIND_COOKIE (frame, afr_dirty_map_start_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->xattrop,
+                                           &local->loc, GF_XATTROP_OR_ARRAY,
+                                           xattr, NULL);
+        }
+
+        dict_unref (xattr);
+}
+
+/* xdata for the changelog xattrops; with changelog-batch it lets
+   protocol/client merge them with other xattrops to the same brick */
+static dict_t *
+afr_changelog_xdata (xlator_t *this)
+{
+        afr_private_t *priv  = NULL;
+        dict_t        *xdata = NULL;
+
+        priv = this->private;
+        if (!priv->changelog_batch)
+                return NULL;
+
+        xdata = dict_new ();
+        if (!xdata)
+                return NULL;
+
+        if (dict_set_int8 (xdata, GF_XATTROP_BATCH_KEY, 1)) {
+                dict_unref (xdata);
+                return NULL;
+        }
+
+        return xdata;
+}
+
 int
 afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
 {
@@ -588,10 +1012,17 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
         int            piggyback = 0;
         int            index = 0;
         int            nothing_failed = 1;
+        int            sources = 0;
+        dict_t        *xdata = NULL;
 
         local    = frame->local;
         int_lock = &local->internal_lock;
 
+        if (afr_dirty_map_needed (frame, this, &sources)) {
+                afr_dirty_map_mark (frame, this, sources);
+                return 0;
+        }
+
         __mark_non_participant_children (local->pending, priv->child_count,
                                          local->transaction.pre_op,
                                          local->transaction.type);
@@ -607,6 +1038,8 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                 xattr[i] = dict_new ();
         }
 
+        xdata = afr_changelog_xdata (this);
+
         call_count = afr_changelog_post_op_call_count (local->transaction.type,
                                                        local->transaction.pre_op,
                                                        priv->child_count);
@@ -652,7 +1085,7 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                                             priv->children[i]->fops->xattrop,
                                             &local->loc,
                                             GF_XATTROP_ADD_ARRAY, xattr[i],
-                                            NULL);
+                                            xdata);
                                 break;
                         }
 
@@ -683,7 +1116,7 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->fxattrop,
                                                    local->fd,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                         }
                 }
                 break;
@@ -702,14 +1135,14 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                                             priv->children[i]->fops->fxattrop,
                                             local->fd,
                                             GF_XATTROP_ADD_ARRAY, xattr[i],
-                                            NULL);
+                                            xdata);
                         else
                                 STACK_WIND (frame, afr_changelog_post_op_cbk,
                                             priv->children[i],
                                             priv->children[i]->fops->xattrop,
                                             &local->loc,
                                             GF_XATTROP_ADD_ARRAY, xattr[i],
-                                            NULL);
+                                            xdata);
                 }
                 break;
 
@@ -726,7 +1159,7 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->xattrop,
                                                    &local->transaction.new_parent_loc,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                         }
                         call_count--;
                 }
@@ -759,14 +1192,14 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                                             priv->children[i]->fops->fxattrop,
                                             local->fd,
                                             GF_XATTROP_ADD_ARRAY, xattr[i],
-                                            NULL);
+                                            xdata);
                         else
                                 STACK_WIND (frame, afr_changelog_post_op_cbk,
                                             priv->children[i],
                                             priv->children[i]->fops->xattrop,
                                             &local->transaction.parent_loc,
                                             GF_XATTROP_ADD_ARRAY, xattr[i],
-                                            NULL);
+                                            xdata);
                 }
                 break;
                 }
@@ -780,6 +1213,9 @@ out:
                 dict_unref (xattr[i]);
         }
 
+        if (xdata)
+                dict_unref (xdata);
+
         return 0;
 }
 
@@ -793,11 +1229,27 @@ afr_changelog_pre_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         afr_private_t * priv  = this->private;
         int call_count  = -1;
         int child_index = (long) cookie;
+        gf_boolean_t    clean = _gf_false;
 
         local = frame->local;
 
+        if (priv->data_dirty_map && (op_ret == 0) &&
+            (local->transaction.type == AFR_DATA_TRANSACTION)) {
+                clean = afr_dirty_map_pre_op_clean (priv, local, xattr);
+                /* whatever is pending gets healed first, and that heal may
+                   drop the map: start it again once in sync */
+                if (!clean)
+                        afr_dirty_map_set_started (this, local->fd ?
+                                                   local->fd->inode :
+                                                   local->loc.inode,
+                                                   _gf_false);
+        }
+
         LOCK (&frame->lock);
         {
+                if (!clean)
+                        local->transaction.dirty_map_start = _gf_false;
+
                 switch (op_ret) {
                 case 0:
                         __mark_pre_op_done_on_fd (frame, this, child_index);
@@ -831,6 +1283,8 @@ afr_changelog_pre_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 if ((local->op_ret == -1) &&
                     (local->op_errno == ENOTSUP)) {
                         local->transaction.resume (frame, this);
+                } else if (local->transaction.dirty_map_start) {
+                        afr_dirty_map_start (frame, this);
                 } else {
                         afr_transaction_perform_fop (frame, this);
                 }
@@ -852,6 +1306,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
         int          piggyback = 0;
         afr_internal_lock_t *int_lock = NULL;
         unsigned char       *locked_nodes = NULL;
+        dict_t              *xdata = NULL;
 
         local = frame->local;
         int_lock = &local->internal_lock;
@@ -863,6 +1318,8 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                 xattr[i] = dict_new ();
         }
 
+        xdata = afr_changelog_xdata (this);
+
         call_count = afr_changelog_pre_op_call_count (local->transaction.type,
                                                       int_lock,
                                                       priv->child_count);
@@ -878,6 +1335,9 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
         __mark_all_pending (local->pending, priv->child_count,
                             local->transaction.type);
 
+        local->transaction.dirty_map_start =
+                afr_dirty_map_start_wanted (frame, this);
+
         if (local->fd)
                 fdctx = afr_fd_ctx_get (local->fd, this);
 
@@ -904,7 +1364,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->xattrop,
                                                    &(local->loc),
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                                 break;
                         }
 
@@ -935,7 +1395,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->fxattrop,
                                                    local->fd,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                 }
                 break;
                 case AFR_METADATA_TRANSACTION:
@@ -955,7 +1415,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->fxattrop,
                                                    local->fd,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                         else
                                 STACK_WIND_COOKIE (frame,
                                                    afr_changelog_pre_op_cbk,
@@ -964,7 +1424,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->xattrop,
                                                    &(local->loc),
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                 }
                 break;
 
@@ -982,7 +1442,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->xattrop,
                                                    &local->transaction.new_parent_loc,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                         }
 
                         call_count--;
@@ -1023,7 +1483,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->fxattrop,
                                                    local->fd,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                         else
                                 STACK_WIND_COOKIE (frame,
                                                    afr_changelog_pre_op_cbk,
@@ -1032,7 +1492,7 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
                                                    priv->children[i]->fops->xattrop,
                                                    &local->transaction.parent_loc,
                                                    GF_XATTROP_ADD_ARRAY, xattr[i],
-                                                   NULL);
+                                                   xdata);
                 }
                 break;
                 }
@@ -1045,6 +1505,9 @@ out:
                 dict_unref (xattr[i]);
         }
 
+        if (xdata)
+                dict_unref (xdata);
+
         return 0;
 }
 
@@ -1271,6 +1734,27 @@ afr_internal_lock_finish (call_frame_t *frame, xlator_t *this)
 }
 
 
+static void
+afr_lease_fd_add (xlator_t *this, fd_t *fd)
+{
+	afr_private_t  *priv   = NULL;
+	afr_fd_ctx_t   *fd_ctx = NULL;
+
+	priv = this->private;
+
+	fd_ctx = afr_fd_ctx_get (fd, this);
+	if (!fd_ctx)
+		return;
+
+	LOCK (&priv->lock);
+	{
+		if (list_empty (&fd_ctx->lease_list))
+			list_add_tail (&fd_ctx->lease_list, &priv->lease_fds);
+	}
+	UNLOCK (&priv->lock);
+}
+
+
 void
 afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this)
 {
@@ -1288,7 +1772,7 @@ afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this)
 	if (!priv)
 		return;
 
-	if (!priv->post_op_delay_secs)
+	if (!priv->post_op_delay_secs && !priv->eager_lock_recall)
 		return;
 
         local = frame->local;
@@ -1301,8 +1785,15 @@ afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this)
 	if (!local->fd)
 		return;
 
-	if (local->op == GF_FOP_WRITE)
-		local->delayed_post_op = _gf_true;
+	if (local->op != GF_FOP_WRITE)
+		return;
+
+	local->delayed_post_op = _gf_true;
+
+	/* keep the fd findable for recalls while its writes are in flight
+	   too, not only while a post-op is delayed */
+	if (priv->eager_lock_recall)
+		afr_lease_fd_add (this, local->fd);
 }
 
 
@@ -1344,8 +1835,10 @@ afr_delayed_changelog_post_op (xlator_t *this, call_frame_t *frame, fd_t *fd)
 {
 	afr_fd_ctx_t      *fd_ctx = NULL;
 	call_frame_t      *prev_frame = NULL;
+	call_frame_t      *now_frame = NULL;
 	struct timeval     delta = {0, };
 	afr_private_t     *priv = NULL;
+	gf_boolean_t       recalled = _gf_false;
 
 	priv = this->private;
 
@@ -1365,10 +1858,27 @@ afr_delayed_changelog_post_op (xlator_t *this, call_frame_t *frame, fd_t *fd)
 		fd_ctx->delay_timer = NULL;
 		if (!frame)
 			goto unlock;
+
+		LOCK (&fd->lock);
+		{
+			recalled = fd_ctx->lease_recalled;
+		}
+		UNLOCK (&fd->lock);
+
+		/* the recall came while this write was in flight and the
+		   bricks do not send it again */
+		if (recalled) {
+			now_frame = frame;
+			goto unlock;
+		}
+
+		fd_ctx->delay_frame = frame;
+		/* with recall the lock is held until a brick asks for it */
+		if (priv->eager_lock_recall)
+			goto unlock;
 		fd_ctx->delay_timer = gf_timer_call_after (this->ctx, delta,
 							   afr_delayed_changelog_wake_up_cbk,
 							   fd);
-		fd_ctx->delay_frame = frame;
 	}
 unlock:
 	pthread_mutex_unlock (&fd_ctx->delay_lock);
@@ -1376,6 +1886,9 @@ unlock:
 	if (prev_frame) {
 		afr_changelog_post_op_now (prev_frame, this);
 	}
+
+	if (now_frame)
+		afr_changelog_post_op_now (now_frame, this);
 }
 
 
@@ -1400,6 +1913,100 @@ afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd)
 }
 
 
+/* a brick recalled the eager lock @recall->owner holds on a file; the
+ * owner is the fd the lock was taken for (see afr_transaction).
+ */
+void
+afr_inodelk_recall (xlator_t *this, gf_upcall_recall_t *recall)
+{
+	afr_private_t  *priv   = NULL;
+	afr_fd_ctx_t   *fd_ctx = NULL;
+	fd_t           *fd     = NULL;
+	gf_lkowner_t    owner  = {0, };
+	gf_boolean_t    parked = _gf_false;
+
+	priv = this->private;
+
+	if (!recall->domain || strcmp (recall->domain, this->name))
+		return;
+
+	LOCK (&priv->lock);
+	{
+		list_for_each_entry (fd_ctx, &priv->lease_fds, lease_list) {
+			set_lk_owner_from_ptr (&owner, fd_ctx->lease_fd);
+			if (!is_same_lkowner (&owner, &recall->owner))
+				continue;
+			if (uuid_compare (fd_ctx->lease_fd->inode->gfid,
+					  recall->gfid))
+				continue;
+			fd = fd_ref (fd_ctx->lease_fd);
+			break;
+		}
+	}
+	UNLOCK (&priv->lock);
+
+	if (!fd) {
+		gf_log (this->name, GF_LOG_DEBUG, "no eager lock held on %s "
+			"for the recall", uuid_utoa (recall->gfid));
+		return;
+	}
+
+	/* writes still in flight must not delay their post-op either, set
+	   this before looking for a delayed one so that none is missed */
+	LOCK (&fd->lock);
+	{
+		fd_ctx->lease_recalled = _gf_true;
+	}
+	UNLOCK (&fd->lock);
+
+	pthread_mutex_lock (&fd_ctx->delay_lock);
+	{
+		parked = (fd_ctx->delay_frame != NULL);
+	}
+	pthread_mutex_unlock (&fd_ctx->delay_lock);
+
+	gf_log (this->name, GF_LOG_DEBUG, "releasing recalled eager lock "
+		"on %s%s", uuid_utoa (recall->gfid),
+		parked ? "" : " after the writes in flight");
+
+	if (parked)
+		afr_delayed_changelog_wake_up (this, fd);
+	fd_unref (fd);
+}
+
+
+/* releases every eager lock waiting for a recall */
+void
+afr_lease_fds_wake_up (xlator_t *this)
+{
+	afr_private_t  *priv   = NULL;
+	afr_fd_ctx_t   *fd_ctx = NULL;
+	fd_t           *fd     = NULL;
+
+	priv = this->private;
+
+	for (;;) {
+		fd = NULL;
+		LOCK (&priv->lock);
+		{
+			if (!list_empty (&priv->lease_fds)) {
+				fd_ctx = list_entry (priv->lease_fds.next,
+						     afr_fd_ctx_t, lease_list);
+				list_del_init (&fd_ctx->lease_list);
+				fd = fd_ref (fd_ctx->lease_fd);
+			}
+		}
+		UNLOCK (&priv->lock);
+
+		if (!fd)
+			break;
+
+		afr_delayed_changelog_wake_up (this, fd);
+		fd_unref (fd);
+	}
+}
+
+
 int
 afr_transaction_resume (call_frame_t *frame, xlator_t *this)
 {
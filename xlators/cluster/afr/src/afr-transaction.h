@@ -37,4 +37,10 @@ afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this);
 void
 afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd);
 
+void
+afr_inodelk_recall (xlator_t *this, gf_upcall_recall_t *recall);
+
+void
+afr_lease_fds_wake_up (xlator_t *this);
+
 #endif /* __TRANSACTION_H__ */
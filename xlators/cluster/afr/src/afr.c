@@ -111,6 +111,9 @@ reconfigure (xlator_t *this, dict_t *options)
         int            ret         = -1;
         int            index       = -1;
         char          *qtype       = NULL;
+        char          *read_policy = NULL;
+        gf_boolean_t   eager_lock_recall = _gf_false;
+        gf_boolean_t   data_dirty_map = _gf_false;
 
         priv = this->private;
 
@@ -146,6 +149,12 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("data-self-heal-algorithm",
                           priv->data_self_heal_algorithm, options, str, out);
 
+        GF_OPTION_RECONF ("entry-self-heal-algorithm",
+                          priv->entry_self_heal_algorithm, options, str, out);
+
+        GF_OPTION_RECONF ("entry-self-heal-merge-limit",
+                          priv->entry_merge_limit, options, uint32, out);
+
         GF_OPTION_RECONF ("self-heal-daemon", priv->shd.enabled, options, bool, out);
 
         GF_OPTION_RECONF ("read-subvolume", read_subvol, options, xlator, out);
@@ -153,6 +162,17 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("read-hash-mode", priv->hash_mode,
                           options, uint32, out);
 
+        GF_OPTION_RECONF ("read-policy", read_policy, options, str, out);
+        priv->read_least_load = !strcmp (read_policy, "least-load");
+
+        GF_OPTION_RECONF ("read-policy-hysteresis", priv->read_hysteresis,
+                          options, uint32, out);
+
+        GF_OPTION_RECONF ("parallel-reads", priv->parallel_reads, options,
+                          bool, out);
+        GF_OPTION_RECONF ("parallel-read-min-size",
+                          priv->parallel_read_min_size, options, size, out);
+
         if (read_subvol) {
                 index = xlator_subvolume_index (this, read_subvol);
                 if (index == -1) {
@@ -180,12 +200,35 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("quorum-count", priv->quorum_count, options,
                           uint32, out);
         fix_quorum_options(this,priv,qtype);
+        GF_OPTION_RECONF ("quorum-early-ack", priv->quorum_early_ack, options,
+                          bool, out);
         GF_OPTION_RECONF ("heal-timeout", priv->shd.timeout, options,
                           int32, out);
+        GF_OPTION_RECONF ("shd-max-threads", priv->shd.max_threads, options,
+                          uint32, out);
+        GF_OPTION_RECONF ("shd-wait-qlength", priv->shd.wait_qlength,
+                          options, uint32, out);
 
 	GF_OPTION_RECONF ("post-op-delay-secs", priv->post_op_delay_secs, options,
 			  uint32, out);
 
+        GF_OPTION_RECONF ("data-dirty-map", data_dirty_map, options,
+                          bool, out);
+        if (priv->data_dirty_map && !data_dirty_map)
+                priv->dirty_map_off_gen++;
+        priv->data_dirty_map = data_dirty_map;
+
+        GF_OPTION_RECONF ("changelog-batch", priv->changelog_batch, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("eager-lock-recall", eager_lock_recall, options,
+                          bool, out);
+        if (priv->eager_lock_recall && !eager_lock_recall) {
+                priv->eager_lock_recall = _gf_false;
+                afr_lease_fds_wake_up (this);
+        }
+        priv->eager_lock_recall = eager_lock_recall;
+
         GF_OPTION_RECONF (AFR_SH_READDIR_SIZE_KEY, priv->sh_readdir_size,
                           options, size, out);
         /* Reset this so we re-discover in case the topology changed.  */
@@ -222,6 +265,7 @@ init (xlator_t *this)
         int            read_subvol_index = -1;
         xlator_t      *fav_child   = NULL;
         char          *qtype       = NULL;
+        char          *read_policy = NULL;
 
         if (!this->children) {
                 gf_log (this->name, GF_LOG_ERROR,
@@ -246,6 +290,8 @@ init (xlator_t *this)
         //lock recovery is not done in afr
         pthread_mutex_init (&priv->mutex, NULL);
         INIT_LIST_HEAD (&priv->saved_fds);
+        INIT_LIST_HEAD (&priv->lease_fds);
+        priv->dirty_map_off_gen = 1;
 
         child_count = xlator_subvolume_count (this);
 
@@ -275,6 +321,16 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("read-hash-mode", priv->hash_mode, uint32, out);
 
+        GF_OPTION_INIT ("read-policy", read_policy, str, out);
+        priv->read_least_load = !strcmp (read_policy, "least-load");
+
+        GF_OPTION_INIT ("read-policy-hysteresis", priv->read_hysteresis,
+                        uint32, out);
+
+        GF_OPTION_INIT ("parallel-reads", priv->parallel_reads, bool, out);
+        GF_OPTION_INIT ("parallel-read-min-size",
+                        priv->parallel_read_min_size, size, out);
+
         priv->favorite_child = -1;
         GF_OPTION_INIT ("favorite-child", fav_child, xlator, out);
         if (fav_child) {
@@ -298,6 +354,12 @@ init (xlator_t *this)
         GF_OPTION_INIT ("data-self-heal-algorithm",
                         priv->data_self_heal_algorithm, str, out);
 
+        GF_OPTION_INIT ("entry-self-heal-algorithm",
+                        priv->entry_self_heal_algorithm, str, out);
+
+        GF_OPTION_INIT ("entry-self-heal-merge-limit",
+                        priv->entry_merge_limit, uint32, out);
+
         GF_OPTION_INIT ("data-self-heal-window-size",
                         priv->data_self_heal_window_size, uint32, out);
 
@@ -332,8 +394,13 @@ init (xlator_t *this)
         GF_OPTION_INIT (AFR_SH_READDIR_SIZE_KEY, priv->sh_readdir_size, size,
                         out);
         fix_quorum_options(this,priv,qtype);
+        GF_OPTION_INIT ("quorum-early-ack", priv->quorum_early_ack, bool, out);
 
 	GF_OPTION_INIT ("post-op-delay-secs", priv->post_op_delay_secs, uint32, out);
+        GF_OPTION_INIT ("data-dirty-map", priv->data_dirty_map, bool, out);
+        GF_OPTION_INIT ("changelog-batch", priv->changelog_batch, bool, out);
+        GF_OPTION_INIT ("eager-lock-recall", priv->eager_lock_recall, bool,
+                        out);
         GF_OPTION_INIT ("readdir-failover", priv->readdir_failover, bool, out);
 
         priv->wait_count = 1;
@@ -359,6 +426,13 @@ init (xlator_t *this)
                 goto out;
         }
 
+        priv->child_load = GF_CALLOC (sizeof (*priv->child_load), child_count,
+                                      gf_afr_mt_child_load_t);
+        if (!priv->child_load) {
+                ret = -ENOMEM;
+                goto out;
+        }
+
         priv->pending_key = GF_CALLOC (sizeof (*priv->pending_key),
                                        child_count,
                                        gf_afr_mt_char);
@@ -430,6 +504,11 @@ init (xlator_t *this)
         if (!priv->shd.timer)
                 goto out;
 
+        priv->shd.progress = GF_CALLOC (sizeof (*priv->shd.progress),
+                                        child_count, gf_afr_mt_shd_progress_t);
+        if (!priv->shd.progress)
+                goto out;
+
         priv->shd.healed = eh_new (AFR_EH_HEALED_LIMIT, _gf_false);
         if (!priv->shd.healed)
                 goto out;
@@ -448,6 +527,9 @@ init (xlator_t *this)
         priv->root_inode = inode_ref (this->itable->root);
         GF_OPTION_INIT ("node-uuid", priv->shd.node_uuid, str, out);
         GF_OPTION_INIT ("heal-timeout", priv->shd.timeout, int32, out);
+        GF_OPTION_INIT ("shd-max-threads", priv->shd.max_threads, uint32, out);
+        GF_OPTION_INIT ("shd-wait-qlength", priv->shd.wait_qlength, uint32,
+                        out);
 
         ret = 0;
 out:
@@ -503,6 +585,11 @@ struct xlator_fops fops = {
         .fsetattr    = afr_fsetattr,
         .removexattr = afr_removexattr,
         .fremovexattr = afr_fremovexattr,
+        .fallocate   = afr_fallocate,
+        .discard     = afr_discard,
+        .zerofill    = afr_zerofill,
+        .seek        = afr_seek,
+        .copy_file_range = afr_copy_file_range,
 
         /* dir read */
         .opendir     = afr_opendir,
@@ -564,6 +651,41 @@ struct volume_options options[] = {
                                                     "same subvolume), "
                          "2 = hash by GFID of file and client PID",
         },
+        { .key  = {"read-policy"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"hash", "least-load"},
+          .default_value = "hash",
+          .description = "hash: read from the read child chosen by "
+                         "read-subvolume, choose-local or read-hash-mode. "
+                         "least-load: track the latency and outstanding reads "
+                         "of each subvolume and move reads of a file to the "
+                         "least loaded readable subvolume."
+        },
+        { .key  = {"read-policy-hysteresis"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 99,
+          .default_value = "20",
+          .description = "With read-policy least-load, percentage by which "
+                         "another subvolume has to be less loaded than the "
+                         "current read child before reads move to it."
+        },
+        { .key  = {"parallel-reads"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Split large reads of files which have no pending "
+                         "changes on any subvolume into chunks, and read "
+                         "the chunks from all readable subvolumes in "
+                         "parallel."
+        },
+        { .key  = {"parallel-read-min-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 8 * GF_UNIT_KB,
+          .max  = 128 * GF_UNIT_MB,
+          .default_value = "256KB",
+          .description = "Reads smaller than this are never split by "
+                         "parallel-reads."
+        },
         { .key  = {"choose-local" },
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "true",
@@ -596,18 +718,45 @@ struct volume_options options[] = {
         },
         { .key  = {"data-self-heal-algorithm"},
           .type = GF_OPTION_TYPE_STR,
-          .description   = "Select between \"full\", \"diff\". The "
+          .description   = "Select between \"full\", \"diff\" and "
+                           "\"delta\". The "
                            "\"full\" algorithm copies the entire file from "
                            "source to sink. The \"diff\" algorithm copies to "
                            "sink only those blocks whose checksums don't match "
-                           "with those of source. If no option is configured "
+                           "with those of source. The \"delta\" algorithm "
+                           "compares differing blocks again in 4KB pieces "
+                           "and copies only the pieces that differ, reusing "
+                           "data the sink already holds at another offset of "
+                           "the block, which suits large files with scattered "
+                           "changes such as VM images. If no option is configured "
                            "the option is chosen dynamically as follows: "
                            "If the file does not exist on one of the sinks "
                            "or empty file exists or if the source file size is "
                            "about the same as page size the entire file will "
                            "be read and written i.e \"full\" algo, "
                            "otherwise \"diff\" algo is chosen.",
-          .value = { "diff", "full"}
+          .value = { "diff", "full", "delta"}
+        },
+        { .key  = {"entry-self-heal-algorithm"},
+          .type = GF_OPTION_TYPE_STR,
+          .default_value = "full",
+          .description = "Select between \"full\" and \"merge\". The "
+                         "\"full\" algorithm looks up every entry of a "
+                         "directory on all subvolumes. The \"merge\" "
+                         "algorithm reads the listings of all subvolumes in "
+                         "parallel, merges them sorted by name and only "
+                         "heals the entries that differ, which saves most "
+                         "of the network round trips on large directories.",
+          .value = { "full", "merge"}
+        },
+        { .key  = {"entry-self-heal-merge-limit"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1024,
+          .max  = 16777216,
+          .default_value = "131072",
+          .description = "Number of entries the \"merge\" entry self-heal "
+                         "algorithm sorts in memory. Larger directories are "
+                         "sorted in runs written to a temporary file."
         },
         { .key  = {"data-self-heal-window-size"},
           .type = GF_OPTION_TYPE_INT,
@@ -740,6 +889,14 @@ struct volume_options options[] = {
                          "this many bricks or present.  Other quorum types "
                          "will OVERWRITE this value.",
         },
+        { .key = {"quorum-early-ack"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "With a quorum-type set, answer a write as soon as "
+                         "a quorum of bricks wrote it instead of waiting for "
+                         "the slowest brick. The remaining bricks complete "
+                         "the write in the background.",
+        },
         { .key  = {"node-uuid"},
           .type = GF_OPTION_TYPE_STR,
           .description = "Local glusterd uuid string, used in starting "
@@ -754,6 +911,27 @@ struct volume_options options[] = {
           .description = "time interval for checking the need to self-heal "
                          "in self-heal-daemon"
         },
+        { .key  = {"shd-max-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 64,
+          .default_value = "1",
+          .description = "Number of entries the self-heal-daemon heals in "
+                         "parallel on each local brick during an index crawl."
+        },
+        { .key  = {"shd-wait-qlength"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 655360,
+          .default_value = "1024",
+          .description = "Number of index entries the self-heal-daemon "
+                         "hands to its shd-max-threads healers at a time. "
+                         "The whole index is read and ordered first: "
+                         "directories are healed first, then small files, "
+                         "then large files. When fewer large files than "
+                         "healers are left, each is healed with a "
+                         "proportionally larger data-self-heal-window-size."
+        },
         { .key  = {"post-op-delay-secs"},
           .type = GF_OPTION_TYPE_INT,
           .min  = 0,
@@ -763,6 +941,37 @@ struct volume_options options[] = {
 	                 "post-operation phase of the transaction to "
                          "enhance overlap of adjacent write operations.",
         },
+        { .key  = {"data-dirty-map"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Record on the bricks which 1MB regions of a file "
+                         "were written while a replica missed the writes, "
+                         "and let data self-heal check only those regions. "
+                         "Enable it only when all clients of the volume "
+                         "support it. A file's map is started by the first "
+                         "write that finds all its replicas in sync, or by "
+                         "a self-heal; until then heals check the whole "
+                         "file.",
+        },
+        { .key  = {"changelog-batch"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Let the client protocol merge changelog pre-ops "
+                         "and post-ops of different files that go to the "
+                         "same brick at the same time into one request. "
+                         "Helps small file workloads such as untar. All "
+                         "bricks must support the XATTROP_BATCH request.",
+        },
+        { .key  = {"eager-lock-recall"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Keep the eager lock and the pending changelog of "
+                         "a file after writes until another client wants "
+                         "the lock and the brick recalls it, instead of "
+                         "dropping it after post-op-delay-secs. Needs "
+                         "eager-lock, and all bricks and clients must "
+                         "support inodelk recall.",
+        },
         { .key = {AFR_SH_READDIR_SIZE_KEY},
           .type = GF_OPTION_TYPE_SIZET,
           .description = "readdirp size for performing entry self-heal",
@@ -28,11 +28,35 @@
 #define AFR_XATTR_PREFIX "trusted.afr"
 #define AFR_PATHINFO_HEADER "REPLICATE:"
 #define AFR_SH_READDIR_SIZE_KEY "self-heal-readdir-size"
+/* set by the self-heal daemon in the xdata of the lookup healing a large
+   file, the number of windows of the data self-heal to run at once */
+#define AFR_SH_WINDOW_KEY "glusterfs.afr.self-heal-window"
+
+/* Regions of a file written while some child missed the write. Bit
+   ((offset >> AFR_DIRTY_MAP_REGION_SHIFT) % AFR_DIRTY_MAP_BITS) is set
+   for every region such a write touched, so large files wrap around the
+   map and share bits between regions. The bitmap follows a small header;
+   AFR_DIRTY_MAP_STARTED in its first byte is only ever written when every
+   child is known to be in sync: by a self-heal that left them so, or by a
+   write whose pre-op found no changes pending on any child. A map that
+   writers created on their own (recording started while changes were
+   already pending) is not trusted, and neither is one that a writer gave up
+   on and marked AFR_DIRTY_MAP_INVALID. */
+#define AFR_DIRTY_MAP_KEY          AFR_XATTR_PREFIX".dirty-map"
+#define AFR_DIRTY_MAP_HDR_SIZE     8
+#define AFR_DIRTY_MAP_SIZE         4096
+#define AFR_DIRTY_MAP_XATTR_SIZE   (AFR_DIRTY_MAP_HDR_SIZE + AFR_DIRTY_MAP_SIZE)
+#define AFR_DIRTY_MAP_BITS         (AFR_DIRTY_MAP_SIZE * 8)
+#define AFR_DIRTY_MAP_REGION_SHIFT 20
+#define AFR_DIRTY_MAP_STARTED      0x01
+#define AFR_DIRTY_MAP_INVALID      0x02
 
 #define AFR_LOCKEE_COUNT_MAX    3
 
 struct _pump_private;
 
+typedef struct afr_entry_merge afr_entry_merge_t;
+
 typedef int (*afr_expunge_done_cbk_t) (call_frame_t *frame, xlator_t *this,
                                        int child, int32_t op_error,
                                        int32_t op_errno);
@@ -62,6 +86,7 @@ typedef enum {
         AFR_INODE_SET_OPENDIR_DONE,
         AFR_INODE_GET_READ_CTX,
         AFR_INODE_GET_OPENDIR_DONE,
+        AFR_INODE_SET_READ_CHILD,
 } afr_inode_op_t;
 
 typedef struct afr_inode_params_ {
@@ -86,14 +111,46 @@ typedef struct afr_inode_ctx_ {
         int32_t  *fresh_children;//increasing order of latency
         afr_spb_state_t mdata_spb;
         afr_spb_state_t data_spb;
+        /* writes acknowledged on quorum: per child the number of them
+           it has not answered yet, the writes, and the fops which
+           overlap them and wait */
+        uint32_t *lagging;
+        struct list_head early_acks;
+        struct list_head ack_waiters;
+        /* dirty_map_off_gen when a pre-op last started the dirty map,
+           0 when it has to be started again */
+        uint32_t dirty_map_started;
 } afr_inode_ctx_t;
 
+typedef struct {
+        struct list_head list;
+        off_t            start;
+        off_t            end;
+} afr_early_ack_t;
+
+typedef struct {
+        struct list_head list;
+        off_t            start;
+        off_t            end;
+        call_stub_t     *stub;
+} afr_ack_waiter_t;
+
+#define AFR_EARLY_ACK_EOF ((off_t) LLONG_MAX)
+
 typedef enum {
         NONE,
         INDEX,
         FULL,
 } afr_crawl_type_t;
 
+/* progress of the index heal of one child, for heal info */
+typedef struct {
+        time_t           started;  /* start of the current or last crawl */
+        time_t           finished; /* 0 while the crawl is running */
+        uint64_t         queued;   /* entries picked up from the index */
+        uint64_t         healed;   /* entries processed */
+} afr_shd_progress_t;
+
 typedef struct afr_self_heald_ {
         gf_boolean_t     enabled;
         gf_boolean_t     iamshd;
@@ -106,8 +163,34 @@ typedef struct afr_self_heald_ {
         eh_t             *split_brain;
         char             *node_uuid;
         int              timeout;
+        uint32_t         max_threads;  /* concurrent heals per child */
+        uint32_t         wait_qlength; /* entries queued per heal batch */
+        afr_shd_progress_t *progress;
 } afr_self_heald_t;
 
+/* one chunk of a readv split across children, see afr_readv_striped () */
+typedef struct {
+        off_t          offset;
+        size_t         size;
+        int32_t        op_ret;
+        int32_t        op_errno;
+        struct iovec  *vector;
+        int32_t        count;
+        struct iatt    buf;
+        struct iobref *iobref;
+} afr_read_stripe_t;
+
+/* how fast a child has been answering reads, see afr_child_load_end () */
+typedef struct {
+        uint64_t  latency;    /* moving average of reply latency, in usec */
+        int32_t   inflight;   /* reads wound and not yet answered */
+        time_t    sampled;    /* when latency was last updated */
+} afr_child_load_t;
+
+/* latency of a child which is not being read from is halved every this
+   many seconds, so that it gets probed again once it may have recovered */
+#define AFR_CHILD_LOAD_DECAY_SECS 5
+
 typedef struct _afr_private {
         gf_lock_t lock;               /* to guard access to child_count, etc */
         unsigned int child_count;     /* total number of children   */
@@ -126,6 +209,8 @@ typedef struct _afr_private {
 
         char         *data_self_heal;              /* on/off/open */
         char *       data_self_heal_algorithm;    /* name of algorithm */
+        char *       entry_self_heal_algorithm;
+        uint32_t     entry_merge_limit;  /* names sorted in memory */
         unsigned int data_self_heal_window_size;  /* max number of pipelined
                                                      read/writes */
 
@@ -140,6 +225,13 @@ typedef struct _afr_private {
 
         int read_child;               /* read-subvolume */
         unsigned int hash_mode;       /* for when read_child is not set */
+        gf_boolean_t read_least_load; /* read-policy least-load */
+        uint32_t     read_hysteresis; /* % a child must beat the current
+                                         read child by to take over */
+        gf_boolean_t parallel_reads;  /* split large reads of clean files
+                                         across all readable children */
+        uint64_t     parallel_read_min_size;
+        afr_child_load_t *child_load; /* guarded by read_child_lock */
         int favorite_child;  /* subvolume to be preferred in resolving
                                          split-brain cases */
 
@@ -161,6 +253,13 @@ typedef struct _afr_private {
         gf_boolean_t      optimistic_change_log;
         gf_boolean_t      eager_lock;
 	uint32_t          post_op_delay_secs;
+        gf_boolean_t      data_dirty_map;
+        uint32_t          dirty_map_off_gen; /* bumped when data-dirty-map
+                                                is turned off */
+        gf_boolean_t      changelog_batch;
+        gf_boolean_t      eager_lock_recall;
+        gf_boolean_t      quorum_early_ack;
+        struct list_head  lease_fds;  /* fd_ctxs holding a recallable lock */
         unsigned int      quorum_count;
 
         char                   vol_uuid[UUID_SIZE + 1];
@@ -261,6 +360,25 @@ typedef struct {
         off_t offset;
         unsigned char *write_needed;
         uint8_t *checksum;
+        /* per AFR_SH_DELTA_BLOCK_SIZE checksums of the window, indexed
+           by block * child_count + child */
+        uint32_t *delta_weak;
+        uint8_t *delta_strong;
+        unsigned char *delta_dirty;
+        int delta_blocks;
+        int delta_next;
+        off_t delta_offset;
+        /* the checksums of the window were asked for with the heal's key,
+           and how many replies came back keyed */
+        gf_boolean_t delta_keyed;
+        int delta_keyed_replies;
+        afr_sh_delta_op_t *delta_ops;
+        int delta_op_count;
+        char *delta_buf;
+        struct iobref *delta_iobref;
+        /* dirty map of the source, only regions set in it are healed */
+        unsigned char *dirty_map;
+        gf_boolean_t dirty_map_clear;
         afr_post_remove_call_t post_remove_call;
 
         loc_t parent_loc;
@@ -270,6 +388,7 @@ typedef struct {
         gf_boolean_t unwound;
 
         afr_sh_algo_private_t *private;
+        afr_entry_merge_t     *entry_merge;
 
         struct afr_sh_algorithm  *algo;
         afr_lock_cbk_t data_lock_success_handler;
@@ -520,8 +639,18 @@ typedef struct _afr_local {
                         off_t offset;
                         int last_index;
                         uint32_t flags;
+                        int call_child;
+                        struct timeval start;
+                        afr_read_stripe_t *stripes;
+                        int stripe_count;
                 } readv;
 
+                struct {
+                        off_t offset;
+                        gf_seek_what_t what;
+                        int last_index;
+                } seek;
+
                 /* dir read */
 
                 struct {
@@ -573,6 +702,39 @@ typedef struct _afr_local {
                         struct iatt postbuf;
                 } ftruncate;
 
+                struct {
+                        int32_t mode;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } fallocate;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } discard;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } zerofill;
+
+                struct {
+                        fd_t *fd_in;
+                        off_t off_in;
+                        off_t off_out;
+                        size_t len;
+                        uint32_t flags;
+                        struct iatt stbuf;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } copy_file_range;
+
                 struct {
                         struct iatt in_buf;
                         int32_t valid;
@@ -675,6 +837,17 @@ typedef struct _afr_local {
 
                 int (*unwind) (call_frame_t *frame, xlator_t *this);
 
+                /* dirty map recorded before the post-op */
+                gf_boolean_t    dirty_map_done;
+
+                /* the pre-op may start the dirty map: nothing was pending
+                   on the children it went to */
+                gf_boolean_t    dirty_map_start;
+
+                /* unwound once a quorum of children wrote the data */
+                gf_boolean_t    early_acked;
+                afr_early_ack_t early_ack;
+
                 /* post-op hook */
         } transaction;
 
@@ -723,6 +896,18 @@ typedef struct {
 	gf_timer_t        *delay_timer;
 	call_frame_t      *delay_frame;
         int               call_child;
+
+        /* on priv->lease_fds once writes through the fd took an eager
+           lock that is only given up when a brick recalls it */
+        struct list_head  lease_list;
+        fd_t             *lease_fd;
+        /* a brick recalled the eager lock; no post-op is delayed until the
+           lock is unlocked on the bricks. Protected by fd->lock */
+        gf_boolean_t      lease_recalled;
+
+        /* dirty_map_off_gen at which writes through this fd last dropped
+           the dirty map */
+        uint32_t          dirty_map_dropped;
 } afr_fd_ctx_t;
 
 
@@ -935,6 +1120,20 @@ afr_internal_lock_init (afr_internal_lock_t *lk, size_t child_count,
 int
 afr_first_up_child (unsigned char *child_up, size_t child_count);
 
+void
+afr_inode_set_read_child (xlator_t *this, inode_t *inode, int32_t read_child);
+
+void
+afr_child_load_start (xlator_t *this, int32_t child, struct timeval *start);
+
+void
+afr_child_load_end (xlator_t *this, int32_t child, struct timeval *start,
+                    int32_t op_ret);
+
+int32_t
+afr_least_loaded_read_child (xlator_t *this, int32_t *fresh_children,
+                             unsigned char *child_up, int32_t read_child);
+
 int
 afr_select_read_child_from_policy (int32_t *fresh_children, int32_t child_count,
                                    int32_t prev_read_child,
@@ -1037,6 +1236,37 @@ afr_child_fd_ctx_set (xlator_t *this, fd_t *fd, int32_t child,
 gf_boolean_t
 afr_have_quorum (char *logname, afr_private_t *priv);
 
+gf_boolean_t
+afr_quorum_met (afr_private_t *priv, unsigned char *success);
+
+gf_boolean_t
+afr_early_ack_pending (xlator_t *this, inode_t *inode);
+
+gf_boolean_t
+afr_early_ack_wait (xlator_t *this, inode_t *inode, off_t start, off_t end,
+                    call_stub_t *stub);
+
+void
+afr_early_ack_start (xlator_t *this, inode_t *inode, afr_early_ack_t *ack,
+                     unsigned char *lagging);
+
+void
+afr_early_ack_reply (xlator_t *this, inode_t *inode, afr_early_ack_t *ack,
+                     int child);
+
+void
+afr_early_ack_done (xlator_t *this, inode_t *inode, afr_early_ack_t *ack);
+
+gf_boolean_t
+afr_early_ack_lagging (xlator_t *this, inode_t *inode, int child);
+
+gf_boolean_t
+afr_dirty_map_started (xlator_t *this, inode_t *inode);
+
+void
+afr_dirty_map_set_started (xlator_t *this, inode_t *inode,
+                           gf_boolean_t started);
+
 void
 afr_matrix_cleanup (int32_t **pending, unsigned int m);
 
@@ -1078,4 +1308,20 @@ afr_xattr_array_destroy (dict_t **xattr, unsigned int child_count);
         }                                                                \
 } while (0);
 
+/* park the fop until the early acknowledged writes it overlaps are done */
+#define AFR_EARLY_ACK_WAIT(_fop,_start,_end,_label,_args...) do {       \
+        call_stub_t *__stub = NULL;                                      \
+        if (!priv->quorum_early_ack ||                                   \
+            !afr_early_ack_pending (this, fd->inode))                    \
+                break;                                                   \
+        __stub = fop_##_fop##_stub (frame, afr_##_fop, fd, _args);       \
+        if (!__stub) {                                                   \
+                op_errno = ENOMEM;                                       \
+                goto _label;                                             \
+        }                                                                \
+        if (afr_early_ack_wait (this, fd->inode, _start, _end, __stub))  \
+                return 0;                                                \
+        call_stub_destroy (__stub);                                      \
+} while (0)
+
 #endif /* __AFR_H__ */
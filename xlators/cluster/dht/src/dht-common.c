@@ -462,6 +462,8 @@ dht_lookup_dir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 dht_iatt_merge (this, &local->stbuf, stbuf, prev->this);
                 dht_iatt_merge (this, &local->postparent, postparent,
                                 prev->this);
+
+                dht_rename_map_capture (this, local, prev->this, stbuf, xattr);
         }
 unlock:
         UNLOCK (&frame->lock);
@@ -487,6 +489,7 @@ unlock:
                         }
 
                         dht_layout_set (this, local->inode, layout);
+                        dht_rename_map_apply (this, local);
                 }
 
                 if (local->loc.parent) {
@@ -639,6 +642,10 @@ dht_revalidate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 } else if (is_dir) {
                         dht_aggregate_xattr (local->xattr, xattr);
                 }
+
+                if (is_dir)
+                        dht_rename_map_capture (this, local, prev->this,
+                                                stbuf, xattr);
         }
 unlock:
         UNLOCK (&frame->lock);
@@ -699,6 +706,9 @@ cont:
                         local->op_errno = ESTALE;
                 }
 
+                if (local->op_ret == 0)
+                        dht_rename_map_apply (this, local);
+
                 if (local->loc.parent) {
                         dht_inode_ctx_time_update (local->loc.parent, this,
                                                    &local->postparent, 1);
@@ -802,6 +812,9 @@ dht_lookup_everywhere_done (call_frame_t *frame, xlator_t *this)
         }
 
         if (!cached_subvol) {
+                /* only when every subvolume said ENOENT */
+                if (local->op_errno == ENOENT)
+                        dht_nlc_add (this, local);
                 DHT_STACK_UNWIND (lookup, frame, -1, ENOENT, NULL, NULL, NULL,
                                   NULL);
                 return 0;
@@ -1272,6 +1285,7 @@ dht_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                 return 0;
                         }
                 }
+                dht_nlc_add (this, local);
         }
 
         if (op_ret == 0) {
@@ -1380,6 +1394,82 @@ dht_check_and_set_acl_xattr_req (inode_t *inode, dict_t *xattr_req)
         return;
 }
 
+/* lookup of a name listed in the rename map of its directory; anything
+   but the data file falls back to the hashed subvolume */
+int
+dht_lookup_renamed_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int op_ret, int op_errno, inode_t *inode,
+                        struct iatt *stbuf, dict_t *xattr,
+                        struct iatt *postparent)
+{
+        call_frame_t *prev          = NULL;
+        dht_local_t  *local         = NULL;
+        dht_conf_t   *conf          = NULL;
+        xlator_t     *hashed_subvol = NULL;
+        int           ret           = 0;
+
+        prev   = cookie;
+        conf   = this->private;
+        local  = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "lookup of %s on %s (following rename map) failed (%s)",
+                        local->loc.path, prev->this->name, strerror (op_errno));
+                if (op_errno == ENOENT)
+                        dht_rename_map_forget (this, &local->loc);
+                goto fallback;
+        }
+
+        if (check_is_dir (inode, stbuf, xattr) ||
+            check_is_linkfile (inode, stbuf, xattr))
+                goto fallback;
+
+        if (!uuid_is_null (local->loc.gfid) &&
+            uuid_compare (local->loc.gfid, stbuf->ia_gfid))
+                goto fallback;
+
+        if (uuid_is_null (local->gfid))
+                uuid_copy (local->gfid, stbuf->ia_gfid);
+
+        if ((stbuf->ia_nlink == 1)
+            && (conf && conf->unhashed_sticky_bit)) {
+                stbuf->ia_prot.sticky = 1;
+        }
+
+        ret = dht_layout_preset (this, prev->this, inode);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "failed to set layout for subvolume %s",
+                        prev->this->name);
+                op_ret   = -1;
+                op_errno = EINVAL;
+        }
+
+        if (local->loc.parent) {
+                dht_inode_ctx_time_update (local->loc.parent, this,
+                                           postparent, 1);
+        }
+
+        DHT_STRIP_PHASE1_FLAGS (stbuf);
+        DHT_STACK_UNWIND (lookup, frame, op_ret, op_errno, inode, stbuf, xattr,
+                          postparent);
+
+        return 0;
+
+fallback:
+        hashed_subvol = local->hashed_subvol;
+
+        dht_nlc_record (this, local);
+
+        STACK_WIND (frame, dht_lookup_cbk,
+                    hashed_subvol, hashed_subvol->fops->lookup,
+                    &local->loc, local->xattr_req);
+
+        return 0;
+}
+
+
 int
 dht_lookup (call_frame_t *frame, xlator_t *this,
             loc_t *loc, dict_t *xattr_req)
@@ -1477,6 +1567,10 @@ dht_lookup (call_frame_t *frame, xlator_t *this,
                                        "trusted.glusterfs.dht", 4 * 4);
 
                 if (IA_ISDIR (local->inode->ia_type)) {
+                        if (conf->rename_map_size)
+                                ret = dict_set_uint32 (local->xattr_req,
+                                                       DHT_RENAME_MAP_KEY, 0);
+
                         local->call_cnt = call_cnt = conf->subvolume_cnt;
                         for (i = 0; i < call_cnt; i++) {
                                 STACK_WIND (frame, dht_revalidate_cbk,
@@ -1522,6 +1616,10 @@ dht_lookup (call_frame_t *frame, xlator_t *this,
                 /* need it for dir self-heal */
                 dht_check_and_set_acl_xattr_req (loc->inode, local->xattr_req);
 
+                if (conf->rename_map_size)
+                        ret = dict_set_uint32 (local->xattr_req,
+                                               DHT_RENAME_MAP_KEY, 0);
+
                 if (!hashed_subvol) {
                         gf_log (this->name, GF_LOG_DEBUG,
                                 "no subvolume in layout for path=%s, "
@@ -1546,6 +1644,25 @@ dht_lookup (call_frame_t *frame, xlator_t *this,
                         return 0;
                 }
 
+                subvol = dht_rename_map_get (this, loc->parent, loc->name);
+                if (subvol && (subvol != hashed_subvol)) {
+                        gf_log (this->name, GF_LOG_TRACE,
+                                "%s: renamed in place, looking up on %s",
+                                loc->path, subvol->name);
+                        STACK_WIND (frame, dht_lookup_renamed_cbk,
+                                    subvol, subvol->fops->lookup,
+                                    &local->loc, local->xattr_req);
+                        return 0;
+                }
+
+                if (dht_nlc_lookup (this, &local->loc)) {
+                        gf_log (this->name, GF_LOG_TRACE,
+                                "%s: cached negative lookup", loc->path);
+                        op_errno = ENOENT;
+                        goto err;
+                }
+                dht_nlc_record (this, local);
+
                 STACK_WIND (frame, dht_lookup_cbk,
                             hashed_subvol, hashed_subvol->fops->lookup,
                             loc, local->xattr_req);
@@ -1598,6 +1715,10 @@ dht_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 unlock:
         UNLOCK (&frame->lock);
 
+        if ((local->op_ret == 0) &&
+            dht_rename_map_get (this, local->loc.parent, local->loc.name))
+                dht_rename_map_forget (this, &local->loc);
+
         DHT_STACK_UNWIND (unlink, frame, local->op_ret, local->op_errno,
                           &local->preparent, &local->postparent, NULL);
 
@@ -2885,14 +3006,76 @@ dht_normalize_stats (struct statvfs *buf, unsigned long bsize,
         }
 }
 
+/* adds the usage of one subvolume to the sum in 'total' */
+static void
+dht_statfs_merge (struct statvfs *total, struct statvfs *statvfs)
+{
+        int          bsize         = 0;
+        int          frsize        = 0;
+
+        if (total->f_bsize != 0) {
+                bsize = max(total->f_bsize, statvfs->f_bsize);
+                frsize = max(total->f_frsize, statvfs->f_frsize);
+                dht_normalize_stats(total, bsize, frsize);
+                dht_normalize_stats(statvfs, bsize, frsize);
+        } else {
+                total->f_bsize    = statvfs->f_bsize;
+                total->f_frsize   = statvfs->f_frsize;
+        }
+
+        total->f_blocks  += statvfs->f_blocks;
+        total->f_bfree   += statvfs->f_bfree;
+        total->f_bavail  += statvfs->f_bavail;
+        total->f_files   += statvfs->f_files;
+        total->f_ffree   += statvfs->f_ffree;
+        total->f_favail  += statvfs->f_favail;
+        total->f_fsid     = statvfs->f_fsid;
+        total->f_flag     = statvfs->f_flag;
+        total->f_namemax  = statvfs->f_namemax;
+}
+
+/* sums up the usage the bricks pushed to us. only possible when every
+ * subvolume is up and pushes, otherwise the caller has to ask them.
+ */
+static int
+dht_statfs_from_snapshot (xlator_t *this, struct statvfs *total)
+{
+        dht_conf_t     *conf    = NULL;
+        struct statvfs  statvfs = {0,};
+        int             i       = 0;
+        int             ret     = -1;
+
+        conf = this->private;
+
+        memset (total, 0, sizeof (*total));
+
+        LOCK (&conf->subvolume_lock);
+        {
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (!conf->subvolume_status[i] ||
+                            !conf->du_stats[i].pushed)
+                                goto unlock;
+                }
+
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        statvfs = conf->du_stats[i].statvfs;
+                        dht_statfs_merge (total, &statvfs);
+                }
+
+                ret = 0;
+        }
+unlock:
+        UNLOCK (&conf->subvolume_lock);
+
+        return ret;
+}
+
 int
 dht_statfs_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 int op_ret, int op_errno, struct statvfs *statvfs, dict_t *xdata)
 {
         dht_local_t *local         = NULL;
         int          this_call_cnt = 0;
-        int          bsize         = 0;
-        int          frsize        = 0;
 
 
         local = frame->local;
@@ -2905,26 +3088,7 @@ dht_statfs_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 }
                 local->op_ret = 0;
 
-                if (local->statvfs.f_bsize != 0) {
-                        bsize = max(local->statvfs.f_bsize, statvfs->f_bsize);
-                        frsize = max(local->statvfs.f_frsize, statvfs->f_frsize);
-                        dht_normalize_stats(&local->statvfs, bsize, frsize);
-                        dht_normalize_stats(statvfs, bsize, frsize);
-                } else {
-                        local->statvfs.f_bsize    = statvfs->f_bsize;
-                        local->statvfs.f_frsize   = statvfs->f_frsize;
-                }
-
-                local->statvfs.f_blocks  += statvfs->f_blocks;
-                local->statvfs.f_bfree   += statvfs->f_bfree;
-                local->statvfs.f_bavail  += statvfs->f_bavail;
-                local->statvfs.f_files   += statvfs->f_files;
-                local->statvfs.f_ffree   += statvfs->f_ffree;
-                local->statvfs.f_favail  += statvfs->f_favail;
-                local->statvfs.f_fsid     = statvfs->f_fsid;
-                local->statvfs.f_flag     = statvfs->f_flag;
-                local->statvfs.f_namemax  = statvfs->f_namemax;
-
+                dht_statfs_merge (&local->statvfs, statvfs);
         }
 unlock:
         UNLOCK (&frame->lock);
@@ -2964,6 +3128,12 @@ dht_statfs (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
         }
 
         if (IA_ISDIR (loc->inode->ia_type)) {
+                if (!dht_statfs_from_snapshot (this, &local->statvfs)) {
+                        DHT_STACK_UNWIND (statfs, frame, 0, 0,
+                                          &local->statvfs, NULL);
+                        return 0;
+                }
+
                 local->call_cnt = conf->subvolume_cnt;
 
                 for (i = 0; i < conf->subvolume_cnt; i++) {
@@ -3040,40 +3210,34 @@ err:
 }
 
 
-int
-dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
-                  int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+/* Filter and transform one subvolume's readdirp reply into @entries.
+ * @next_offset is the subvolume offset after the last entry read,
+ * @last_offset the one after the last entry kept.
+ */
+static int
+dht_readdirp_filter (xlator_t *this, dht_local_t *local, xlator_t *subvol,
+                     gf_dirent_t *orig_entries, gf_dirent_t *entries,
+                     off_t *next_offset, off_t *last_offset)
 {
-        dht_local_t  *local = NULL;
-        gf_dirent_t   entries;
         gf_dirent_t  *orig_entry = NULL;
         gf_dirent_t  *entry = NULL;
-        call_frame_t *prev = NULL;
-        xlator_t     *next_subvol = NULL;
-        off_t         next_offset = 0;
         int           count = 0;
         dht_layout_t *layout = 0;
         dht_conf_t   *conf   = NULL;
-        xlator_t     *subvol = 0;
+        xlator_t     *hashed = 0;
         int           ret    = 0;
 
-        INIT_LIST_HEAD (&entries.list);
-        prev = cookie;
-        local = frame->local;
         conf  = this->private;
 
-        if (op_ret < 0)
-                goto done;
-
         if (!local->layout)
                 local->layout = dht_layout_get (this, local->fd->inode);
 
         layout = local->layout;
 
         list_for_each_entry (orig_entry, (&orig_entries->list), list) {
-                next_offset = orig_entry->d_off;
+                *next_offset = orig_entry->d_off;
                 if ((check_is_dir (NULL, (&orig_entry->d_stat), NULL) &&
-		    (prev->this != local->first_up_subvol)) ||
+		    (subvol != local->first_up_subvol)) ||
                     check_is_linkfile (NULL, (&orig_entry->d_stat),
                                        orig_entry->dict)) {
                         continue;
@@ -3082,22 +3246,23 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                 entry = gf_dirent_for_name (orig_entry->d_name);
                 if (!entry) {
 
-                        goto unwind;
+                        return -1;
                 }
 
                 /* Do this if conf->search_unhashed is set to "auto" */
                 if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) {
-                        subvol = dht_layout_search (this, layout,
+                        hashed = dht_layout_search (this, layout,
                                                     orig_entry->d_name);
-                        if (!subvol || (subvol != prev->this)) {
+                        if (!hashed || (hashed != subvol)) {
                                 /* TODO: Count the number of entries which need
                                    linkfile to prove its existence in fs */
                                 layout->search_unhashed++;
                         }
                 }
 
-                dht_itransform (this, prev->this, orig_entry->d_off,
+                dht_itransform (this, subvol, orig_entry->d_off,
                                 &entry->d_off);
+                *last_offset = orig_entry->d_off;
 
                 entry->d_stat = orig_entry->d_stat;
                 entry->d_ino  = orig_entry->d_ino;
@@ -3111,7 +3276,7 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                    currently possible only for non-directories, so for
                    directories don't set entry inodes */
                 if (!IA_ISDIR(entry->d_stat.ia_type)) {
-                        ret = dht_layout_preset (this, prev->this,
+                        ret = dht_layout_preset (this, subvol,
                                                  orig_entry->inode);
                         if (ret)
                                 gf_log (this->name, GF_LOG_WARNING,
@@ -3122,9 +3287,305 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                                                    &entry->d_stat, 1);
                 }
 
-                list_add_tail (&entry->list, &entries.list);
+                list_add_tail (&entry->list, &entries->list);
                 count++;
         }
+
+        return count;
+}
+
+
+/*
+ * readdir-prefetch: while one subvolume of a directory is being listed,
+ * the first chunk of the next few subvolumes, and the next chunk of the
+ * current one, are read into per-fd buffers. Entries are still handed out
+ * one subvolume after the other, so the d_off of every entry keeps naming
+ * its subvolume and the offset in it, and a reader can resume anywhere.
+ * A buffer is only used by a readdirp asking for exactly the offset it
+ * was read at; anything else goes to the subvolume as before.
+ */
+static dht_fd_ctx_t *
+dht_fd_ctx_readdir_get (xlator_t *this, fd_t *fd)
+{
+        dht_conf_t   *conf   = NULL;
+        dht_fd_ctx_t *ctx    = NULL;
+        uint64_t      value  = 0;
+        int           i      = 0;
+
+        conf = this->private;
+
+        LOCK (&fd->lock);
+        {
+                if (!__fd_ctx_get (fd, this, &value)) {
+                        ctx = (dht_fd_ctx_t *) (long) value;
+                        goto unlock;
+                }
+
+                ctx = GF_CALLOC (1, sizeof (*ctx) + conf->subvolume_cnt *
+                                 sizeof (ctx->bufs[0]), gf_dht_mt_fd_ctx_t);
+                if (!ctx)
+                        goto unlock;
+
+                LOCK_INIT (&ctx->lock);
+                for (i = 0; i < conf->subvolume_cnt; i++)
+                        INIT_LIST_HEAD (&ctx->bufs[i].entries.list);
+
+                if (__fd_ctx_set (fd, this, (uint64_t) (long) ctx)) {
+                        LOCK_DESTROY (&ctx->lock);
+                        GF_FREE (ctx);
+                        ctx = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&fd->lock);
+
+        return ctx;
+}
+
+
+static void
+dht_readdirp_set_skip_dirs (xlator_t *this, dht_local_t *local,
+                            xlator_t *subvol)
+{
+        dht_conf_t *conf = NULL;
+        int         ret  = 0;
+
+        conf = this->private;
+
+        if ((conf->readdir_optimize != _gf_true) || !local->xattr)
+                return;
+
+        if (subvol != local->first_up_subvol) {
+                ret = dict_set_int32 (local->xattr, GF_READDIR_SKIP_DIRS, 1);
+                if (ret)
+                        gf_log (this->name, GF_LOG_ERROR, "dict set failed");
+        } else {
+                dict_del (local->xattr, GF_READDIR_SKIP_DIRS);
+        }
+}
+
+
+/* a reader that rewinds or seeks elsewhere lists the directory afresh:
+   drop what was read ahead but not handed out yet, and what is still in
+   flight once it lands */
+static void
+dht_readdirp_prefetch_check (xlator_t *this, fd_t *fd, off_t yoff)
+{
+        dht_conf_t   *conf  = NULL;
+        dht_fd_ctx_t *ctx   = NULL;
+        uint64_t      value = 0;
+        int           i     = 0;
+
+        conf = this->private;
+
+        if (fd_ctx_get (fd, this, &value) || !value)
+                return;
+        ctx = (dht_fd_ctx_t *) (long) value;
+
+        LOCK (&ctx->lock);
+        {
+                if (yoff && (yoff == ctx->expect))
+                        goto unlock;
+
+                ctx->gen++;
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (ctx->bufs[i].state != DHT_RDBUF_READY)
+                                continue;
+                        gf_dirent_free (&ctx->bufs[i].entries);
+                        ctx->bufs[i].state = DHT_RDBUF_EMPTY;
+                }
+        }
+unlock:
+        UNLOCK (&ctx->lock);
+}
+
+
+/* where the reader of @fd continues if it does not seek */
+static void
+dht_readdirp_prefetch_expect (xlator_t *this, fd_t *fd, gf_dirent_t *entries)
+{
+        dht_fd_ctx_t *ctx   = NULL;
+        gf_dirent_t  *last  = NULL;
+        uint64_t      value = 0;
+
+        if (list_empty (&entries->list) ||
+            fd_ctx_get (fd, this, &value) || !value)
+                return;
+        ctx = (dht_fd_ctx_t *) (long) value;
+
+        last = list_entry (entries->list.prev, gf_dirent_t, list);
+
+        LOCK (&ctx->lock);
+        {
+                ctx->expect = last->d_off;
+        }
+        UNLOCK (&ctx->lock);
+}
+
+
+int
+dht_releasedir (xlator_t *this, fd_t *fd)
+{
+        dht_conf_t   *conf  = NULL;
+        dht_fd_ctx_t *ctx   = NULL;
+        uint64_t      value = 0;
+        int           i     = 0;
+
+        conf = this->private;
+
+        if (fd_ctx_del (fd, this, &value) || !value)
+                return 0;
+        ctx = (dht_fd_ctx_t *) (long) value;
+
+        /* reads in flight hold a ref on the fd, none is left */
+        for (i = 0; conf && (i < conf->subvolume_cnt); i++)
+                gf_dirent_free (&ctx->bufs[i].entries);
+
+        LOCK_DESTROY (&ctx->lock);
+        GF_FREE (ctx);
+
+        return 0;
+}
+
+
+int dht_readdirp_wind (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                       off_t offset);
+
+int
+dht_readdirp_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int op_ret, int op_errno, gf_dirent_t *orig_entries,
+                           dict_t *xdata);
+
+
+static void
+dht_readdirp_prefetch (call_frame_t *frame, xlator_t *this, dht_fd_ctx_t *ctx,
+                       int idx, off_t offset)
+{
+        dht_conf_t       *conf   = NULL;
+        dht_local_t      *local  = NULL;
+        dht_local_t      *plocal = NULL;
+        call_frame_t     *pframe = NULL;
+        call_frame_t     *waiter = NULL;
+        dht_readdir_buf_t *buf   = NULL;
+        xlator_t         *subvol = NULL;
+        gf_boolean_t      start  = _gf_false;
+
+        conf = this->private;
+        local = frame->local;
+        subvol = conf->subvolumes[idx];
+        buf = &ctx->bufs[idx];
+
+        if (!conf->subvolume_status[idx])
+                return;
+
+        LOCK (&ctx->lock);
+        {
+                if ((buf->state == DHT_RDBUF_INFLIGHT) ||
+                    ((buf->state == DHT_RDBUF_READY) &&
+                     (buf->offset == offset)))
+                        goto unlock;
+
+                /* left over from an earlier position in the directory */
+                gf_dirent_free (&buf->entries);
+
+                buf->state = DHT_RDBUF_INFLIGHT;
+                buf->gen = ctx->gen;
+                buf->offset = offset;
+                buf->size = local->size;
+                start = _gf_true;
+        }
+unlock:
+        UNLOCK (&ctx->lock);
+
+        if (!start)
+                return;
+
+        pframe = copy_frame (frame);
+        if (!pframe)
+                goto err;
+
+        plocal = dht_local_init (pframe, NULL, local->fd, GF_FOP_READDIRP);
+        if (!plocal)
+                goto err;
+
+        plocal->size = local->size;
+        plocal->first_up_subvol = local->first_up_subvol;
+        if (local->xattr)
+                plocal->xattr = dict_copy_with_ref (local->xattr, NULL);
+        dht_readdirp_set_skip_dirs (this, plocal, subvol);
+
+        STACK_WIND (pframe, dht_readdirp_prefetch_cbk,
+                    subvol, subvol->fops->readdirp,
+                    plocal->fd, plocal->size, offset, plocal->xattr);
+        return;
+
+err:
+        if (pframe)
+                DHT_STACK_DESTROY (pframe);
+
+        LOCK (&ctx->lock);
+        {
+                buf->state = DHT_RDBUF_EMPTY;
+                waiter = buf->waiter;
+                buf->waiter = NULL;
+        }
+        UNLOCK (&ctx->lock);
+
+        if (waiter)
+                dht_readdirp_wind (waiter, this, subvol, offset);
+}
+
+
+static void
+dht_readdirp_prefetch_ahead (call_frame_t *frame, xlator_t *this,
+                             xlator_t *subvol, off_t last_offset)
+{
+        dht_conf_t   *conf  = NULL;
+        dht_local_t  *local = NULL;
+        dht_fd_ctx_t *ctx   = NULL;
+        int           idx   = 0;
+        int           i     = 0;
+
+        conf = this->private;
+        local = frame->local;
+
+        if (!conf->readdir_prefetch)
+                return;
+
+        idx = dht_subvol_cnt (this, subvol);
+        if (idx < 0)
+                return;
+
+        ctx = dht_fd_ctx_readdir_get (this, local->fd);
+        if (!ctx)
+                return;
+
+        if (last_offset)
+                dht_readdirp_prefetch (frame, this, ctx, idx, last_offset);
+
+        for (i = idx + 1; (i < conf->subvolume_cnt) &&
+                     (i <= idx + conf->readdir_prefetch); i++)
+                dht_readdirp_prefetch (frame, this, ctx, i, 0);
+}
+
+
+/* Hand one subvolume's (filtered) entries back, or move on to the next
+   subvolume when there are none. Takes over @entries. */
+static int
+dht_readdirp_reply (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                    int op_ret, int op_errno, gf_dirent_t *entries,
+                    int count, off_t next_offset, off_t last_offset)
+{
+        dht_conf_t   *conf = NULL;
+        dht_local_t  *local = NULL;
+        xlator_t     *next_subvol = NULL;
+
+        conf = this->private;
+        local = frame->local;
+
+        if (op_ret < 0)
+                goto done;
+
         op_ret = count;
         /* We need to ensure that only the last subvolume's end-of-directory
          * notification is respected so that directory reading does not stop
@@ -3133,7 +3594,7 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
          * distribute we're not concerned only with a posix's view of the
          * directory but the aggregated namespace' view of the directory.
          */
-        if (prev->this != dht_last_up_subvol (this))
+        if (subvol != dht_last_up_subvol (this))
                 op_errno = 0;
 
 done:
@@ -3142,43 +3603,213 @@ done:
                    EOF is not yet hit on the current subvol
                 */
                 if (next_offset == 0) {
-                        next_subvol = dht_subvol_next (this, prev->this);
+                        next_subvol = dht_subvol_next (this, subvol);
                 } else {
-                        next_subvol = prev->this;
+                        next_subvol = subvol;
                 }
 
                 if (!next_subvol) {
                         goto unwind;
                 }
 
-		if (conf->readdir_optimize == _gf_true) {
-                        if (next_subvol != local->first_up_subvol) {
-                                ret = dict_set_int32 (local->xattr,
-                                                      GF_READDIR_SKIP_DIRS, 1);
-                                if (ret)
-                                        gf_log (this->name, GF_LOG_ERROR,
-					         "dict set failed");
-		        } else {
-                                 dict_del (local->xattr,
-                                           GF_READDIR_SKIP_DIRS);
-                        }
-                }
-
-                STACK_WIND (frame, dht_readdirp_cbk,
-                            next_subvol, next_subvol->fops->readdirp,
-                            local->fd, local->size, next_offset,
-                            local->xattr);
+                dht_readdirp_wind (frame, this, next_subvol, next_offset);
                 return 0;
         }
 
+        dht_readdirp_prefetch_ahead (frame, this, subvol, last_offset);
+
+        if (conf->readdir_prefetch)
+                dht_readdirp_prefetch_expect (this, local->fd, entries);
+
 unwind:
         if (op_ret < 0)
                 op_ret = 0;
 
-        DHT_STACK_UNWIND (readdirp, frame, op_ret, op_errno, &entries, NULL);
+        DHT_STACK_UNWIND (readdirp, frame, op_ret, op_errno, entries, NULL);
+
+        gf_dirent_free (entries);
+
+        return 0;
+}
+
+
+int
+dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                  int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+{
+        dht_local_t  *local = NULL;
+        gf_dirent_t   entries;
+        call_frame_t *prev = NULL;
+        off_t         next_offset = 0;
+        off_t         last_offset = 0;
+        int           count = 0;
+
+        INIT_LIST_HEAD (&entries.list);
+        prev = cookie;
+        local = frame->local;
+
+        if (op_ret < 0)
+                goto reply;
+
+        count = dht_readdirp_filter (this, local, prev->this, orig_entries,
+                                     &entries, &next_offset, &last_offset);
+        if (count < 0) {
+                DHT_STACK_UNWIND (readdirp, frame, op_ret, op_errno, &entries,
+                                  NULL);
+                gf_dirent_free (&entries);
+                return 0;
+        }
+
+reply:
+        return dht_readdirp_reply (frame, this, prev->this, op_ret, op_errno,
+                                   &entries, count, next_offset, last_offset);
+}
+
+
+int
+dht_readdirp_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int op_ret, int op_errno, gf_dirent_t *orig_entries,
+                           dict_t *xdata)
+{
+        dht_local_t       *local = NULL;
+        dht_fd_ctx_t      *ctx   = NULL;
+        dht_readdir_buf_t *buf   = NULL;
+        call_frame_t      *prev  = NULL;
+        call_frame_t      *waiter = NULL;
+        gf_dirent_t        entries;
+        off_t              next_offset = 0;
+        off_t              last_offset = 0;
+        int                count = 0;
+        int                idx = 0;
+
+        INIT_LIST_HEAD (&entries.list);
+        prev = cookie;
+        local = frame->local;
+
+        idx = dht_subvol_cnt (this, prev->this);
+        ctx = dht_fd_ctx_readdir_get (this, local->fd);
+        if ((idx < 0) || !ctx)
+                goto out;
+        buf = &ctx->bufs[idx];
+
+        if (op_ret >= 0) {
+                count = dht_readdirp_filter (this, local, prev->this,
+                                             orig_entries, &entries,
+                                             &next_offset, &last_offset);
+                if (count < 0) {
+                        gf_dirent_free (&entries);
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        count = 0;
+                }
+        }
+
+        LOCK (&ctx->lock);
+        {
+                waiter = buf->waiter;
+                buf->waiter = NULL;
+                /* read for a position the reader has since left */
+                if (waiter || (op_ret < 0) || (buf->gen != ctx->gen)) {
+                        buf->state = DHT_RDBUF_EMPTY;
+                        goto unlock;
+                }
+
+                list_splice_init (&entries.list, &buf->entries.list);
+                buf->op_ret = op_ret;
+                buf->op_errno = op_errno;
+                buf->count = count;
+                buf->next_offset = next_offset;
+                buf->last_offset = last_offset;
+                buf->state = DHT_RDBUF_READY;
+        }
+unlock:
+        UNLOCK (&ctx->lock);
+
+        if (waiter) {
+                /* a failed read-ahead is retried on behalf of the reader */
+                if (op_ret < 0)
+                        dht_readdirp_wind (waiter, this, prev->this,
+                                           buf->offset);
+                else
+                        dht_readdirp_reply (waiter, this, prev->this, op_ret,
+                                            op_errno, &entries, count,
+                                            next_offset, last_offset);
+        }
 
+out:
         gf_dirent_free (&entries);
+        DHT_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+int
+dht_readdirp_wind (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                   off_t offset)
+{
+        dht_conf_t        *conf   = NULL;
+        dht_local_t       *local  = NULL;
+        dht_fd_ctx_t      *ctx    = NULL;
+        dht_readdir_buf_t *buf    = NULL;
+        gf_dirent_t        entries;
+        int                idx    = 0;
+        int                served = 0;
+        int                parked = 0;
+        int                op_ret = 0;
+        int                op_errno = 0;
+        int                count = 0;
+        off_t              next_offset = 0;
+        off_t              last_offset = 0;
+
+        conf = this->private;
+        local = frame->local;
+        INIT_LIST_HEAD (&entries.list);
+
+        if (conf->readdir_prefetch)
+                ctx = dht_fd_ctx_readdir_get (this, local->fd);
+
+        idx = dht_subvol_cnt (this, subvol);
+        if (!ctx || (idx < 0))
+                goto wind;
+
+        buf = &ctx->bufs[idx];
+        LOCK (&ctx->lock);
+        {
+                if ((buf->offset != offset) || (buf->size > local->size))
+                        goto unlock;
+
+                if (buf->state == DHT_RDBUF_READY) {
+                        list_splice_init (&buf->entries.list, &entries.list);
+                        op_ret = buf->op_ret;
+                        op_errno = buf->op_errno;
+                        count = buf->count;
+                        next_offset = buf->next_offset;
+                        last_offset = buf->last_offset;
+                        buf->state = DHT_RDBUF_EMPTY;
+                        served = 1;
+                } else if ((buf->state == DHT_RDBUF_INFLIGHT) &&
+                           (buf->gen == ctx->gen) && !buf->waiter) {
+                        buf->waiter = frame;
+                        parked = 1;
+                }
+        }
+unlock:
+        UNLOCK (&ctx->lock);
+
+        if (served)
+                return dht_readdirp_reply (frame, this, subvol, op_ret,
+                                           op_errno, &entries, count,
+                                           next_offset, last_offset);
+        if (parked)
+                return 0;
 
+wind:
+        dht_readdirp_set_skip_dirs (this, local, subvol);
+
+        STACK_WIND (frame, dht_readdirp_cbk,
+                    subvol, subvol->fops->readdirp,
+                    local->fd, local->size, offset, local->xattr);
         return 0;
 }
 
@@ -3317,6 +3948,9 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 else
                         local->xattr = dict_new ();
 
+                if (conf->readdir_prefetch)
+                        dht_readdirp_prefetch_check (this, fd, yoff);
+
                 if (local->xattr) {
                         ret = dict_set_uint32 (local->xattr,
                                                "trusted.glusterfs.dht.linkto",
@@ -3325,23 +3959,9 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                                 gf_log (this->name, GF_LOG_WARNING,
                                         "failed to set 'glusterfs.dht.linkto'"
                                         " key");
-			if (conf->readdir_optimize == _gf_true) {
-                                if (xvol != local->first_up_subvol) {
-				        ret = dict_set_int32 (local->xattr,
-			                               GF_READDIR_SKIP_DIRS, 1);
-				        if (ret)
-					        gf_log (this->name,
-                                                        GF_LOG_ERROR,
-						        "Dict set failed");
-                                } else {
-                                        dict_del (local->xattr,
-                                                  GF_READDIR_SKIP_DIRS);
-                                }
-			}
                 }
 
-                STACK_WIND (frame, dht_readdirp_cbk, xvol, xvol->fops->readdirp,
-                            fd, size, xoff, local->xattr);
+                dht_readdirp_wind (frame, this, xvol, xoff);
         } else {
                 STACK_WIND (frame, dht_readdir_cbk, xvol, xvol->fops->readdir,
                             fd, size, xoff, local->xattr);
@@ -3494,6 +4114,8 @@ dht_newfile_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                            preparent, 0);
                 dht_inode_ctx_time_update (local->loc.parent, this,
                                            postparent, 1);
+                dht_nlc_invalidate (this, local->loc.parent,
+                                    local->loc.name);
         }
 
         ret = dht_layout_preset (this, prev, inode);
@@ -3775,6 +4397,8 @@ dht_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                            preparent, 0);
                 dht_inode_ctx_time_update (local->loc.parent, this,
                                            postparent, 1);
+                dht_nlc_invalidate (this, local->loc.parent,
+                                    local->loc.name);
         }
         if (local->linked == _gf_true) {
                 local->stbuf = *stbuf;
@@ -3912,6 +4536,8 @@ dht_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
                 dht_inode_ctx_time_update (local->loc.parent, this,
                                            postparent, 1);
+                dht_nlc_invalidate (this, local->loc.parent,
+                                    local->loc.name);
         }
 
         ret = dht_layout_preset (this, prev->this, inode);
@@ -4184,6 +4810,8 @@ dht_mkdir_hashed_cbk (call_frame_t *frame, void *cookie,
         }
         local->op_ret = 0;
 
+        dht_nlc_invalidate (this, local->loc.parent, local->loc.name);
+
         dht_iatt_merge (this, &local->stbuf, stbuf, prev->this);
         dht_iatt_merge (this, &local->preparent, preparent, prev->this);
         dht_iatt_merge (this, &local->postparent, postparent, prev->this);
@@ -4983,6 +5611,8 @@ dht_forget (xlator_t *this, inode_t *inode)
         layout = ctx->layout;
         ctx->layout = NULL;
         dht_layout_unref (this, layout);
+        dht_nlc_forget (this, ctx);
+        dht_rename_map_release (ctx);
         GF_FREE (ctx);
 
         return 0;
@@ -5095,6 +5725,8 @@ dht_notify (xlator_t *this, int event, void *data, ...)
                         conf->subvolume_status[cnt] = 0;
                         conf->last_event[cnt] = event;
                         conf->subvol_up_time[cnt] = 0;
+                        /* pushes may be missed until it is back up */
+                        conf->du_stats[cnt].pushed = _gf_false;
                 }
                 UNLOCK (&conf->subvolume_lock);
 
@@ -5154,6 +5786,17 @@ unlock:
                 break;
         }
 
+        case GF_EVENT_STATFS_PUSH:
+        {
+                gf_statfs_push_t *push = data;
+
+                /* ours alone, the xlators above have no use for it */
+                if (push)
+                        dht_du_info_update (this, push->subvol, &push->buf,
+                                            _gf_true);
+                return 0;
+        }
+
         default:
                 propagate = 1;
                 break;
@@ -45,6 +45,12 @@ struct dht_layout {
         int                type;
         int                ref; /* use with dht_conf_t->layout_lock */
         int                search_unhashed;
+        /* search index built when the layout is set on an inode:
+           the range starts in ascending order, and the list[] entry
+           each belongs to, so that dht_layout_search can bisect */
+        int                search_cnt;
+        uint32_t          *search_start;
+        int               *search_idx;
         struct {
                 int        err;   /* 0 = normal
                                      -1 = dir exists and no xattr
@@ -68,14 +74,76 @@ struct dht_stat_time {
 
 typedef struct dht_stat_time dht_stat_time_t;
 
+/* negative lookup cache: names a lookup recently found missing in a
+   directory, dropped when the directory's layout generation or mtime moves
+   on, when they expire, or when a name is created through this client */
+#define DHT_NLC_BUCKETS 64
+
+struct dht_nlc_dir {
+        struct list_head     names[DHT_NLC_BUCKETS];
+        struct dht_inode_ctx *ctx;    /* owner, whose nlc points here */
+        int                  count;
+        int                  gen;     /* conf->gen of the cached misses */
+        uint32_t             mtime;
+        uint32_t             mtime_nsec;
+};
+typedef struct dht_nlc_dir dht_nlc_dir_t;
+
+struct dht_nlc_entry {
+        struct list_head  bucket;
+        struct list_head  lru;
+        dht_nlc_dir_t    *dir;
+        time_t            expires;
+        size_t            size;       /* whole allocation, name included */
+        char              name[];
+};
+typedef struct dht_nlc_entry dht_nlc_entry_t;
+
 struct dht_inode_ctx {
         dht_layout_t    *layout;
         dht_stat_time_t  time;
+        /* both under conf->nlc_lock */
+        dht_nlc_dir_t   *nlc;
+        uint32_t         nlc_gen;     /* bumped on every invalidation */
+        /* rename map of a directory, under inode->lock */
+        data_t          *renames;
 };
 
 typedef struct dht_inode_ctx dht_inode_ctx_t;
 
 
+/* readdirp read-ahead of one subvolume, see readdir-prefetch */
+enum {
+        DHT_RDBUF_EMPTY,
+        DHT_RDBUF_INFLIGHT,
+        DHT_RDBUF_READY,
+};
+
+struct dht_readdir_buf {
+        int               state;
+        off_t             offset;      /* subvolume offset it was read at */
+        uint32_t          gen;         /* of the fd context, when started */
+        size_t            size;
+        int               op_ret;
+        int               op_errno;
+        int               count;
+        off_t             next_offset;
+        off_t             last_offset;
+        gf_dirent_t       entries;
+        call_frame_t     *waiter;      /* readdirp waiting for this read */
+};
+typedef struct dht_readdir_buf dht_readdir_buf_t;
+
+/* fd context of a directory */
+struct dht_fd_ctx {
+        gf_lock_t          lock;
+        uint32_t           gen;        /* bumped when the reader seeks */
+        off_t              expect;     /* d_off a sequential reader asks
+                                          for next */
+        dht_readdir_buf_t  bufs[];     /* one per subvolume */
+};
+typedef struct dht_fd_ctx dht_fd_ctx_t;
+
 typedef enum {
         DHT_HASH_TYPE_DM,
         DHT_HASH_TYPE_DM_USER,
@@ -183,6 +251,13 @@ struct dht_local {
         struct dht_rebalance_ rebalance;
         xlator_t        *first_up_subvol;
 
+        /* negative lookup cache generation of the parent at wind time */
+        gf_boolean_t     nlc_check;
+        uint32_t         nlc_gen;
+
+        /* rename map of a directory, as its holder returned it */
+        gf_boolean_t     rename_map_seen;
+        data_t          *rename_map;
 };
 typedef struct dht_local dht_local_t;
 
@@ -191,7 +266,10 @@ struct dht_du {
         double   avail_percent;
 	double   avail_inodes;
         uint64_t avail_space;
+        uint64_t total_space;
         uint32_t log;
+        struct statvfs statvfs;  /* as last reported by the subvolume */
+        gf_boolean_t   pushed;   /* it pushes changes, statvfs is current */
 };
 typedef struct dht_du dht_du_t;
 
@@ -233,6 +311,15 @@ struct gf_defrag_info_ {
         struct timeval               start_time;
         gf_boolean_t                 stats;
 
+        /* parallel migration */
+        uint32_t                     workers_max;
+        uint32_t                     pipeline_depth;
+        uint32_t                     latency_target; /* msecs, 0 = off */
+        uint32_t                     workers;     /* current, adaptive */
+        double                       latency;     /* usecs per chunk */
+
+        /* list the local bricks instead of crawling the namespace */
+        gf_boolean_t                 brick_crawl;
 };
 
 typedef struct gf_defrag_info_ gf_defrag_info_t;
@@ -277,6 +364,24 @@ struct dht_conf {
         /* Request to filter directory entries in readdir request */
 
         gf_boolean_t    readdir_optimize;
+
+        /* subvolumes read ahead of the one being listed */
+        uint32_t        readdir_prefetch;
+
+        /* size hash ranges by the total space of the subvolumes */
+        gf_boolean_t    do_weighting;
+
+        /* negative lookup cache */
+        gf_boolean_t     nlc_enabled;
+        uint32_t         nlc_timeout;
+        uint64_t         nlc_limit;
+        uint64_t         nlc_size;
+        uint64_t         nlc_hits;
+        struct list_head nlc_lru;
+        gf_lock_t        nlc_lock;
+
+        /* bytes of rename map a directory may hold, 0 uses linkfiles */
+        uint64_t         rename_map_size;
 };
 typedef struct dht_conf dht_conf_t;
 
@@ -310,6 +415,13 @@ typedef enum {
 #define DHT_LINKFILE_KEY         "trusted.glusterfs.dht.linkto"
 #define DHT_LINKFILE_MODE        (S_ISVTX)
 
+/* rename map: files renamed in place, on a subvolume other than the one
+   their new name hashes to, listed on their directory as
+   "<subvolume>\0<name>\0" pairs instead of getting a linkfile. one
+   subvolume, picked by the gfid of the directory, holds it. */
+#define DHT_RENAME_MAP_KEY       "trusted.glusterfs.dht.renames"
+#define DHT_RENAME_MAP_DOMAIN    "dht.rename-map"
+
 #define check_is_linkfile(i,s,x) (                                      \
                 ((st_mode_from_ia ((s)->ia_prot, (s)->ia_type) & ~S_IFMT) \
                  == DHT_LINKFILE_MODE) &&                               \
@@ -446,9 +558,13 @@ gf_boolean_t dht_is_subvol_filled (xlator_t *this, xlator_t *subvol);
 xlator_t *dht_free_disk_available_subvol (xlator_t *this, xlator_t *subvol,
                                           dht_local_t *layout);
 int       dht_get_du_info_for_subvol (xlator_t *this, int subvol_idx);
+void      dht_du_info_update (xlator_t *this, xlator_t *subvol,
+                              struct statvfs *statvfs, gf_boolean_t pushed);
 
 int dht_layout_preset (xlator_t *this, xlator_t *subvol, inode_t *inode);
 int           dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout);;
+void          dht_layout_search_build (dht_layout_t *layout);
+int           dht_layout_ranges_equal (dht_layout_t *one, dht_layout_t *two);
 void          dht_layout_unref (xlator_t *this, dht_layout_t *layout);
 dht_layout_t *dht_layout_ref (xlator_t *this, dht_layout_t *layout);
 xlator_t     *dht_first_up_subvol (xlator_t *this);
@@ -503,6 +619,40 @@ int32_t dht_ftruncate (call_frame_t *frame,
                        fd_t     *fd,
                        off_t     offset, dict_t *xdata);
 
+int32_t dht_fallocate (call_frame_t *frame,
+                       xlator_t *this,
+                       fd_t     *fd,
+                       int32_t   mode,
+                       off_t     offset,
+                       size_t    len, dict_t *xdata);
+
+int32_t dht_discard (call_frame_t *frame,
+                     xlator_t *this,
+                     fd_t     *fd,
+                     off_t     offset,
+                     size_t    len, dict_t *xdata);
+
+int32_t dht_zerofill (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t     *fd,
+                      off_t     offset,
+                      size_t    len, dict_t *xdata);
+
+int32_t dht_copy_file_range (call_frame_t *frame,
+                             xlator_t *this,
+                             fd_t     *fd_in,
+                             off_t     off_in,
+                             fd_t     *fd_out,
+                             off_t     off_out,
+                             size_t    len,
+                             uint32_t  flags, dict_t *xdata);
+
+int32_t dht_seek (call_frame_t *frame,
+                  xlator_t *this,
+                  fd_t     *fd,
+                  off_t     offset,
+                  gf_seek_what_t what, dict_t *xdata);
+
 int32_t dht_access (call_frame_t *frame,
                     xlator_t *this,
                     loc_t    *loc,
@@ -723,6 +873,14 @@ dht_inode_ctx_time_update (inode_t *inode, xlator_t *this, struct iatt *stat,
 
 int dht_inode_ctx_get (inode_t *inode, xlator_t *this, dht_inode_ctx_t **ctx);
 int dht_inode_ctx_set (inode_t *inode, xlator_t *this, dht_inode_ctx_t *ctx);
+
+void dht_nlc_record (xlator_t *this, dht_local_t *local);
+gf_boolean_t dht_nlc_lookup (xlator_t *this, loc_t *loc);
+void dht_nlc_add (xlator_t *this, dht_local_t *local);
+void dht_nlc_invalidate (xlator_t *this, inode_t *parent, const char *name);
+void dht_nlc_forget (xlator_t *this, dht_inode_ctx_t *ctx);
+
+int dht_releasedir (xlator_t *this, fd_t *fd);
 int
 dht_dir_attr_heal (void *data);
 int
@@ -740,4 +898,14 @@ dht_subvol_maxspace_nonzeroinode (xlator_t *this, xlator_t *subvol,
                                   dht_layout_t *layout);
 int
 dht_linkfile_attr_heal (call_frame_t *frame, xlator_t *this);
+
+xlator_t *dht_rename_map_subvol (xlator_t *this, uuid_t gfid);
+xlator_t *dht_rename_map_get (xlator_t *this, inode_t *parent,
+                              const char *name);
+void dht_rename_map_capture (xlator_t *this, dht_local_t *local,
+                             xlator_t *subvol, struct iatt *stbuf,
+                             dict_t *xattr);
+void dht_rename_map_apply (xlator_t *this, dht_local_t *local);
+void dht_rename_map_forget (xlator_t *this, loc_t *loc);
+void dht_rename_map_release (dht_inode_ctx_t *ctx);
 #endif/* _DHT_H */
@@ -24,34 +24,30 @@
 #include <sys/time.h>
 
 
-int
-dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
-		 int op_ret, int op_errno, struct statvfs *statvfs,
-                 dict_t *xdata)
+/* records the usage of a subvolume, either answered to our statfs or
+ * pushed by its bricks. 'pushed' says whether the bricks keep us posted,
+ * in which case we stop asking them.
+ */
+void
+dht_du_info_update (xlator_t *this, xlator_t *subvol, struct statvfs *statvfs,
+		    gf_boolean_t pushed)
 {
 	dht_conf_t    *conf         = NULL;
-	call_frame_t  *prev          = NULL;
-	int            this_call_cnt = 0;
 	int            i = 0;
 	double         percent = 0;
 	double         percent_inodes = 0;
 	uint64_t       bytes = 0;
+	uint64_t       total = 0;
 
 	conf = this->private;
-	prev = cookie;
 
-	if (op_ret == -1) {
-		gf_log (this->name, GF_LOG_WARNING,
-			"failed to get disk info from %s", prev->this->name);
-		goto out;
-	}
-
-	if (statvfs && statvfs->f_blocks) {
+	if (statvfs->f_blocks) {
 		percent = (statvfs->f_bavail * 100) / statvfs->f_blocks;
 		bytes = (statvfs->f_bavail * statvfs->f_frsize);
+		total = (statvfs->f_blocks * statvfs->f_frsize);
 	}
 
-	if (statvfs && statvfs->f_files) {
+	if (statvfs->f_files) {
 		percent_inodes = (statvfs->f_ffree * 100) / statvfs->f_files;
 	} else {
 		/* set percent inodes to 100 for dynamically allocated inode filesystems
@@ -66,21 +62,47 @@ dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 	LOCK (&conf->subvolume_lock);
 	{
 		for (i = 0; i < conf->subvolume_cnt; i++)
-			if (prev->this == conf->subvolumes[i]) {
+			if (subvol == conf->subvolumes[i]) {
 				conf->du_stats[i].avail_percent = percent;
 				conf->du_stats[i].avail_space   = bytes;
+				conf->du_stats[i].total_space   = total;
 				conf->du_stats[i].avail_inodes  = percent_inodes;
+				conf->du_stats[i].statvfs       = *statvfs;
+				conf->du_stats[i].pushed        = pushed;
 				gf_log (this->name, GF_LOG_DEBUG,
 					"on subvolume '%s': avail_percent is: "
 					"%.2f and avail_space is: %"PRIu64" "
-					"and avail_inodes is: %.2f",
-					prev->this->name,
+					"and avail_inodes is: %.2f%s",
+					subvol->name,
 					conf->du_stats[i].avail_percent,
 					conf->du_stats[i].avail_space,
-					conf->du_stats[i].avail_inodes);
+					conf->du_stats[i].avail_inodes,
+					pushed ? " (pushed)" : "");
 			}
 	}
 	UNLOCK (&conf->subvolume_lock);
+}
+
+int
+dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+		 int op_ret, int op_errno, struct statvfs *statvfs,
+                 dict_t *xdata)
+{
+	call_frame_t  *prev          = NULL;
+	int            this_call_cnt = 0;
+
+	prev = cookie;
+
+	if (op_ret == -1) {
+		gf_log (this->name, GF_LOG_WARNING,
+			"failed to get disk info from %s", prev->this->name);
+		goto out;
+	}
+
+	if (statvfs)
+		dht_du_info_update (this, prev->this, statvfs,
+				    (xdata && dict_get (xdata,
+							GF_STATFS_PUSH_KEY)));
 
 out:
 	this_call_cnt = dht_frame_return (frame);
@@ -131,55 +153,43 @@ err:
 	return -1;
 }
 
+/* refreshes the usage of the subvolumes whose bricks do not push it to
+ * us, at most once every refresh_interval seconds.
+ */
 int
 dht_get_du_info (call_frame_t *frame, xlator_t *this, loc_t *loc)
 {
 	int            i            = 0;
+	int            ret          = 0;
 	dht_conf_t    *conf         = NULL;
-	call_frame_t  *statfs_frame = NULL;
-	dht_local_t   *statfs_local = NULL;
 	struct timeval tv           = {0,};
-        loc_t          tmp_loc      = {0,};
+	gf_boolean_t   pushed       = _gf_false;
 
 	conf  = this->private;
 
 	gettimeofday (&tv, NULL);
 
-        /* make it root gfid, should be enough to get the proper
-           info back */
-        tmp_loc.gfid[15] = 1;
-
 	if (tv.tv_sec > (conf->refresh_interval
 			 + conf->last_stat_fetch.tv_sec)) {
 
-		statfs_frame = copy_frame (frame);
-		if (!statfs_frame) {
-			goto err;
-		}
+		for (i = 0; i < conf->subvolume_cnt; i++) {
+			LOCK (&conf->subvolume_lock);
+			{
+				pushed = conf->du_stats[i].pushed;
+			}
+			UNLOCK (&conf->subvolume_lock);
 
-		/* In this case, 'local->fop' is not used */
-		statfs_local = dht_local_init (statfs_frame, loc, NULL,
-					       GF_FOP_MAXVALUE);
-		if (!statfs_local) {
-			goto err;
-		}
+			if (pushed)
+				continue;
 
-		statfs_local->call_cnt = conf->subvolume_cnt;
-		for (i = 0; i < conf->subvolume_cnt; i++) {
-			STACK_WIND (statfs_frame, dht_du_info_cbk,
-				    conf->subvolumes[i],
-				    conf->subvolumes[i]->fops->statfs,
-				    &tmp_loc, NULL);
+			if (dht_get_du_info_for_subvol (this, i))
+				ret = -1;
 		}
 
 		conf->last_stat_fetch.tv_sec = tv.tv_sec;
 	}
-	return 0;
-err:
-	if (statfs_frame)
-		DHT_STACK_DESTROY (statfs_frame);
 
-	return -1;
+	return ret;
 }
 
 
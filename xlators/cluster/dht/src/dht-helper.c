@@ -16,6 +16,7 @@
 
 #include "glusterfs.h"
 #include "xlator.h"
+#include "hashfn.h"
 #include "dht-common.h"
 
 
@@ -285,6 +286,9 @@ dht_local_wipe (xlator_t *this, dht_local_t *local)
 
         GF_FREE (local->key);
 
+        if (local->rename_map)
+                data_unref (local->rename_map);
+
         GF_FREE (local->rebalance.vector);
 
         if (local->rebalance.iobref)
@@ -1076,3 +1080,323 @@ int dht_inode_ctx_set (inode_t *inode, xlator_t *this, dht_inode_ctx_t *ctx)
 out:
         return ret;
 }
+
+
+#define dht_nlc_bucket(name) (SuperFastHash (name, strlen (name))       \
+                              % DHT_NLC_BUCKETS)
+
+static void
+__dht_nlc_entry_del (dht_conf_t *conf, dht_nlc_entry_t *entry)
+{
+        list_del (&entry->bucket);
+        list_del (&entry->lru);
+        entry->dir->count--;
+        conf->nlc_size -= entry->size;
+        GF_FREE (entry);
+}
+
+
+/* a directory's cache is charged against nlc_limit like its entries, so
+   it is freed as soon as it holds none */
+static void
+__dht_nlc_dir_release (dht_conf_t *conf, dht_nlc_dir_t *dir)
+{
+        if (dir->count)
+                return;
+
+        dir->ctx->nlc = NULL;
+        conf->nlc_size -= sizeof (*dir);
+        GF_FREE (dir);
+}
+
+
+static void
+__dht_nlc_dir_purge (dht_conf_t *conf, dht_nlc_dir_t *dir)
+{
+        dht_nlc_entry_t *entry = NULL;
+        dht_nlc_entry_t *tmp   = NULL;
+        int              i     = 0;
+
+        for (i = 0; i < DHT_NLC_BUCKETS; i++) {
+                list_for_each_entry_safe (entry, tmp, &dir->names[i], bucket)
+                        __dht_nlc_entry_del (conf, entry);
+        }
+}
+
+
+static dht_nlc_entry_t *
+__dht_nlc_dir_find (dht_nlc_dir_t *dir, const char *name, int idx)
+{
+        dht_nlc_entry_t *entry = NULL;
+
+        list_for_each_entry (entry, &dir->names[idx], bucket) {
+                if (strcmp (entry->name, name) == 0)
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+static void
+dht_nlc_dir_mtime (inode_t *inode, dht_inode_ctx_t *ctx, uint32_t *mtime,
+                   uint32_t *mtime_nsec)
+{
+        LOCK (&inode->lock);
+        {
+                *mtime = ctx->time.mtime;
+                *mtime_nsec = ctx->time.mtime_nsec;
+        }
+        UNLOCK (&inode->lock);
+}
+
+
+/* Note the parent's invalidation count before a lookup is wound; a miss
+   is only cached if nothing was created under that name meanwhile. */
+void
+dht_nlc_record (xlator_t *this, dht_local_t *local)
+{
+        dht_conf_t      *conf = NULL;
+        dht_inode_ctx_t *ctx  = NULL;
+
+        conf = this->private;
+        local->nlc_check = _gf_false;
+
+        if (!conf->nlc_enabled || !local->loc.parent || !local->loc.name)
+                return;
+
+        if (dht_inode_ctx_get (local->loc.parent, this, &ctx) || !ctx)
+                return;
+
+        LOCK (&conf->nlc_lock);
+        {
+                local->nlc_gen = ctx->nlc_gen;
+        }
+        UNLOCK (&conf->nlc_lock);
+
+        local->nlc_check = _gf_true;
+}
+
+
+gf_boolean_t
+dht_nlc_lookup (xlator_t *this, loc_t *loc)
+{
+        dht_conf_t      *conf       = NULL;
+        dht_inode_ctx_t *ctx        = NULL;
+        dht_nlc_dir_t   *dir        = NULL;
+        dht_nlc_entry_t *entry      = NULL;
+        uint32_t         mtime      = 0;
+        uint32_t         mtime_nsec = 0;
+        int              idx        = 0;
+        gf_boolean_t     hit        = _gf_false;
+
+        conf = this->private;
+
+        if (!conf->nlc_enabled || !loc->parent || !loc->name)
+                return _gf_false;
+
+        if (dht_inode_ctx_get (loc->parent, this, &ctx) || !ctx || !ctx->nlc)
+                return _gf_false;
+
+        dht_nlc_dir_mtime (loc->parent, ctx, &mtime, &mtime_nsec);
+        idx = dht_nlc_bucket (loc->name);
+
+        LOCK (&conf->nlc_lock);
+        {
+                dir = ctx->nlc;
+                if (!dir || !dir->count)
+                        goto unlock;
+
+                if ((dir->gen != conf->gen) || (dir->mtime != mtime) ||
+                    (dir->mtime_nsec != mtime_nsec)) {
+                        __dht_nlc_dir_purge (conf, dir);
+                        __dht_nlc_dir_release (conf, dir);
+                        goto unlock;
+                }
+
+                entry = __dht_nlc_dir_find (dir, loc->name, idx);
+                if (!entry)
+                        goto unlock;
+
+                if (entry->expires <= time (NULL)) {
+                        __dht_nlc_entry_del (conf, entry);
+                        __dht_nlc_dir_release (conf, dir);
+                        goto unlock;
+                }
+
+                list_move (&entry->lru, &conf->nlc_lru);
+                conf->nlc_hits++;
+                hit = _gf_true;
+        }
+unlock:
+        UNLOCK (&conf->nlc_lock);
+
+        return hit;
+}
+
+
+void
+dht_nlc_add (xlator_t *this, dht_local_t *local)
+{
+        dht_conf_t      *conf       = NULL;
+        dht_inode_ctx_t *ctx        = NULL;
+        dht_nlc_dir_t   *dir        = NULL;
+        dht_nlc_entry_t *entry      = NULL;
+        dht_nlc_entry_t *old        = NULL;
+        dht_nlc_dir_t   *victim     = NULL;
+        loc_t           *loc        = NULL;
+        uint32_t         mtime      = 0;
+        uint32_t         mtime_nsec = 0;
+        size_t           len        = 0;
+        size_t           size       = 0;
+        int              idx        = 0;
+        int              i          = 0;
+
+        conf = this->private;
+        loc = &local->loc;
+
+        if (!local->nlc_check || !conf->nlc_enabled || !conf->nlc_timeout)
+                return;
+
+        if (dht_inode_ctx_get (loc->parent, this, &ctx) || !ctx)
+                return;
+
+        len = strlen (loc->name) + 1;
+        size = sizeof (*entry) + len;
+        if (size + sizeof (*dir) > conf->nlc_limit)
+                return;
+
+        entry = GF_CALLOC (1, size, gf_dht_mt_nlc_entry_t);
+        if (!entry)
+                return;
+
+        memcpy (entry->name, loc->name, len);
+        entry->size = size;
+        entry->expires = time (NULL) + conf->nlc_timeout;
+
+        dht_nlc_dir_mtime (loc->parent, ctx, &mtime, &mtime_nsec);
+        idx = dht_nlc_bucket (loc->name);
+
+        LOCK (&conf->nlc_lock);
+        {
+                /* created or renamed into through this client meanwhile */
+                if (ctx->nlc_gen != local->nlc_gen)
+                        goto unlock;
+
+                dir = ctx->nlc;
+                if (!dir) {
+                        dir = GF_CALLOC (1, sizeof (*dir),
+                                         gf_dht_mt_nlc_dir_t);
+                        if (!dir)
+                                goto unlock;
+                        for (i = 0; i < DHT_NLC_BUCKETS; i++)
+                                INIT_LIST_HEAD (&dir->names[i]);
+                        dir->ctx = ctx;
+                        ctx->nlc = dir;
+                        conf->nlc_size += sizeof (*dir);
+                }
+
+                if ((dir->gen != conf->gen) || (dir->mtime != mtime) ||
+                    (dir->mtime_nsec != mtime_nsec)) {
+                        __dht_nlc_dir_purge (conf, dir);
+                        dir->gen = conf->gen;
+                        dir->mtime = mtime;
+                        dir->mtime_nsec = mtime_nsec;
+                }
+
+                old = __dht_nlc_dir_find (dir, loc->name, idx);
+                if (old) {
+                        old->expires = entry->expires;
+                        list_move (&old->lru, &conf->nlc_lru);
+                        goto unlock;
+                }
+
+                while ((conf->nlc_size + size > conf->nlc_limit) &&
+                       !list_empty (&conf->nlc_lru)) {
+                        old = list_entry (conf->nlc_lru.prev,
+                                          dht_nlc_entry_t, lru);
+                        victim = old->dir;
+                        __dht_nlc_entry_del (conf, old);
+                        /* ours gets the new entry below */
+                        if (victim != dir)
+                                __dht_nlc_dir_release (conf, victim);
+                }
+
+                entry->dir = dir;
+                list_add (&entry->bucket, &dir->names[idx]);
+                list_add (&entry->lru, &conf->nlc_lru);
+                dir->count++;
+                conf->nlc_size += size;
+                entry = NULL;
+        }
+unlock:
+        UNLOCK (&conf->nlc_lock);
+
+        GF_FREE (entry);
+}
+
+
+/* @name is (about to be) created in @parent through this client; a NULL
+   @name drops every cached miss of @parent */
+void
+dht_nlc_invalidate (xlator_t *this, inode_t *parent, const char *name)
+{
+        dht_conf_t      *conf  = NULL;
+        dht_inode_ctx_t *ctx   = NULL;
+        dht_nlc_entry_t *entry = NULL;
+        int              idx   = 0;
+
+        conf = this->private;
+
+        if (!parent || dht_inode_ctx_get (parent, this, &ctx) || !ctx)
+                return;
+
+        if (!conf->nlc_enabled && !ctx->nlc)
+                return;
+
+        if (name)
+                idx = dht_nlc_bucket (name);
+
+        LOCK (&conf->nlc_lock);
+        {
+                ctx->nlc_gen++;
+
+                if (!ctx->nlc)
+                        goto unlock;
+
+                if (!name) {
+                        __dht_nlc_dir_purge (conf, ctx->nlc);
+                        __dht_nlc_dir_release (conf, ctx->nlc);
+                        goto unlock;
+                }
+
+                entry = __dht_nlc_dir_find (ctx->nlc, name, idx);
+                if (entry) {
+                        __dht_nlc_entry_del (conf, entry);
+                        __dht_nlc_dir_release (conf, ctx->nlc);
+                }
+        }
+unlock:
+        UNLOCK (&conf->nlc_lock);
+}
+
+
+void
+dht_nlc_forget (xlator_t *this, dht_inode_ctx_t *ctx)
+{
+        dht_conf_t *conf = NULL;
+
+        conf = this->private;
+
+        if (!ctx->nlc || !conf)
+                return;
+
+        LOCK (&conf->nlc_lock);
+        {
+                if (ctx->nlc) {
+                        __dht_nlc_dir_purge (conf, ctx->nlc);
+                        __dht_nlc_dir_release (conf, ctx->nlc);
+                }
+        }
+        UNLOCK (&conf->nlc_lock);
+}
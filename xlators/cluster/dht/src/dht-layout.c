@@ -23,7 +23,10 @@
 
 #define layout_entry_size (sizeof ((dht_layout_t *)NULL)->list[0])
 
-#define layout_size(cnt) (layout_base_size + (cnt * layout_entry_size))
+#define layout_search_size (sizeof (uint32_t) + sizeof (int))
+
+#define layout_size(cnt) (layout_base_size +                            \
+                          (cnt * (layout_entry_size + layout_search_size)))
 
 
 dht_layout_t *
@@ -43,6 +46,8 @@ dht_layout_new (xlator_t *this, int cnt)
 
         layout->type = DHT_HASH_TYPE_DM;
         layout->cnt = cnt;
+        layout->search_start = (uint32_t *) &layout->list[cnt];
+        layout->search_idx = (int *) &layout->search_start[cnt];
 
         if (conf) {
                 layout->spread_cnt = conf->dir_spread_cnt;
@@ -91,6 +96,8 @@ dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout)
         if (!conf)
                 goto out;
 
+        dht_layout_search_build (layout);
+
         LOCK (&conf->layout_lock);
         {
                 oldret = dht_inode_ctx_layout_get (inode, this, &old_layout);
@@ -100,6 +107,11 @@ dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout)
         UNLOCK (&conf->layout_lock);
 
         if (!oldret) {
+                /* misses cached under the old ranges mean nothing now */
+                if (conf->nlc_enabled && old_layout && (old_layout != layout)
+                    && !dht_layout_ranges_equal (old_layout, layout))
+                        dht_nlc_invalidate (this, inode, NULL);
+
                 dht_layout_unref (this, old_layout);
         }
 
@@ -149,6 +161,113 @@ dht_layout_ref (xlator_t *this, dht_layout_t *layout)
 }
 
 
+int
+dht_layout_ranges_equal (dht_layout_t *one, dht_layout_t *two)
+{
+        int i = 0;
+
+        if (one->cnt != two->cnt)
+                return 0;
+
+        for (i = 0; i < one->cnt; i++) {
+                if ((one->list[i].start != two->list[i].start) ||
+                    (one->list[i].stop != two->list[i].stop) ||
+                    (one->list[i].xlator != two->list[i].xlator))
+                        return 0;
+        }
+
+        return 1;
+}
+
+
+static int
+dht_layout_search_cmp (const void *a, const void *b)
+{
+        uint64_t x = *(const uint64_t *) a;
+        uint64_t y = *(const uint64_t *) b;
+
+        return (x > y) - (x < y);
+}
+
+
+/*
+ * Index the ranges of @layout by their start. Empty (0 - 0) ranges are
+ * left out; a layout whose ranges overlap is not indexed at all, since
+ * the first matching entry in list[] order must win and only the linear
+ * scan gives that.
+ */
+void
+dht_layout_search_build (dht_layout_t *layout)
+{
+        uint64_t *keys = NULL;
+        int       cnt = 0;
+        int       i = 0;
+        int       idx = 0;
+
+        if (layout->search_cnt || !layout->search_start)
+                return;
+
+        keys = alloca (layout->cnt * sizeof (*keys));
+
+        for (i = 0; i < layout->cnt; i++) {
+                if ((layout->list[i].start > layout->list[i].stop) ||
+                    (!layout->list[i].start && !layout->list[i].stop))
+                        continue;
+                keys[cnt++] = ((uint64_t) layout->list[i].start << 32) | i;
+        }
+
+        if (!cnt)
+                return;
+
+        qsort (keys, cnt, sizeof (*keys), dht_layout_search_cmp);
+
+        for (i = 0; i < cnt; i++) {
+                idx = (int) (keys[i] & 0xffffffff);
+                if (i && (layout->list[idx].start <=
+                          layout->list[layout->search_idx[i - 1]].stop))
+                        return;
+
+                layout->search_start[i] = layout->list[idx].start;
+                layout->search_idx[i] = idx;
+        }
+
+        layout->search_cnt = cnt;
+}
+
+
+static xlator_t *
+dht_layout_search_index (dht_layout_t *layout, uint32_t hash)
+{
+        int lo = 0;
+        int hi = 0;
+        int mid = 0;
+        int idx = 0;
+
+        hi = layout->search_cnt;
+        if (!hi || !hash)
+                return NULL;
+
+        /* last range starting at or below hash */
+        while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+                if (layout->search_start[mid] <= hash)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        if (!lo)
+                return NULL;
+
+        /* the ranges may have been changed under the index */
+        idx = layout->search_idx[lo - 1];
+        if ((layout->list[idx].start > hash) ||
+            (layout->list[idx].stop < hash))
+                return NULL;
+
+        return layout->list[idx].xlator;
+}
+
+
 xlator_t *
 dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
 {
@@ -166,6 +285,10 @@ dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
                 goto out;
         }
 
+        subvol = dht_layout_search_index (layout, hash);
+        if (subvol)
+                goto out;
+
         for (i = 0; i < layout->cnt; i++) {
                 if (layout->list[i].start <= hash
                     && layout->list[i].stop >= hash) {
@@ -30,6 +30,11 @@ enum gf_dht_mem_types_ {
         gf_defrag_info_mt,
         gf_dht_mt_inode_ctx_t,
         gf_dht_mt_ctx_stat_time_t,
+        gf_dht_mt_nlc_dir_t,
+        gf_dht_mt_nlc_entry_t,
+        gf_dht_mt_fd_ctx_t,
+        gf_dht_mt_migrate_copier_t,
+        gf_dht_mt_defrag_job_t,
         gf_dht_mt_end
 };
 #endif
@@ -403,6 +403,188 @@ out:
         return ret;
 }
 
+/* Feed the time a block took to be read and written into the average
+   the rebalance process throttles its workers on */
+static void
+dht_rebalance_latency_sample (xlator_t *this, struct timeval *start)
+{
+        dht_conf_t       *conf   = NULL;
+        gf_defrag_info_t *defrag = NULL;
+        struct timeval    end    = {0,};
+        double            usecs  = 0;
+
+        conf = this->private;
+        if (!conf || !conf->defrag)
+                return;
+        defrag = conf->defrag;
+
+        gettimeofday (&end, NULL);
+        usecs = (end.tv_sec - start->tv_sec) * 1e6 +
+                (end.tv_usec - start->tv_usec);
+
+        LOCK (&defrag->lock);
+        {
+                if (defrag->latency)
+                        defrag->latency = (defrag->latency * 7 + usecs) / 8;
+                else
+                        defrag->latency = usecs;
+        }
+        UNLOCK (&defrag->lock);
+}
+
+struct dht_migrate_copier {
+        xlator_t      *this;
+        xlator_t      *from;
+        xlator_t      *to;
+        fd_t          *src;
+        fd_t          *dst;
+        uint64_t       ia_size;
+        off_t          start;
+        int            stride;
+        int            ret;
+        syncbarrier_t *barrier;
+};
+typedef struct dht_migrate_copier dht_migrate_copier_t;
+
+/* copies the blocks start, start + stride, start + 2 * stride ... */
+static int
+dht_migrate_copier_task (void *data)
+{
+        dht_migrate_copier_t *copier = data;
+        struct iovec         *vector = NULL;
+        struct iobref        *iobref = NULL;
+        struct timeval        start  = {0,};
+        off_t                 offset = 0;
+        off_t                 end    = 0;
+        size_t                read_size = 0;
+        int                   count  = 0;
+        int                   ret    = 0;
+
+        for (offset = copier->start; offset < copier->ia_size;
+             offset = end + (off_t)(copier->stride - 1) *
+                     DHT_REBALANCE_BLKSIZE) {
+                end = offset + DHT_REBALANCE_BLKSIZE;
+                if (end > copier->ia_size)
+                        end = copier->ia_size;
+
+                /* short reads leave the rest of the block to read */
+                while (offset < end) {
+                        gettimeofday (&start, NULL);
+                        read_size = end - offset;
+                        ret = syncop_readv (copier->from, copier->src,
+                                            read_size, offset, 0, &vector,
+                                            &count, &iobref);
+                        if (ret <= 0)
+                                goto out;
+
+                        ret = syncop_writev (copier->to, copier->dst, vector,
+                                             count, offset, iobref, 0);
+                        GF_FREE (vector);
+                        vector = NULL;
+                        if (iobref)
+                                iobref_unref (iobref);
+                        iobref = NULL;
+                        if (ret < 0)
+                                goto out;
+
+                        offset += ret;
+                        dht_rebalance_latency_sample (copier->this, &start);
+                }
+        }
+out:
+        /* like the serial copy, a read hitting the end of the file is
+           not an error */
+        return (ret < 0) ? -1 : 0;
+}
+
+static int
+dht_migrate_copier_done (int ret, call_frame_t *frame, void *data)
+{
+        dht_migrate_copier_t *copier = data;
+
+        copier->ret = ret;
+        syncbarrier_wake (copier->barrier);
+
+        return 0;
+}
+
+/* Copy a file with no holes by 'depth' tasks, each of them keeping a
+   block in flight, instead of one block at a time */
+static int
+__dht_rebalance_migrate_data_pipelined (xlator_t *this, xlator_t *from,
+                                        xlator_t *to, fd_t *src, fd_t *dst,
+                                        uint64_t ia_size, int depth)
+{
+        dht_migrate_copier_t *copiers = NULL;
+        syncbarrier_t         barrier;
+        struct synctask      *task    = NULL;
+        call_frame_t         *frame   = NULL;
+        int                   started = 0;
+        int                   ret     = -1;
+        int                   i       = 0;
+
+        copiers = GF_CALLOC (depth, sizeof (*copiers),
+                             gf_dht_mt_migrate_copier_t);
+        if (!copiers)
+                return -1;
+
+        ret = syncbarrier_init (&barrier);
+        if (ret) {
+                GF_FREE (copiers);
+                return -1;
+        }
+
+        /* the copiers' frames are copies of the migration's, so that the
+           bricks see the rebalance pid and lk-owner on every block: marker
+           must not update xtimes for them */
+        task = synctask_get ();
+        if (task)
+                frame = task->opframe;
+
+        for (i = 0; i < depth; i++) {
+                if ((uint64_t) i * DHT_REBALANCE_BLKSIZE >= ia_size)
+                        break;
+
+                copiers[i].this    = this;
+                copiers[i].from    = from;
+                copiers[i].to      = to;
+                copiers[i].src     = src;
+                copiers[i].dst     = dst;
+                copiers[i].ia_size = ia_size;
+                copiers[i].start   = (off_t) i * DHT_REBALANCE_BLKSIZE;
+                copiers[i].stride  = depth;
+                copiers[i].barrier = &barrier;
+
+                ret = synctask_new (this->ctx->env, dht_migrate_copier_task,
+                                    dht_migrate_copier_done, frame,
+                                    &copiers[i]);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "failed to start copier %d", i);
+                        break;
+                }
+                started++;
+        }
+
+        if (started)
+                syncbarrier_wait (&barrier, started);
+
+        if (i < depth && (uint64_t) i * DHT_REBALANCE_BLKSIZE < ia_size)
+                ret = -1; /* a copier could not be started */
+        else
+                ret = 0;
+
+        for (i = 0; i < started; i++) {
+                if (copiers[i].ret)
+                        ret = -1;
+        }
+
+        syncbarrier_destroy (&barrier);
+        GF_FREE (copiers);
+
+        return ret;
+}
+
 static inline int
 __dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
                              uint64_t ia_size, int hole_exists)
@@ -414,11 +596,59 @@ __dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst
         struct iobref *iobref = NULL;
         uint64_t       total  = 0;
         size_t         read_size = 0;
+        off_t          data_end  = 0;
+        off_t          seek_off  = 0;
+        int            use_seek  = hole_exists;
+        struct timeval start     = {0,};
+        xlator_t      *this      = THIS;
+        dht_conf_t    *conf      = this->private;
+
+        if (!hole_exists && conf && conf->defrag &&
+            (conf->defrag->pipeline_depth > 1) &&
+            (ia_size > DHT_REBALANCE_BLKSIZE))
+                return __dht_rebalance_migrate_data_pipelined (this, from, to,
+                                                               src, dst,
+                                                               ia_size,
+                                                               conf->defrag->pipeline_depth);
 
         /* if file size is '0', no need to enter this loop */
         while (total < ia_size) {
+                /* Sparse source: ask it where the next data extent is
+                   instead of reading (and sending) its holes. The
+                   destination was already truncated to ia_size, so the
+                   skipped ranges stay holes there too. */
+                if (use_seek && (offset >= data_end)) {
+                        ret = syncop_seek (from, src, offset, GF_SEEK_DATA,
+                                           &seek_off);
+                        if ((ret == -1) && (errno == ENXIO)) {
+                                /* nothing but a hole till the end */
+                                ret = 0;
+                                break;
+                        }
+                        if (ret == 0) {
+                                total += (seek_off - offset);
+                                offset = seek_off;
+                                ret = syncop_seek (from, src, offset,
+                                                   GF_SEEK_HOLE, &data_end);
+                        }
+                        if (ret == -1) {
+                                /* not supported underneath, copy it all */
+                                gf_log (THIS->name, GF_LOG_DEBUG,
+                                        "seek on %s failed (%s), reading "
+                                        "the whole file", from->name,
+                                        strerror (errno));
+                                use_seek = 0;
+                                ret = 0;
+                        }
+                        if (total >= ia_size)
+                                break;
+                }
+
                 read_size = (((ia_size - total) > DHT_REBALANCE_BLKSIZE) ?
                              DHT_REBALANCE_BLKSIZE : (ia_size - total));
+                if (use_seek && ((size_t)(data_end - offset) < read_size))
+                        read_size = data_end - offset;
+                gettimeofday (&start, NULL);
                 ret = syncop_readv (from, src, read_size,
                                     offset, 0, &vector, &count, &iobref);
                 if (!ret || (ret < 0)) {
@@ -436,6 +666,7 @@ __dht_rebalance_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst
                 }
                 offset += ret;
                 total += ret;
+                dht_rebalance_latency_sample (this, &start);
 
                 GF_FREE (vector);
                 if (iobref)
@@ -1052,6 +1283,377 @@ gf_defrag_handle_migrate_error (int32_t op_errno, gf_defrag_info_t *defrag)
         return 0;
 }
 
+/* Migrate one regular file of the directory at 'loc', if it belongs to this
+   node. Returns -1 when the whole rebalance has to be aborted. */
+static int
+gf_defrag_migrate_entry (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
+                         gf_dirent_t *entry, dict_t *migrate_data)
+{
+        int                      ret            = -1;
+        loc_t                    entry_loc      = {0,};
+        dict_t                  *dict           = NULL;
+        struct iatt              iatt           = {0,};
+        int32_t                  op_errno       = 0;
+        char                    *uuid_str       = NULL;
+        uuid_t                   node_uuid      = {0,};
+        struct timeval           end            = {0,};
+        double                   elapsed        = {0,};
+        struct timeval           start          = {0,};
+        int32_t                  err            = 0;
+
+        LOCK (&defrag->lock);
+        {
+                defrag->num_files_lookedup++;
+        }
+        UNLOCK (&defrag->lock);
+
+        if (defrag->stats == _gf_true) {
+                gettimeofday (&start, NULL);
+        }
+        ret =dht_build_child_loc (this, &entry_loc, loc, entry->d_name);
+        if (ret) {
+                gf_log (this->name, GF_LOG_ERROR, "Child loc build failed");
+                goto out;
+        }
+
+        ret = 0;
+
+        if (uuid_is_null (entry->d_stat.ia_gfid)) {
+                gf_log (this->name, GF_LOG_ERROR, "%s/%s gfid not present",
+                        loc->path, entry->d_name);
+                goto out;
+        }
+
+        uuid_copy (entry_loc.gfid, entry->d_stat.ia_gfid);
+
+        if (uuid_is_null (loc->gfid)) {
+                gf_log (this->name, GF_LOG_ERROR, "%s/%s gfid not present",
+                        loc->path, entry->d_name);
+                goto out;
+        }
+
+        uuid_copy (entry_loc.pargfid, loc->gfid);
+
+        entry_loc.inode->ia_type = entry->d_stat.ia_type;
+
+        ret = syncop_lookup (this, &entry_loc, NULL, &iatt, NULL, NULL);
+        if (ret) {
+                gf_log (this->name, GF_LOG_ERROR, "%s lookup failed",
+                        entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        ret = syncop_getxattr (this, &entry_loc, &dict,
+                               GF_XATTR_NODE_UUID_KEY);
+        if(ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "Failed to get node-uuid "
+                        "for %s", entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        ret = dict_get_str (dict, GF_XATTR_NODE_UUID_KEY, &uuid_str);
+        if(ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "Failed to get node-uuid "
+                        "from dict for %s", entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        if (uuid_parse (uuid_str, node_uuid)) {
+                gf_log (this->name, GF_LOG_ERROR, "uuid_parse failed for %s",
+                        entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        /* if file belongs to different node, skip migration
+         * the other node will take responsibility of migration
+         */
+        if (uuid_compare (node_uuid, defrag->node_uuid)) {
+                gf_log (this->name, GF_LOG_TRACE, "%s does not"
+                        "belong to this node", entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        uuid_str = NULL;
+
+        dict_del (dict, GF_XATTR_NODE_UUID_KEY);
+
+
+        /* if distribute is present, it will honor this key.
+         * -1 is returned if distribute is not present or file
+         * doesn't have a link-file. If file has link-file, the
+         * path of link-file will be the value, and also that
+         * guarantees that file has to be mostly migrated */
+
+        ret = syncop_getxattr (this, &entry_loc, &dict,
+                               GF_XATTR_LINKINFO_KEY);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_TRACE, "failed to "
+                        "get link-to key for %s", entry_loc.path);
+                ret = 0;
+                goto out;
+        }
+
+        ret = syncop_setxattr (this, &entry_loc, migrate_data, 0);
+        if (ret) {
+                err = op_errno;
+                /* errno is overloaded. See
+                 * rebalance_task_completion () */
+                LOCK (&defrag->lock);
+                {
+                        if (err != ENOSPC) {
+                                gf_log (this->name, GF_LOG_DEBUG,
+                                        "migrate-data skipped for %s"
+                                        " due to space constraints",
+                                        entry_loc.path);
+                                defrag->skipped +=1;
+                        } else{
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "migrate-data failed for %s",
+                                        entry_loc.path);
+                                defrag->total_failures +=1;
+                        }
+                }
+                UNLOCK (&defrag->lock);
+        }
+
+        if (ret == -1) {
+                op_errno = errno;
+                ret = gf_defrag_handle_migrate_error (op_errno, defrag);
+
+                if (!ret)
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "migrate-data on %s failed: %s",
+                                entry_loc.path, strerror (op_errno));
+                else if (ret == 1) {
+                        ret = 0;
+                        goto out;
+                } else if (ret == -1)
+                        goto out;
+        }
+
+        LOCK (&defrag->lock);
+        {
+                defrag->total_files += 1;
+                defrag->total_data += iatt.ia_size;
+        }
+        UNLOCK (&defrag->lock);
+        if (defrag->stats == _gf_true) {
+                gettimeofday (&end, NULL);
+                elapsed = (end.tv_sec - start.tv_sec) * 1e6 +
+                          (end.tv_usec - start.tv_usec);
+                gf_log (this->name, GF_LOG_INFO, "Migration of "
+                        "file:%s size:%"PRIu64" bytes took %.2f"
+                        "secs", entry_loc.path, iatt.ia_size,
+                         elapsed/1e6);
+        }
+        ret = 0;
+out:
+        loc_wipe (&entry_loc);
+
+        if (dict)
+                dict_unref(dict);
+
+        return ret;
+}
+
+/* Files of a directory being migrated at the same time, see
+ * rebalance-workers. The workers report to the crawler through the
+ * barrier; 'done' is only folded into 'inflight' by the crawler, and
+ * under 'mutex', so that the last worker has left the pool before the
+ * crawler can see it drained and let it go out of scope.
+ */
+struct gf_defrag_pool {
+        pthread_mutex_t          mutex;
+        syncbarrier_t            barrier;
+        call_frame_t            *frame;
+        int                      inflight;
+        int                      done;
+        int                      abort;
+};
+typedef struct gf_defrag_pool gf_defrag_pool_t;
+
+struct gf_defrag_job {
+        xlator_t                *this;
+        gf_defrag_info_t        *defrag;
+        gf_defrag_pool_t        *pool;
+        loc_t                   *loc;
+        gf_dirent_t             *entry;
+        dict_t                  *migrate_data;
+};
+typedef struct gf_defrag_job gf_defrag_job_t;
+
+static int
+gf_defrag_job_task (void *data)
+{
+        gf_defrag_job_t *job = data;
+
+        return gf_defrag_migrate_entry (job->this, job->defrag, job->loc,
+                                        job->entry, job->migrate_data);
+}
+
+static int
+gf_defrag_job_done (int ret, call_frame_t *frame, void *data)
+{
+        gf_defrag_job_t  *job  = data;
+        gf_defrag_pool_t *pool = job->pool;
+
+        if (job->entry->inode)
+                inode_unref (job->entry->inode);
+        if (job->entry->dict)
+                dict_unref (job->entry->dict);
+        GF_FREE (job->entry);
+        GF_FREE (job);
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                pool->done++;
+                if (ret < 0)
+                        pool->abort = 1;
+                syncbarrier_wake (&pool->barrier);
+        }
+        pthread_mutex_unlock (&pool->mutex);
+
+        return 0;
+}
+
+/* Number of files to migrate at the same time: one less while blocks take
+   longer than rebalance-latency-target, one more once they are well below
+   it again */
+static int
+gf_defrag_workers (gf_defrag_info_t *defrag)
+{
+        double target = defrag->latency_target * 1000.0;
+        int    workers = 0;
+
+        LOCK (&defrag->lock);
+        {
+                if (!target)
+                        defrag->workers = defrag->workers_max;
+                else if ((defrag->latency > target) && (defrag->workers > 1))
+                        defrag->workers--;
+                else if ((defrag->latency < target * 3 / 4) &&
+                         (defrag->workers < defrag->workers_max))
+                        defrag->workers++;
+
+                if (defrag->workers > defrag->workers_max)
+                        defrag->workers = defrag->workers_max;
+                if (!defrag->workers)
+                        defrag->workers = 1;
+                workers = defrag->workers;
+        }
+        UNLOCK (&defrag->lock);
+
+        return workers;
+}
+
+/* wait till fewer than 'limit' files are being migrated */
+static void
+gf_defrag_pool_wait (gf_defrag_pool_t *pool, int limit)
+{
+        int busy = 0;
+
+        for (;;) {
+                pthread_mutex_lock (&pool->mutex);
+                {
+                        pool->inflight -= pool->done;
+                        pool->done = 0;
+                        busy = (pool->inflight >= limit);
+                }
+                pthread_mutex_unlock (&pool->mutex);
+
+                if (!busy)
+                        break;
+
+                syncbarrier_wait (&pool->barrier, 1);
+        }
+}
+
+static int
+gf_defrag_pool_init (xlator_t *this, gf_defrag_info_t *defrag,
+                     gf_defrag_pool_t *pool)
+{
+        memset (pool, 0, sizeof (*pool));
+
+        /* the workers' fops carry the pid of the rebalance process, like
+           the ones of the crawl */
+        pool->frame = create_frame (this, this->ctx->pool);
+        if (!pool->frame)
+                return -1;
+        pool->frame->root->pid = defrag->pid;
+
+        pthread_mutex_init (&pool->mutex, NULL);
+        if (syncbarrier_init (&pool->barrier)) {
+                pthread_mutex_destroy (&pool->mutex);
+                STACK_DESTROY (pool->frame->root);
+                pool->frame = NULL;
+                return -1;
+        }
+
+        return 0;
+}
+
+static void
+gf_defrag_pool_fini (gf_defrag_pool_t *pool)
+{
+        /* the workers use their parent's loc, migrate_data and the pool */
+        gf_defrag_pool_wait (pool, 1);
+        syncbarrier_destroy (&pool->barrier);
+        pthread_mutex_destroy (&pool->mutex);
+        STACK_DESTROY (pool->frame->root);
+        pool->frame = NULL;
+}
+
+/* Migrate 'entry', unlinked from its list and freed by the worker, of the
+ * directory at 'loc' once a worker is free. Fails when the rebalance has
+ * to be aborted. */
+static int
+gf_defrag_pool_submit (xlator_t *this, gf_defrag_info_t *defrag,
+                       gf_defrag_pool_t *pool, loc_t *loc, gf_dirent_t *entry,
+                       dict_t *migrate_data)
+{
+        gf_defrag_job_t *job = NULL;
+        int              ret = -1;
+
+        gf_defrag_pool_wait (pool, gf_defrag_workers (defrag));
+        if (pool->abort)
+                return -1;
+
+        job = GF_CALLOC (1, sizeof (*job), gf_dht_mt_defrag_job_t);
+        if (!job)
+                return -1;
+        job->this = this;
+        job->defrag = defrag;
+        job->pool = pool;
+        job->loc = loc;
+        job->migrate_data = migrate_data;
+
+        /* the job owns the entry from now on */
+        list_del_init (&entry->list);
+        job->entry = entry;
+
+        pthread_mutex_lock (&pool->mutex);
+        {
+                pool->inflight++;
+        }
+        pthread_mutex_unlock (&pool->mutex);
+
+        ret = synctask_new (this->ctx->env, gf_defrag_job_task,
+                            gf_defrag_job_done, pool->frame, job);
+        if (ret) {
+                gf_log (this->name, GF_LOG_ERROR, "failed to start "
+                        "migration of %s/%s", loc->path, entry->d_name);
+                gf_defrag_job_done (-1, NULL, job);
+                return -1;
+        }
+
+        return 0;
+}
+
 /* We do a depth first traversal of directories. But before we move into
  * subdirs, we complete the data migration of those directories whose layouts
  * have been fixed
@@ -1062,24 +1664,18 @@ gf_defrag_migrate_data (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                         dict_t *migrate_data)
 {
         int                      ret            = -1;
-        loc_t                    entry_loc      = {0,};
         fd_t                    *fd             = NULL;
         gf_dirent_t              entries;
         gf_dirent_t             *tmp            = NULL;
         gf_dirent_t             *entry          = NULL;
         gf_boolean_t             free_entries   = _gf_false;
         off_t                    offset         = 0;
-        dict_t                  *dict           = NULL;
-        struct iatt              iatt           = {0,};
-        int32_t                  op_errno       = 0;
-        char                    *uuid_str       = NULL;
-        uuid_t                   node_uuid      = {0,};
         int                      readdir_operrno = 0;
         struct timeval           dir_start      = {0,};
         struct timeval           end            = {0,};
         double                   elapsed        = {0,};
-        struct timeval           start          = {0,};
-        int32_t                  err            = 0;
+        gf_defrag_pool_t         pool;
+        gf_boolean_t             pool_ready     = _gf_false;
 
         gf_log (this->name, GF_LOG_INFO, "migrate data called on %s",
                 loc->path);
@@ -1098,6 +1694,13 @@ gf_defrag_migrate_data (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                 goto out;
         }
 
+        if (defrag->workers_max > 1) {
+                ret = gf_defrag_pool_init (this, defrag, &pool);
+                if (ret)
+                        goto out;
+                pool_ready = _gf_true;
+        }
+
         INIT_LIST_HEAD (&entries.list);
 
         while ((ret = syncop_readdirp (this, fd, 131072, offset, NULL,
@@ -1135,150 +1738,19 @@ gf_defrag_migrate_data (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                         if (IA_ISDIR (entry->d_stat.ia_type))
                                 continue;
 
-                        defrag->num_files_lookedup++;
-                        if (defrag->stats == _gf_true) {
-                                gettimeofday (&start, NULL);
-                        }
-                        loc_wipe (&entry_loc);
-                        ret =dht_build_child_loc (this, &entry_loc, loc,
-                                                  entry->d_name);
-                        if (ret) {
-                                gf_log (this->name, GF_LOG_ERROR, "Child loc"
-                                        " build failed");
-                                goto out;
-                        }
-
-                        if (uuid_is_null (entry->d_stat.ia_gfid)) {
-                                gf_log (this->name, GF_LOG_ERROR, "%s/%s"
-                                        " gfid not present", loc->path,
-                                         entry->d_name);
-                                continue;
-                        }
-
-                        uuid_copy (entry_loc.gfid, entry->d_stat.ia_gfid);
-
-                        if (uuid_is_null (loc->gfid)) {
-                                gf_log (this->name, GF_LOG_ERROR, "%s/%s"
-                                        " gfid not present", loc->path,
-                                         entry->d_name);
-                                continue;
-                        }
-
-                        uuid_copy (entry_loc.pargfid, loc->gfid);
-
-                        entry_loc.inode->ia_type = entry->d_stat.ia_type;
-
-                        ret = syncop_lookup (this, &entry_loc, NULL, &iatt,
-                                             NULL, NULL);
-                        if (ret) {
-                                gf_log (this->name, GF_LOG_ERROR, "%s"
-                                        " lookup failed", entry_loc.path);
-                                continue;
-                        }
-
-                        ret = syncop_getxattr (this, &entry_loc, &dict,
-                                               GF_XATTR_NODE_UUID_KEY);
-                        if(ret < 0) {
-                                gf_log (this->name, GF_LOG_ERROR, "Failed to "
-                                        "get node-uuid for %s", entry_loc.path);
-                                continue;
-                        }
-
-                        ret = dict_get_str (dict, GF_XATTR_NODE_UUID_KEY,
-                                            &uuid_str);
-                        if(ret < 0) {
-                                gf_log (this->name, GF_LOG_ERROR, "Failed to "
-                                        "get node-uuid from dict for %s",
-                                        entry_loc.path);
-                                continue;
-                        }
-
-                        if (uuid_parse (uuid_str, node_uuid)) {
-                                gf_log (this->name, GF_LOG_ERROR, "uuid_parse "
-                                        "failed for %s", entry_loc.path);
-                                continue;
-                        }
-
-                        /* if file belongs to different node, skip migration
-                         * the other node will take responsibility of migration
-                         */
-                        if (uuid_compare (node_uuid, defrag->node_uuid)) {
-                                gf_log (this->name, GF_LOG_TRACE, "%s does not"
-                                        "belong to this node", entry_loc.path);
-                                continue;
-                        }
-
-                        uuid_str = NULL;
-
-                        dict_del (dict, GF_XATTR_NODE_UUID_KEY);
-
-
-                        /* if distribute is present, it will honor this key.
-                         * -1 is returned if distribute is not present or file
-                         * doesn't have a link-file. If file has link-file, the
-                         * path of link-file will be the value, and also that
-                         * guarantees that file has to be mostly migrated */
-
-                        ret = syncop_getxattr (this, &entry_loc, &dict,
-                                               GF_XATTR_LINKINFO_KEY);
-                        if (ret < 0) {
-                                gf_log (this->name, GF_LOG_TRACE, "failed to "
-                                        "get link-to key for %s",
-                                        entry_loc.path);
-                                continue;
-                        }
-
-                        ret = syncop_setxattr (this, &entry_loc, migrate_data,
-                                               0);
-                        if (ret) {
-                                err = op_errno;
-                                /* errno is overloaded. See
-                                 * rebalance_task_completion () */
-                                if (err != ENOSPC) {
-                                        gf_log (this->name, GF_LOG_DEBUG,
-                                                "migrate-data skipped for %s"
-                                                " due to space constraints",
-                                                entry_loc.path);
-                                        defrag->skipped +=1;
-                                } else{
-                                        gf_log (this->name, GF_LOG_ERROR,
-                                                "migrate-data failed for %s",
-                                                entry_loc.path);
-                                        defrag->total_failures +=1;
-                                }
-                        }
-
-                        if (ret == -1) {
-                                op_errno = errno;
-                                ret = gf_defrag_handle_migrate_error (op_errno,
-                                                                      defrag);
-
-                                if (!ret)
-                                        gf_log (this->name, GF_LOG_DEBUG,
-                                                "migrate-data on %s failed: %s",
-                                                entry_loc.path,
-                                                strerror (op_errno));
-                                else if (ret == 1)
-                                        continue;
-                                else if (ret == -1)
+                        if (!pool_ready) {
+                                ret = gf_defrag_migrate_entry (this, defrag,
+                                                               loc, entry,
+                                                               migrate_data);
+                                if (ret)
                                         goto out;
+                                continue;
                         }
 
-                        LOCK (&defrag->lock);
-                        {
-                                defrag->total_files += 1;
-                                defrag->total_data += iatt.ia_size;
-                        }
-                        UNLOCK (&defrag->lock);
-                        if (defrag->stats == _gf_true) {
-                                gettimeofday (&end, NULL);
-                                elapsed = (end.tv_sec - start.tv_sec) * 1e6 +
-                                          (end.tv_usec - start.tv_usec);
-                                gf_log (this->name, GF_LOG_INFO, "Migration of "
-                                        "file:%s size:%"PRIu64" bytes took %.2f"
-                                        "secs", entry_loc.path, iatt.ia_size,
-                                         elapsed/1e6);
-                        }
+                        ret = gf_defrag_pool_submit (this, defrag, &pool, loc,
+                                                     entry, migrate_data);
+                        if (ret)
+                                goto out;
                 }
 
                 gf_dirent_free (&entries);
@@ -1289,6 +1761,14 @@ gf_defrag_migrate_data (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                         break;
         }
 
+        if (pool_ready) {
+                gf_defrag_pool_wait (&pool, 1);
+                if (pool.abort) {
+                        ret = -1;
+                        goto out;
+                }
+        }
+
         gettimeofday (&end, NULL);
         elapsed = (end.tv_sec - dir_start.tv_sec) * 1e6 +
                   (end.tv_usec - dir_start.tv_usec);
@@ -1296,14 +1776,12 @@ gf_defrag_migrate_data (xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                 "%.2f secs", loc->path, elapsed/1e6);
         ret = 0;
 out:
+        if (pool_ready)
+                gf_defrag_pool_fini (&pool);
+
         if (free_entries)
                 gf_dirent_free (&entries);
 
-        loc_wipe (&entry_loc);
-
-        if (dict)
-                dict_unref(dict);
-
         if (fd)
                 fd_unref (fd);
         return ret;
@@ -1474,6 +1952,407 @@ out:
 }
 
 
+/* Crawl-free rebalance: instead of walking the namespace, every node lists
+ * its own brick of each subvolume it migrates from (those answering with its
+ * node-uuid) through the brick crawl directory, walked locally by posix.
+ * A directory comes before its files and its subdirectories, so it is fixed
+ * before the files listed after it are migrated, and fixed directories are
+ * kept on a stack indexed by depth to be the parents of what follows.
+ */
+
+/* 1 when 'subvol' is migrated from by this node, 0 when not, -1 on errors */
+static int
+gf_defrag_subvol_is_local (xlator_t *this, gf_defrag_info_t *defrag,
+                           xlator_t *subvol, loc_t *root)
+{
+        dict_t *dict     = NULL;
+        char   *uuid_str = NULL;
+        uuid_t  node_uuid = {0,};
+        int     ret      = -1;
+
+        ret = syncop_getxattr (subvol, root, &dict, GF_XATTR_NODE_UUID_KEY);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "failed to get node-uuid "
+                        "of %s (%s)", subvol->name, strerror (errno));
+                goto out;
+        }
+
+        ret = dict_get_str (dict, GF_XATTR_NODE_UUID_KEY, &uuid_str);
+        if (ret < 0 || uuid_parse (uuid_str, node_uuid)) {
+                gf_log (this->name, GF_LOG_ERROR, "bad node-uuid from %s",
+                        subvol->name);
+                ret = -1;
+                goto out;
+        }
+
+        ret = !uuid_compare (node_uuid, defrag->node_uuid);
+out:
+        if (dict)
+                dict_unref (dict);
+        return ret;
+}
+
+/* The protocol/client below 'subvol' connected to the brick of this node.
+   The crawl directory is listed there: a replicate above it would examine
+   and heal the directory, or read it from a brick that is not local. */
+static xlator_t *
+gf_defrag_local_brick (xlator_t *this, gf_defrag_info_t *defrag,
+                       xlator_t *subvol, loc_t *root)
+{
+        xlator_list_t *child = NULL;
+
+        if (!strcmp (subvol->type, "protocol/client"))
+                return subvol;
+
+        for (child = subvol->children; child; child = child->next) {
+                if (gf_defrag_subvol_is_local (this, defrag, child->xlator,
+                                               root) == 1)
+                        return gf_defrag_local_brick (this, defrag,
+                                                      child->xlator, root);
+        }
+
+        return NULL;
+}
+
+/* open the crawl directory of 'brick'; fails with ENODATA or ENOTSUP when
+   the brick does not have one */
+static int
+gf_defrag_brick_crawl_open (xlator_t *this, gf_defrag_info_t *defrag,
+                            xlator_t *brick, loc_t *root, loc_t *dirloc,
+                            fd_t **fd)
+{
+        dict_t      *dict   = NULL;
+        void        *gfid   = NULL;
+        inode_t     *linked = NULL;
+        struct iatt  iatt   = {0,};
+        struct iatt  parent = {0,};
+        int          ret    = -1;
+
+        ret = syncop_getxattr (brick, root, &dict, GF_XATTR_BRICK_CRAWL_GFID);
+        if (ret < 0)
+                goto out;
+
+        ret = dict_get_ptr (dict, GF_XATTR_BRICK_CRAWL_GFID, &gfid);
+        if (ret < 0 || !gfid) {
+                errno = ENODATA;
+                ret = -1;
+                goto out;
+        }
+
+        uuid_copy (dirloc->gfid, gfid);
+        dirloc->path = gf_strdup ("<brick-crawl>");
+        dirloc->inode = inode_new (root->inode->table);
+        if (!dirloc->path || !dirloc->inode) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+
+        ret = syncop_lookup (brick, dirloc, NULL, &iatt, NULL, &parent);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "lookup of the brick crawl "
+                        "directory of %s failed (%s)", brick->name,
+                        strerror (errno));
+                goto out;
+        }
+
+        linked = inode_link (dirloc->inode, NULL, NULL, &iatt);
+        if (linked) {
+                inode_unref (dirloc->inode);
+                dirloc->inode = linked;
+        }
+
+        *fd = fd_create (dirloc->inode, defrag->pid);
+        if (!*fd) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+
+        ret = syncop_opendir (brick, dirloc, *fd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "opendir of the brick "
+                        "crawl directory of %s failed (%s)", brick->name,
+                        strerror (errno));
+                fd_unref (*fd);
+                *fd = NULL;
+        }
+out:
+        if (dict)
+                dict_unref (dict);
+        return ret;
+}
+
+/* Fix the layouts of the directories listed by 'brick', the local brick of
+ * 'subvol', and migrate their files. 'dirs' is the stack of directories,
+ * dirs[0] the root. */
+static int
+gf_defrag_brick_crawl (xlator_t *this, gf_defrag_info_t *defrag,
+                       xlator_t *subvol, xlator_t *brick, loc_t *dirs,
+                       int max_depth, dict_t *fix_layout,
+                       dict_t *migrate_data)
+{
+        loc_t             dirloc     = {0,};
+        fd_t             *fd         = NULL;
+        gf_dirent_t       entries;
+        gf_dirent_t      *tmp        = NULL;
+        gf_dirent_t      *entry      = NULL;
+        gf_boolean_t      free_entries = _gf_false;
+        gf_defrag_pool_t  pool;
+        gf_boolean_t      pool_ready = _gf_false;
+        struct iatt       iatt       = {0,};
+        off_t             offset     = 0;
+        char             *base       = NULL;
+        char             *p          = NULL;
+        int               depth      = 0;
+        int               top        = 0;  /* deepest directory fixed */
+        int               valid      = 1;  /* dirs[top] is the last listed */
+        int               readdir_errno = 0;
+        int               ret        = -1;
+
+        ret = gf_defrag_brick_crawl_open (this, defrag, brick, &dirs[0],
+                                          &dirloc, &fd);
+        if (ret)
+                goto out;
+
+        gf_log (this->name, GF_LOG_INFO, "crawling %s, the brick of %s",
+                brick->name, subvol->name);
+
+        if ((defrag->cmd != GF_DEFRAG_CMD_START_LAYOUT_FIX) &&
+            (defrag->workers_max > 1)) {
+                ret = gf_defrag_pool_init (this, defrag, &pool);
+                if (ret)
+                        goto out;
+                pool_ready = _gf_true;
+        }
+
+        INIT_LIST_HEAD (&entries.list);
+
+        while ((ret = syncop_readdirp (brick, fd, 131072, offset, NULL,
+                                       &entries)) != 0) {
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_ERROR, "listing %s failed "
+                                "(%s)", brick->name, strerror (errno));
+                        goto out;
+                }
+
+                readdir_errno = errno;
+
+                if (list_empty (&entries.list))
+                        break;
+
+                free_entries = _gf_true;
+
+                list_for_each_entry_safe (entry, tmp, &entries.list, list) {
+                        if (defrag->defrag_status != GF_DEFRAG_STATUS_STARTED) {
+                                ret = 1;
+                                goto out;
+                        }
+
+                        offset = entry->d_off;
+
+                        depth = 1;
+                        base = entry->d_name;
+                        for (p = entry->d_name; *p; p++) {
+                                if (*p == '/') {
+                                        depth++;
+                                        base = p + 1;
+                                }
+                        }
+
+                        if (!IA_ISDIR (entry->d_stat.ia_type)) {
+                                if ((depth != top + 1) || !valid ||
+                                    (defrag->cmd ==
+                                     GF_DEFRAG_CMD_START_LAYOUT_FIX))
+                                        continue;
+
+                                memmove (entry->d_name, base,
+                                         strlen (base) + 1);
+                                if (!pool_ready) {
+                                        ret = gf_defrag_migrate_entry (this,
+                                                      defrag, &dirs[top],
+                                                      entry, migrate_data);
+                                        if (ret)
+                                                goto out;
+                                        continue;
+                                }
+                                ret = gf_defrag_pool_submit (this, defrag,
+                                                             &pool, &dirs[top],
+                                                             entry,
+                                                             migrate_data);
+                                if (ret)
+                                        goto out;
+                                continue;
+                        }
+
+                        /* the files of the previous directory use it */
+                        if (pool_ready)
+                                gf_defrag_pool_wait (&pool, 1);
+                        if (pool_ready && pool.abort) {
+                                ret = -1;
+                                goto out;
+                        }
+
+                        valid = 0;
+                        if ((depth > top + 1) || (depth >= max_depth) ||
+                            uuid_is_null (entry->d_stat.ia_gfid)) {
+                                /* below a directory we could not fix */
+                                continue;
+                        }
+                        while (top >= depth)
+                                loc_wipe (&dirs[top--]);
+
+                        ret = dht_build_child_loc (this, &dirs[depth],
+                                                   &dirs[depth - 1], base);
+                        if (ret) {
+                                gf_log (this->name, GF_LOG_ERROR, "Child loc"
+                                        " build failed");
+                                goto out;
+                        }
+                        dirs[depth].inode->ia_type = entry->d_stat.ia_type;
+                        uuid_copy (dirs[depth].gfid, entry->d_stat.ia_gfid);
+                        uuid_copy (dirs[depth].pargfid, dirs[depth - 1].gfid);
+
+                        ret = syncop_lookup (this, &dirs[depth], NULL, &iatt,
+                                             NULL, NULL);
+                        if (ret) {
+                                gf_log (this->name, GF_LOG_ERROR, "%s"
+                                        " lookup failed", dirs[depth].path);
+                                loc_wipe (&dirs[depth]);
+                                continue;
+                        }
+
+                        ret = syncop_setxattr (this, &dirs[depth], fix_layout,
+                                               0);
+                        if (ret) {
+                                gf_log (this->name, GF_LOG_ERROR, "Setxattr "
+                                        "failed for %s", dirs[depth].path);
+                                defrag->defrag_status =
+                                        GF_DEFRAG_STATUS_FAILED;
+                                defrag->total_failures ++;
+                                goto out;
+                        }
+
+                        top = depth;
+                        valid = 1;
+                }
+
+                gf_dirent_free (&entries);
+                free_entries = _gf_false;
+                INIT_LIST_HEAD (&entries.list);
+
+                if (readdir_errno == ENOENT)
+                        break;
+        }
+
+        ret = 0;
+out:
+        if (pool_ready) {
+                gf_defrag_pool_fini (&pool);
+                if (pool.abort)
+                        ret = -1;
+        }
+
+        for (depth = 1; depth < max_depth; depth++)
+                loc_wipe (&dirs[depth]);
+
+        if (free_entries)
+                gf_dirent_free (&entries);
+
+        if (fd)
+                fd_unref (fd);
+
+        loc_wipe (&dirloc);
+
+        return ret;
+}
+
+/* Rebalance from the brick listings of the local subvolumes. Sets
+   'unsupported', with nothing done, when some of them cannot be listed so. */
+static int
+gf_defrag_crawl_bricks (xlator_t *this, gf_defrag_info_t *defrag, loc_t *root,
+                        dict_t *fix_layout, dict_t *migrate_data,
+                        gf_boolean_t *unsupported)
+{
+        dht_conf_t *conf   = this->private;
+        dict_t     *dict   = NULL;
+        loc_t      *dirs   = NULL;
+        xlator_t  **bricks = NULL;
+        int         max_depth = PATH_MAX / 2;
+        int         ret    = -1;
+        int         i      = 0;
+
+        bricks = GF_CALLOC (conf->subvolume_cnt, sizeof (*bricks),
+                            gf_dht_mt_xlator_t);
+        if (!bricks)
+                goto out;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                ret = gf_defrag_subvol_is_local (this, defrag,
+                                                 conf->subvolumes[i], root);
+                if (ret < 0) {
+                        /* leave it to the namespace crawl */
+                        *unsupported = _gf_true;
+                        goto out;
+                }
+                if (!ret)
+                        continue;
+
+                bricks[i] = gf_defrag_local_brick (this, defrag,
+                                                   conf->subvolumes[i], root);
+                if (!bricks[i]) {
+                        gf_log (this->name, GF_LOG_INFO, "no brick of %s is "
+                                "local, crawling the namespace",
+                                conf->subvolumes[i]->name);
+                        *unsupported = _gf_true;
+                        ret = -1;
+                        goto out;
+                }
+
+                ret = syncop_getxattr (bricks[i], root, &dict,
+                                       GF_XATTR_BRICK_CRAWL_GFID);
+                if (dict) {
+                        dict_unref (dict);
+                        dict = NULL;
+                }
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_INFO, "bricks of %s can "
+                                "not be listed (%s), crawling the namespace",
+                                conf->subvolumes[i]->name, strerror (errno));
+                        *unsupported = _gf_true;
+                        goto out;
+                }
+        }
+
+        dirs = GF_CALLOC (max_depth, sizeof (*dirs), gf_dht_mt_loc_t);
+        if (!dirs) {
+                ret = -1;
+                goto out;
+        }
+        loc_copy (&dirs[0], root);
+
+        /* Every local subvolume fixes the directories it lists: one whose
+           bricks were just added has none of them yet */
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                if (!bricks[i])
+                        continue;
+                ret = gf_defrag_brick_crawl (this, defrag, conf->subvolumes[i],
+                                             bricks[i], dirs, max_depth,
+                                             fix_layout, migrate_data);
+                if (ret)
+                        goto out;
+        }
+        ret = 0;
+out:
+        if (dirs) {
+                loc_wipe (&dirs[0]);
+                GF_FREE (dirs);
+        }
+        GF_FREE (bricks);
+        return ret;
+}
+
+
 int
 gf_defrag_start_crawl (void *data)
 {
@@ -1488,6 +2367,7 @@ gf_defrag_start_crawl (void *data)
         dict_t                  *migrate_data = NULL;
         dict_t                  *status = NULL;
         glusterfs_ctx_t         *ctx = NULL;
+        gf_boolean_t             unsupported = _gf_false;
 
         this = data;
         if (!this)
@@ -1557,8 +2437,19 @@ gf_defrag_start_crawl (void *data)
                 if (ret)
                         goto out;
         }
-        ret = gf_defrag_fix_layout (this, defrag, &loc, fix_layout,
-                                    migrate_data);
+        if (defrag->brick_crawl) {
+                ret = gf_defrag_crawl_bricks (this, defrag, &loc, fix_layout,
+                                              migrate_data, &unsupported);
+                if ((ret < 0) && !unsupported &&
+                    (defrag->defrag_status == GF_DEFRAG_STATUS_STARTED)) {
+                        defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                        defrag->total_failures++;
+                }
+        }
+        if (!defrag->brick_crawl || unsupported) {
+                ret = gf_defrag_fix_layout (this, defrag, &loc, fix_layout,
+                                            migrate_data);
+        }
         if ((defrag->defrag_status != GF_DEFRAG_STATUS_STOPPED) &&
             (defrag->defrag_status != GF_DEFRAG_STATUS_FAILED)) {
                 defrag->defrag_status = GF_DEFRAG_STATUS_COMPLETE;
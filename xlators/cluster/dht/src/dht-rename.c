@@ -20,6 +20,8 @@
 #include "xlator.h"
 #include "dht-common.h"
 #include "defaults.h"
+#include "hashfn.h"
+#include "lkowner.h"
 
 
 int
@@ -48,6 +50,9 @@ dht_rename_dir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 local->op_errno = op_errno;
                 goto unwind;
         }
+
+        dht_nlc_invalidate (this, local->loc2.parent, local->loc2.name);
+
         /* TODO: construct proper stbuf for dir */
         /*
          * FIXME: is this the correct way to build stbuf and
@@ -113,6 +118,9 @@ dht_rename_hashed_dir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 local->op_errno = op_errno;
                 goto unwind;
         }
+
+        dht_nlc_invalidate (this, local->loc2.parent, local->loc2.name);
+
         /* TODO: construct proper stbuf for dir */
         /*
          * FIXME: is this the correct way to build stbuf and
@@ -485,6 +493,8 @@ dht_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto cleanup;
         }
 
+        dht_nlc_invalidate (this, local->loc2.parent, local->loc2.name);
+
         if ((src_cached == dst_cached) && (dst_hashed != dst_cached)) {
                 link_frame = copy_frame (frame);
                 if (!link_frame) {
@@ -782,6 +792,642 @@ nolinks:
 }
 
 
+/* rename map */
+
+xlator_t *
+dht_rename_map_subvol (xlator_t *this, uuid_t gfid)
+{
+        dht_conf_t *conf = NULL;
+        uint32_t    hash = 0;
+
+        conf = this->private;
+
+        if (!conf->subvolume_cnt || uuid_is_null (gfid))
+                return NULL;
+
+        hash = gf_dm_hashfn ((const char *) gfid, 16);
+
+        return conf->subvolumes[hash % conf->subvolume_cnt];
+}
+
+
+static xlator_t *
+dht_rename_map_subvol_by_name (xlator_t *this, const char *name)
+{
+        dht_conf_t *conf = NULL;
+        int         i = 0;
+
+        conf = this->private;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+                if (strcmp (conf->subvolumes[i]->name, name) == 0)
+                        return conf->subvolumes[i];
+        }
+
+        return NULL;
+}
+
+
+/* steps over one "<subvolume>\0<name>\0" pair, NULL at the end of the map
+   or on a truncated pair */
+static const char *
+dht_rename_map_next (const char *pos, const char *end, const char **subvol,
+                     const char **name)
+{
+        const char *nul = NULL;
+
+        if (pos >= end)
+                return NULL;
+
+        nul = memchr (pos, '\0', end - pos);
+        if (!nul)
+                return NULL;
+        *subvol = pos;
+        pos = nul + 1;
+
+        nul = memchr (pos, '\0', end - pos);
+        if (!nul)
+                return NULL;
+        *name = pos;
+
+        return nul + 1;
+}
+
+
+static const char *
+dht_rename_map_find (const char *map, size_t len, const char *name)
+{
+        const char *pos = map;
+        const char *subvol = NULL;
+        const char *entry = NULL;
+
+        while ((pos = dht_rename_map_next (pos, map + len, &subvol, &entry))) {
+                if (strcmp (entry, name) == 0)
+                        return subvol;
+        }
+
+        return NULL;
+}
+
+
+/* a copy of the map without the entry of @name, with (@subvol, @name)
+   appended when @subvol is given. *changed tells whether it differs from
+   the original. */
+static char *
+dht_rename_map_edit (const char *map, size_t len, const char *name,
+                     const char *subvol, size_t *newlen,
+                     gf_boolean_t *changed)
+{
+        const char *pos = map;
+        const char *next = NULL;
+        const char *entry_subvol = NULL;
+        const char *entry = NULL;
+        char       *buf = NULL;
+        size_t      size = 0;
+        size_t      off = 0;
+
+        size = len;
+        if (subvol)
+                size += strlen (subvol) + strlen (name) + 2;
+
+        buf = GF_CALLOC (1, size + 1, gf_dht_mt_char);
+        if (!buf)
+                return NULL;
+
+        *changed = _gf_false;
+
+        while ((next = dht_rename_map_next (pos, map + len, &entry_subvol,
+                                            &entry))) {
+                if (strcmp (entry, name) == 0) {
+                        if (subvol && (strcmp (entry_subvol, subvol) == 0)) {
+                                /* already there */
+                                subvol = NULL;
+                        } else {
+                                *changed = _gf_true;
+                                pos = next;
+                                continue;
+                        }
+                }
+                memcpy (buf + off, pos, next - pos);
+                off += next - pos;
+                pos = next;
+        }
+
+        if (subvol) {
+                off += sprintf (buf + off, "%s", subvol) + 1;
+                off += sprintf (buf + off, "%s", name) + 1;
+                *changed = _gf_true;
+        }
+
+        *newlen = off;
+
+        return buf;
+}
+
+
+xlator_t *
+dht_rename_map_get (xlator_t *this, inode_t *parent, const char *name)
+{
+        dht_inode_ctx_t *ctx = NULL;
+        const char      *subvol = NULL;
+        xlator_t        *target = NULL;
+
+        if (!parent || !name || dht_inode_ctx_get (parent, this, &ctx) || !ctx)
+                return NULL;
+
+        LOCK (&parent->lock);
+        {
+                if (ctx->renames)
+                        subvol = dht_rename_map_find (ctx->renames->data,
+                                                      ctx->renames->len, name);
+                if (subvol)
+                        target = dht_rename_map_subvol_by_name (this, subvol);
+        }
+        UNLOCK (&parent->lock);
+
+        return target;
+}
+
+
+static void
+dht_rename_map_cache (xlator_t *this, inode_t *inode, data_t *map)
+{
+        dht_inode_ctx_t *ctx = NULL;
+        data_t          *old = NULL;
+
+        if (!inode || dht_inode_ctx_get (inode, this, &ctx) || !ctx)
+                return;
+
+        if (map && !map->len)
+                map = NULL;
+
+        LOCK (&inode->lock);
+        {
+                old = ctx->renames;
+                ctx->renames = map ? data_ref (map) : NULL;
+        }
+        UNLOCK (&inode->lock);
+
+        if (old)
+                data_unref (old);
+}
+
+
+/* keeps the cached map of @parent in step with an update we made */
+static void
+dht_rename_map_cache_edit (xlator_t *this, inode_t *parent, const char *name,
+                           xlator_t *subvol)
+{
+        dht_inode_ctx_t *ctx = NULL;
+        data_t          *map = NULL;
+        char            *buf = NULL;
+        size_t           len = 0;
+        gf_boolean_t     changed = _gf_false;
+
+        if (!parent || !name || dht_inode_ctx_get (parent, this, &ctx) || !ctx)
+                return;
+
+        LOCK (&parent->lock);
+        {
+                if (ctx->renames)
+                        buf = dht_rename_map_edit (ctx->renames->data,
+                                                   ctx->renames->len, name,
+                                                   subvol ? subvol->name : NULL,
+                                                   &len, &changed);
+                else if (subvol)
+                        buf = dht_rename_map_edit (NULL, 0, name, subvol->name,
+                                                   &len, &changed);
+        }
+        UNLOCK (&parent->lock);
+
+        if (!buf)
+                return;
+
+        if (changed && len)
+                map = data_from_dynptr (buf, len);
+        if (!map) {
+                GF_FREE (buf);
+                if (!changed)
+                        return;
+        }
+
+        dht_rename_map_cache (this, parent, map);
+}
+
+
+/* called for each successful directory lookup reply, under frame->lock */
+void
+dht_rename_map_capture (xlator_t *this, dht_local_t *local, xlator_t *subvol,
+                        struct iatt *stbuf, dict_t *xattr)
+{
+        data_t *map = NULL;
+
+        if (subvol != dht_rename_map_subvol (this, stbuf->ia_gfid))
+                return;
+
+        local->rename_map_seen = _gf_true;
+
+        if (xattr)
+                map = dict_get (xattr, DHT_RENAME_MAP_KEY);
+        if (local->rename_map)
+                data_unref (local->rename_map);
+        local->rename_map = map ? data_ref (map) : NULL;
+}
+
+
+void
+dht_rename_map_apply (xlator_t *this, dht_local_t *local)
+{
+        if (!local->rename_map_seen || !local->inode)
+                return;
+
+        dht_rename_map_cache (this, local->inode, local->rename_map);
+}
+
+
+void
+dht_rename_map_release (dht_inode_ctx_t *ctx)
+{
+        if (ctx->renames) {
+                data_unref (ctx->renames);
+                ctx->renames = NULL;
+        }
+}
+
+
+/* runs in a synctask: sets the entry of @name in the map of @parent to
+   @subvol, or removes it when @subvol is NULL */
+static int
+dht_rename_map_update (xlator_t *this, inode_t *parent, const char *name,
+                       xlator_t *subvol)
+{
+        dht_conf_t      *conf = NULL;
+        xlator_t        *holder = NULL;
+        struct synctask *task = NULL;
+        struct gf_flock  flock = {0, };
+        loc_t            loc = {0, };
+        dict_t          *xattr = NULL;
+        dict_t          *update = NULL;
+        data_t          *map = NULL;
+        char            *buf = NULL;
+        size_t           len = 0;
+        gf_boolean_t     changed = _gf_false;
+        int              ret = -1;
+        int              err = 0;
+
+        conf = this->private;
+
+        if (!parent || !name)
+                goto out;
+
+        holder = dht_rename_map_subvol (this, parent->gfid);
+        if (!holder)
+                goto out;
+
+        task = synctask_get ();
+        set_lk_owner_from_ptr (&task->opframe->root->lk_owner, task);
+
+        loc.inode = inode_ref (parent);
+        uuid_copy (loc.gfid, parent->gfid);
+        inode_path (parent, NULL, (char **)&loc.path);
+
+        flock.l_type   = F_WRLCK;
+        flock.l_whence = SEEK_SET;
+
+        ret = syncop_inodelk (holder, DHT_RENAME_MAP_DOMAIN, &loc, F_SETLKW,
+                              &flock);
+        if (ret) {
+                err = errno;
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: failed to lock rename map on %s (%s)",
+                        loc.path, holder->name, strerror (err));
+                goto out;
+        }
+
+        ret = syncop_getxattr (holder, &loc, &xattr, DHT_RENAME_MAP_KEY);
+        if (ret && (errno != ENODATA)) {
+                err = errno;
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: failed to read rename map on %s (%s)",
+                        loc.path, holder->name, strerror (err));
+                goto unlock;
+        }
+
+        if (xattr)
+                map = dict_get (xattr, DHT_RENAME_MAP_KEY);
+
+        buf = dht_rename_map_edit (map ? map->data : NULL, map ? map->len : 0,
+                                   name, subvol ? subvol->name : NULL,
+                                   &len, &changed);
+        if (!buf) {
+                ret = -1;
+                err = ENOMEM;
+                goto unlock;
+        }
+
+        if (subvol && (len > conf->rename_map_size)) {
+                ret = -1;
+                err = ENOSPC;
+                goto unlock;
+        }
+
+        ret = 0;
+        if (!changed)
+                goto unlock;
+
+        if (!len) {
+                ret = syncop_removexattr (holder, &loc, DHT_RENAME_MAP_KEY);
+                if (ret && (errno == ENODATA))
+                        ret = 0;
+        } else {
+                update = dict_new ();
+                if (!update ||
+                    dict_set_bin (update, DHT_RENAME_MAP_KEY, buf, len)) {
+                        ret = -1;
+                        errno = ENOMEM;
+                } else {
+                        buf = NULL;
+                        ret = syncop_setxattr (holder, &loc, update, 0);
+                }
+        }
+        if (ret) {
+                err = errno;
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: failed to write rename map on %s (%s)",
+                        loc.path, holder->name, strerror (err));
+        }
+
+unlock:
+        flock.l_type = F_UNLCK;
+        syncop_inodelk (holder, DHT_RENAME_MAP_DOMAIN, &loc, F_SETLK, &flock);
+
+        if (!ret) {
+                /* what we wrote is the map now */
+                map = NULL;
+                if (changed && len && update)
+                        map = dict_get (update, DHT_RENAME_MAP_KEY);
+                else if (!changed && xattr)
+                        map = dict_get (xattr, DHT_RENAME_MAP_KEY);
+                dht_rename_map_cache (this, parent, map);
+        }
+
+out:
+        GF_FREE (buf);
+        if (xattr)
+                dict_unref (xattr);
+        if (update)
+                dict_unref (update);
+        loc_wipe (&loc);
+
+        if (ret)
+                errno = err;
+
+        return ret;
+}
+
+
+static int
+dht_rename_map_forget_task (void *data)
+{
+        call_frame_t *frame = NULL;
+        dht_local_t  *local = NULL;
+
+        frame = data;
+        local = frame->local;
+
+        SYNCTASK_SETID (0, 0);
+
+        return dht_rename_map_update (frame->this, local->loc.parent,
+                                      local->loc.name, NULL);
+}
+
+
+static int
+dht_rename_map_forget_done (int op_ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t *frame = NULL;
+
+        frame = data;
+
+        DHT_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+/* drops the entry of a name that went away, in the background */
+void
+dht_rename_map_forget (xlator_t *this, loc_t *loc)
+{
+        call_frame_t *frame = NULL;
+        dht_local_t  *local = NULL;
+        int           ret = -1;
+
+        if (!loc->parent || !loc->name)
+                return;
+
+        dht_rename_map_cache_edit (this, loc->parent, loc->name, NULL);
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto err;
+
+        local = dht_local_init (frame, loc, NULL, GF_FOP_MAXVALUE);
+        if (!local)
+                goto err;
+
+        ret = synctask_new (this->ctx->env, dht_rename_map_forget_task,
+                            dht_rename_map_forget_done, frame, frame);
+        if (!ret)
+                return;
+
+err:
+        gf_log (this->name, GF_LOG_DEBUG,
+                "%s: could not drop rename map entry", loc->path);
+        if (frame)
+                DHT_STACK_DESTROY (frame);
+}
+
+
+int
+dht_rename_in_place_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                         struct iatt *preoldparent, struct iatt *postoldparent,
+                         struct iatt *prenewparent, struct iatt *postnewparent,
+                         dict_t *xdata)
+{
+        dht_local_t  *local = NULL;
+        call_frame_t *prev = NULL;
+        xlator_t     *src_hashed = NULL;
+        xlator_t     *src_cached = NULL;
+        xlator_t     *dst_hashed = NULL;
+        xlator_t     *dst_cached = NULL;
+        gf_boolean_t  src_mapped = _gf_false;
+
+        local = frame->local;
+        prev = cookie;
+
+        src_hashed = local->src_hashed;
+        src_cached = local->src_cached;
+        dst_hashed = local->dst_hashed;
+        dst_cached = local->dst_cached;
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s: rename on %s failed (%s)", local->loc.path,
+                        prev->this->name, strerror (op_errno));
+                dht_rename_map_forget (this, &local->loc2);
+                DHT_STACK_UNWIND (rename, frame, -1, op_errno, NULL, NULL,
+                                  NULL, NULL, NULL, NULL);
+                return 0;
+        }
+
+        dht_nlc_invalidate (this, local->loc2.parent, local->loc2.name);
+
+        dht_iatt_merge (this, &local->stbuf, stbuf, prev->this);
+        dht_iatt_merge (this, &local->preoldparent, preoldparent, prev->this);
+        dht_iatt_merge (this, &local->postoldparent, postoldparent, prev->this);
+        dht_iatt_merge (this, &local->preparent, prenewparent, prev->this);
+        dht_iatt_merge (this, &local->postparent, postnewparent, prev->this);
+
+        /* the old name may itself have been a map entry, then there is no
+           linkfile to remove for it */
+        if (dht_rename_map_get (this, local->loc.parent, local->loc.name)) {
+                src_mapped = _gf_true;
+                dht_rename_map_forget (this, &local->loc);
+        }
+
+        if (src_hashed != src_cached && !src_mapped)
+                local->call_cnt++;
+
+        if (dst_cached && dst_cached != src_cached)
+                local->call_cnt++;
+
+        if (dst_cached && dst_cached != dst_hashed)
+                local->call_cnt++;
+
+        if (local->call_cnt == 0)
+                goto unwind;
+
+        if (src_hashed != src_cached && !src_mapped) {
+                gf_log (this->name, GF_LOG_TRACE,
+                        "deleting old src linkfile %s @ %s",
+                        local->loc.path, src_hashed->name);
+
+                STACK_WIND (frame, dht_rename_unlink_cbk,
+                            src_hashed, src_hashed->fops->unlink,
+                            &local->loc, 0, NULL);
+        }
+
+        if (dst_cached && dst_cached != src_cached) {
+                gf_log (this->name, GF_LOG_TRACE,
+                        "deleting old dst datafile %s @ %s",
+                        local->loc2.path, dst_cached->name);
+
+                STACK_WIND (frame, dht_rename_unlink_cbk,
+                            dst_cached, dst_cached->fops->unlink,
+                            &local->loc2, 0, NULL);
+        }
+
+        if (dst_cached && dst_cached != dst_hashed) {
+                gf_log (this->name, GF_LOG_TRACE,
+                        "deleting old dst linkfile %s @ %s",
+                        local->loc2.path, dst_hashed->name);
+
+                STACK_WIND (frame, dht_rename_unlink_cbk,
+                            dst_hashed, dst_hashed->fops->unlink,
+                            &local->loc2, 0, NULL);
+        }
+
+        return 0;
+
+unwind:
+        WIPE (&local->preoldparent);
+        WIPE (&local->postoldparent);
+        WIPE (&local->preparent);
+        WIPE (&local->postparent);
+
+        DHT_STRIP_PHASE1_FLAGS (&local->stbuf);
+        DHT_STACK_UNWIND (rename, frame, local->op_ret, local->op_errno,
+                          &local->stbuf, &local->preoldparent,
+                          &local->postoldparent, &local->preparent,
+                          &local->postparent, NULL);
+
+        return 0;
+}
+
+
+static int
+dht_rename_map_task (void *data)
+{
+        call_frame_t *frame = NULL;
+        dht_local_t  *local = NULL;
+
+        frame = data;
+        local = frame->local;
+
+        SYNCTASK_SETID (0, 0);
+
+        return dht_rename_map_update (frame->this, local->loc2.parent,
+                                      local->loc2.name, local->src_cached);
+}
+
+
+static int
+dht_rename_map_done (int op_ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t *frame = NULL;
+        dht_local_t  *local = NULL;
+        xlator_t     *src_cached = NULL;
+
+        frame = data;
+        local = frame->local;
+        src_cached = local->src_cached;
+
+        if (op_ret) {
+                gf_log (frame->this->name, GF_LOG_DEBUG,
+                        "%s: rename map not updated (%s), using linkfiles",
+                        local->loc2.path, strerror (errno));
+                dht_rename_create_links (frame);
+                return 0;
+        }
+
+        gf_log (frame->this->name, GF_LOG_TRACE,
+                "renaming %s => %s in place (%s)",
+                local->loc.path, local->loc2.path, src_cached->name);
+
+        STACK_WIND (frame, dht_rename_in_place_cbk,
+                    src_cached, src_cached->fops->rename,
+                    &local->loc, &local->loc2, NULL);
+
+        return 0;
+}
+
+
+/* a file which stays where it is while its new name hashes elsewhere is
+   listed in the rename map of the new directory, instead of getting a
+   linkfile on the new hashed subvolume */
+static gf_boolean_t
+dht_rename_map_wanted (xlator_t *this, dht_local_t *local)
+{
+        dht_conf_t *conf = NULL;
+
+        conf = this->private;
+
+        if (!conf->rename_map_size)
+                return _gf_false;
+
+        if (local->src_cached == local->dst_hashed)
+                return _gf_false;
+
+        if (!local->loc2.parent || !local->loc2.name ||
+            uuid_is_null (local->loc2.parent->gfid))
+                return _gf_false;
+
+        return _gf_true;
+}
+
+
 int
 dht_rename (call_frame_t *frame, xlator_t *this,
             loc_t *oldloc, loc_t *newloc, dict_t *xdata)
@@ -859,6 +1505,10 @@ dht_rename (call_frame_t *frame, xlator_t *this,
                 dht_rename_dir (frame, this);
         } else {
                 local->op_ret = 0;
+                if (dht_rename_map_wanted (this, local) &&
+                    !synctask_new (this->ctx->env, dht_rename_map_task,
+                                   dht_rename_map_done, frame, frame))
+                        return 0;
                 dht_rename_create_links (frame);
         }
 
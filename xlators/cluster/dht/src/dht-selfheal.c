@@ -28,6 +28,10 @@
                         layout->list[i].xlator->name, path);            \
         } while (0)
 
+/* share of the hash space of a subvolume of the given weight, never empty */
+#define DHT_WEIGHTED_CHUNK(weight,total)                                \
+        max ((uint32_t)(((uint64_t) 0xffffffff * (weight)) / (total)), 1)
+
 #define DHT_RESET_LAYOUT_RANGE(layout)    do {                          \
                 int cnt = 0;                                            \
                 for (cnt = 0; cnt < layout->cnt; cnt++ ) {              \
@@ -637,6 +641,8 @@ dht_selfheal_layout_maximize_overlap (call_frame_t *frame, loc_t *loc,
 	int           max_overlap_idx = -1;
 	uint32_t      overlap      = 0;
         uint32_t     *table = NULL;
+        uint32_t      size_i       = 0;
+        uint32_t      size_j       = 0;
 
 	dht_layout_sort_volname (old);
 	/* Now both old_layout->list[] and new_layout->list[]
@@ -676,6 +682,15 @@ dht_selfheal_layout_maximize_overlap (call_frame_t *frame, loc_t *loc,
 			        */
 			        continue;
                         }
+                        /* Weighted ranges may differ in size, swapping
+                           those would give a subvolume the share of
+                           another. Equal ones only differ by the rounding
+                           left to the last range. */
+                        size_i = new->list[i].stop - new->list[i].start;
+                        size_j = new->list[j].stop - new->list[j].start;
+                        if (((size_i > size_j) ? (size_i - size_j) :
+                             (size_j - size_i)) >= (uint32_t) new->cnt)
+                                continue;
                         /* Calculate the overlap now. */
                         curr_overlap = OV_ENTRY(i,i) + OV_ENTRY(j,j);
                         /* Calculate the overlap after the proposed swap. */
@@ -774,6 +789,56 @@ done:
 }
 
 
+/* Weights of the 'cnt' subvolumes getting a range, in the order they get
+ * it, from their total space in MBs. Returns their sum, or 0 when ranges
+ * are to be equal: weighting is off or the size of one is not known yet.
+ */
+static uint64_t
+dht_selfheal_layout_weights (xlator_t *this, dht_layout_t *layout,
+                             int start_subvol, int cnt, uint32_t *weights)
+{
+        dht_conf_t *conf  = NULL;
+        uint64_t    total = 0;
+        int         i     = 0;
+        int         j     = 0;
+        int         k     = 0;
+        int         err   = 0;
+
+        conf = this->private;
+        if (!conf->do_weighting)
+                return 0;
+
+        LOCK (&conf->subvolume_lock);
+        {
+                for (k = 0; (k < layout->cnt) && cnt; k++) {
+                        i = (start_subvol + k) % layout->cnt;
+                        err = layout->list[i].err;
+                        if (err != -1 && err != ENOENT)
+                                continue;
+
+                        for (j = 0; j < conf->subvolume_cnt; j++) {
+                                if (conf->subvolumes[j] ==
+                                    layout->list[i].xlator)
+                                        break;
+                        }
+                        if ((j == conf->subvolume_cnt) ||
+                            !conf->du_stats[j].total_space) {
+                                total = 0;
+                                break;
+                        }
+
+                        weights[i] = conf->du_stats[j].total_space >> 20;
+                        if (!weights[i])
+                                weights[i] = 1;
+                        total += weights[i];
+                        cnt--;
+                }
+        }
+        UNLOCK (&conf->subvolume_lock);
+
+        return total;
+}
+
 void
 dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
                                    dht_layout_t *layout)
@@ -785,6 +850,8 @@ dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
         int          cnt = 0;
         int          err = 0;
         int          start_subvol = 0;
+        uint32_t    *weights = NULL;
+        uint64_t     total = 0;
 
         this = frame->this;
 
@@ -794,11 +861,17 @@ dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
 
         start_subvol = dht_selfheal_layout_alloc_start (this, loc, layout);
 
+        weights = alloca (layout->cnt * sizeof (*weights));
+        total = dht_selfheal_layout_weights (this, layout, start_subvol, cnt,
+                                             weights);
+
         /* clear out the range, as we are re-computing here */
         DHT_RESET_LAYOUT_RANGE (layout);
         for (i = start_subvol; i < layout->cnt; i++) {
                 err = layout->list[i].err;
                 if (err == -1 || err == ENOENT) {
+                        if (total)
+                                chunk = DHT_WEIGHTED_CHUNK (weights[i], total);
                         DHT_SET_LAYOUT_RANGE(layout, i, start, chunk,
                                              cnt, loc->path);
                         if (--cnt == 0) {
@@ -812,6 +885,8 @@ dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
         for (i = 0; i < start_subvol; i++) {
                 err = layout->list[i].err;
                 if (err == -1 || err == ENOENT) {
+                        if (total)
+                                chunk = DHT_WEIGHTED_CHUNK (weights[i], total);
                         DHT_SET_LAYOUT_RANGE(layout, i, start, chunk,
                                              cnt, loc->path);
                         if (--cnt == 0) {
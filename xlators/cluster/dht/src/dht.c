@@ -130,6 +130,10 @@ dht_priv_dump (xlator_t *this)
         gf_proc_dump_write("disk_unit", "%c", conf->disk_unit);
         gf_proc_dump_write("refresh_interval", "%d", conf->refresh_interval);
         gf_proc_dump_write("unhashed_sticky_bit", "%d", conf->unhashed_sticky_bit);
+        if (conf->nlc_enabled) {
+                gf_proc_dump_write("nlc.size", "%"PRIu64, conf->nlc_size);
+                gf_proc_dump_write("nlc.hits", "%"PRIu64, conf->nlc_hits);
+        }
         if (conf ->du_stats) {
                 gf_proc_dump_write("du_stats.avail_percent", "%lf",
                                    conf->du_stats->avail_percent);
@@ -338,9 +342,33 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("readdir-optimize", conf->readdir_optimize, options,
                           bool, out);
+        GF_OPTION_RECONF ("readdir-prefetch", conf->readdir_prefetch, options,
+                          uint32, out);
+        GF_OPTION_RECONF ("weighted-rebalance", conf->do_weighting, options,
+                          bool, out);
+        GF_OPTION_RECONF ("negative-lookup-cache", conf->nlc_enabled, options,
+                          bool, out);
+        GF_OPTION_RECONF ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                          options, uint32, out);
+        GF_OPTION_RECONF ("negative-lookup-cache-size", conf->nlc_limit,
+                          options, size, out);
+        GF_OPTION_RECONF ("rename-map-size", conf->rename_map_size,
+                          options, size, out);
         if (conf->defrag) {
                 GF_OPTION_RECONF ("rebalance-stats", conf->defrag->stats,
                                   options, bool, out);
+                GF_OPTION_RECONF ("rebalance-workers",
+                                  conf->defrag->workers_max, options, uint32,
+                                  out);
+                GF_OPTION_RECONF ("rebalance-pipeline-depth",
+                                  conf->defrag->pipeline_depth, options,
+                                  uint32, out);
+                GF_OPTION_RECONF ("rebalance-latency-target",
+                                  conf->defrag->latency_target, options,
+                                  uint32, out);
+                GF_OPTION_RECONF ("rebalance-brick-crawl",
+                                  conf->defrag->brick_crawl, options, bool,
+                                  out);
         }
 
         if (dict_get_str (options, "decommissioned-bricks", &temp_str) == 0) {
@@ -446,8 +474,30 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("readdir-optimize", conf->readdir_optimize, bool, err);
 
+        GF_OPTION_INIT ("readdir-prefetch", conf->readdir_prefetch, uint32,
+                        err);
+
+        GF_OPTION_INIT ("weighted-rebalance", conf->do_weighting, bool, err);
+
+        GF_OPTION_INIT ("negative-lookup-cache", conf->nlc_enabled, bool, err);
+        GF_OPTION_INIT ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                        uint32, err);
+        GF_OPTION_INIT ("negative-lookup-cache-size", conf->nlc_limit, size,
+                        err);
+
+        GF_OPTION_INIT ("rename-map-size", conf->rename_map_size, size, err);
+
         if (defrag) {
                 GF_OPTION_INIT ("rebalance-stats", defrag->stats, bool, err);
+                GF_OPTION_INIT ("rebalance-workers", defrag->workers_max,
+                                uint32, err);
+                GF_OPTION_INIT ("rebalance-pipeline-depth",
+                                defrag->pipeline_depth, uint32, err);
+                GF_OPTION_INIT ("rebalance-latency-target",
+                                defrag->latency_target, uint32, err);
+                GF_OPTION_INIT ("rebalance-brick-crawl", defrag->brick_crawl,
+                                bool, err);
+                defrag->workers = defrag->workers_max;
         }
 
         /* option can be any one of percent or bytes */
@@ -473,6 +523,8 @@ init (xlator_t *this)
 
         LOCK_INIT (&conf->subvolume_lock);
         LOCK_INIT (&conf->layout_lock);
+        LOCK_INIT (&conf->nlc_lock);
+        INIT_LIST_HEAD (&conf->nlc_lru);
 
         conf->gen = 1;
 
@@ -552,6 +604,11 @@ struct xlator_fops fops = {
         .fsetxattr   = dht_fsetxattr,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
+        .copy_file_range = dht_copy_file_range,
         .writev      = dht_writev,
         .xattrop     = dht_xattrop,
         .fxattrop    = dht_fxattrop,
@@ -567,7 +624,7 @@ struct xlator_dumpops dumpops = {
 
 struct xlator_cbks cbks = {
 //      .release    = dht_release,
-//      .releasedir = dht_releasedir,
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -630,6 +687,15 @@ struct volume_options options[] = {
         { .key = {"node-uuid"},
           .type = GF_OPTION_TYPE_STR,
         },
+        { .key = {"weighted-rebalance"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "When enabled, the hash range of a subvolume in the "
+          "layout of a new or fixed directory is proportional to its total "
+          "size, so that bricks of different sizes fill up evenly. Existing "
+          "directories get weighted layouts from a fix-layout or a "
+          "rebalance."
+        },
         { .key = {"rebalance-stats"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
@@ -638,6 +704,42 @@ struct volume_options options[] = {
           "process. If set to OFF, the rebalance logs will only display the "
           "time spent in each directory."
         },
+        { .key = {"rebalance-workers"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 1,
+          .max = 64,
+          .default_value = "4",
+          .description = "Maximum number of files the rebalance process of "
+          "a node migrates at the same time. 1 migrates them one by one."
+        },
+        { .key = {"rebalance-pipeline-depth"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 1,
+          .max = 32,
+          .default_value = "4",
+          .description = "Number of blocks of a file the rebalance process "
+          "reads and writes at the same time while migrating it. Sparse "
+          "files are always copied one block at a time."
+        },
+        { .key = {"rebalance-latency-target"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 60000,
+          .default_value = "0",
+          .description = "Average time, in milliseconds, a migrated block "
+          "may take to be read and written. Above it the rebalance process "
+          "migrates fewer files at the same time, below it more, up to "
+          "rebalance-workers. 0 disables the throttle."
+        },
+        { .key = {"rebalance-brick-crawl"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "If ON, the rebalance process of a node gets the "
+          "directories and files to rebalance from a listing, done on the "
+          "bricks themselves, of the subvolumes whose data it migrates, "
+          "instead of crawling the whole namespace. It falls back to the "
+          "crawl when some of those bricks cannot list themselves."
+        },
         { .key = {"readdir-optimize"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
@@ -645,6 +747,53 @@ struct volume_options options[] = {
           "that allows DHT to requests non-first subvolumes to filter out "
           "directory entries."
         },
+        { .key = {"readdir-prefetch"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 64,
+          .default_value = "0",
+          .description = "Number of subvolumes whose first directory entries "
+          "are read ahead, in parallel, while an earlier subvolume of the "
+          "directory is being listed; the next entries of that subvolume are "
+          "read ahead as well. 0 lists the subvolumes strictly one after "
+          "the other."
+        },
+        { .key = {"negative-lookup-cache"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "This option if set to ON remembers, per directory, "
+          "the names a lookup did not find, and answers further lookups of "
+          "them with ENOENT without going to the subvolumes. The names are "
+          "forgotten when the directory's layout or mtime changes, or when "
+          "they are created through this client."
+        },
+        { .key = {"negative-lookup-cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 3600,
+          .default_value = "5",
+          .description = "Seconds a missing name is remembered. Names "
+          "created by other clients are seen after at most this long."
+        },
+        { .key = {"negative-lookup-cache-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min = 0,
+          .max = 1 * GF_UNIT_GB,
+          .default_value = "8MB",
+          .description = "Memory used for remembered names; the least "
+          "recently used ones are dropped beyond it."
+        },
+        { .key = {"rename-map-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min = 0,
+          .max = 64 * GF_UNIT_KB,
+          .default_value = "0",
+          .description = "Files renamed to a name hashing to another "
+          "subvolume stay where they are and are listed in an extended "
+          "attribute of their directory, up to this many bytes per "
+          "directory, instead of getting a linkfile. 0 keeps linkfiles. "
+          "ext4 bricks hold about 4KB of extended attributes per inode."
+        },
 
         { .key  = {NULL} },
 };
@@ -976,6 +976,11 @@ struct xlator_fops fops = {
         .fstat       = dht_fstat,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
+        .copy_file_range = dht_copy_file_range,
         .access      = dht_access,
         .readlink    = dht_readlink,
         .setxattr    = dht_setxattr,
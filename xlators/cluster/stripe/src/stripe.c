@@ -3092,6 +3092,342 @@ err:
 }
 
 
+/*
+ * Map the byte range [offset, offset + len) of the file onto the part that
+ * is stored on the stripe child at index 'idx'. Returns -1 when none of the
+ * stripes in the range belong to that child.
+ */
+static int
+stripe_child_range (stripe_fd_ctx_t *fctx, int idx, off_t offset, size_t len,
+                    off_t *dest_offset, size_t *dest_len)
+{
+        uint64_t        stripe_size  = fctx->stripe_size;
+        int             stripe_count = fctx->stripe_count;
+        off_t           first        = 0;
+        off_t           last         = 0;
+        off_t           block        = 0;
+        int             block_idx    = 0;
+
+        /* first byte of the range which lives on this child */
+        block = floor (offset, stripe_size);
+        block_idx = (block / stripe_size) % stripe_count;
+        if (block_idx == idx)
+                first = offset;
+        else
+                first = block + ((idx - block_idx + stripe_count) %
+                                 stripe_count) * stripe_size;
+
+        /* last byte of the range which lives on this child */
+        block = floor (offset + len - 1, stripe_size);
+        block_idx = (block / stripe_size) % stripe_count;
+        if (block_idx == idx)
+                last = offset + len - 1;
+        else
+                last = block - ((block_idx - idx + stripe_count) %
+                                stripe_count) * stripe_size + stripe_size - 1;
+
+        if ((first >= offset + len) || (last < first))
+                return -1;
+
+        if (fctx->stripe_coalesce) {
+                first = coalesced_offset (first, stripe_size, stripe_count);
+                last = coalesced_offset (last, stripe_size, stripe_count);
+        }
+
+        *dest_offset = first;
+        *dest_len = last - first + 1;
+
+        return 0;
+}
+
+
+/*
+ * Common reply handling for the fops which operate on a byte range without
+ * carrying data. Returns the number of replies which are still pending.
+ */
+static int32_t
+stripe_range_fop_reply (call_frame_t *frame, call_frame_t *prev,
+                        xlator_t *this, int32_t op_ret, int32_t op_errno,
+                        struct iatt *prebuf, struct iatt *postbuf)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                if (op_ret == 0) {
+                        local->op_ret = 0;
+                        if (FIRST_CHILD(this) == prev->this) {
+                                local->pre_buf  = *prebuf;
+                                local->post_buf = *postbuf;
+                        }
+
+                        local->prebuf_blocks  += prebuf->ia_blocks;
+                        local->postbuf_blocks += postbuf->ia_blocks;
+
+                        correct_file_size (prebuf, local->fctx, prev);
+                        correct_file_size (postbuf, local->fctx, prev);
+
+                        if (local->prebuf_size < prebuf->ia_size)
+                                local->prebuf_size = prebuf->ia_size;
+
+                        if (local->postbuf_size < postbuf->ia_size)
+                                local->postbuf_size = postbuf->ia_size;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                if (local->failed)
+                        local->op_ret = -1;
+
+                if (local->op_ret != -1) {
+                        local->pre_buf.ia_blocks  = local->prebuf_blocks;
+                        local->pre_buf.ia_size    = local->prebuf_size;
+                        local->post_buf.ia_blocks = local->postbuf_blocks;
+                        local->post_buf.ia_size   = local->postbuf_size;
+                }
+        }
+
+        return callcnt;
+}
+
+
+int32_t
+stripe_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf, dict_t *xdata)
+{
+        stripe_local_t *local = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        local = frame->local;
+
+        if (stripe_range_fop_reply (frame, cookie, this, op_ret, op_errno,
+                                    prebuf, postbuf))
+                goto out;
+
+        switch (local->fop) {
+        case GF_FOP_FALLOCATE:
+                STRIPE_STACK_UNWIND (fallocate, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf, NULL);
+                break;
+        case GF_FOP_DISCARD:
+                STRIPE_STACK_UNWIND (discard, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf, NULL);
+                break;
+        default:
+                STRIPE_STACK_UNWIND (zerofill, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf, NULL);
+                break;
+        }
+out:
+        return 0;
+}
+
+
+/*
+ * Wind a range fop to every child which stores a part of the range. The
+ * children see the range translated to their own file layout, so a large
+ * request results in one call per child rather than one per stripe.
+ * Returns an errno on failure, in which case nothing has been wound.
+ */
+static int32_t
+stripe_range_fop_wind (call_frame_t *frame, xlator_t *this,
+                       glusterfs_fop_t fop, fd_t *fd, int32_t mode,
+                       off_t offset, size_t len, dict_t *xdata)
+{
+        stripe_local_t   *local = NULL;
+        stripe_fd_ctx_t  *fctx = NULL;
+        xlator_t         *subvol = NULL;
+        uint64_t          tmp_fctx = 0;
+        off_t             dest_offset = 0;
+        size_t            dest_len = 0;
+        int               i = 0;
+        int               count = 0;
+
+        inode_ctx_get (fd->inode, this, &tmp_fctx);
+        if (!tmp_fctx) {
+                gf_log (this->name, GF_LOG_ERROR, "no stripe context");
+                return EINVAL;
+        }
+        fctx = (stripe_fd_ctx_t *)(long)tmp_fctx;
+
+        if (!fctx->stripe_count || !fctx->stripe_size) {
+                gf_log (this->name, GF_LOG_ERROR, "invalid stripe context");
+                return EINVAL;
+        }
+
+        if (!len)
+                return EINVAL;
+
+        for (i = 0; i < fctx->stripe_count; i++) {
+                if (!fctx->xl_array[i]) {
+                        gf_log (this->name, GF_LOG_ERROR, "no xlator at index "
+                                "%d", i);
+                        return EINVAL;
+                }
+                if (!stripe_child_range (fctx, i, offset, len, &dest_offset,
+                                         &dest_len))
+                        count++;
+        }
+
+        local = mem_get0 (this->local_pool);
+        if (!local)
+                return ENOMEM;
+
+        local->op_ret = -1;
+        local->fctx = fctx;
+        local->fop = fop;
+        local->call_count = count;
+        frame->local = local;
+
+        for (i = 0; i < fctx->stripe_count; i++) {
+                if (stripe_child_range (fctx, i, offset, len, &dest_offset,
+                                        &dest_len))
+                        continue;
+
+                subvol = fctx->xl_array[i];
+
+                switch (fop) {
+                case GF_FOP_FALLOCATE:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->fallocate, fd, mode,
+                                    dest_offset, dest_len, xdata);
+                        break;
+                case GF_FOP_DISCARD:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->discard, fd, dest_offset,
+                                    dest_len, xdata);
+                        break;
+                default:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->zerofill, fd, dest_offset,
+                                    dest_len, xdata);
+                        break;
+                }
+        }
+
+        return 0;
+}
+
+
+int32_t
+stripe_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t mode, off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t           op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        op_errno = stripe_range_fop_wind (frame, this, GF_FOP_FALLOCATE, fd,
+                                          mode, offset, len, xdata);
+        if (op_errno)
+                goto err;
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+stripe_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t           op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        op_errno = stripe_range_fop_wind (frame, this, GF_FOP_DISCARD, fd, 0,
+                                          offset, len, xdata);
+        if (op_errno)
+                goto err;
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+stripe_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t           op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        op_errno = stripe_range_fop_wind (frame, this, GF_FOP_ZEROFILL, fd, 0,
+                                          offset, len, xdata);
+        if (op_errno)
+                goto err;
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+/* Every child holds only every n-th block of the file, so the data/hole
+ * offsets a child reports cannot be mapped back without walking each
+ * stripe. Refuse instead of letting the default pass it to one child;
+ * callers then treat the whole range as data. */
+int32_t
+stripe_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+        STRIPE_STACK_UNWIND (seek, frame, -1, ENOTSUP, 0, NULL);
+        return 0;
+}
+
+
+/* Source and destination stripes only line up on the same child when both
+ * offsets fall at the same place of a stripe of the same size, which is
+ * rare enough not to bother. Report it like a cross-device copy, so that
+ * the caller falls back to reading and writing. */
+int32_t
+stripe_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                        off_t off_in, fd_t *fd_out, off_t off_out,
+                        size_t len, uint32_t flags, dict_t *xdata)
+{
+        STRIPE_STACK_UNWIND (copy_file_range, frame, -1, EXDEV, NULL, NULL,
+                             NULL, NULL);
+        return 0;
+}
+
+
 int32_t
 stripe_fsyncdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -5204,6 +5540,11 @@ struct xlator_fops fops = {
         .flush          = stripe_flush,
         .fsync          = stripe_fsync,
         .ftruncate      = stripe_ftruncate,
+        .fallocate      = stripe_fallocate,
+        .discard        = stripe_discard,
+        .zerofill       = stripe_zerofill,
+        .seek           = stripe_seek,
+        .copy_file_range = stripe_copy_file_range,
         .fstat          = stripe_fstat,
         .mkdir          = stripe_mkdir,
         .rmdir          = stripe_rmdir,
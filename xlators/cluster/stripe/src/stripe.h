@@ -211,6 +211,7 @@ struct stripe_local {
 
         int                  xflag;
         mode_t               umask;
+        glusterfs_fop_t      fop;
 };
 
 typedef struct stripe_local   stripe_local_t;
@@ -15,6 +15,8 @@
 #include "xlator.h"
 #include "error-gen.h"
 #include "statedump.h"
+#include "call-stub.h"
+#include "timer.h"
 
 sys_error_t error_no_list[] = {
         [GF_FOP_LOOKUP]            = { .error_no_count = 4,
@@ -174,7 +176,16 @@ sys_error_t error_no_list[] = {
                                                  EROFS,EBADF,EIO}},
         [GF_FOP_GETSPEC]           = { .error_no_count = 4,
                                     .error_no = {EACCES,EBADF,ENAMETOOLONG,
-                                                 EINTR}}
+                                                 EINTR}},
+        [GF_FOP_FALLOCATE]         = { .error_no_count = 7,
+                                    .error_no = {EBADF,EFBIG,EINTR,EINVAL,
+                                                 EIO,ENOSPC,EOPNOTSUPP}},
+        [GF_FOP_DISCARD]           = { .error_no_count = 5,
+                                    .error_no = {EBADF,EINTR,EINVAL,EIO,
+                                                 EOPNOTSUPP}},
+        [GF_FOP_ZEROFILL]          = { .error_no_count = 7,
+                                    .error_no = {EBADF,EFBIG,EINTR,EINVAL,
+                                                 EIO,ENOSPC,EOPNOTSUPP}}
 };
 
 int
@@ -329,6 +340,12 @@ get_fop_int (char **op_no_str)
                 return GF_FOP_FSETATTR;
         else if (!strcmp ((*op_no_str), "getspec"))
                 return GF_FOP_GETSPEC;
+        else if (!strcmp ((*op_no_str), "fallocate"))
+                return GF_FOP_FALLOCATE;
+        else if (!strcmp ((*op_no_str), "discard"))
+                return GF_FOP_DISCARD;
+        else if (!strcmp ((*op_no_str), "zerofill"))
+                return GF_FOP_ZEROFILL;
 	else
                 return -1;
 }
@@ -599,6 +616,127 @@ error_gen_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd,
 }
 
 
+int
+error_gen_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                         struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+error_gen_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t keep_size, off_t offset, size_t len,
+                     dict_t *xdata)
+{
+	int              op_errno = 0;
+        eg_t            *egp =NULL;
+        int              enable = 1;
+
+        egp = this->private;
+        enable = egp->enable[GF_FOP_FALLOCATE];
+
+        if (enable)
+                op_errno = error_gen (this, GF_FOP_FALLOCATE);
+
+	if (op_errno) {
+		GF_ERROR(this, "unwind(-1, %s)", strerror (op_errno));
+		STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno,
+                                     NULL, NULL, xdata);
+        return 0;
+	}
+
+	STACK_WIND (frame, error_gen_fallocate_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->fallocate,
+		    fd, keep_size, offset, len, xdata);
+        return 0;
+}
+
+
+int
+error_gen_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                       struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+error_gen_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   off_t offset, size_t len, dict_t *xdata)
+{
+	int              op_errno = 0;
+        eg_t            *egp =NULL;
+        int              enable = 1;
+
+        egp = this->private;
+        enable = egp->enable[GF_FOP_DISCARD];
+
+        if (enable)
+                op_errno = error_gen (this, GF_FOP_DISCARD);
+
+	if (op_errno) {
+		GF_ERROR(this, "unwind(-1, %s)", strerror (op_errno));
+		STACK_UNWIND_STRICT (discard, frame, -1, op_errno,
+                                     NULL, NULL, xdata);
+        return 0;
+	}
+
+	STACK_WIND (frame, error_gen_discard_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->discard,
+		    fd, offset, len, xdata);
+        return 0;
+}
+
+
+int
+error_gen_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                        struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+error_gen_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    off_t offset, size_t len, dict_t *xdata)
+{
+	int              op_errno = 0;
+        eg_t            *egp =NULL;
+        int              enable = 1;
+
+        egp = this->private;
+        enable = egp->enable[GF_FOP_ZEROFILL];
+
+        if (enable)
+                op_errno = error_gen (this, GF_FOP_ZEROFILL);
+
+	if (op_errno) {
+		GF_ERROR(this, "unwind(-1, %s)", strerror (op_errno));
+		STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno,
+                                     NULL, NULL, xdata);
+        return 0;
+	}
+
+	STACK_WIND (frame, error_gen_zerofill_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->zerofill,
+		    fd, offset, len, xdata);
+        return 0;
+}
+
+
 int
 error_gen_access_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 		      int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -1094,9 +1232,10 @@ error_gen_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 
 int
-error_gen_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
-		  struct iovec *vector, int32_t count,
-		  off_t off, uint32_t flags, struct iobref *iobref, dict_t *xdata)
+error_gen_do_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     struct iovec *vector, int32_t count,
+                     off_t off, uint32_t flags, struct iobref *iobref,
+                     dict_t *xdata)
 {
 	int              op_errno = 0;
         eg_t            *egp = NULL;
@@ -1138,6 +1277,46 @@ error_gen_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
 }
 
 
+static void
+error_gen_writev_resume (void *data)
+{
+        call_resume ((call_stub_t *) data);
+}
+
+
+/* write-delay makes this subvolume a slow replica */
+int
+error_gen_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+		  struct iovec *vector, int32_t count,
+		  off_t off, uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        eg_t            *egp   = NULL;
+        call_stub_t     *stub  = NULL;
+        struct timeval   delta = {0, };
+
+        egp = this->private;
+
+        if (!egp->write_delay)
+                goto wind;
+
+        stub = fop_writev_stub (frame, error_gen_do_writev, fd, vector, count,
+                                off, flags, iobref, xdata);
+        if (!stub)
+                goto wind;
+
+        delta.tv_sec  = egp->write_delay / 1000000;
+        delta.tv_usec = egp->write_delay % 1000000;
+        if (gf_timer_call_after (this->ctx, delta, error_gen_writev_resume,
+                                 stub))
+                return 0;
+
+        call_stub_destroy (stub);
+wind:
+        return error_gen_do_writev (frame, this, fd, vector, count, off,
+                                    flags, iobref, xdata);
+}
+
+
 int
 error_gen_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 		     int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -1981,6 +2160,7 @@ error_gen_priv_dump (xlator_t *this)
         gf_proc_dump_write("failure_iter_no", "%d", conf->failure_iter_no);
         gf_proc_dump_write("error_no", "%s", conf->error_no);
         gf_proc_dump_write("random_failure", "%d", conf->random_failure);
+        gf_proc_dump_write("write_delay", "%u", conf->write_delay);
 
         UNLOCK(&conf->lock);
 out:
@@ -2101,12 +2281,24 @@ init (xlator_t *this)
                                                _gf_false);
         pvt->random_failure = random_failure;
 
+        GF_OPTION_INIT ("write-delay", pvt->write_delay, uint32, free_pvt);
+        /* used on its own, write-delay only slows the subvolume down */
+        if (pvt->write_delay && !error_no && !failure_percent && !enable) {
+                for (i = 0; i < GF_FOP_MAXVALUE; i++)
+                        pvt->enable[i] = 0;
+        }
+
         this->private = pvt;
 
         /* Give some seed value here */
         srand (time(NULL));
 out:
         return ret;
+
+free_pvt:
+        LOCK_DESTROY (&pvt->lock);
+        GF_FREE (pvt);
+        return -1;
 }
 
 
@@ -2164,6 +2356,9 @@ struct xlator_fops fops = {
 	.fsyncdir    = error_gen_fsyncdir,
 	.access      = error_gen_access,
 	.ftruncate   = error_gen_ftruncate,
+	.fallocate   = error_gen_fallocate,
+	.discard     = error_gen_discard,
+	.zerofill    = error_gen_zerofill,
 	.fstat       = error_gen_fstat,
 	.lk          = error_gen_lk,
 	.lookup_cbk  = error_gen_lookup_cbk,
@@ -2192,5 +2387,11 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL},
         { .key  = {"enable"},
           .type = GF_OPTION_TYPE_STR },
+        { .key  = {"write-delay"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .default_value = "0",
+          .description = "Hold every writev back this many microseconds "
+                         "before passing it on." },
         { .key  = {NULL} }
 };
@@ -37,6 +37,7 @@ typedef struct {
         int failure_iter_no;
         char *error_no;
         gf_boolean_t random_failure;
+        uint32_t write_delay;   /* usecs every writev is held back */
         gf_lock_t lock;
 } eg_t;
 
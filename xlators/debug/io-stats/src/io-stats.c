@@ -1713,6 +1713,67 @@ io_stats_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+int
+io_stats_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno,
+                        struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, FALLOCATE);
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+io_stats_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno,
+                      struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, DISCARD);
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+io_stats_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno,
+                       struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, ZEROFILL);
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno,
+                             prebuf, postbuf, xdata);
+        return 0;
+}
+
+
+int
+io_stats_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, off_t offset,
+                   dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, SEEK);
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset, xdata);
+        return 0;
+}
+
+
+int
+io_stats_copy_file_range_cbk (call_frame_t *frame, void *cookie,
+                              xlator_t *this, int32_t op_ret,
+                              int32_t op_errno, struct iatt *stbuf,
+                              struct iatt *prebuf_dst,
+                              struct iatt *postbuf_dst, dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, COPY_FILE_RANGE);
+        STACK_UNWIND_STRICT (copy_file_range, frame, op_ret, op_errno, stbuf,
+                             prebuf_dst, postbuf_dst, xdata);
+        return 0;
+}
+
+
 int
 io_stats_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, struct iatt *buf, dict_t *xdata)
@@ -2363,6 +2424,78 @@ io_stats_ftruncate (call_frame_t *frame, xlator_t *this,
 }
 
 
+int
+io_stats_fallocate (call_frame_t *frame, xlator_t *this,
+                    fd_t *fd, int32_t keep_size, off_t offset, size_t len,
+                    dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_fallocate_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate,
+                    fd, keep_size, offset, len, xdata);
+        return 0;
+}
+
+
+int
+io_stats_discard (call_frame_t *frame, xlator_t *this,
+                  fd_t *fd, off_t offset, size_t len, dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_discard_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard,
+                    fd, offset, len, xdata);
+        return 0;
+}
+
+
+int
+io_stats_zerofill (call_frame_t *frame, xlator_t *this,
+                   fd_t *fd, off_t offset, size_t len, dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_zerofill_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill,
+                    fd, offset, len, xdata);
+        return 0;
+}
+
+
+int
+io_stats_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+               gf_seek_what_t what, dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_seek_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek,
+                    fd, offset, what, xdata);
+        return 0;
+}
+
+
+int
+io_stats_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                          off_t off_in, fd_t *fd_out, off_t off_out,
+                          size_t len, uint32_t flags, dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_copy_file_range_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->copy_file_range,
+                    fd_in, off_in, fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
+
 int
 io_stats_fsetattr (call_frame_t *frame, xlator_t *this,
                    fd_t *fd, struct iatt *stbuf, int32_t valid, dict_t *xdata)
@@ -2806,6 +2939,11 @@ struct xlator_fops fops = {
         .fsyncdir    = io_stats_fsyncdir,
         .access      = io_stats_access,
         .ftruncate   = io_stats_ftruncate,
+        .fallocate   = io_stats_fallocate,
+        .discard     = io_stats_discard,
+        .zerofill    = io_stats_zerofill,
+        .seek        = io_stats_seek,
+        .copy_file_range = io_stats_copy_file_range,
         .fstat       = io_stats_fstat,
         .create      = io_stats_create,
         .lk          = io_stats_lk,
@@ -210,6 +210,23 @@ index_generate_index (index_priv_t *priv, uuid_t index)
         UNLOCK (&priv->lock);
 }
 
+static void
+index_count_update (index_priv_t *priv, int delta)
+{
+        LOCK (&priv->lock);
+        {
+                /* not counted yet, the first count will see this */
+                if (priv->count_valid) {
+                        if (delta > 0)
+                                priv->xattrop_count++;
+                        else if (priv->xattrop_count)
+                                priv->xattrop_count--;
+                }
+                priv->xattrop_gen++;
+        }
+        UNLOCK (&priv->lock);
+}
+
 static void
 make_index_path (char *base, const char *subdir, uuid_t index,
                  char *index_path, size_t len)
@@ -363,6 +380,8 @@ index_add (xlator_t *this, uuid_t gfid, const char *subdir)
                          index, index_path, sizeof (index_path));
         ret = link (index_path, gfid_path);
         if (!ret || (errno == EEXIST))  {
+                if (!ret)
+                        index_count_update (priv, 1);
                 ret = 0;
                 goto out;
         }
@@ -399,6 +418,8 @@ index_add (xlator_t *this, uuid_t gfid, const char *subdir)
                         strerror (errno));
                 goto out;
         }
+        if (!ret)
+                index_count_update (priv, 1);
 
         ret = 0;
 out:
@@ -426,8 +447,194 @@ index_del (xlator_t *this, uuid_t gfid, const char *subdir)
                 ret = -errno;
                 goto out;
         }
+        if (!ret)
+                index_count_update (priv, -1);
+        ret = 0;
+out:
+        return ret;
+}
+
+static gf_boolean_t
+index_is_gfid_entry (const char *name, uuid_t gfid)
+{
+        if (!strncmp (name, XATTROP_SUBDIR"-", strlen (XATTROP_SUBDIR"-")))
+                return _gf_false;
+
+        return (uuid_parse (name, gfid) == 0);
+}
+
+/* @count entries were seen by a pass over the index that started at @gen;
+ * if nothing changed since, index_add and index_del keep it up to date */
+static void
+index_count_set (index_priv_t *priv, uint64_t gen, uint64_t count)
+{
+        LOCK (&priv->lock);
+        {
+                if (!priv->count_valid && (priv->xattrop_gen == gen)) {
+                        priv->xattrop_count = count;
+                        priv->count_valid = _gf_true;
+                }
+        }
+        UNLOCK (&priv->lock);
+}
+
+/* the index is counted when first asked for, not at start up; a pass that
+ * races with changes to the index answers but is not kept */
+static uint64_t
+index_count_get (xlator_t *this)
+{
+        index_priv_t  *priv  = NULL;
+        DIR           *dir   = NULL;
+        struct dirent *entry = NULL;
+        char           index_dir[PATH_MAX] = {0};
+        uuid_t         gfid  = {0};
+        uint64_t       count = 0;
+        uint64_t       gen   = 0;
+        gf_boolean_t   valid = _gf_false;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                valid = priv->count_valid;
+                count = priv->xattrop_count;
+                gen = priv->xattrop_gen;
+        }
+        UNLOCK (&priv->lock);
+
+        if (valid)
+                return count;
+
+        make_index_dir_path (priv->index_basepath, XATTROP_SUBDIR,
+                             index_dir, sizeof (index_dir));
+
+        count = 0;
+        dir = opendir (index_dir);
+        if (!dir && (errno != ENOENT))
+                return 0;
+
+        while (dir && (entry = readdir (dir))) {
+                if (index_is_gfid_entry (entry->d_name, gfid))
+                        count++;
+        }
+        if (dir)
+                closedir (dir);
+
+        index_count_set (priv, gen, count);
+        gf_log (this->name, GF_LOG_DEBUG, "%"PRIu64" entries in the xattrop "
+                "index", count);
+
+        return count;
+}
+
+static void
+make_summary_path (char *base, char *summary_path, size_t len)
+{
+        snprintf (summary_path, len, "%s/%s-summary", base, XATTROP_SUBDIR);
+}
+
+static int
+index_gfid_cmp (const void *a, const void *b)
+{
+        return memcmp (a, b, sizeof (uuid_t));
+}
+
+/*
+ * The summary is the gfids of the xattrop index, sorted and packed in one
+ * file, so that heal info can page through the index with a binary search
+ * per page instead of holding a readdir stream over the whole directory.
+ * It is rebuilt when a listing starts over and the index changed since.
+ */
+static int
+index_summary_build (xlator_t *this)
+{
+        index_priv_t  *priv    = NULL;
+        DIR           *dir     = NULL;
+        struct dirent *entry   = NULL;
+        unsigned char *gfids   = NULL;
+        unsigned char *tmp     = NULL;
+        size_t         count   = 0;
+        size_t         alloced = 0;
+        size_t         len     = 0;
+        uint64_t       gen     = 0;
+        size_t         written = 0;
+        ssize_t        n       = 0;
+        int            fd      = -1;
+        int            ret     = -1;
+        char           index_dir[PATH_MAX] = {0};
+        char           summary_path[PATH_MAX] = {0};
+        char           tmp_path[PATH_MAX] = {0};
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                gen = priv->xattrop_gen;
+        }
+        UNLOCK (&priv->lock);
+
+        make_index_dir_path (priv->index_basepath, XATTROP_SUBDIR,
+                             index_dir, sizeof (index_dir));
+        dir = opendir (index_dir);
+        if (!dir && (errno != ENOENT))
+                goto out;
+
+        while (dir && (entry = readdir (dir))) {
+                if (count == alloced) {
+                        alloced = alloced ? alloced * 2 : INDEX_SUMMARY_PAGE;
+                        tmp = GF_REALLOC (gfids, alloced * sizeof (uuid_t));
+                        if (!tmp)
+                                goto out;
+                        gfids = tmp;
+                }
+                if (index_is_gfid_entry (entry->d_name,
+                                         gfids + count * sizeof (uuid_t)))
+                        count++;
+        }
+
+        if (count)
+                qsort (gfids, count, sizeof (uuid_t), index_gfid_cmp);
+
+        make_summary_path (priv->index_basepath, summary_path,
+                           sizeof (summary_path));
+        snprintf (tmp_path, sizeof (tmp_path), "%s.tmp", summary_path);
+        fd = open (tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0)
+                goto out;
+
+        len = count * sizeof (uuid_t);
+        while (written < len) {
+                n = write (fd, gfids + written, len - written);
+                if (n < 0)
+                        goto out;
+                written += n;
+        }
+
+        ret = rename (tmp_path, summary_path);
+        if (ret)
+                goto out;
+
+        LOCK (&priv->lock);
+        {
+                priv->summary_gen = gen;
+                priv->summary_valid = _gf_true;
+        }
+        UNLOCK (&priv->lock);
+
+        index_count_set (priv, gen, count);
+
+        gf_log (this->name, GF_LOG_DEBUG, "index summary rebuilt with %zu "
+                "entries", count);
         ret = 0;
 out:
+        if (ret)
+                gf_log (this->name, GF_LOG_ERROR, "failed to build the index "
+                        "summary (%s)", strerror (errno));
+        if (fd >= 0)
+                close (fd);
+        if (dir)
+                closedir (dir);
+        GF_FREE (gfids);
         return ret;
 }
 
@@ -757,6 +964,167 @@ done:
         return 0;
 }
 
+int32_t
+index_getxattr_count_wrapper (call_frame_t *frame, xlator_t *this,
+                              loc_t *loc, const char *name, dict_t *xdata)
+{
+        dict_t          *xattr = NULL;
+        uint64_t        count = 0;
+        int             ret = 0;
+
+        count = index_count_get (this);
+
+        xattr = dict_new ();
+        if (!xattr) {
+                ret = -ENOMEM;
+                goto done;
+        }
+
+        ret = dict_set_uint64 (xattr, GF_XATTROP_INDEX_COUNT, count);
+        if (ret)
+                ret = -ENOMEM;
+done:
+        if (ret)
+                STACK_UNWIND_STRICT (getxattr, frame, -1, -ret, xattr, xdata);
+        else
+                STACK_UNWIND_STRICT (getxattr, frame, 0, 0, xattr, xdata);
+
+        if (xattr)
+                dict_unref (xattr);
+
+        return 0;
+}
+
+/* first summary record greater than @cursor */
+static int
+index_summary_seek (int fd, size_t count, uuid_t cursor, size_t *pos)
+{
+        uuid_t  gfid = {0};
+        size_t  lo = 0;
+        size_t  hi = count;
+        size_t  mid = 0;
+
+        while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+                if (pread (fd, gfid, sizeof (gfid),
+                           mid * sizeof (gfid)) != sizeof (gfid))
+                        return -1;
+                if (index_gfid_cmp (gfid, cursor) <= 0)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+
+        *pos = lo;
+        return 0;
+}
+
+int32_t
+index_getxattr_page_wrapper (call_frame_t *frame, xlator_t *this,
+                             loc_t *loc, const char *name, dict_t *xdata)
+{
+        index_priv_t    *priv = NULL;
+        dict_t          *xattr = NULL;
+        unsigned char   *page = NULL;
+        struct stat     st = {0};
+        uuid_t          cursor = {0};
+        gf_boolean_t    rebuild = _gf_false;
+        size_t          count = 0;
+        size_t          pos = 0;
+        size_t          len = 0;
+        int             fd = -1;
+        int             ret = 0;
+        char            summary_path[PATH_MAX] = {0};
+
+        priv = this->private;
+
+        name += strlen (GF_XATTROP_INDEX_PAGE);
+        if (*name == '.') {
+                if (uuid_parse (name + 1, cursor)) {
+                        ret = -EINVAL;
+                        goto done;
+                }
+                LOCK (&priv->lock);
+                {
+                        rebuild = !priv->summary_valid;
+                }
+                UNLOCK (&priv->lock);
+        } else {
+                /* a new listing, start from a fresh summary */
+                LOCK (&priv->lock);
+                {
+                        rebuild = (!priv->summary_valid ||
+                                   (priv->summary_gen != priv->xattrop_gen));
+                }
+                UNLOCK (&priv->lock);
+        }
+
+        if (rebuild && index_summary_build (this)) {
+                ret = -errno;
+                goto done;
+        }
+
+        make_summary_path (priv->index_basepath, summary_path,
+                           sizeof (summary_path));
+        fd = open (summary_path, O_RDONLY);
+        if ((fd < 0) || fstat (fd, &st)) {
+                ret = -errno;
+                goto done;
+        }
+
+        count = st.st_size / sizeof (uuid_t);
+        if (*name == '.') {
+                if (index_summary_seek (fd, count, cursor, &pos)) {
+                        ret = -EIO;
+                        goto done;
+                }
+        }
+
+        count = min (count - pos, INDEX_SUMMARY_PAGE);
+        if (!count) {
+                ret = -ENODATA;
+                goto done;
+        }
+
+        len = count * sizeof (uuid_t);
+        page = GF_MALLOC (len, gf_index_mt_summary_t);
+        if (!page) {
+                ret = -ENOMEM;
+                goto done;
+        }
+
+        if (pread (fd, page, len, pos * sizeof (uuid_t)) != len) {
+                ret = -EIO;
+                goto done;
+        }
+
+        xattr = dict_new ();
+        if (!xattr) {
+                ret = -ENOMEM;
+                goto done;
+        }
+
+        ret = dict_set_bin (xattr, GF_XATTROP_INDEX_PAGE, page, len);
+        if (ret) {
+                ret = -ENOMEM;
+                goto done;
+        }
+        page = NULL;
+done:
+        if (ret)
+                STACK_UNWIND_STRICT (getxattr, frame, -1, -ret, xattr, xdata);
+        else
+                STACK_UNWIND_STRICT (getxattr, frame, 0, 0, xattr, xdata);
+
+        if (fd >= 0)
+                close (fd);
+        GF_FREE (page);
+        if (xattr)
+                dict_unref (xattr);
+
+        return 0;
+}
+
 int32_t
 index_lookup_wrapper (call_frame_t *frame, xlator_t *this,
                       loc_t *loc, dict_t *xattr_req)
@@ -859,6 +1227,83 @@ done:
         return 0;
 }
 
+/* the gfid handle of an indexed file, which lives next to the indices
+   under .glusterfs. Entries whose handle is gone keep an invalid type */
+static void
+index_entry_stat (xlator_t *this, gf_dirent_t *entry)
+{
+        index_priv_t *priv = NULL;
+        char          path[PATH_MAX] = {0};
+        struct stat   lstatbuf = {0};
+        struct stat   statbuf = {0};
+        uuid_t        gfid = {0};
+
+        priv = this->private;
+        if (uuid_parse (entry->d_name, gfid))
+                return;
+
+        snprintf (path, sizeof (path), "%s/../%c%c/%c%c/%s",
+                  priv->index_basepath, entry->d_name[0], entry->d_name[1],
+                  entry->d_name[2], entry->d_name[3], entry->d_name);
+        if (lstat (path, &lstatbuf))
+                return;
+
+        /* directory handles are symlinks to the directory itself */
+        if (S_ISLNK (lstatbuf.st_mode) && !stat (path, &statbuf) &&
+            S_ISDIR (statbuf.st_mode))
+                lstatbuf = statbuf;
+
+        iatt_from_stat (&entry->d_stat, &lstatbuf);
+        uuid_copy (entry->d_stat.ia_gfid, gfid);
+}
+
+int32_t
+index_readdirp_wrapper (call_frame_t *frame, xlator_t *this,
+                        fd_t *fd, size_t size, off_t off, dict_t *xdata)
+{
+        index_fd_ctx_t       *fctx           = NULL;
+        gf_dirent_t          *entry          = NULL;
+        DIR                  *dir            = NULL;
+        int                   ret            = -1;
+        int32_t               op_ret         = -1;
+        int32_t               op_errno       = 0;
+        int                   count          = 0;
+        gf_dirent_t           entries;
+
+        INIT_LIST_HEAD (&entries.list);
+
+        ret = index_fd_ctx_get (fd, this, &fctx);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                op_errno = -ret;
+                goto done;
+        }
+
+        dir = fctx->dir;
+
+        if (!dir) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dir is NULL for fd=%p", fd);
+                op_errno = EINVAL;
+                goto done;
+        }
+
+        count = index_fill_readdir (fd, dir, off, size, &entries);
+
+        /* pick ENOENT to indicate EOF */
+        op_errno = errno;
+        op_ret = count;
+
+        list_for_each_entry (entry, &entries.list, list)
+                index_entry_stat (this, entry);
+done:
+        STACK_UNWIND_STRICT (readdirp, frame, op_ret, op_errno, &entries,
+                             xdata);
+        gf_dirent_free (&entries);
+        return 0;
+}
+
 int
 index_unlink_wrapper (call_frame_t *frame, xlator_t *this, loc_t *loc, int flag,
                       dict_t *xdata)
@@ -914,12 +1359,24 @@ index_getxattr (call_frame_t *frame, xlator_t *this,
                 loc_t *loc, const char *name, dict_t *xdata)
 {
         call_stub_t     *stub = NULL;
+        fop_getxattr_t  wrapper = NULL;
+
+        if (!name)
+                goto out;
 
-        if (!name || strcmp (GF_XATTROP_INDEX_GFID, name))
+        if (!strcmp (GF_XATTROP_INDEX_GFID, name)) {
+                wrapper = index_getxattr_wrapper;
+        } else if (!strcmp (GF_XATTROP_INDEX_COUNT, name)) {
+                /* the first one counts the index */
+                wrapper = index_getxattr_count_wrapper;
+        } else if (!strncmp (GF_XATTROP_INDEX_PAGE, name,
+                             strlen (GF_XATTROP_INDEX_PAGE))) {
+                wrapper = index_getxattr_page_wrapper;
+        } else {
                 goto out;
+        }
 
-        stub = fop_getxattr_stub (frame, index_getxattr_wrapper, loc, name,
-                                  xdata);
+        stub = fop_getxattr_stub (frame, wrapper, loc, name, xdata);
         if (!stub) {
                 STACK_UNWIND_STRICT (getxattr, frame, -1, ENOMEM, NULL, NULL);
                 return 0;
@@ -984,6 +1441,30 @@ out:
         return 0;
 }
 
+int32_t
+index_readdirp (call_frame_t *frame, xlator_t *this,
+                fd_t *fd, size_t size, off_t off, dict_t *xdata)
+{
+        call_stub_t     *stub = NULL;
+        index_priv_t    *priv = NULL;
+
+        priv = this->private;
+        if (uuid_compare (fd->inode->gfid, priv->xattrop_vgfid))
+                goto out;
+        stub = fop_readdirp_stub (frame, index_readdirp_wrapper, fd, size,
+                                  off, xdata);
+        if (!stub) {
+                STACK_UNWIND_STRICT (readdirp, frame, -1, ENOMEM, NULL, NULL);
+                return 0;
+        }
+        worker_enqueue (this, stub);
+        return 0;
+out:
+        STACK_WIND (frame, default_readdirp_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->readdirp, fd, size, off, xdata);
+        return 0;
+}
+
 int
 index_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
               dict_t *xdata)
@@ -1180,6 +1661,7 @@ struct xlator_fops fops = {
         .getxattr    = index_getxattr,
         .lookup      = index_lookup,
         .readdir     = index_readdir,
+        .readdirp    = index_readdirp,
         .unlink      = index_unlink
 };
 
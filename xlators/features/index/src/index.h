@@ -19,6 +19,7 @@
 #include "index-mem-types.h"
 
 #define INDEX_THREAD_STACK_SIZE   ((size_t)(1024*1024))
+#define INDEX_SUMMARY_PAGE        1024    /* gfids per summary page */
 
 typedef enum {
         UNKNOWN,
@@ -44,6 +45,11 @@ typedef struct index_priv {
         struct list_head callstubs;
         pthread_mutex_t mutex;
         pthread_cond_t  cond;
+        uint64_t xattrop_count;  /* entries in the xattrop index */
+        gf_boolean_t count_valid; /* xattrop_count has been counted */
+        uint64_t xattrop_gen;    /* bumped whenever the index changes */
+        uint64_t summary_gen;    /* xattrop_gen the summary was built at */
+        gf_boolean_t summary_valid;
 } index_priv_t;
 
 #define INDEX_STACK_UNWIND(fop, frame, params ...)      \
@@ -19,6 +19,7 @@
 #include "logging.h"
 #include "common-utils.h"
 #include "list.h"
+#include "defaults.h"
 
 #include "locks.h"
 #include "common.h"
@@ -191,6 +192,33 @@ __owner_has_lock (pl_dom_list_t *dom, pl_inode_lock_t *newlock)
 }
 
 
+/* Finds a granted recallable lock that @lock is waiting for and whose
+ * holder has not been asked to release it yet.
+ */
+static int
+__inodelk_recall_get (pl_dom_list_t *dom, pl_inode_lock_t *lock,
+                      gf_upcall_recall_t *recall)
+{
+        pl_inode_lock_t *l = NULL;
+
+        list_for_each_entry (l, &dom->inodelk_list, list) {
+                if (!l->recallable || l->recall_sent)
+                        continue;
+                if (!inodelk_conflict (lock, l) ||
+                    same_inodelk_owner (lock, l))
+                        continue;
+
+                l->recall_sent = _gf_true;
+
+                recall->client = l->transport;
+                recall->domain = dom->domain;
+                recall->owner  = l->owner;
+                return 1;
+        }
+
+        return 0;
+}
+
 /* Determines if lock can be granted and adds the lock. If the lock
  * is blocking, adds it to the blocked_inodelks list of the domain.
  */
@@ -463,16 +491,21 @@ release_inode_locks_of_transport (xlator_t *this, pl_dom_list_t *dom,
 
 static int
 pl_inode_setlk (xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
-                int can_block,  pl_dom_list_t *dom)
+                int can_block,  pl_dom_list_t *dom, inode_t *inode)
 {
         int ret = -EINVAL;
         pl_inode_lock_t *retlock = NULL;
         gf_boolean_t    unref = _gf_true;
+        gf_upcall_recall_t recall = {0,};
+        int             need_recall = 0;
 
         pthread_mutex_lock (&pl_inode->mutex);
         {
                 if (lock->fl_type != F_UNLCK) {
                         ret = __lock_inodelk (this, pl_inode, lock, can_block, dom);
+                        if (ret == -EAGAIN)
+                                need_recall = __inodelk_recall_get (dom, lock,
+                                                                    &recall);
                         if (ret == 0) {
                                 gf_log (this->name, GF_LOG_TRACE,
                                         "%s (pid=%d) (lk-owner=%s) %"PRId64" - %"PRId64" => OK",
@@ -509,6 +542,17 @@ out:
         if (unref)
                 __pl_inodelk_unref (lock);
         pthread_mutex_unlock (&pl_inode->mutex);
+
+        /* domains live as long as the inode; protocol/server checks that
+           the holder's connection still exists before using it */
+        if (need_recall) {
+                uuid_copy (recall.gfid, inode->gfid);
+                gf_log (this->name, GF_LOG_DEBUG, "recalling inodelk of "
+                        "lk-owner %s on %s", lkowner_utoa (&recall.owner),
+                        uuid_utoa (recall.gfid));
+                default_notify (this, GF_EVENT_UPCALL, &recall);
+        }
+
         grant_blocked_inode_locks (this, pl_inode, dom);
         return ret;
 }
@@ -551,7 +595,8 @@ new_inode_lock (struct gf_flock *flock, void *transport, pid_t client_pid,
 int
 pl_common_inodelk (call_frame_t *frame, xlator_t *this,
                    const char *volume, inode_t *inode, int32_t cmd,
-                   struct gf_flock *flock, loc_t *loc, fd_t *fd)
+                   struct gf_flock *flock, loc_t *loc, fd_t *fd,
+                   dict_t *xdata)
 {
         int32_t           op_ret     = -1;
         int32_t           op_errno   = 0;
@@ -615,6 +660,9 @@ pl_common_inodelk (call_frame_t *frame, xlator_t *this,
         reqlock->frame = frame;
         reqlock->this  = this;
 
+        if (xdata && dict_get (xdata, GF_INODELK_RECALL_KEY))
+                reqlock->recallable = _gf_true;
+
         switch (cmd) {
         case F_SETLKW:
                 can_block = 1;
@@ -626,7 +674,7 @@ pl_common_inodelk (call_frame_t *frame, xlator_t *this,
         case F_SETLK:
                 memcpy (&reqlock->user_flock, flock, sizeof (struct gf_flock));
                 ret = pl_inode_setlk (this, pinode, reqlock,
-                                      can_block, dom);
+                                      can_block, dom, inode);
 
                 if (ret < 0) {
                         if ((can_block) && (F_UNLCK != flock->l_type)) {
@@ -664,20 +712,24 @@ out:
 
 int
 pl_inodelk (call_frame_t *frame, xlator_t *this,
-            const char *volume, loc_t *loc, int32_t cmd, struct gf_flock *flock)
+            const char *volume, loc_t *loc, int32_t cmd, struct gf_flock *flock,
+            dict_t *xdata)
 {
 
-        pl_common_inodelk (frame, this, volume, loc->inode, cmd, flock, loc, NULL);
+        pl_common_inodelk (frame, this, volume, loc->inode, cmd, flock, loc,
+                           NULL, xdata);
 
         return 0;
 }
 
 int
 pl_finodelk (call_frame_t *frame, xlator_t *this,
-             const char *volume, fd_t *fd, int32_t cmd, struct gf_flock *flock)
+             const char *volume, fd_t *fd, int32_t cmd, struct gf_flock *flock,
+             dict_t *xdata)
 {
 
-        pl_common_inodelk (frame, this, volume, fd->inode, cmd, flock, NULL, fd);
+        pl_common_inodelk (frame, this, volume, fd->inode, cmd, flock, NULL,
+                           fd, xdata);
 
         return 0;
 
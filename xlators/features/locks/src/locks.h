@@ -78,6 +78,10 @@ struct __pl_inode_lock {
         void              *transport;     /* to identify client node */
         gf_lkowner_t       owner;
         pid_t              client_pid;    /* pid of client process */
+
+        gf_boolean_t       recallable;    /* holder asked to be told about
+                                             contention */
+        gf_boolean_t       recall_sent;
 };
 typedef struct __pl_inode_lock pl_inode_lock_t;
 
@@ -57,6 +57,10 @@ struct xlator_fops fops = {
         .removexattr = ro_removexattr,
         .fsyncdir    = ro_fsyncdir,
         .ftruncate   = ro_ftruncate,
+        .fallocate   = ro_fallocate,
+        .discard     = ro_discard,
+        .zerofill    = ro_zerofill,
+        .copy_file_range = ro_copy_file_range,
         .create      = ro_create,
         .setattr     = ro_setattr,
         .fsetattr    = ro_fsetattr,
@@ -0,0 +1,2795 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "shard.h"
+#include "defaults.h"
+#include "byte-order.h"
+#include "lkowner.h"
+
+#define SHARD_STACK_UNWIND(fop, frame, params ...) do {         \
+                shard_local_t *__local = NULL;                  \
+                if (frame) {                                    \
+                        __local = frame->local;                 \
+                        frame->local = NULL;                    \
+                }                                               \
+                STACK_UNWIND_STRICT (fop, frame, params);       \
+                if (__local)                                    \
+                        shard_local_wipe (__local);             \
+        } while (0)
+
+static void
+shard_local_wipe (shard_local_t *local)
+{
+        if (!local)
+                return;
+
+        loc_wipe (&local->loc);
+        loc_wipe (&local->loc2);
+        if (local->xattr_req)
+                dict_unref (local->xattr_req);
+        if (local->fd)
+                fd_unref (local->fd);
+        if (local->inode)
+                inode_unref (local->inode);
+        GF_FREE (local->vector);
+        if (local->iobref)
+                iobref_unref (local->iobref);
+        GF_FREE (local->rvector);
+        if (local->riobref)
+                iobref_unref (local->riobref);
+
+        GF_FREE (local);
+}
+
+static shard_local_t *
+shard_local_init (call_frame_t *frame, glusterfs_fop_t fop)
+{
+        shard_local_t *local = NULL;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_shard_mt_local_t);
+        if (!local)
+                return NULL;
+
+        local->fop = fop;
+        frame->local = local;
+
+        return local;
+}
+
+/* {{{ inode context */
+
+static shard_inode_ctx_t *
+__shard_inode_ctx_get (inode_t *inode, xlator_t *this)
+{
+        shard_inode_ctx_t *ctx   = NULL;
+        uint64_t           value = 0;
+
+        if (!__inode_ctx_get (inode, this, &value))
+                return (shard_inode_ctx_t *)(long) value;
+
+        ctx = GF_CALLOC (1, sizeof (*ctx), gf_shard_mt_inode_ctx_t);
+        if (!ctx)
+                return NULL;
+
+        if (__inode_ctx_put (inode, this, (uint64_t)(long) ctx)) {
+                GF_FREE (ctx);
+                return NULL;
+        }
+
+        return ctx;
+}
+
+/* copy of the context of @inode, -1 when it was never looked up here */
+static int
+shard_inode_ctx_fetch (inode_t *inode, xlator_t *this, shard_inode_ctx_t *out)
+{
+        uint64_t value = 0;
+        int      ret   = -1;
+
+        LOCK (&inode->lock);
+        {
+                ret = __inode_ctx_get (inode, this, &value);
+                if (!ret)
+                        *out = *(shard_inode_ctx_t *)(long) value;
+        }
+        UNLOCK (&inode->lock);
+
+        return ret;
+}
+
+static int
+shard_xattr_get_uint64 (dict_t *xattr, char *key, uint64_t *value)
+{
+        void     *ptr = NULL;
+        int       len = 0;
+        uint64_t  raw = 0;
+
+        if (!xattr)
+                return -1;
+        if (dict_get_ptr_and_len (xattr, key, &ptr, &len) ||
+            len != sizeof (raw))
+                return -1;
+
+        memcpy (&raw, ptr, sizeof (raw));
+        *value = ntoh64 (raw);
+
+        return 0;
+}
+
+static int
+shard_xattr_set_uint64 (dict_t *xattr, char *key, uint64_t value)
+{
+        uint64_t *raw = NULL;
+        int       ret = -1;
+
+        raw = GF_CALLOC (1, sizeof (*raw), gf_shard_mt_uint64_t);
+        if (!raw)
+                return -1;
+
+        *raw = hton64 (value);
+        ret = dict_set_bin (xattr, key, raw, sizeof (*raw));
+        if (ret)
+                GF_FREE (raw);
+
+        return ret;
+}
+
+/* blocks past the first one are not accounted, a sharded file counts as
+   allocated all through */
+static void
+shard_iatt_fix (struct iatt *stbuf, uint64_t block_size, uint64_t size)
+{
+        if (size > block_size)
+                stbuf->ia_blocks += (size - block_size + 511) / 512;
+        stbuf->ia_size = size;
+}
+
+/* remembers what a lookup (or a listing) told about a regular file, and
+   returns its block size */
+static uint64_t
+shard_inode_ctx_set (xlator_t *this, inode_t *inode, struct iatt *stbuf,
+                     dict_t *xattr)
+{
+        shard_inode_ctx_t *ctx        = NULL;
+        uint64_t           block_size = 0;
+        uint64_t           size       = 0;
+
+        size = stbuf->ia_size;
+        if (!shard_xattr_get_uint64 (xattr, GF_XATTR_SHARD_BLOCK_SIZE,
+                                     &block_size))
+                shard_xattr_get_uint64 (xattr, GF_XATTR_SHARD_FILE_SIZE,
+                                        &size);
+
+        if (!inode)
+                goto out;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __shard_inode_ctx_get (inode, this);
+                if (ctx) {
+                        ctx->block_size = block_size;
+                        ctx->size       = size;
+                        ctx->stat       = *stbuf;
+                }
+        }
+        UNLOCK (&inode->lock);
+out:
+        if (block_size)
+                shard_iatt_fix (stbuf, block_size, size);
+
+        return block_size;
+}
+
+/* fixes up attributes of the file itself to those of the sharded file */
+static void
+shard_iatt_from_ctx (xlator_t *this, inode_t *inode, struct iatt *stbuf)
+{
+        shard_inode_ctx_t *ctx   = NULL;
+        uint64_t           value = 0;
+        uint64_t           block_size = 0;
+        uint64_t           size  = 0;
+
+        if (!inode || !stbuf || !IA_ISREG (stbuf->ia_type))
+                return;
+
+        LOCK (&inode->lock);
+        {
+                if (!__inode_ctx_get (inode, this, &value)) {
+                        ctx = (shard_inode_ctx_t *)(long) value;
+                        ctx->stat  = *stbuf;
+                        block_size = ctx->block_size;
+                        size       = ctx->size;
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (block_size)
+                shard_iatt_fix (stbuf, block_size, size);
+}
+
+static void
+shard_inode_ctx_size_set (xlator_t *this, inode_t *inode, uint64_t size)
+{
+        shard_inode_ctx_t *ctx = NULL;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __shard_inode_ctx_get (inode, this);
+                if (ctx)
+                        ctx->size = size;
+        }
+        UNLOCK (&inode->lock);
+}
+
+static void
+shard_dirty_mark (xlator_t *this, inode_t *inode, uint64_t block)
+{
+        shard_inode_ctx_t *ctx = NULL;
+        int                i   = 0;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __shard_inode_ctx_get (inode, this);
+                if (!ctx || ctx->dirty_cnt < 0)
+                        goto unlock;
+
+                for (i = 0; i < ctx->dirty_cnt; i++) {
+                        if (ctx->dirty[i] == block)
+                                goto unlock;
+                }
+
+                if (ctx->dirty_cnt == SHARD_DIRTY_MAX)
+                        ctx->dirty_cnt = -1;
+                else
+                        ctx->dirty[ctx->dirty_cnt++] = block;
+        }
+unlock:
+        UNLOCK (&inode->lock);
+}
+
+/* }}} */
+
+/* {{{ blocks */
+
+static int
+shard_is_dot_shard (xlator_t *this, loc_t *loc)
+{
+        if (!loc->name || strcmp (loc->name, GF_SHARD_DIR))
+                return 0;
+
+        if (loc->parent)
+                return __is_root_gfid (loc->parent->gfid);
+
+        return __is_root_gfid (loc->pargfid);
+}
+
+static void
+shard_inode_cache_add (xlator_t *this, inode_t *inode)
+{
+        shard_priv_t *priv = NULL;
+        inode_t      *old  = NULL;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                old = priv->inode_cache[priv->inode_cache_next];
+                priv->inode_cache[priv->inode_cache_next] = inode_ref (inode);
+                priv->inode_cache_next = (priv->inode_cache_next + 1) %
+                                         SHARD_INODE_CACHE;
+        }
+        UNLOCK (&priv->lock);
+
+        if (old)
+                inode_unref (old);
+}
+
+/* the inode of /.shard, looked up (and created, when @create is set) the
+   first time it is needed */
+static inode_t *
+shard_dot_shard_inode (xlator_t *this, inode_table_t *table,
+                       gf_boolean_t create)
+{
+        shard_priv_t *priv      = NULL;
+        inode_t      *inode     = NULL;
+        inode_t      *old       = NULL;
+        dict_t       *xattr_req = NULL;
+        loc_t         loc       = {0, };
+        struct iatt   iatt      = {0, };
+        int           op_errno  = 0;
+        int           ret       = -1;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                if (priv->dot_shard_inode &&
+                    priv->dot_shard_inode->table == table)
+                        inode = inode_ref (priv->dot_shard_inode);
+        }
+        UNLOCK (&priv->lock);
+
+        if (inode)
+                return inode;
+
+        xattr_req = dict_new ();
+        if (!xattr_req) {
+                errno = ENOMEM;
+                goto out;
+        }
+        ret = dict_set_static_bin (xattr_req, "gfid-req",
+                                   priv->dot_shard_gfid, 16);
+        if (ret) {
+                errno = ENOMEM;
+                goto out;
+        }
+
+        loc.inode  = inode_new (table);
+        loc.parent = inode_ref (table->root);
+        loc.path   = gf_strdup ("/" GF_SHARD_DIR);
+        if (!loc.inode || !loc.path) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+        loc.name = loc.path + 1;
+        uuid_copy (loc.pargfid, table->root->gfid);
+
+        ret = syncop_lookup (FIRST_CHILD (this), &loc, xattr_req, &iatt,
+                             NULL, NULL);
+        if (ret && errno == ENOENT && create) {
+                ret = syncop_mkdir (FIRST_CHILD (this), &loc, 0755,
+                                    xattr_req, &iatt);
+                if (ret && errno == EEXIST)
+                        ret = syncop_lookup (FIRST_CHILD (this), &loc,
+                                             xattr_req, &iatt, NULL, NULL);
+        }
+        if (ret)
+                goto out;
+
+        if (uuid_compare (iatt.ia_gfid, priv->dot_shard_gfid)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "/%s has gfid %s, expected %s", GF_SHARD_DIR,
+                        uuid_utoa (iatt.ia_gfid), SHARD_ROOT_GFID);
+                errno = EIO;
+                ret = -1;
+                goto out;
+        }
+
+        inode = inode_link (loc.inode, table->root, GF_SHARD_DIR, &iatt);
+        if (!inode) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+        inode_lookup (inode);
+
+        LOCK (&priv->lock);
+        {
+                old = priv->dot_shard_inode;
+                priv->dot_shard_inode = inode_ref (inode);
+        }
+        UNLOCK (&priv->lock);
+
+        if (old)
+                inode_unref (old);
+out:
+        op_errno = errno;
+        if (ret)
+                gf_log (this->name, (op_errno == ENOENT) ? GF_LOG_DEBUG :
+                        GF_LOG_WARNING, "lookup of /%s failed (%s)",
+                        GF_SHARD_DIR, strerror (op_errno));
+        if (xattr_req)
+                dict_unref (xattr_req);
+        loc_wipe (&loc);
+
+        errno = op_errno;
+        return ret ? NULL : inode;
+}
+
+static int
+shard_block_loc (xlator_t *this, inode_table_t *table, uuid_t gfid,
+                 uint64_t block, gf_boolean_t create, loc_t *loc)
+{
+        char     *path = NULL;
+        int       ret  = -1;
+
+        loc->parent = shard_dot_shard_inode (this, table, create);
+        if (!loc->parent)
+                return -1;
+
+        ret = gf_asprintf (&path, "/%s/%s.%"PRIu64, GF_SHARD_DIR,
+                           uuid_utoa (gfid), block);
+        if (ret < 0) {
+                errno = ENOMEM;
+                return -1;
+        }
+
+        loc->path = path;
+        loc->name = strrchr (path, '/') + 1;
+        uuid_copy (loc->pargfid, loc->parent->gfid);
+
+        return 0;
+}
+
+/* the inode of block @block of the file with @gfid, ENOENT when the block
+   was never written and @create is not set */
+static inode_t *
+shard_block_inode (xlator_t *this, inode_table_t *table, uuid_t gfid,
+                   uint64_t block, gf_boolean_t create)
+{
+        inode_t     *inode     = NULL;
+        dict_t      *xattr_req = NULL;
+        loc_t        loc       = {0, };
+        struct iatt  iatt      = {0, };
+        uuid_t       gfid_req  = {0, };
+        int          op_errno  = 0;
+        int          ret       = -1;
+
+        ret = shard_block_loc (this, table, gfid, block, create, &loc);
+        if (ret)
+                goto out;
+
+        inode = inode_grep (table, loc.parent, loc.name);
+        if (inode)
+                goto out;
+
+        loc.inode = inode_new (table);
+        if (!loc.inode) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+
+        ret = syncop_lookup (FIRST_CHILD (this), &loc, NULL, &iatt, NULL,
+                             NULL);
+        if (ret && errno == ENOENT && create) {
+                xattr_req = dict_new ();
+                if (!xattr_req) {
+                        errno = ENOMEM;
+                        goto out;
+                }
+                uuid_generate (gfid_req);
+                ret = dict_set_static_bin (xattr_req, "gfid-req", gfid_req,
+                                           16);
+                if (ret) {
+                        errno = ENOMEM;
+                        goto out;
+                }
+
+                ret = syncop_mknod (FIRST_CHILD (this), &loc, S_IFREG | 0600,
+                                    0, xattr_req, &iatt);
+                if (ret && errno == EEXIST)
+                        ret = syncop_lookup (FIRST_CHILD (this), &loc, NULL,
+                                             &iatt, NULL, NULL);
+        }
+        if (ret)
+                goto out;
+
+        inode = inode_link (loc.inode, loc.parent, loc.name, &iatt);
+        if (!inode) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+        inode_lookup (inode);
+        shard_inode_cache_add (this, inode);
+out:
+        op_errno = errno;
+        if (xattr_req)
+                dict_unref (xattr_req);
+        loc_wipe (&loc);
+
+        errno = op_errno;
+        return inode;
+}
+
+/* another client may have removed or recreated a block since its inode
+   was linked here; unlinked from the table, the next shard_block_inode
+   looks it up again */
+static void
+shard_block_forget (xlator_t *this, inode_t *shard, uuid_t gfid,
+                    uint64_t block)
+{
+        loc_t loc = {0, };
+
+        if (!shard_block_loc (this, shard->table, gfid, block, _gf_false,
+                              &loc))
+                inode_unlink (shard, loc.parent, loc.name);
+
+        loc_wipe (&loc);
+}
+
+/* an anonymous fd on block @block of @inode, NULL with ENOENT when the
+   block was never written and @create is not set */
+static fd_t *
+shard_block_fd (xlator_t *this, inode_t *inode, uint64_t block,
+                gf_boolean_t create)
+{
+        inode_t *shard = NULL;
+        fd_t    *fd    = NULL;
+
+        shard = shard_block_inode (this, inode->table, inode->gfid, block,
+                                   create);
+        if (!shard)
+                return NULL;
+
+        fd = fd_anonymous (shard);
+        if (!fd)
+                errno = ENOMEM;
+        inode_unref (shard);
+
+        return fd;
+}
+
+/* done with @fd, the result of an operation on it was @ret; returns 1 when
+   the block is to be looked up again and the operation retried, once */
+static int
+shard_block_fd_done (xlator_t *this, inode_t *inode, uint64_t block,
+                     fd_t *fd, int ret, gf_boolean_t *retried)
+{
+        int op_errno = errno;
+        int retry    = 0;
+
+        if (!fd)
+                return 0;
+
+        if ((ret < 0) && !*retried &&
+            ((op_errno == ESTALE) || (op_errno == ENOENT))) {
+                shard_block_forget (this, fd->inode, inode->gfid, block);
+                *retried = _gf_true;
+                retry = 1;
+        }
+        fd_unref (fd);
+
+        errno = op_errno;
+        return retry;
+}
+
+static int
+shard_block_unlink (xlator_t *this, inode_table_t *table, uuid_t gfid,
+                    uint64_t block)
+{
+        loc_t         loc      = {0, };
+        gf_boolean_t  retried  = _gf_false;
+        int           op_errno = 0;
+        int           ret      = -1;
+
+again:
+        ret = shard_block_loc (this, table, gfid, block, _gf_false, &loc);
+        if (ret)
+                goto out;
+
+        loc.inode = shard_block_inode (this, table, gfid, block, _gf_false);
+        if (!loc.inode) {
+                ret = -1;
+                goto out;
+        }
+
+        ret = syncop_unlink (FIRST_CHILD (this), &loc);
+        if (!ret || errno == ENOENT || errno == ESTALE)
+                inode_unlink (loc.inode, loc.parent, loc.name);
+        if (ret && errno == ESTALE && !retried) {
+                /* recreated under the same name */
+                retried = _gf_true;
+                loc_wipe (&loc);
+                goto again;
+        }
+out:
+        op_errno = errno;
+        loc_wipe (&loc);
+
+        errno = op_errno;
+        return (ret && op_errno == ENOENT) ? 0 : ret;
+}
+
+static int
+shard_block_ftruncate (xlator_t *this, inode_t *inode, uint64_t block,
+                       off_t offset)
+{
+        fd_t         *fd      = NULL;
+        gf_boolean_t  retried = _gf_false;
+        int           ret     = -1;
+
+        do {
+                ret = -1;
+                fd = shard_block_fd (this, inode, block, _gf_false);
+                if (!fd)
+                        return (errno == ENOENT) ? 0 : -1;
+
+                ret = syncop_ftruncate (FIRST_CHILD (this), fd, offset);
+        } while (shard_block_fd_done (this, inode, block, fd, ret, &retried));
+
+        return ret;
+}
+
+/* }}} */
+
+/* {{{ size */
+
+static int
+shard_base_loc (inode_t *inode, loc_t *loc)
+{
+        loc->inode = inode_ref (inode);
+        uuid_copy (loc->gfid, inode->gfid);
+
+        if (inode_path (inode, NULL, (char **)&loc->path) < 0)
+                loc->path = NULL;
+
+        return 0;
+}
+
+static int
+shard_lock (xlator_t *this, loc_t *loc, short type)
+{
+        struct gf_flock flock = {0, };
+
+        flock.l_type   = type;
+        flock.l_whence = SEEK_SET;
+
+        return syncop_inodelk (FIRST_CHILD (this), this->name, loc,
+                               (type == F_UNLCK) ? F_SETLK : F_SETLKW,
+                               &flock);
+}
+
+static int
+shard_size_read (xlator_t *this, loc_t *loc, uint64_t *size)
+{
+        dict_t      *xattr = NULL;
+        struct iatt  stbuf = {0, };
+        int          ret   = -1;
+
+        ret = syncop_getxattr (FIRST_CHILD (this), loc, &xattr,
+                               GF_XATTR_SHARD_FILE_SIZE);
+        if (!ret) {
+                ret = shard_xattr_get_uint64 (xattr, GF_XATTR_SHARD_FILE_SIZE,
+                                              size);
+                if (ret)
+                        errno = EIO;
+        } else if (errno == ENODATA) {
+                /* nothing was written past the first block yet */
+                ret = syncop_stat (FIRST_CHILD (this), loc, &stbuf);
+                if (!ret)
+                        *size = stbuf.ia_size;
+        }
+
+        if (xattr)
+                dict_unref (xattr);
+
+        return ret;
+}
+
+static int
+shard_size_write (xlator_t *this, loc_t *loc, uint64_t size)
+{
+        dict_t *xattr = NULL;
+        int     ret   = -1;
+
+        xattr = dict_new ();
+        if (!xattr) {
+                errno = ENOMEM;
+                return -1;
+        }
+
+        ret = shard_xattr_set_uint64 (xattr, GF_XATTR_SHARD_FILE_SIZE, size);
+        if (ret)
+                errno = ENOMEM;
+        else
+                ret = syncop_setxattr (FIRST_CHILD (this), loc, xattr, 0);
+
+        dict_unref (xattr);
+
+        return ret;
+}
+
+/* }}} */
+
+/* {{{ tasks */
+
+/* what the file looks like to shard, asked from the bricks when it was not
+   looked up through this translator */
+static int
+shard_inode_ctx_load (xlator_t *this, inode_t *inode, fd_t *fd, loc_t *loc,
+                      shard_inode_ctx_t *ctx)
+{
+        dict_t      *xattr = NULL;
+        dict_t      *size  = NULL;
+        struct iatt  stbuf = {0, };
+        int          ret   = -1;
+
+        if (!shard_inode_ctx_fetch (inode, this, ctx))
+                return 0;
+
+        if (fd)
+                ret = syncop_fstat (FIRST_CHILD (this), fd, &stbuf);
+        else
+                ret = syncop_stat (FIRST_CHILD (this), loc, &stbuf);
+        if (ret)
+                return -1;
+
+        if (fd)
+                ret = syncop_fgetxattr (FIRST_CHILD (this), fd, &xattr,
+                                        GF_XATTR_SHARD_BLOCK_SIZE);
+        else
+                ret = syncop_getxattr (FIRST_CHILD (this), loc, &xattr,
+                                       GF_XATTR_SHARD_BLOCK_SIZE);
+        if (ret && errno != ENODATA)
+                goto out;
+
+        if (!ret) {
+                if (fd)
+                        ret = syncop_fgetxattr (FIRST_CHILD (this), fd, &size,
+                                                GF_XATTR_SHARD_FILE_SIZE);
+                else
+                        ret = syncop_getxattr (FIRST_CHILD (this), loc, &size,
+                                               GF_XATTR_SHARD_FILE_SIZE);
+                if (ret && errno != ENODATA)
+                        goto out;
+                if (!ret)
+                        dict_copy (size, xattr);
+        }
+
+        shard_inode_ctx_set (this, inode, &stbuf, xattr);
+
+        ret = shard_inode_ctx_fetch (inode, this, ctx);
+        if (ret)
+                errno = ENOMEM;
+out:
+        if (xattr)
+                dict_unref (xattr);
+        if (size)
+                dict_unref (size);
+
+        return ret;
+}
+
+/* blocks are reached through the hidden directory and the size is kept
+   in a trusted xattr, whatever the permissions of the caller, so tasks
+   run as root; operations on the file itself go with the credentials of
+   the caller (shard_as_caller) */
+static void
+shard_task_begin (shard_local_t *local)
+{
+        struct synctask *task = NULL;
+
+        task = synctask_get ();
+
+        local->uid = task->uid;
+        local->gid = task->gid;
+        synctask_setid (task, 0, 0);
+        set_lk_owner_from_ptr (&task->opframe->root->lk_owner, task);
+}
+
+static void
+shard_as_caller (shard_local_t *local)
+{
+        synctask_setid (synctask_get (), local->uid, local->gid);
+}
+
+static void
+shard_as_root (void)
+{
+        synctask_setid (synctask_get (), 0, 0);
+}
+
+/* blocks go through anonymous fds, which do not carry the access mode the
+   file was opened with */
+static int
+shard_fd_check (fd_t *fd, int mode)
+{
+        if (fd->anonymous)
+                return 0;
+
+        if ((fd->flags & O_ACCMODE) == O_RDWR ||
+            (fd->flags & O_ACCMODE) == mode)
+                return 0;
+
+        errno = EBADF;
+        return -1;
+}
+
+static void
+shard_prepare_iatts (xlator_t *this, inode_t *inode, uint64_t old_size,
+                     shard_local_t *local)
+{
+        shard_inode_ctx_t ctx = {0, };
+
+        if (shard_inode_ctx_fetch (inode, this, &ctx))
+                return;
+
+        local->prebuf  = ctx.stat;
+        local->postbuf = ctx.stat;
+        if (!ctx.block_size)
+                return;
+
+        shard_iatt_fix (&local->prebuf, ctx.block_size, old_size);
+        shard_iatt_fix (&local->postbuf, ctx.block_size, ctx.size);
+}
+
+static int
+shard_writev_task (void *data)
+{
+        call_frame_t      *frame   = data;
+        xlator_t          *this    = NULL;
+        shard_local_t     *local   = NULL;
+        shard_inode_ctx_t  ctx     = {0, };
+        inode_t           *inode   = NULL;
+        gf_boolean_t       retried = _gf_false;
+        fd_t              *anon_fd = NULL;
+        struct iovec      *iov     = NULL;
+        loc_t              loc     = {0, };
+        uint64_t           total   = 0;
+        uint64_t           written = 0;
+        uint64_t           chunk   = 0;
+        uint64_t           block   = 0;
+        uint64_t           size    = 0;
+        off_t              pos     = 0;
+        int                count   = 0;
+        int                ret     = -1;
+
+        this  = frame->this;
+        local = frame->local;
+        inode = local->fd->inode;
+
+        shard_task_begin (local);
+
+        ret = shard_inode_ctx_load (this, inode, local->fd, NULL, &ctx);
+        if (ret)
+                goto out;
+
+        if (!ctx.block_size) {
+                shard_as_caller (local);
+                ret = syncop_writev (FIRST_CHILD (this), local->fd,
+                                     local->vector, local->count,
+                                     local->offset, local->iobref,
+                                     local->flags);
+                if (ret >= 0)
+                        syncop_fstat (FIRST_CHILD (this), local->fd,
+                                      &local->postbuf);
+                local->prebuf = local->postbuf;
+                goto out;
+        }
+
+        ret = shard_fd_check (local->fd, O_WRONLY);
+        if (ret)
+                goto out;
+
+        total = iov_length (local->vector, local->count);
+        while (written < total) {
+                pos   = local->offset + written;
+                block = pos / ctx.block_size;
+                chunk = min (total - written,
+                             (block + 1) * ctx.block_size - pos);
+
+                count = iov_subset (local->vector, local->count, written,
+                                    written + chunk, NULL);
+                iov = GF_CALLOC (count, sizeof (*iov), gf_shard_mt_iovec);
+                if (!iov) {
+                        errno = ENOMEM;
+                        ret = -1;
+                        break;
+                }
+                iov_subset (local->vector, local->count, written,
+                            written + chunk, iov);
+
+                if (!block) {
+                        shard_as_caller (local);
+                        ret = syncop_writev (FIRST_CHILD (this), local->fd,
+                                             iov, count, pos, local->iobref,
+                                             local->flags);
+                        shard_as_root ();
+                } else {
+                        retried = _gf_false;
+                        do {
+                                ret = -1;
+                                anon_fd = shard_block_fd (this, inode, block,
+                                                          _gf_true);
+                                if (anon_fd)
+                                        ret = syncop_writev (FIRST_CHILD (this),
+                                                             anon_fd, iov,
+                                                             count, pos -
+                                                             block *
+                                                             ctx.block_size,
+                                                             local->iobref,
+                                                             local->flags);
+                        } while (shard_block_fd_done (this, inode, block,
+                                                      anon_fd, ret,
+                                                      &retried));
+                        anon_fd = NULL;
+                        if (ret > 0)
+                                shard_dirty_mark (this, inode, block);
+                }
+
+                GF_FREE (iov);
+
+                if (ret < 0)
+                        break;
+                written += ret;
+                if (ret < chunk)
+                        break;
+        }
+
+        if (!written)
+                goto out;
+
+        ret = written;
+        if (local->offset + written <= ctx.size) {
+                shard_prepare_iatts (this, inode, ctx.size, local);
+                goto out;
+        }
+
+        /* extending writes of all clients meet here, the size only grows */
+        shard_base_loc (inode, &loc);
+        ret = shard_lock (this, &loc, F_WRLCK);
+        if (ret)
+                goto out;
+
+        ret = shard_size_read (this, &loc, &size);
+        if (!ret && size < local->offset + written) {
+                size = local->offset + written;
+                ret = shard_size_write (this, &loc, size);
+        }
+
+        shard_lock (this, &loc, F_UNLCK);
+
+        if (ret)
+                goto out;
+
+        shard_inode_ctx_size_set (this, inode, size);
+        shard_prepare_iatts (this, inode, ctx.size, local);
+        ret = written;
+out:
+        loc_wipe (&loc);
+
+        local->op_ret = ret;
+        if (ret < 0)
+                local->op_errno = errno;
+
+        return 0;
+}
+
+static int
+shard_writev_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t  *frame = data;
+        shard_local_t *local = frame->local;
+
+        SHARD_STACK_UNWIND (writev, frame, local->op_ret, local->op_errno,
+                            &local->prebuf, &local->postbuf, NULL);
+
+        return 0;
+}
+
+static int
+shard_readv_task (void *data)
+{
+        call_frame_t      *frame   = data;
+        xlator_t          *this    = NULL;
+        shard_local_t     *local   = NULL;
+        shard_inode_ctx_t  ctx     = {0, };
+        inode_t           *inode   = NULL;
+        gf_boolean_t       retried = _gf_false;
+        fd_t              *anon_fd = NULL;
+        struct iobuf      *iobuf   = NULL;
+        struct iovec      *vector  = NULL;
+        struct iobref     *iobref  = NULL;
+        char              *buf     = NULL;
+        uint64_t           len     = 0;
+        uint64_t           done    = 0;
+        uint64_t           chunk   = 0;
+        uint64_t           size    = 0;
+        loc_t              loc     = {0, };
+        uint64_t           block   = 0;
+        off_t              pos     = 0;
+        int                count   = 0;
+        int                ret     = -1;
+
+        this  = frame->this;
+        local = frame->local;
+        inode = local->fd->inode;
+
+        shard_task_begin (local);
+
+        ret = shard_inode_ctx_load (this, inode, local->fd, NULL, &ctx);
+        if (ret)
+                goto out;
+
+        if (!ctx.block_size) {
+                shard_as_caller (local);
+                ret = syncop_readv (FIRST_CHILD (this), local->fd,
+                                    local->size, local->offset, local->flags,
+                                    &local->rvector, &local->rcount,
+                                    &local->riobref);
+                if (ret >= 0)
+                        local->postbuf = ctx.stat;
+                goto out;
+        }
+
+        ret = shard_fd_check (local->fd, O_RDONLY);
+        if (ret)
+                goto out;
+
+        /* another client may have grown the file since it was looked up */
+        if (local->offset + local->size > ctx.size) {
+                shard_base_loc (inode, &loc);
+                if (!shard_size_read (this, &loc, &size) && size != ctx.size) {
+                        shard_inode_ctx_size_set (this, inode, size);
+                        ctx.size = size;
+                }
+                loc_wipe (&loc);
+        }
+
+        local->postbuf = ctx.stat;
+        shard_iatt_fix (&local->postbuf, ctx.block_size, ctx.size);
+
+        if (local->offset >= ctx.size) {
+                ret = 0;
+                goto out;
+        }
+        len = min (local->size, ctx.size - local->offset);
+
+        local->riobref = iobref_new ();
+        local->rvector = GF_CALLOC (1, sizeof (*local->rvector),
+                                    gf_shard_mt_iovec);
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, len);
+        if (!local->riobref || !local->rvector || !iobuf) {
+                errno = ENOMEM;
+                ret = -1;
+                goto out;
+        }
+        iobref_add (local->riobref, iobuf);
+        buf = iobuf_ptr (iobuf);
+
+        /* holes, and blocks never written, read as zeroes */
+        memset (buf, 0, len);
+
+        while (done < len) {
+                pos   = local->offset + done;
+                block = pos / ctx.block_size;
+                chunk = min (len - done, (block + 1) * ctx.block_size - pos);
+
+                if (!block) {
+                        shard_as_caller (local);
+                        ret = syncop_readv (FIRST_CHILD (this), local->fd,
+                                            chunk, pos, local->flags,
+                                            &vector, &count, &iobref);
+                        shard_as_root ();
+                } else {
+                        retried = _gf_false;
+                        do {
+                                ret = -1;
+                                anon_fd = shard_block_fd (this, inode, block,
+                                                          _gf_false);
+                                if (!anon_fd && errno == ENOENT)
+                                        ret = 0;
+                                if (anon_fd)
+                                        ret = syncop_readv (FIRST_CHILD (this),
+                                                            anon_fd, chunk,
+                                                            pos - block *
+                                                            ctx.block_size,
+                                                            local->flags,
+                                                            &vector, &count,
+                                                            &iobref);
+                        } while (shard_block_fd_done (this, inode, block,
+                                                      anon_fd, ret,
+                                                      &retried));
+                        anon_fd = NULL;
+                }
+
+                if (ret > 0)
+                        iov_unload (buf + done, vector, count);
+
+                GF_FREE (vector);
+                vector = NULL;
+                if (iobref)
+                        iobref_unref (iobref);
+                iobref = NULL;
+
+                if (ret < 0)
+                        break;
+                done += chunk;
+        }
+
+        if (ret < 0)
+                goto out;
+
+        local->rvector[0].iov_base = buf;
+        local->rvector[0].iov_len  = len;
+        local->rcount = 1;
+        ret = len;
+out:
+        if (iobuf)
+                iobuf_unref (iobuf);
+
+        local->op_ret = ret;
+        if (ret < 0)
+                local->op_errno = errno;
+
+        return 0;
+}
+
+static int
+shard_readv_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t  *frame = data;
+        shard_local_t *local = frame->local;
+
+        SHARD_STACK_UNWIND (readv, frame, local->op_ret, local->op_errno,
+                            local->rvector, local->rcount, &local->postbuf,
+                            local->riobref, NULL);
+
+        return 0;
+}
+
+/* truncate, ftruncate and open with O_TRUNC */
+static int
+shard_truncate_task (void *data)
+{
+        call_frame_t      *frame = data;
+        xlator_t          *this  = NULL;
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+        inode_t           *inode = NULL;
+        loc_t              loc   = {0, };
+        uint64_t           old   = 0;
+        uint64_t           new   = 0;
+        uint64_t           block = 0;
+        uint64_t           last  = 0;
+        int                ret   = -1;
+
+        this  = frame->this;
+        local = frame->local;
+        inode = local->fd ? local->fd->inode : local->loc.inode;
+        new   = local->offset;
+
+        shard_task_begin (local);
+
+        ret = shard_inode_ctx_load (this, inode, local->fd, &local->loc,
+                                    &ctx);
+        if (ret)
+                goto out;
+
+        if (!ctx.block_size) {
+                shard_as_caller (local);
+                if (local->fd)
+                        ret = syncop_ftruncate (FIRST_CHILD (this), local->fd,
+                                                new);
+                else
+                        ret = syncop_truncate (FIRST_CHILD (this), &local->loc,
+                                               new);
+                if (ret)
+                        goto out;
+
+                local->prebuf = ctx.stat;
+                if (local->fd)
+                        ret = syncop_fstat (FIRST_CHILD (this), local->fd,
+                                            &local->postbuf);
+                else
+                        ret = syncop_stat (FIRST_CHILD (this), &local->loc,
+                                           &local->postbuf);
+                goto out;
+        }
+
+        /* the file itself may be left as it is, the caller still needs
+           to be allowed to change it */
+        if (local->fop == GF_FOP_OPEN) {
+                /* checked by the open with O_TRUNC */
+                ret = 0;
+        } else if (local->fd) {
+                ret = shard_fd_check (local->fd, O_WRONLY);
+        } else {
+                shard_as_caller (local);
+                ret = syncop_access (FIRST_CHILD (this), &local->loc, W_OK);
+                shard_as_root ();
+        }
+        if (ret)
+                goto out;
+
+        shard_base_loc (inode, &loc);
+        ret = shard_lock (this, &loc, F_WRLCK);
+        if (ret)
+                goto out;
+
+        ret = shard_size_read (this, &loc, &old);
+        if (ret)
+                goto unlock;
+
+        if (new < ctx.block_size) {
+                shard_as_caller (local);
+                if (local->fd)
+                        ret = syncop_ftruncate (FIRST_CHILD (this), local->fd,
+                                                new);
+                else
+                        ret = syncop_truncate (FIRST_CHILD (this), &loc, new);
+                shard_as_root ();
+                if (ret)
+                        goto unlock;
+        }
+
+        last = old ? (old - 1) / ctx.block_size : 0;
+        for (block = last; block >= 1; block--) {
+                if (block * ctx.block_size >= new)
+                        ret = shard_block_unlink (this, inode->table,
+                                                  inode->gfid, block);
+                else if ((block + 1) * ctx.block_size > new)
+                        ret = shard_block_ftruncate (this, inode, block,
+                                                     new - block *
+                                                     ctx.block_size);
+                else
+                        break;
+                if (ret)
+                        goto unlock;
+        }
+
+        ret = shard_size_write (this, &loc, new);
+unlock:
+        shard_lock (this, &loc, F_UNLCK);
+
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "truncate of %s to %"PRIu64" failed (%s)",
+                        uuid_utoa (inode->gfid), new, strerror (errno));
+                goto out;
+        }
+
+        shard_inode_ctx_size_set (this, inode, new);
+        shard_prepare_iatts (this, inode, old, local);
+out:
+        loc_wipe (&loc);
+
+        local->op_ret = ret;
+        if (ret < 0)
+                local->op_errno = errno;
+
+        return 0;
+}
+
+static int
+shard_truncate_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t  *frame = data;
+        shard_local_t *local = frame->local;
+        fd_t          *fd    = NULL;
+
+        switch (local->fop) {
+        case GF_FOP_OPEN:
+                fd = local->fd;
+                SHARD_STACK_UNWIND (open, frame, local->op_ret,
+                                    local->op_errno, fd, NULL);
+                break;
+        case GF_FOP_FTRUNCATE:
+                SHARD_STACK_UNWIND (ftruncate, frame, local->op_ret,
+                                    local->op_errno, &local->prebuf,
+                                    &local->postbuf, NULL);
+                break;
+        default:
+                SHARD_STACK_UNWIND (truncate, frame, local->op_ret,
+                                    local->op_errno, &local->prebuf,
+                                    &local->postbuf, NULL);
+                break;
+        }
+
+        return 0;
+}
+
+static int
+shard_fsync_task (void *data)
+{
+        call_frame_t      *frame   = data;
+        xlator_t          *this    = NULL;
+        shard_local_t     *local   = NULL;
+        shard_inode_ctx_t *ctx     = NULL;
+        inode_t           *inode   = NULL;
+        gf_boolean_t       retried = _gf_false;
+        fd_t              *anon_fd = NULL;
+        uint64_t           dirty[SHARD_DIRTY_MAX];
+        uint64_t           value   = 0;
+        uint64_t           block   = 0;
+        uint64_t           last    = 0;
+        int                cnt     = 0;
+        int                i       = 0;
+        int                ret     = -1;
+
+        this  = frame->this;
+        local = frame->local;
+        inode = local->fd->inode;
+
+        shard_task_begin (local);
+
+        shard_as_caller (local);
+        ret = syncop_fsync (FIRST_CHILD (this), local->fd, local->datasync);
+        shard_as_root ();
+        if (ret)
+                goto out;
+
+        LOCK (&inode->lock);
+        {
+                if (!__inode_ctx_get (inode, this, &value)) {
+                        ctx = (shard_inode_ctx_t *)(long) value;
+                        cnt = ctx->dirty_cnt;
+                        if (cnt > 0)
+                                memcpy (dirty, ctx->dirty,
+                                        cnt * sizeof (dirty[0]));
+                        if (ctx->block_size && ctx->size)
+                                last = (ctx->size - 1) / ctx->block_size;
+                        ctx->dirty_cnt = 0;
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        for (i = 0; (cnt < 0) ? (i < last) : (i < cnt); i++) {
+                block = (cnt < 0) ? i + 1 : dirty[i];
+
+                retried = _gf_false;
+                do {
+                        ret = -1;
+                        anon_fd = shard_block_fd (this, inode, block,
+                                                  _gf_false);
+                        if (!anon_fd && errno == ENOENT)
+                                ret = 0;
+                        if (anon_fd)
+                                ret = syncop_fsync (FIRST_CHILD (this),
+                                                    anon_fd, local->datasync);
+                } while (shard_block_fd_done (this, inode, block, anon_fd,
+                                              ret, &retried));
+                anon_fd = NULL;
+
+                if (ret) {
+                        /* written again by the next fsync */
+                        shard_dirty_mark (this, inode, block);
+                        break;
+                }
+        }
+
+        if (!ret)
+                ret = syncop_fstat (FIRST_CHILD (this), local->fd,
+                                    &local->postbuf);
+        if (!ret) {
+                shard_iatt_from_ctx (this, inode, &local->postbuf);
+                local->prebuf = local->postbuf;
+        }
+out:
+        local->op_ret = ret;
+        if (ret < 0)
+                local->op_errno = errno;
+
+        return 0;
+}
+
+static int
+shard_fsync_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t  *frame = data;
+        shard_local_t *local = frame->local;
+
+        SHARD_STACK_UNWIND (fsync, frame, local->op_ret, local->op_errno,
+                            &local->prebuf, &local->postbuf, NULL);
+
+        return 0;
+}
+
+/* removes the blocks of a file once its last name is gone */
+static int
+shard_remove_task (void *data)
+{
+        call_frame_t  *frame = data;
+        xlator_t      *this  = NULL;
+        shard_local_t *local = NULL;
+        inode_t       *inode = NULL;
+        loc_t          loc   = {0, };
+        struct iatt    iatt  = {0, };
+        uint64_t       block = 0;
+        uint64_t       last  = 0;
+        int            ret   = -1;
+
+        this  = frame->this;
+        local = frame->local;
+        inode = local->inode;
+
+        shard_task_begin (local);
+
+        /* another name may still lead to it */
+        loc.inode = inode_new (inode->table);
+        if (!loc.inode)
+                goto out;
+        uuid_copy (loc.gfid, inode->gfid);
+
+        ret = syncop_lookup (FIRST_CHILD (this), &loc, NULL, &iatt, NULL,
+                             NULL);
+        if (!ret || (errno != ENOENT && errno != ESTALE)) {
+                ret = 0;
+                goto out;
+        }
+
+        last = local->file_size ? (local->file_size - 1) / local->block_size :
+                                  0;
+        for (block = 1; block <= last; block++) {
+                ret = shard_block_unlink (this, inode->table, inode->gfid,
+                                          block);
+                if (ret)
+                        break;
+        }
+
+        if (ret)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "removing blocks of %s failed at block %"PRIu64" "
+                        "(%s)", uuid_utoa (inode->gfid), block,
+                        strerror (errno));
+        else
+                gf_log (this->name, GF_LOG_DEBUG, "removed %"PRIu64" blocks "
+                        "of %s", last, uuid_utoa (inode->gfid));
+out:
+        loc_wipe (&loc);
+
+        return ret;
+}
+
+static int
+shard_remove_done (int ret, call_frame_t *sync_frame, void *data)
+{
+        call_frame_t *frame = data;
+
+        shard_local_wipe (frame->local);
+        frame->local = NULL;
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+static void
+shard_remove_blocks_start (xlator_t *this, inode_t *inode,
+                           uint64_t block_size, uint64_t size)
+{
+        call_frame_t      *frame = NULL;
+        shard_local_t     *local = NULL;
+        int                ret   = -1;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto err;
+
+        local = shard_local_init (frame, GF_FOP_UNLINK);
+        if (!local)
+                goto err;
+
+        local->inode      = inode_ref (inode);
+        local->block_size = block_size;
+        local->file_size  = size;
+
+        ret = synctask_new (this->ctx->env, shard_remove_task,
+                            shard_remove_done, frame, frame);
+        if (!ret)
+                return;
+err:
+        gf_log (this->name, GF_LOG_WARNING, "could not start removing the "
+                "blocks of %s", uuid_utoa (inode->gfid));
+        if (frame) {
+                shard_local_wipe (frame->local);
+                frame->local = NULL;
+                STACK_DESTROY (frame->root);
+        }
+}
+
+/* open by anything but anonymous fds, which are not held past the
+   operation they were taken for */
+static gf_boolean_t
+__shard_inode_is_open (inode_t *inode)
+{
+        fd_t *fd = NULL;
+
+        list_for_each_entry (fd, &inode->fd_list, inode_list) {
+                if (!fd->anonymous)
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+/* the last name of @inode is gone; its blocks go with it once the last fd
+   on it is released (shard_release) */
+static void
+shard_remove_blocks (xlator_t *this, inode_t *inode, uint64_t block_size,
+                     uint64_t size)
+{
+        shard_inode_ctx_t *ctx   = NULL;
+        gf_boolean_t       defer = _gf_false;
+
+        if (!block_size || size <= block_size)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                if (__shard_inode_is_open (inode)) {
+                        ctx = __shard_inode_ctx_get (inode, this);
+                        if (ctx) {
+                                ctx->remove_pending = _gf_true;
+                                ctx->remove_size = size;
+                                defer = _gf_true;
+                        }
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (defer) {
+                gf_log (this->name, GF_LOG_DEBUG, "%s is still open, its "
+                        "blocks are removed when it is closed",
+                        uuid_utoa (inode->gfid));
+                return;
+        }
+
+        shard_remove_blocks_start (this, inode, block_size, size);
+}
+
+/* the size of a file losing its last name is taken from the file, the one
+   this client saw last may be stale; stays at that one if it cannot */
+static void
+shard_remove_size_get (xlator_t *this, shard_local_t *local, int32_t op_ret,
+                       int32_t op_errno, dict_t *xattr)
+{
+        if (op_ret == 0) {
+                if (!shard_xattr_get_uint64 (xattr, GF_XATTR_SHARD_FILE_SIZE,
+                                             &local->file_size))
+                        return;
+        } else if (op_errno == ENODATA) {
+                /* nothing was written past the first block yet */
+                local->file_size = 0;
+                return;
+        }
+
+        gf_log (this->name, GF_LOG_DEBUG, "%s: could not read the size "
+                "(%s), using the one last seen", uuid_utoa (local->inode->gfid),
+                strerror (op_errno));
+}
+
+/* }}} */
+
+/* {{{ fops */
+
+int32_t
+shard_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, inode_t *inode,
+                  struct iatt *buf, dict_t *xdata, struct iatt *postparent)
+{
+        if (op_ret == 0 && IA_ISREG (buf->ia_type))
+                shard_inode_ctx_set (this, inode, buf, xdata);
+
+        STACK_UNWIND_STRICT (lookup, frame, op_ret, op_errno, inode, buf,
+                             xdata, postparent);
+        return 0;
+}
+
+int32_t
+shard_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        dict_t *xattr_req = NULL;
+        int     ret       = -1;
+
+        if (shard_is_dot_shard (this, loc)) {
+                STACK_UNWIND_STRICT (lookup, frame, -1, ENOENT, NULL, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        xattr_req = xdata ? dict_ref (xdata) : dict_new ();
+        if (!xattr_req)
+                goto err;
+
+        ret = dict_set_uint64 (xattr_req, GF_XATTR_SHARD_BLOCK_SIZE, 0);
+        if (!ret)
+                ret = dict_set_uint64 (xattr_req, GF_XATTR_SHARD_FILE_SIZE,
+                                       0);
+        if (ret) {
+                dict_unref (xattr_req);
+                goto err;
+        }
+
+        STACK_WIND (frame, shard_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xattr_req);
+
+        dict_unref (xattr_req);
+        return 0;
+err:
+        STACK_UNWIND_STRICT (lookup, frame, -1, ENOMEM, NULL, NULL, NULL,
+                             NULL);
+        return 0;
+}
+
+static int shard_seek_reply (call_frame_t *frame, xlator_t *this);
+
+/* the size of a sharded file is read again for stat, fstat and seek, the
+   one seen at lookup goes stale once another client grows the file */
+int32_t
+shard_size_refresh_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xattr,
+                        dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+        uint64_t       size  = 0;
+
+        if (op_ret == 0 &&
+            !shard_xattr_get_uint64 (xattr, GF_XATTR_SHARD_FILE_SIZE, &size))
+                shard_inode_ctx_size_set (this, local->inode, size);
+
+        switch (local->fop) {
+        case GF_FOP_SEEK:
+                shard_seek_reply (frame, this);
+                break;
+        case GF_FOP_FSTAT:
+                shard_iatt_from_ctx (this, local->inode, &local->postbuf);
+                SHARD_STACK_UNWIND (fstat, frame, 0, 0, &local->postbuf,
+                                    local->xattr_req);
+                break;
+        default:
+                shard_iatt_from_ctx (this, local->inode, &local->postbuf);
+                SHARD_STACK_UNWIND (stat, frame, 0, 0, &local->postbuf,
+                                    local->xattr_req);
+                break;
+        }
+
+        return 0;
+}
+
+/* stat and fstat of a sharded file, the size is read next */
+int32_t
+shard_stat_sharded_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                        dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        if (op_ret < 0) {
+                if (local->fop == GF_FOP_FSTAT)
+                        SHARD_STACK_UNWIND (fstat, frame, op_ret, op_errno,
+                                            buf, xdata);
+                else
+                        SHARD_STACK_UNWIND (stat, frame, op_ret, op_errno,
+                                            buf, xdata);
+                return 0;
+        }
+
+        local->postbuf = *buf;
+        /* kept for the reply */
+        if (xdata)
+                local->xattr_req = dict_ref (xdata);
+
+        if (local->fop == GF_FOP_FSTAT)
+                STACK_WIND (frame, shard_size_refresh_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->fgetxattr, local->fd,
+                            GF_XATTR_SHARD_FILE_SIZE, NULL);
+        else
+                STACK_WIND (frame, shard_size_refresh_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->getxattr, &local->loc,
+                            GF_XATTR_SHARD_FILE_SIZE, NULL);
+        return 0;
+}
+
+int32_t
+shard_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                dict_t *xdata)
+{
+        if (op_ret == 0)
+                shard_iatt_from_ctx (this, cookie, buf);
+
+        STACK_UNWIND_STRICT (stat, frame, op_ret, op_errno, buf, xdata);
+        return 0;
+}
+
+int32_t
+shard_stat (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (loc->inode && !shard_inode_ctx_fetch (loc->inode, this, &ctx) &&
+            ctx.block_size) {
+                local = shard_local_init (frame, GF_FOP_STAT);
+                if (!local || loc_copy (&local->loc, loc)) {
+                        SHARD_STACK_UNWIND (stat, frame, -1, ENOMEM, NULL,
+                                            NULL);
+                        return 0;
+                }
+                local->inode = inode_ref (loc->inode);
+
+                STACK_WIND (frame, shard_stat_sharded_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->stat, loc, xdata);
+                return 0;
+        }
+
+        STACK_WIND_COOKIE (frame, shard_stat_cbk, loc->inode,
+                           FIRST_CHILD (this), FIRST_CHILD (this)->fops->stat,
+                           loc, xdata);
+        return 0;
+}
+
+int32_t
+shard_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                 dict_t *xdata)
+{
+        if (op_ret == 0)
+                shard_iatt_from_ctx (this, cookie, buf);
+
+        STACK_UNWIND_STRICT (fstat, frame, op_ret, op_errno, buf, xdata);
+        return 0;
+}
+
+int32_t
+shard_fstat (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (!shard_inode_ctx_fetch (fd->inode, this, &ctx) &&
+            ctx.block_size) {
+                local = shard_local_init (frame, GF_FOP_FSTAT);
+                if (!local) {
+                        STACK_UNWIND_STRICT (fstat, frame, -1, ENOMEM, NULL,
+                                             NULL);
+                        return 0;
+                }
+                local->fd    = fd_ref (fd);
+                local->inode = inode_ref (fd->inode);
+
+                STACK_WIND (frame, shard_stat_sharded_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->fstat, fd, xdata);
+                return 0;
+        }
+
+        STACK_WIND_COOKIE (frame, shard_fstat_cbk, fd->inode,
+                           FIRST_CHILD (this), FIRST_CHILD (this)->fops->fstat,
+                           fd, xdata);
+        return 0;
+}
+
+int32_t
+shard_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                   struct iatt *statpost, dict_t *xdata)
+{
+        if (op_ret == 0) {
+                shard_iatt_from_ctx (this, cookie, statpost);
+                if (statpre && statpost)
+                        statpre->ia_size = statpost->ia_size;
+        }
+
+        STACK_UNWIND_STRICT (setattr, frame, op_ret, op_errno, statpre,
+                             statpost, xdata);
+        return 0;
+}
+
+int32_t
+shard_setattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+               struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, shard_setattr_cbk, loc->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->setattr, loc, stbuf,
+                           valid, xdata);
+        return 0;
+}
+
+int32_t
+shard_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                    struct iatt *statpost, dict_t *xdata)
+{
+        if (op_ret == 0) {
+                shard_iatt_from_ctx (this, cookie, statpost);
+                if (statpre && statpost)
+                        statpre->ia_size = statpost->ia_size;
+        }
+
+        STACK_UNWIND_STRICT (fsetattr, frame, op_ret, op_errno, statpre,
+                             statpost, xdata);
+        return 0;
+}
+
+int32_t
+shard_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, shard_fsetattr_cbk, fd->inode,
+                           FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->fsetattr, fd, stbuf,
+                           valid, xdata);
+        return 0;
+}
+
+static int
+shard_readdir_filter (xlator_t *this, fd_t *fd, int32_t op_ret,
+                      gf_dirent_t *entries, gf_boolean_t plus)
+{
+        gf_dirent_t  hidden;
+        gf_dirent_t *entry = NULL;
+        gf_dirent_t *tmp   = NULL;
+        gf_boolean_t root  = _gf_false;
+
+        INIT_LIST_HEAD (&hidden.list);
+        root = __is_root_gfid (fd->inode->gfid);
+
+        list_for_each_entry_safe (entry, tmp, &entries->list, list) {
+                if (root && !strcmp (entry->d_name, GF_SHARD_DIR)) {
+                        list_del_init (&entry->list);
+                        list_add_tail (&entry->list, &hidden.list);
+                        op_ret--;
+                        continue;
+                }
+
+                if (!plus || !IA_ISREG (entry->d_stat.ia_type))
+                        continue;
+
+                shard_inode_ctx_set (this, entry->inode, &entry->d_stat,
+                                     entry->dict);
+        }
+
+        gf_dirent_free (&hidden);
+
+        return op_ret;
+}
+
+int32_t
+shard_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                   dict_t *xdata)
+{
+        if (op_ret > 0)
+                op_ret = shard_readdir_filter (this, cookie, op_ret, entries,
+                                               _gf_false);
+
+        STACK_UNWIND_STRICT (readdir, frame, op_ret, op_errno, entries,
+                             xdata);
+        return 0;
+}
+
+int32_t
+shard_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+               off_t offset, dict_t *xdata)
+{
+        STACK_WIND_COOKIE (frame, shard_readdir_cbk, fd, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->readdir, fd, size,
+                           offset, xdata);
+        return 0;
+}
+
+int32_t
+shard_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                    dict_t *xdata)
+{
+        if (op_ret > 0)
+                op_ret = shard_readdir_filter (this, cookie, op_ret, entries,
+                                               _gf_true);
+
+        STACK_UNWIND_STRICT (readdirp, frame, op_ret, op_errno, entries,
+                             xdata);
+        return 0;
+}
+
+int32_t
+shard_readdirp (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                off_t offset, dict_t *xdata)
+{
+        dict_t *xattr_req = NULL;
+        int     ret       = -1;
+
+        xattr_req = xdata ? dict_ref (xdata) : dict_new ();
+        if (!xattr_req)
+                goto err;
+
+        ret = dict_set_uint64 (xattr_req, GF_XATTR_SHARD_BLOCK_SIZE, 0);
+        if (!ret)
+                ret = dict_set_uint64 (xattr_req, GF_XATTR_SHARD_FILE_SIZE,
+                                       0);
+        if (ret) {
+                dict_unref (xattr_req);
+                goto err;
+        }
+
+        STACK_WIND_COOKIE (frame, shard_readdirp_cbk, fd, FIRST_CHILD (this),
+                           FIRST_CHILD (this)->fops->readdirp, fd, size,
+                           offset, xattr_req);
+
+        dict_unref (xattr_req);
+        return 0;
+err:
+        STACK_UNWIND_STRICT (readdirp, frame, -1, ENOMEM, NULL, NULL);
+        return 0;
+}
+
+static dict_t *
+shard_create_xattr_req (xlator_t *this, dict_t *xdata, uint64_t *block_size)
+{
+        shard_priv_t *priv  = NULL;
+        dict_t       *xattr = NULL;
+
+        priv = this->private;
+
+        xattr = xdata ? dict_copy_with_ref (xdata, NULL) : dict_new ();
+        if (!xattr)
+                return NULL;
+
+        if (shard_xattr_set_uint64 (xattr, GF_XATTR_SHARD_BLOCK_SIZE,
+                                    priv->block_size)) {
+                dict_unref (xattr);
+                return NULL;
+        }
+
+        *block_size = priv->block_size;
+
+        return xattr;
+}
+
+static void
+shard_inode_ctx_new (xlator_t *this, inode_t *inode, struct iatt *buf,
+                     uint64_t block_size)
+{
+        shard_inode_ctx_t *ctx = NULL;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __shard_inode_ctx_get (inode, this);
+                if (ctx) {
+                        ctx->block_size = block_size;
+                        ctx->size       = buf->ia_size;
+                        ctx->stat       = *buf;
+                }
+        }
+        UNLOCK (&inode->lock);
+}
+
+int32_t
+shard_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+                  struct iatt *buf, struct iatt *preparent,
+                  struct iatt *postparent, dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        if (op_ret == 0) {
+                shard_inode_ctx_new (this, inode, buf, local->block_size);
+                fd_ctx_set (fd, this, 1);
+        }
+
+        SHARD_STACK_UNWIND (create, frame, op_ret, op_errno, fd, inode, buf,
+                            preparent, postparent, xdata);
+        return 0;
+}
+
+int32_t
+shard_create (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+              mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+        shard_local_t *local     = NULL;
+        dict_t        *xattr_req = NULL;
+
+        if (shard_is_dot_shard (this, loc)) {
+                STACK_UNWIND_STRICT (create, frame, -1, EPERM, NULL, NULL,
+                                     NULL, NULL, NULL, NULL);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_CREATE);
+        if (!local)
+                goto err;
+
+        xattr_req = shard_create_xattr_req (this, xdata, &local->block_size);
+        if (!xattr_req)
+                goto err;
+
+        /* the file itself ends at the first block, appending to it would
+           land there */
+        STACK_WIND (frame, shard_create_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->create, loc, flags & ~O_APPEND,
+                    mode, umask, fd, xattr_req);
+
+        dict_unref (xattr_req);
+        return 0;
+err:
+        SHARD_STACK_UNWIND (create, frame, -1, ENOMEM, NULL, NULL, NULL,
+                            NULL, NULL, NULL);
+        return 0;
+}
+
+int32_t
+shard_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, inode_t *inode,
+                 struct iatt *buf, struct iatt *preparent,
+                 struct iatt *postparent, dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        if (op_ret == 0)
+                shard_inode_ctx_new (this, inode, buf, local->block_size);
+
+        SHARD_STACK_UNWIND (mknod, frame, op_ret, op_errno, inode, buf,
+                            preparent, postparent, xdata);
+        return 0;
+}
+
+int32_t
+shard_mknod (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+             dev_t rdev, mode_t umask, dict_t *xdata)
+{
+        shard_local_t *local     = NULL;
+        dict_t        *xattr_req = NULL;
+
+        if (!S_ISREG (mode)) {
+                STACK_WIND (frame, default_mknod_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->mknod, loc, mode, rdev,
+                            umask, xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_MKNOD);
+        if (!local)
+                goto err;
+
+        xattr_req = shard_create_xattr_req (this, xdata, &local->block_size);
+        if (!xattr_req)
+                goto err;
+
+        STACK_WIND (frame, shard_mknod_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mknod, loc, mode, rdev, umask,
+                    xattr_req);
+
+        dict_unref (xattr_req);
+        return 0;
+err:
+        SHARD_STACK_UNWIND (mknod, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL);
+        return 0;
+}
+
+int32_t
+shard_mkdir (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+             mode_t umask, dict_t *xdata)
+{
+        if (shard_is_dot_shard (this, loc)) {
+                STACK_UNWIND_STRICT (mkdir, frame, -1, EPERM, NULL, NULL,
+                                     NULL, NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, default_mkdir_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mkdir, loc, mode, umask, xdata);
+        return 0;
+}
+
+int32_t
+shard_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        /* for shard_release to see it closed */
+        if (op_ret == 0)
+                fd_ctx_set (fd, this, 1);
+
+        if (op_ret < 0 || !local || !(local->flags & O_TRUNC))
+                goto unwind;
+
+        /* the file itself is truncated, its blocks are left */
+        local->fd = fd_ref (fd);
+        local->offset = 0;
+        if (!synctask_new (this->ctx->env, shard_truncate_task,
+                           shard_truncate_done, frame, frame))
+                return 0;
+
+        op_ret = -1;
+        op_errno = ENOMEM;
+unwind:
+        SHARD_STACK_UNWIND (open, frame, op_ret, op_errno, fd, xdata);
+        return 0;
+}
+
+int32_t
+shard_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+            fd_t *fd, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (shard_inode_ctx_fetch (loc->inode, this, &ctx) ||
+            !ctx.block_size) {
+                STACK_WIND (frame, shard_open_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->open, loc, flags, fd,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_OPEN);
+        if (!local) {
+                STACK_UNWIND_STRICT (open, frame, -1, ENOMEM, NULL, NULL);
+                return 0;
+        }
+        local->flags = flags;
+
+        STACK_WIND (frame, shard_open_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->open, loc, flags & ~O_APPEND,
+                    fd, xdata);
+        return 0;
+}
+
+int32_t
+shard_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+        if (op_ret >= 0) {
+                shard_iatt_from_ctx (this, cookie, postbuf);
+                if (prebuf && postbuf)
+                        prebuf->ia_size = postbuf->ia_size;
+        }
+
+        STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, prebuf, postbuf,
+                             xdata);
+        return 0;
+}
+
+int32_t
+shard_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              struct iovec *vector, int32_t count, off_t offset,
+              uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+        uint64_t           end   = 0;
+
+        /* files which are not sharded, and writes inside the first block
+           which do not change the size, need no help */
+        if (!shard_inode_ctx_fetch (fd->inode, this, &ctx)) {
+                end = offset + iov_length (vector, count);
+                if (!ctx.block_size ||
+                    (end <= ctx.block_size && end <= ctx.size)) {
+                        STACK_WIND_COOKIE (frame, shard_writev_cbk, fd->inode,
+                                           FIRST_CHILD (this),
+                                           FIRST_CHILD (this)->fops->writev,
+                                           fd, vector, count, offset, flags,
+                                           iobref, xdata);
+                        return 0;
+                }
+        }
+
+        local = shard_local_init (frame, GF_FOP_WRITE);
+        if (!local)
+                goto err;
+
+        local->fd     = fd_ref (fd);
+        local->offset = offset;
+        local->flags  = flags;
+        local->count  = count;
+        local->vector = iov_dup (vector, count);
+        if (!local->vector)
+                goto err;
+        if (iobref)
+                local->iobref = iobref_ref (iobref);
+
+        if (synctask_new (this->ctx->env, shard_writev_task,
+                          shard_writev_done, frame, frame))
+                goto err;
+
+        return 0;
+err:
+        SHARD_STACK_UNWIND (writev, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+}
+
+int32_t
+shard_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+             off_t offset, uint32_t flags, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (!shard_inode_ctx_fetch (fd->inode, this, &ctx) &&
+            !ctx.block_size) {
+                STACK_WIND (frame, default_readv_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->readv, fd, size,
+                            offset, flags, xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_READ);
+        if (!local)
+                goto err;
+
+        local->fd     = fd_ref (fd);
+        local->size   = size;
+        local->offset = offset;
+        local->flags  = flags;
+
+        if (synctask_new (this->ctx->env, shard_readv_task, shard_readv_done,
+                          frame, frame))
+                goto err;
+
+        return 0;
+err:
+        SHARD_STACK_UNWIND (readv, frame, -1, ENOMEM, NULL, 0, NULL, NULL,
+                            NULL);
+        return 0;
+}
+
+int32_t
+shard_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc,
+                off_t offset, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (!shard_inode_ctx_fetch (loc->inode, this, &ctx) &&
+            !ctx.block_size) {
+                STACK_WIND (frame, default_truncate_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->truncate, loc, offset,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_TRUNCATE);
+        if (!local)
+                goto err;
+
+        local->offset = offset;
+        if (loc_copy (&local->loc, loc))
+                goto err;
+
+        if (synctask_new (this->ctx->env, shard_truncate_task,
+                          shard_truncate_done, frame, frame))
+                goto err;
+
+        return 0;
+err:
+        SHARD_STACK_UNWIND (truncate, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+}
+
+int32_t
+shard_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                 dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (!shard_inode_ctx_fetch (fd->inode, this, &ctx) &&
+            !ctx.block_size) {
+                STACK_WIND (frame, default_ftruncate_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->ftruncate, fd, offset,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_FTRUNCATE);
+        if (!local)
+                goto err;
+
+        local->fd     = fd_ref (fd);
+        local->offset = offset;
+
+        if (synctask_new (this->ctx->env, shard_truncate_task,
+                          shard_truncate_done, frame, frame))
+                goto err;
+
+        return 0;
+err:
+        SHARD_STACK_UNWIND (ftruncate, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+}
+
+int32_t
+shard_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
+             dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (shard_inode_ctx_fetch (fd->inode, this, &ctx) ||
+            !ctx.block_size) {
+                STACK_WIND (frame, default_fsync_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->fsync, fd, datasync,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_FSYNC);
+        if (!local)
+                goto err;
+
+        local->fd       = fd_ref (fd);
+        local->datasync = datasync;
+
+        if (synctask_new (this->ctx->env, shard_fsync_task, shard_fsync_done,
+                          frame, frame))
+                goto err;
+
+        return 0;
+err:
+        SHARD_STACK_UNWIND (fsync, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+}
+
+int32_t
+shard_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+                  struct iatt *postparent, dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        if (op_ret == 0 && local->inode)
+                shard_remove_blocks (this, local->inode, local->block_size,
+                                     local->file_size);
+
+        SHARD_STACK_UNWIND (unlink, frame, op_ret, op_errno, preparent,
+                            postparent, xdata);
+        return 0;
+}
+
+int32_t
+shard_unlink_size_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, dict_t *xattr,
+                       dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        shard_remove_size_get (this, local, op_ret, op_errno, xattr);
+
+        STACK_WIND (frame, shard_unlink_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->unlink, &local->loc,
+                    local->flags, local->xattr_req);
+        return 0;
+}
+
+int32_t
+shard_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+              dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (!loc->inode || shard_inode_ctx_fetch (loc->inode, this, &ctx) ||
+            !ctx.block_size) {
+                STACK_WIND (frame, default_unlink_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->unlink, loc, xflag,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_UNLINK);
+        if (!local || loc_copy (&local->loc, loc)) {
+                SHARD_STACK_UNWIND (unlink, frame, -1, ENOMEM, NULL, NULL,
+                                    NULL);
+                return 0;
+        }
+        local->inode      = inode_ref (loc->inode);
+        local->flags      = xflag;
+        local->block_size = ctx.block_size;
+        local->file_size  = ctx.size;
+        if (xdata)
+                local->xattr_req = dict_ref (xdata);
+
+        STACK_WIND (frame, shard_unlink_size_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->getxattr, loc,
+                    GF_XATTR_SHARD_FILE_SIZE, NULL);
+        return 0;
+}
+
+int32_t
+shard_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                  struct iatt *preoldparent, struct iatt *postoldparent,
+                  struct iatt *prenewparent, struct iatt *postnewparent,
+                  dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        /* the file replaced by the rename */
+        if (op_ret == 0 && local->inode)
+                shard_remove_blocks (this, local->inode, local->block_size,
+                                     local->file_size);
+
+        if (op_ret == 0)
+                shard_iatt_from_ctx (this, local->loc.inode, buf);
+
+        SHARD_STACK_UNWIND (rename, frame, op_ret, op_errno, buf,
+                            preoldparent, postoldparent, prenewparent,
+                            postnewparent, xdata);
+        return 0;
+}
+
+int32_t
+shard_rename_size_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, dict_t *xattr,
+                       dict_t *xdata)
+{
+        shard_local_t *local = frame->local;
+
+        shard_remove_size_get (this, local, op_ret, op_errno, xattr);
+
+        STACK_WIND (frame, shard_rename_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->rename, &local->loc,
+                    &local->loc2, local->xattr_req);
+        return 0;
+}
+
+int32_t
+shard_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,
+              loc_t *newloc, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (shard_is_dot_shard (this, oldloc) ||
+            shard_is_dot_shard (this, newloc)) {
+                STACK_UNWIND_STRICT (rename, frame, -1, EPERM, NULL, NULL,
+                                     NULL, NULL, NULL, NULL);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_RENAME);
+        if (!local) {
+                STACK_UNWIND_STRICT (rename, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL, NULL, NULL);
+                return 0;
+        }
+        if (oldloc->inode)
+                local->loc.inode = inode_ref (oldloc->inode);
+
+        if (!newloc->inode || newloc->inode == oldloc->inode ||
+            shard_inode_ctx_fetch (newloc->inode, this, &ctx) ||
+            !ctx.block_size) {
+                STACK_WIND (frame, shard_rename_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->rename, oldloc, newloc,
+                            xdata);
+                return 0;
+        }
+
+        /* a sharded file gets replaced */
+        loc_wipe (&local->loc);
+        if (loc_copy (&local->loc, oldloc) || loc_copy (&local->loc2, newloc)) {
+                SHARD_STACK_UNWIND (rename, frame, -1, ENOMEM, NULL, NULL,
+                                    NULL, NULL, NULL, NULL);
+                return 0;
+        }
+        local->inode      = inode_ref (newloc->inode);
+        local->block_size = ctx.block_size;
+        local->file_size  = ctx.size;
+        if (xdata)
+                local->xattr_req = dict_ref (xdata);
+
+        STACK_WIND (frame, shard_rename_size_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->getxattr, newloc,
+                    GF_XATTR_SHARD_FILE_SIZE, NULL);
+        return 0;
+}
+
+/* the operations below work on byte ranges of the file itself, which only
+   holds the first block of a sharded file */
+static int
+shard_is_sharded (xlator_t *this, fd_t *fd)
+{
+        shard_inode_ctx_t ctx = {0, };
+
+        if (shard_inode_ctx_fetch (fd->inode, this, &ctx))
+                return 0;
+
+        return ctx.block_size != 0;
+}
+
+int32_t
+shard_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+        if (shard_is_sharded (this, fd)) {
+                STACK_UNWIND_STRICT (fallocate, frame, -1, EOPNOTSUPP, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                    offset, len, xdata);
+        return 0;
+}
+
+int32_t
+shard_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+               size_t len, dict_t *xdata)
+{
+        if (shard_is_sharded (this, fd)) {
+                STACK_UNWIND_STRICT (discard, frame, -1, EOPNOTSUPP, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->discard, fd, offset, len,
+                    xdata);
+        return 0;
+}
+
+int32_t
+shard_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                size_t len, dict_t *xdata)
+{
+        if (shard_is_sharded (this, fd)) {
+                STACK_UNWIND_STRICT (zerofill, frame, -1, EOPNOTSUPP, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->zerofill, fd, offset, len,
+                    xdata);
+        return 0;
+}
+
+static int
+shard_seek_reply (call_frame_t *frame, xlator_t *this)
+{
+        shard_local_t     *local = frame->local;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        shard_inode_ctx_fetch (local->inode, this, &ctx);
+
+        /* data all through, with the hole at the end */
+        if (local->offset >= ctx.size)
+                SHARD_STACK_UNWIND (seek, frame, -1, ENXIO, 0, NULL);
+        else if (local->flags == GF_SEEK_DATA)
+                SHARD_STACK_UNWIND (seek, frame, 0, 0, local->offset, NULL);
+        else
+                SHARD_STACK_UNWIND (seek, frame, 0, 0, ctx.size, NULL);
+
+        return 0;
+}
+
+int32_t
+shard_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            gf_seek_what_t what, dict_t *xdata)
+{
+        shard_local_t     *local = NULL;
+        shard_inode_ctx_t  ctx   = {0, };
+
+        if (shard_inode_ctx_fetch (fd->inode, this, &ctx) ||
+            !ctx.block_size) {
+                STACK_WIND (frame, default_seek_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->seek, fd, offset, what,
+                            xdata);
+                return 0;
+        }
+
+        local = shard_local_init (frame, GF_FOP_SEEK);
+        if (!local) {
+                STACK_UNWIND_STRICT (seek, frame, -1, ENOMEM, 0, NULL);
+                return 0;
+        }
+        local->fd     = fd_ref (fd);
+        local->inode  = inode_ref (fd->inode);
+        local->offset = offset;
+        local->flags  = what;
+
+        STACK_WIND (frame, shard_size_refresh_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fgetxattr, fd,
+                    GF_XATTR_SHARD_FILE_SIZE, NULL);
+        return 0;
+}
+
+int32_t
+shard_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                       off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                       uint32_t flags, dict_t *xdata)
+{
+        if (shard_is_sharded (this, fd_in) ||
+            shard_is_sharded (this, fd_out)) {
+                STACK_UNWIND_STRICT (copy_file_range, frame, -1, EOPNOTSUPP,
+                                     NULL, NULL, NULL, NULL);
+                return 0;
+        }
+
+        STACK_WIND (frame, default_copy_file_range_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->copy_file_range, fd_in, off_in,
+                    fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
+/* }}} */
+
+int32_t
+shard_forget (xlator_t *this, inode_t *inode)
+{
+        uint64_t value = 0;
+
+        inode_ctx_del (inode, this, &value);
+        GF_FREE ((void *)(long) value);
+
+        return 0;
+}
+
+int32_t
+shard_release (xlator_t *this, fd_t *fd)
+{
+        inode_t           *inode      = NULL;
+        shard_inode_ctx_t *ctx        = NULL;
+        uint64_t           value      = 0;
+        uint64_t           block_size = 0;
+        uint64_t           size       = 0;
+
+        fd_ctx_del (fd, this, NULL);
+
+        inode = fd->inode;
+
+        LOCK (&inode->lock);
+        {
+                if (!__inode_ctx_get (inode, this, &value)) {
+                        ctx = (shard_inode_ctx_t *)(long) value;
+                        if (ctx->remove_pending &&
+                            !__shard_inode_is_open (inode)) {
+                                ctx->remove_pending = _gf_false;
+                                block_size = ctx->block_size;
+                                size = ctx->remove_size;
+                        }
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (block_size)
+                shard_remove_blocks_start (this, inode, block_size, size);
+
+        return 0;
+}
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int ret = -1;
+
+        if (!this)
+                return ret;
+
+        ret = xlator_mem_acct_init (this, gf_shard_mt_end + 1);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR, "Memory accounting init "
+                        "failed");
+                return ret;
+        }
+
+        return ret;
+}
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        shard_priv_t *priv = NULL;
+        int           ret  = -1;
+
+        priv = this->private;
+
+        /* files keep the block size they were created with */
+        GF_OPTION_RECONF ("block-size", priv->block_size, options, size,
+                          out);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+int
+init (xlator_t *this)
+{
+        shard_priv_t *priv = NULL;
+        int           ret  = -1;
+
+        if (!this->children || this->children->next) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "shard not configured with exactly one child");
+                goto out;
+        }
+
+        if (!this->parents) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dangling volume. check volfile ");
+        }
+
+        priv = GF_CALLOC (1, sizeof (*priv), gf_shard_mt_priv_t);
+        if (!priv)
+                goto out;
+
+        priv->inode_cache = GF_CALLOC (SHARD_INODE_CACHE, sizeof (inode_t *),
+                                       gf_shard_mt_inode_list);
+        if (!priv->inode_cache)
+                goto out;
+
+        GF_OPTION_INIT ("block-size", priv->block_size, size, out);
+
+        uuid_parse (SHARD_ROOT_GFID, priv->dot_shard_gfid);
+        LOCK_INIT (&priv->lock);
+
+        this->private = priv;
+        ret = 0;
+out:
+        if (ret && priv) {
+                GF_FREE (priv->inode_cache);
+                GF_FREE (priv);
+        }
+
+        return ret;
+}
+
+void
+fini (xlator_t *this)
+{
+        shard_priv_t *priv = NULL;
+        int           i    = 0;
+
+        priv = this->private;
+        if (!priv)
+                return;
+        this->private = NULL;
+
+        for (i = 0; i < SHARD_INODE_CACHE; i++) {
+                if (priv->inode_cache[i])
+                        inode_unref (priv->inode_cache[i]);
+        }
+        if (priv->dot_shard_inode)
+                inode_unref (priv->dot_shard_inode);
+
+        LOCK_DESTROY (&priv->lock);
+        GF_FREE (priv->inode_cache);
+        GF_FREE (priv);
+
+        return;
+}
+
+struct xlator_fops fops = {
+        .lookup          = shard_lookup,
+        .stat            = shard_stat,
+        .fstat           = shard_fstat,
+        .setattr         = shard_setattr,
+        .fsetattr        = shard_fsetattr,
+        .readdir         = shard_readdir,
+        .readdirp        = shard_readdirp,
+        .create          = shard_create,
+        .mknod           = shard_mknod,
+        .mkdir           = shard_mkdir,
+        .open            = shard_open,
+        .writev          = shard_writev,
+        .readv           = shard_readv,
+        .truncate        = shard_truncate,
+        .ftruncate       = shard_ftruncate,
+        .fsync           = shard_fsync,
+        .unlink          = shard_unlink,
+        .rename          = shard_rename,
+        .fallocate       = shard_fallocate,
+        .discard         = shard_discard,
+        .zerofill        = shard_zerofill,
+        .seek            = shard_seek,
+        .copy_file_range = shard_copy_file_range,
+};
+
+struct xlator_cbks cbks = {
+        .forget  = shard_forget,
+        .release = shard_release,
+};
+
+struct volume_options options[] = {
+        { .key  = {"block-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = SHARD_MIN_BLOCK_SIZE,
+          .max  = SHARD_MAX_BLOCK_SIZE,
+          .default_value = "64MB",
+          .description = "Size of the blocks a file created while sharding "
+                         "is enabled is split into. The first block stays in "
+                         "the file itself, every further block is a file of "
+                         "its own under the hidden directory /.shard."
+        },
+        { .key  = {NULL} },
+};
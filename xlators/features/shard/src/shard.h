@@ -0,0 +1,90 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef __SHARD_H__
+#define __SHARD_H__
+
+#include "xlator.h"
+#include "syncop.h"
+#include "shard-mem-types.h"
+
+/* A sharded file keeps its first block-size bytes in the file itself and
+ * every further block in a file of its own, "<gfid>.<block>", under the
+ * hidden directory /.shard. The translators below place those like any
+ * other file, so the blocks of a large file spread over all subvolumes
+ * and rebalance moves them one at a time. The block size and the size of
+ * the whole file are kept in xattrs of the file itself. */
+
+#define GF_SHARD_DIR              ".shard"
+#define SHARD_ROOT_GFID           "be318638-e8a0-4c6d-977d-7a937aa84806"
+
+#define GF_XATTR_SHARD_BLOCK_SIZE "trusted.glusterfs.shard.block-size"
+#define GF_XATTR_SHARD_FILE_SIZE  "trusted.glusterfs.shard.file-size"
+
+#define SHARD_MIN_BLOCK_SIZE      (4 * GF_UNIT_MB)
+#define SHARD_MAX_BLOCK_SIZE      (4 * GF_UNIT_TB)
+
+/* block inodes kept referenced, so that they are not looked up again on
+   every access */
+#define SHARD_INODE_CACHE         1024
+
+/* blocks remembered per file as written since its last fsync; beyond that
+   fsync goes to all of them */
+#define SHARD_DIRTY_MAX           64
+
+typedef struct {
+        uint64_t          block_size;
+        uuid_t            dot_shard_gfid;
+        inode_t          *dot_shard_inode;
+        inode_t         **inode_cache;
+        int               inode_cache_next;
+        gf_lock_t         lock;
+} shard_priv_t;
+
+typedef struct {
+        uint64_t          block_size;   /* 0 for files which are not sharded */
+        uint64_t          size;
+        struct iatt       stat;         /* last known attributes of the file
+                                           itself */
+        int               dirty_cnt;    /* -1 once dirty[] overflowed */
+        uint64_t          dirty[SHARD_DIRTY_MAX];
+        gf_boolean_t      remove_pending; /* last name gone while open */
+        uint64_t          remove_size;  /* size of the file at that time */
+} shard_inode_ctx_t;
+
+typedef struct {
+        glusterfs_fop_t   fop;
+        loc_t             loc;
+        loc_t             loc2;
+        dict_t           *xattr_req;
+        fd_t             *fd;
+        inode_t          *inode;
+        struct iovec     *vector;
+        int32_t           count;
+        struct iobref    *iobref;
+        off_t             offset;
+        size_t            size;
+        uint32_t          flags;
+        int32_t           datasync;
+        uint64_t          block_size;
+        uint64_t          file_size;
+        uid_t             uid;          /* of the caller, tasks run as root */
+        gid_t             gid;
+
+        int32_t           op_ret;
+        int32_t           op_errno;
+        struct iatt       prebuf;
+        struct iatt       postbuf;
+        struct iovec     *rvector;
+        int32_t           rcount;
+        struct iobref    *riobref;
+} shard_local_t;
+
+#endif /* __SHARD_H__ */
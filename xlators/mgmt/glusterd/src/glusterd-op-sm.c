@@ -4617,7 +4617,8 @@ glusterd_bricks_select_heal_volume (dict_t *dict, char **op_errstr,
 
 
         if (!glusterd_is_nodesvc_online ("glustershd") &&
-            (heal_op == GF_AFR_OP_INDEX_SUMMARY)) {
+            ((heal_op == GF_AFR_OP_INDEX_SUMMARY) ||
+             (heal_op == GF_AFR_OP_INDEX_COUNT))) {
 
                 op_ctx = glusterd_op_get_ctx ();
 
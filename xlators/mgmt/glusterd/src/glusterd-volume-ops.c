@@ -1200,6 +1200,7 @@ glusterd_op_stage_heal_volume (dict_t *dict, char **op_errstr)
         }
 
         if ((heal_op != GF_AFR_OP_INDEX_SUMMARY) &&
+            (heal_op != GF_AFR_OP_INDEX_COUNT) &&
             !glusterd_is_nodesvc_online ("glustershd")) {
                 ret = -1;
                 *op_errstr = gf_strdup ("Self-heal daemon is not running."
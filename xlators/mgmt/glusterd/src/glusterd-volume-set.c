@@ -362,11 +362,36 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.weighted-rebalance",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.rebalance-stats",
           .voltype    = "cluster/distribute",
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.rebalance-workers",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.rebalance-pipeline-depth",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.rebalance-latency-target",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.rebalance-brick-crawl",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key         = "cluster.subvols-per-directory",
           .voltype     = "cluster/distribute",
           .option      = "directory-layout-spread",
@@ -379,6 +404,31 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.readdir-prefetch",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.negative-lookup-cache",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.negative-lookup-cache-timeout",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.negative-lookup-cache-size",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.rename-map-size",
+          .voltype    = "cluster/distribute",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.nufa",
           .voltype    = "cluster/distribute",
           .option     = "!nufa",
@@ -409,6 +459,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.read-policy",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.read-policy-hysteresis",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.parallel-reads",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.parallel-read-min-size",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.background-self-heal-count",
           .voltype    = "cluster/replicate",
           .op_version = 1,
@@ -440,6 +510,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.shd-max-threads",
+          .voltype    = "cluster/replicate",
+          .option     = "!shd-max-threads",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.shd-wait-qlength",
+          .voltype    = "cluster/replicate",
+          .option     = "!shd-wait-qlength",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.strict-readdir",
           .voltype    = "cluster/replicate",
           .type       = NO_DOC,
@@ -468,6 +550,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.entry-self-heal-algorithm",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.entry-self-heal-merge-limit",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.eager-lock",
           .voltype    = "cluster/replicate",
           .op_version = 1,
@@ -485,6 +577,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.quorum-early-ack",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.choose-local",
           .voltype    = "cluster/replicate",
           .op_version = 2,
@@ -501,6 +598,21 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.data-dirty-map",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.changelog-batch",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.eager-lock-recall",
+          .voltype    = "cluster/replicate",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.readdir-failover",
           .voltype    = "cluster/replicate",
           .op_version = 2,
@@ -1122,6 +1234,19 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT | OPT_FLAG_XLATOR_OPT
         },
+        { .key        = "features.shard",
+          .voltype    = "features/shard",
+          .option     = "!shard",
+          .value      = "off",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT | OPT_FLAG_XLATOR_OPT
+        },
+        { .key        = "features.shard-block-size",
+          .voltype    = "features/shard",
+          .option     = "block-size",
+          .op_version = 2,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key         = "storage.linux-aio",
           .voltype     = "storage/posix",
           .op_version  = 1
@@ -1136,6 +1261,35 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .option      = "brick-gid",
           .op_version  = 1
         },
+        { .key         = "storage.background-unlink",
+          .voltype     = "storage/posix",
+          .option      = "background-unlink",
+          .op_version  = 2
+        },
+        { .key         = "storage.background-unlink-thread-count",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
+        { .key         = "storage.background-unlink-queue-size",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
+        { .key         = "storage.background-unlink-chunk-size",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
+        { .key         = "storage.background-unlink-rate-limit",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
+        { .key         = "storage.statfs-push-interval",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
+        { .key         = "storage.statfs-push-threshold",
+          .voltype     = "storage/posix",
+          .op_version  = 2
+        },
         { .key        = "config.memory-accounting",
           .voltype    = "configuration",
           .option     = "!config",
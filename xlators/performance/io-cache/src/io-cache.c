@@ -17,6 +17,7 @@
 #include "logging.h"
 #include "dict.h"
 #include "xlator.h"
+#include "defaults.h"
 #include "io-cache.h"
 #include "ioc-mem-types.h"
 #include "statedump.h"
@@ -1359,6 +1360,83 @@ ioc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
         return 0;
 }
 
+/*
+ * ioc_fallocate, ioc_discard, ioc_zerofill -
+ *
+ * change the contents of a range without passing data through us, the
+ * cached pages of the inode can not be trusted afterwards.
+ */
+int32_t
+ioc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset,
+                    len, xdata);
+        return 0;
+}
+
+
+int32_t
+ioc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len, dict_t *xdata)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len, xdata);
+        return 0;
+}
+
+
+int32_t
+ioc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              size_t len, dict_t *xdata)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len, xdata);
+        return 0;
+}
+
+
+/* same as above, for the destination of a server side copy */
+int32_t
+ioc_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                     off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                     uint32_t flags, dict_t *xdata)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd_out->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, default_copy_file_range_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->copy_file_range, fd_in, off_in,
+                    fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
 int32_t
 ioc_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
             int32_t op_errno, struct gf_flock *lock, dict_t *xdata)
@@ -2040,6 +2118,10 @@ struct xlator_fops fops = {
         .writev      = ioc_writev,
         .truncate    = ioc_truncate,
         .ftruncate   = ioc_ftruncate,
+        .fallocate   = ioc_fallocate,
+        .discard     = ioc_discard,
+        .zerofill    = ioc_zerofill,
+        .copy_file_range = ioc_copy_file_range,
         .lookup      = ioc_lookup,
         .lk          = ioc_lk,
         .setattr     = ioc_setattr,
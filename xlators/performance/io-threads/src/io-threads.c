@@ -295,6 +295,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FSETXATTR:
         case GF_FOP_REMOVEXATTR:
         case GF_FOP_FREMOVEXATTR:
+        case GF_FOP_SEEK:
                 pri = IOT_PRI_NORMAL;
                 break;
 
@@ -303,6 +304,10 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FSYNC:
         case GF_FOP_TRUNCATE:
         case GF_FOP_FTRUNCATE:
+        case GF_FOP_FALLOCATE:
+        case GF_FOP_DISCARD:
+        case GF_FOP_ZEROFILL:
+        case GF_FOP_COPY_FILE_RANGE:
         case GF_FOP_FSYNCDIR:
         case GF_FOP_XATTROP:
         case GF_FOP_FXATTROP:
@@ -1012,6 +1017,116 @@ out:
 }
 
 
+int
+iot_copy_file_range_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                         struct iatt *prebuf, struct iatt *postbuf,
+                         dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (copy_file_range, frame, op_ret, op_errno, stbuf,
+                             prebuf, postbuf, xdata);
+	return 0;
+}
+
+
+int
+iot_copy_file_range_wrapper (call_frame_t *frame, xlator_t *this,
+                             fd_t *fd_in, off_t off_in, fd_t *fd_out,
+                             off_t off_out, size_t len, uint32_t flags,
+                             dict_t *xdata)
+{
+	STACK_WIND (frame, iot_copy_file_range_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->copy_file_range,
+		    fd_in, off_in, fd_out, off_out, len, flags, xdata);
+	return 0;
+}
+
+
+int
+iot_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                     off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                     uint32_t flags, dict_t *xdata)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_copy_file_range_stub (frame, iot_copy_file_range_wrapper,
+                                         fd_in, off_in, fd_out, off_out, len,
+                                         flags, xdata);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_copy_file_range call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (copy_file_range, frame, -1, -ret, NULL,
+                                     NULL, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset, xdata);
+	return 0;
+}
+
+
+int
+iot_seek_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+	STACK_WIND (frame, iot_seek_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->seek,
+		    fd, offset, what, xdata);
+	return 0;
+}
+
+
+int
+iot_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+          gf_seek_what_t what, dict_t *xdata)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_seek_stub (frame, iot_seek_wrapper, fd, offset, what,
+                              xdata);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_seek call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (seek, frame, -1, -ret, 0, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
 int
 iot_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -1429,6 +1544,166 @@ out:
 }
 
 
+int
+iot_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+	return 0;
+}
+
+
+int
+iot_fallocate_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int32_t keep_size, off_t offset, size_t len,
+                       dict_t *xdata)
+{
+	STACK_WIND (frame, iot_fallocate_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->fallocate,
+		    fd, keep_size, offset, len, xdata);
+	return 0;
+}
+
+
+int
+iot_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_fallocate_stub (frame, iot_fallocate_wrapper, fd,
+                                   keep_size, offset, len, xdata);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_fallocate call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+	return 0;
+}
+
+
+int
+iot_discard_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, size_t len, dict_t *xdata)
+{
+	STACK_WIND (frame, iot_discard_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->discard,
+		    fd, offset, len, xdata);
+	return 0;
+}
+
+
+int
+iot_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len, dict_t *xdata)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_discard_stub (frame, iot_discard_wrapper, fd, offset,
+                                   len, xdata);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_discard call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+	STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
+                             postbuf, xdata);
+	return 0;
+}
+
+
+int
+iot_zerofill_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      off_t offset, size_t len, dict_t *xdata)
+{
+	STACK_WIND (frame, iot_zerofill_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->zerofill,
+		    fd, offset, len, xdata);
+	return 0;
+}
+
+
+int
+iot_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              size_t len, dict_t *xdata)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_zerofill_stub (frame, iot_zerofill_wrapper, fd, offset,
+                                   len, xdata);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_zerofill call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (zerofill, frame, -1, -ret, NULL, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
 
 int
 iot_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -2706,6 +2981,11 @@ struct xlator_fops fops = {
 	.fstat       = iot_fstat,
 	.truncate    = iot_truncate,
 	.ftruncate   = iot_ftruncate,
+	.fallocate   = iot_fallocate,
+	.discard     = iot_discard,
+	.zerofill    = iot_zerofill,
+	.seek        = iot_seek,
+	.copy_file_range = iot_copy_file_range,
 	.unlink      = iot_unlink,
         .lookup      = iot_lookup,
         .setattr     = iot_setattr,
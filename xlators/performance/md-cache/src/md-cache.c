@@ -1033,6 +1033,177 @@ mdc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd,
 }
 
 
+int
+mdc_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno,
+                   struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret != 0)
+                goto out;
+
+        if (!local)
+                goto out;
+
+        mdc_inode_iatt_set_validate(this, local->fd->inode, prebuf, postbuf);
+
+out:
+        MDC_STACK_UNWIND (fallocate, frame, op_ret, op_errno, prebuf, postbuf,
+                          xdata);
+
+        return 0;
+}
+
+
+int
+mdc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len,
+               dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = mdc_local_get (frame);
+
+        local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_fallocate_cbk,
+                    FIRST_CHILD(this), FIRST_CHILD(this)->fops->fallocate,
+                    fd, keep_size, offset, len, xdata);
+        return 0;
+}
+
+
+int
+mdc_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno,
+                 struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret != 0)
+                goto out;
+
+        if (!local)
+                goto out;
+
+        mdc_inode_iatt_set_validate(this, local->fd->inode, prebuf, postbuf);
+
+out:
+        MDC_STACK_UNWIND (discard, frame, op_ret, op_errno, prebuf, postbuf,
+                          xdata);
+
+        return 0;
+}
+
+
+int
+mdc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = mdc_local_get (frame);
+
+        local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_discard_cbk,
+                    FIRST_CHILD(this), FIRST_CHILD(this)->fops->discard,
+                    fd, offset, len, xdata);
+        return 0;
+}
+
+
+int
+mdc_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno,
+                  struct iatt *prebuf, struct iatt *postbuf, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret != 0)
+                goto out;
+
+        if (!local)
+                goto out;
+
+        mdc_inode_iatt_set_validate(this, local->fd->inode, prebuf, postbuf);
+
+out:
+        MDC_STACK_UNWIND (zerofill, frame, op_ret, op_errno, prebuf, postbuf,
+                          xdata);
+
+        return 0;
+}
+
+
+int
+mdc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, size_t len, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = mdc_local_get (frame);
+
+        local->fd = fd_ref (fd);
+
+        STACK_WIND (frame, mdc_zerofill_cbk,
+                    FIRST_CHILD(this), FIRST_CHILD(this)->fops->zerofill,
+                    fd, offset, len, xdata);
+        return 0;
+}
+
+
+int
+mdc_copy_file_range_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                         struct iatt *prebuf, struct iatt *postbuf,
+                         dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret < 0)
+                goto out;
+
+        if (!local)
+                goto out;
+
+        mdc_inode_iatt_set_validate(this, local->fd->inode, prebuf, postbuf);
+
+out:
+        MDC_STACK_UNWIND (copy_file_range, frame, op_ret, op_errno, stbuf,
+                          prebuf, postbuf, xdata);
+
+        return 0;
+}
+
+
+int
+mdc_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                     off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                     uint32_t flags, dict_t *xdata)
+{
+        mdc_local_t  *local = NULL;
+
+        local = mdc_local_get (frame);
+
+        local->fd = fd_ref (fd_out);
+
+        STACK_WIND (frame, mdc_copy_file_range_cbk,
+                    FIRST_CHILD(this), FIRST_CHILD(this)->fops->copy_file_range,
+                    fd_in, off_in, fd_out, off_out, len, flags, xdata);
+        return 0;
+}
+
+
 int
 mdc_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -2128,6 +2299,10 @@ struct xlator_fops fops = {
         .fstat       = mdc_fstat,
         .truncate    = mdc_truncate,
         .ftruncate   = mdc_ftruncate,
+        .fallocate   = mdc_fallocate,
+        .discard     = mdc_discard,
+        .zerofill    = mdc_zerofill,
+        .copy_file_range = mdc_copy_file_range,
         .mknod       = mdc_mknod,
         .mkdir       = mdc_mkdir,
         .unlink      = mdc_unlink,
@@ -533,6 +533,134 @@ err:
 	return 0;
 }
 
+int
+ob_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int keep_size,
+	      off_t offset, size_t len, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_fallocate_stub (frame, default_fallocate_resume, fd,
+				   keep_size, offset, len, xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (fallocate, frame, -1, ENOMEM, 0, 0, 0);
+
+	return 0;
+}
+
+int
+ob_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+	    size_t len, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_discard_stub (frame, default_discard_resume, fd, offset,
+				 len, xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (discard, frame, -1, ENOMEM, 0, 0, 0);
+
+	return 0;
+}
+
+int
+ob_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+	     size_t len, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_zerofill_stub (frame, default_zerofill_resume, fd, offset,
+				  len, xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (zerofill, frame, -1, ENOMEM, 0, 0, 0);
+
+	return 0;
+}
+
+
+int
+ob_copy_file_range_out (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+			off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+			uint32_t flags, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_copy_file_range_stub (frame, default_copy_file_range_resume,
+					 fd_in, off_in, fd_out, off_out, len,
+					 flags, xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd_out, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (copy_file_range, frame, -1, ENOMEM, 0, 0, 0, 0);
+
+	return 0;
+}
+
+
+/* both fds have to be open on the bricks, one after the other */
+int
+ob_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+		    off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+		    uint32_t flags, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_copy_file_range_stub (frame, ob_copy_file_range_out, fd_in,
+					 off_in, fd_out, off_out, len, flags,
+					 xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd_in, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (copy_file_range, frame, -1, ENOMEM, 0, 0, 0, 0);
+
+	return 0;
+}
+
+
+int
+ob_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+	 gf_seek_what_t what, dict_t *xdata)
+{
+	call_stub_t  *stub = NULL;
+
+	stub = fop_seek_stub (frame, default_seek_resume, fd, offset, what,
+			      xdata);
+	if (!stub)
+		goto err;
+
+	open_and_resume (this, fd, stub);
+
+	return 0;
+err:
+	STACK_UNWIND_STRICT (seek, frame, -1, ENOMEM, 0, 0);
+
+	return 0;
+}
+
 
 int
 ob_fsetxattr (call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xattr,
@@ -900,6 +1028,11 @@ struct xlator_fops fops = {
 	.fsync       = ob_fsync,
 	.fstat       = ob_fstat,
 	.ftruncate   = ob_ftruncate,
+	.fallocate   = ob_fallocate,
+	.discard     = ob_discard,
+	.zerofill    = ob_zerofill,
+	.seek        = ob_seek,
+	.copy_file_range = ob_copy_file_range,
 	.fsetxattr   = ob_fsetxattr,
 	.fgetxattr   = ob_fgetxattr,
 	.fremovexattr = ob_fremovexattr,
@@ -661,6 +661,60 @@ qr_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 }
 
 
+int
+qr_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd, int keep_size,
+	      off_t offset, size_t len, dict_t *xdata)
+{
+	qr_inode_prune (this, fd->inode);
+
+	STACK_WIND (frame, default_fallocate_cbk,
+		    FIRST_CHILD (this), FIRST_CHILD (this)->fops->fallocate,
+		    fd, keep_size, offset, len, xdata);
+	return 0;
+}
+
+
+int
+qr_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+	    size_t len, dict_t *xdata)
+{
+	qr_inode_prune (this, fd->inode);
+
+	STACK_WIND (frame, default_discard_cbk,
+		    FIRST_CHILD (this), FIRST_CHILD (this)->fops->discard,
+		    fd, offset, len, xdata);
+	return 0;
+}
+
+
+int
+qr_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+	     size_t len, dict_t *xdata)
+{
+	qr_inode_prune (this, fd->inode);
+
+	STACK_WIND (frame, default_zerofill_cbk,
+		    FIRST_CHILD (this), FIRST_CHILD (this)->fops->zerofill,
+		    fd, offset, len, xdata);
+	return 0;
+}
+
+
+int
+qr_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+		    off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+		    uint32_t flags, dict_t *xdata)
+{
+	qr_inode_prune (this, fd_out->inode);
+
+	STACK_WIND (frame, default_copy_file_range_cbk,
+		    FIRST_CHILD (this),
+		    FIRST_CHILD (this)->fops->copy_file_range,
+		    fd_in, off_in, fd_out, off_out, len, flags, xdata);
+	return 0;
+}
+
+
 int
 qr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
 	 fd_t *fd, dict_t *xdata)
@@ -1108,7 +1162,11 @@ struct xlator_fops fops = {
         .readv       = qr_readv,
 	.writev      = qr_writev,
 	.truncate    = qr_truncate,
-	.ftruncate   = qr_ftruncate
+	.ftruncate   = qr_ftruncate,
+	.fallocate   = qr_fallocate,
+	.discard     = qr_discard,
+	.zerofill    = qr_zerofill,
+	.copy_file_range = qr_copy_file_range,
 };
 
 struct xlator_cbks cbks = {
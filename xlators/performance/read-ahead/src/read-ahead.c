@@ -24,6 +24,7 @@
 #include "logging.h"
 #include "dict.h"
 #include "xlator.h"
+#include "defaults.h"
 #include "read-ahead.h"
 #include "statedump.h"
 #include <assert.h>
@@ -943,6 +944,123 @@ unwind:
 }
 
 
+/* drop the pages of every fd open on the inode, like truncation does */
+static void
+ra_inode_flush_all (call_frame_t *frame, xlator_t *this, inode_t *inode)
+{
+        ra_file_t *file    = NULL;
+        fd_t      *iter_fd = NULL;
+        uint64_t  tmp_file = 0;
+
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (iter_fd, &inode->fd_list, inode_list) {
+                        tmp_file = 0;
+                        fd_ctx_get (iter_fd, this, &tmp_file);
+                        file = (ra_file_t *)(long)tmp_file;
+                        if (!file)
+                                continue;
+
+                        flush_region (frame, file, 0,
+                                      file->pages.prev->offset + 1, 1);
+                }
+        }
+        UNLOCK (&inode->lock);
+}
+
+
+int
+ra_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t   op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush_all (frame, this, fd->inode);
+
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fallocate, fd, keep_size,
+                    offset, len, xdata);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+ra_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len, dict_t *xdata)
+{
+        int32_t   op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush_all (frame, this, fd->inode);
+
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->discard, fd, offset, len, xdata);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+ra_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             size_t len, dict_t *xdata)
+{
+        int32_t   op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        ra_inode_flush_all (frame, this, fd->inode);
+
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->zerofill, fd, offset, len, xdata);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+ra_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                    off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                    uint32_t flags, dict_t *xdata)
+{
+        int32_t   op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd_out, unwind);
+
+        ra_inode_flush_all (frame, this, fd_out->inode);
+
+        STACK_WIND (frame, default_copy_file_range_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->copy_file_range, fd_in, off_in,
+                    fd_out, off_out, len, flags, xdata);
+        return 0;
+
+unwind:
+        STACK_UNWIND_STRICT (copy_file_range, frame, -1, op_errno, NULL, NULL,
+                             NULL, NULL);
+        return 0;
+}
+
+
 int
 ra_priv_dump (xlator_t *this)
 {
@@ -1118,6 +1236,10 @@ struct xlator_fops fops = {
         .fsync       = ra_fsync,
         .truncate    = ra_truncate,
         .ftruncate   = ra_ftruncate,
+        .fallocate   = ra_fallocate,
+        .discard     = ra_discard,
+        .zerofill    = ra_zerofill,
+        .copy_file_range = ra_copy_file_range,
         .fstat       = ra_fstat,
 };
 
@@ -15,6 +15,7 @@
 
 #include "client.h"
 #include "rpc-clnt.h"
+#include "defaults.h"
 
 int
 client_cbk_null (struct rpc_clnt *rpc, void *mydata, void *data)
@@ -40,10 +41,98 @@ client_cbk_ino_flush (struct rpc_clnt *rpc, void *mydata, void *data)
         return 0;
 }
 
+/* the brick wants a lock of ours back; let the xlator above that took
+ * it (afr's eager lock) decide whether to release it.
+ */
+int
+client_cbk_inodelk_recall (struct rpc_clnt *rpc, void *mydata, void *data)
+{
+        xlator_t                *this   = NULL;
+        struct iovec            *iov    = NULL;
+        gfs3_inodelk_recall_req  req    = {{0,},};
+        gf_upcall_recall_t       recall = {0,};
+        int                      ret    = -1;
+
+        this = mydata;
+        iov  = data;
+
+        ret = xdr_to_generic (*iov, &req,
+                              (xdrproc_t)xdr_gfs3_inodelk_recall_req);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "failed to decode inodelk recall");
+                goto out;
+        }
+
+        if (req.lk_owner.lk_owner_len > GF_MAX_LOCK_OWNER_LEN) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "inodelk recall with invalid lk-owner length %u",
+                        req.lk_owner.lk_owner_len);
+                goto out;
+        }
+
+        memcpy (recall.gfid, req.gfid, 16);
+        recall.domain    = req.domain;
+        recall.owner.len = req.lk_owner.lk_owner_len;
+        memcpy (recall.owner.data, req.lk_owner.lk_owner_val,
+                recall.owner.len);
+
+        gf_log (this->name, GF_LOG_DEBUG, "inodelk recall for %s in "
+                "domain %s", uuid_utoa (recall.gfid), recall.domain);
+
+        default_notify (this, GF_EVENT_UPCALL, &recall);
+
+        ret = 0;
+out:
+        free (req.domain);
+        free (req.lk_owner.lk_owner_val);
+
+        return ret;
+}
+
+/* the brick's usage moved past its push threshold; hand it to the
+ * xlators above (dht keeps it for placement and statfs).
+ */
+int
+client_cbk_statfs_push (struct rpc_clnt *rpc, void *mydata, void *data)
+{
+        xlator_t         *this = NULL;
+        struct iovec     *iov  = NULL;
+        struct gf_statfs  req  = {0,};
+        gf_statfs_push_t  push = {0,};
+        int               ret  = -1;
+
+        this = mydata;
+        iov  = data;
+
+        ret = xdr_to_generic (*iov, &req, (xdrproc_t)xdr_gf_statfs);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "failed to decode statfs push");
+                goto out;
+        }
+
+        gf_statfs_to_statfs (&req, &push.buf);
+
+        gf_log (this->name, GF_LOG_DEBUG, "statfs push: %"PRIu64" of "
+                "%"PRIu64" blocks available", (uint64_t)push.buf.f_bavail,
+                (uint64_t)push.buf.f_blocks);
+
+        default_notify (this, GF_EVENT_STATFS_PUSH, &push);
+
+        ret = 0;
+out:
+        return ret;
+}
+
 rpcclnt_cb_actor_t gluster_cbk_actors[] = {
         [GF_CBK_NULL]      = {"NULL",      GF_CBK_NULL,      client_cbk_null },
         [GF_CBK_FETCHSPEC] = {"FETCHSPEC", GF_CBK_FETCHSPEC, client_cbk_fetchspec },
         [GF_CBK_INO_FLUSH] = {"INO_FLUSH", GF_CBK_INO_FLUSH, client_cbk_ino_flush },
+        [GF_CBK_INODELK_RECALL] = {"INODELK_RECALL", GF_CBK_INODELK_RECALL,
+                                   client_cbk_inodelk_recall },
+        [GF_CBK_STATFS_PUSH] = {"STATFS_PUSH", GF_CBK_STATFS_PUSH,
+                                client_cbk_statfs_push },
 };
 
 
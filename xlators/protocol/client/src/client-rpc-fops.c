@@ -2732,6 +2732,280 @@ client3_3_releasedir_cbk (struct rpc_req *req, struct iovec *iov, int count,
         return 0;
 }
 
+int
+client3_3_fallocate_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                         void *myframe)
+{
+        gfs3_fallocate_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+        dict_t         *xdata    = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_fallocate_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      rsp.op_errno, out);
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        CLIENT_STACK_UNWIND (fallocate, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat, xdata);
+
+        free (rsp.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
+int
+client3_3_discard_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                       void *myframe)
+{
+        gfs3_discard_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+        dict_t         *xdata    = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_discard_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      rsp.op_errno, out);
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        CLIENT_STACK_UNWIND (discard, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat, xdata);
+
+        free (rsp.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
+int
+client3_3_zerofill_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        gfs3_zerofill_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+        dict_t         *xdata    = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_zerofill_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      rsp.op_errno, out);
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        CLIENT_STACK_UNWIND (zerofill, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat, xdata);
+
+        free (rsp.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
+int
+client3_3_seek_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                    void *myframe)
+{
+        gfs3_seek_rsp   rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+        dict_t         *xdata    = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_seek_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      rsp.op_errno, out);
+
+out:
+        /* ENXIO is the regular answer when there is no data or hole
+           after the offset, no need to warn about it */
+        if ((rsp.op_ret == -1) &&
+            (gf_error_to_errno (rsp.op_errno) != ENXIO)) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        CLIENT_STACK_UNWIND (seek, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), rsp.offset,
+                             xdata);
+
+        free (rsp.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
+int
+client3_3_copy_file_range_cbk (struct rpc_req *req, struct iovec *iov,
+                               int count, void *myframe)
+{
+        gfs3_copy_file_range_rsp rsp = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     stbuf    = {0,};
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+        dict_t         *xdata    = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp,
+                              (xdrproc_t)xdr_gfs3_copy_file_range_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.stat, &stbuf);
+                gf_stat_to_iatt (&rsp.prestat, &prestat);
+                gf_stat_to_iatt (&rsp.poststat, &poststat);
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      rsp.op_errno, out);
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        CLIENT_STACK_UNWIND (copy_file_range, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &stbuf,
+                             &prestat, &poststat, xdata);
+
+        free (rsp.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
 int
 client_fdctx_destroy (xlator_t *this, clnt_fd_ctx_t *fdctx)
 {
@@ -3925,7 +4199,9 @@ client3_3_readv (call_frame_t *frame, xlator_t *this,
 
         memcpy (req.gfid, args->fd->inode->gfid, 16);
 
-        rsp_iobuf = iobuf_get2 (this->ctx->iobuf_pool, args->size);
+        /* let the reply land page aligned for O_DIRECT consumers */
+        rsp_iobuf = iobuf_get_page_aligned (this->ctx->iobuf_pool, args->size,
+                                            GF_IOBUF_PAGE_ALIGN_SIZE);
         if (rsp_iobuf == NULL) {
                 op_errno = ENOMEM;
                 goto unwind;
@@ -4748,39 +5024,338 @@ unwind:
 
 
 
-int32_t
-client3_3_xattrop (call_frame_t *frame, xlator_t *this,
-                   void *data)
+/* Changelog xattrops carrying GF_XATTROP_BATCH_KEY are merged per brick:
+ * while one XATTROP_BATCH request is in flight, further ones are queued and
+ * sent together as the next request when its reply arrives. An idle
+ * connection sends the first xattrop right away, so batching only kicks in
+ * when xattrops to this brick actually overlap.
+ */
+static gf_boolean_t
+client_xattrop_batchable (dict_t *xdata)
 {
-        clnt_conf_t      *conf       = NULL;
-        clnt_args_t      *args       = NULL;
-        gfs3_xattrop_req  req        = {{0,},};
-        int               ret        = 0;
-        int               op_errno   = ESTALE;
-        int               count      = 0;
-        clnt_local_t   *local      = NULL;
-        struct iobref    *rsp_iobref = NULL;
-        struct iobuf     *rsp_iobuf  = NULL;
-        struct iovec     *rsphdr     = NULL;
-        struct iovec      vector[MAX_IOVEC] = {{0}, };
+        if (!xdata)
+                return _gf_false;
 
-        if (!frame || !this || !data)
-                goto unwind;
+        return (dict_get (xdata, GF_XATTROP_BATCH_KEY) != NULL);
+}
 
-        args = data;
+static int
+client3_3_xattrop_batch_send (xlator_t *this, struct list_head *entries,
+                              int count);
 
-        if (!(args->loc && args->loc->inode))
-                goto unwind;
+static void
+client3_3_xattrop_batch_unwind (xlator_t *this, clnt_xattrop_batch_t *entry,
+                                gfs3_xattrop_rsp *rsp, int op_errno)
+{
+        call_frame_t *frame  = NULL;
+        clnt_local_t *local  = NULL;
+        dict_t       *dict   = NULL;
+        dict_t       *xdata  = NULL;
+        int           op_ret = -1;
+        int           ret    = 0;
 
-        local = mem_get0 (this->local_pool);
-        if (!local) {
-                op_errno = ENOMEM;
-                goto unwind;
+        frame = entry->frame;
+        local = frame->local;
+
+        if (!rsp)
+                goto out;
+
+        op_ret   = rsp->op_ret;
+        op_errno = gf_error_to_errno (rsp->op_errno);
+        if (-1 != op_ret) {
+                GF_PROTOCOL_DICT_UNSERIALIZE (this, dict,
+                                              (rsp->dict.dict_val),
+                                              (rsp->dict.dict_len), op_ret,
+                                              op_errno, out);
         }
-        frame->local = local;
 
-        rsp_iobref = iobref_new ();
-        if (rsp_iobref == NULL) {
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp->xdata.xdata_val),
+                                      (rsp->xdata.xdata_len), ret,
+                                      op_errno, out);
+out:
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "remote operation failed: %s (%s)",
+                        strerror (op_errno),
+                        uuid_utoa ((unsigned char *)entry->req.gfid));
+        }
+
+        if (entry->fop == GF_FOP_FXATTROP) {
+                if (op_ret == 0 && local && local->attempt_reopen)
+                        client_attempt_reopen (local->fd, this);
+                CLIENT_STACK_UNWIND (fxattrop, frame, op_ret, op_errno,
+                                     dict, xdata);
+        } else {
+                CLIENT_STACK_UNWIND (xattrop, frame, op_ret, op_errno,
+                                     dict, xdata);
+        }
+
+        GF_FREE (entry->req.dict.dict_val);
+        GF_FREE (entry->req.xdata.xdata_val);
+        GF_FREE (entry);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        if (dict)
+                dict_unref (dict);
+}
+
+/* moves the next batch off the queue, with conf->lock held */
+static int
+__client_xattrop_batch_take (clnt_conf_t *conf, struct list_head *batch)
+{
+        clnt_xattrop_batch_t *entry = NULL;
+        clnt_xattrop_batch_t *tmp   = NULL;
+        int                   count = 0;
+
+        list_for_each_entry_safe (entry, tmp, &conf->xattrop_queue, list) {
+                if (count == CLIENT_XATTROP_BATCH_MAX)
+                        break;
+                list_move_tail (&entry->list, batch);
+                count++;
+        }
+
+        return count;
+}
+
+static void
+client3_3_xattrop_batch_next (xlator_t *this)
+{
+        clnt_conf_t      *conf  = NULL;
+        struct list_head  batch;
+        int               count = 0;
+
+        conf = this->private;
+        INIT_LIST_HEAD (&batch);
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                count = __client_xattrop_batch_take (conf, &batch);
+                if (!count)
+                        conf->xattrop_inflight = _gf_false;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (count)
+                client3_3_xattrop_batch_send (this, &batch, count);
+}
+
+int
+client3_3_xattrop_batch_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                             void *myframe)
+{
+        call_frame_t           *frame    = NULL;
+        struct list_head       *batch    = NULL;
+        clnt_xattrop_batch_t   *entry    = NULL;
+        clnt_xattrop_batch_t   *tmp      = NULL;
+        gfs3_xattrop_batch_rsp  rsp      = {0,};
+        int                     ret      = 0;
+        int                     op_errno = 0;
+        u_int                   i        = 0;
+        xlator_t               *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+        batch = frame->local;
+        frame->local = NULL;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret = -1;
+                op_errno = ENOTCONN;
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp,
+                              (xdrproc_t)xdr_gfs3_xattrop_batch_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        op_errno = gf_error_to_errno (rsp.op_errno);
+        if (rsp.op_ret == -1)
+                goto out;
+
+        list_for_each_entry (entry, batch, list)
+                i++;
+        if (rsp.entries.entries_len != i) {
+                gf_log (this->name, GF_LOG_ERROR, "XATTROP_BATCH reply has "
+                        "%u entries, sent %u", rsp.entries.entries_len, i);
+                rsp.op_ret = -1;
+                op_errno = EINVAL;
+        }
+out:
+        i = 0;
+        list_for_each_entry_safe (entry, tmp, batch, list) {
+                list_del_init (&entry->list);
+                if (rsp.op_ret == -1)
+                        client3_3_xattrop_batch_unwind (this, entry, NULL,
+                                                        op_errno);
+                else
+                        client3_3_xattrop_batch_unwind (this, entry,
+                                                  &rsp.entries.entries_val[i],
+                                                        0);
+                i++;
+        }
+
+        for (i = 0; i < rsp.entries.entries_len; i++) {
+                free (rsp.entries.entries_val[i].dict.dict_val);
+                free (rsp.entries.entries_val[i].xdata.xdata_val);
+        }
+        free (rsp.entries.entries_val);
+        free (rsp.xdata.xdata_val);
+
+        GF_FREE (batch);
+        STACK_DESTROY (frame->root);
+
+        client3_3_xattrop_batch_next (this);
+
+        return 0;
+}
+
+static int
+client3_3_xattrop_batch_send (xlator_t *this, struct list_head *entries,
+                              int count)
+{
+        clnt_conf_t            *conf  = NULL;
+        call_frame_t           *frame = NULL;
+        struct list_head       *batch = NULL;
+        clnt_xattrop_batch_t   *entry = NULL;
+        clnt_xattrop_batch_t   *tmp   = NULL;
+        gfs3_xattrop_batch_req  req   = {{0,},};
+        int                     i     = 0;
+
+        conf = this->private;
+
+        batch = GF_CALLOC (1, sizeof (*batch), gf_client_mt_xattrop_batch_t);
+        req.entries.entries_val = GF_CALLOC (count,
+                                             sizeof (gfs3_xattrop_batch_entry),
+                                             gf_client_mt_xattrop_batch_t);
+        entry = list_entry (entries->next, clnt_xattrop_batch_t, list);
+        /* the batch runs with the credentials of its first xattrop; the
+           brick does not permission check xattrops */
+        frame = copy_frame (entry->frame);
+        if (!batch || !req.entries.entries_val || !frame) {
+                list_for_each_entry_safe (entry, tmp, entries, list) {
+                        list_del_init (&entry->list);
+                        client3_3_xattrop_batch_unwind (this, entry, NULL,
+                                                        ENOMEM);
+                }
+                GF_FREE (batch);
+                GF_FREE (req.entries.entries_val);
+                if (frame)
+                        STACK_DESTROY (frame->root);
+
+                client3_3_xattrop_batch_next (this);
+                return -1;
+        }
+
+        INIT_LIST_HEAD (batch);
+        list_splice_init (entries, batch);
+        list_for_each_entry (entry, batch, list)
+                req.entries.entries_val[i++] = entry->req;
+        req.entries.entries_len = count;
+
+        frame->local = batch;
+
+        client_submit_request (this, &req, frame, conf->fops,
+                               GFS3_OP_XATTROP_BATCH,
+                               client3_3_xattrop_batch_cbk, NULL,
+                               NULL, 0, NULL, 0, NULL,
+                               (xdrproc_t)xdr_gfs3_xattrop_batch_req);
+
+        /* the entries only borrowed the buffers of the queued requests */
+        GF_FREE (req.entries.entries_val);
+
+        return 0;
+}
+
+/* Queues an already serialized xattrop. On success the entry owns
+   @dict_val and @xdata_val, and the frame is unwound once the batch
+   carrying it is answered. */
+static int
+client3_3_xattrop_batch_queue (xlator_t *this, call_frame_t *frame,
+                               glusterfs_fop_t fop, char *gfid, int64_t fd,
+                               uint32_t flags, char *dict_val, u_int dict_len,
+                               char *xdata_val, u_int xdata_len)
+{
+        clnt_conf_t          *conf  = NULL;
+        clnt_xattrop_batch_t *entry = NULL;
+        struct list_head      batch;
+        int                   count = 0;
+
+        conf = this->private;
+        INIT_LIST_HEAD (&batch);
+
+        entry = GF_CALLOC (1, sizeof (*entry), gf_client_mt_xattrop_batch_t);
+        if (!entry)
+                return -1;
+
+        INIT_LIST_HEAD (&entry->list);
+        entry->frame = frame;
+        entry->fop   = fop;
+        memcpy (entry->req.gfid, gfid, 16);
+        entry->req.fd    = fd;
+        entry->req.flags = flags;
+        entry->req.dict.dict_val   = dict_val;
+        entry->req.dict.dict_len   = dict_len;
+        entry->req.xdata.xdata_val = xdata_val;
+        entry->req.xdata.xdata_len = xdata_len;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                list_add_tail (&entry->list, &conf->xattrop_queue);
+                if (!conf->xattrop_inflight) {
+                        conf->xattrop_inflight = _gf_true;
+                        count = __client_xattrop_batch_take (conf, &batch);
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (count)
+                client3_3_xattrop_batch_send (this, &batch, count);
+
+        return 0;
+}
+
+
+int32_t
+client3_3_xattrop (call_frame_t *frame, xlator_t *this,
+                   void *data)
+{
+        clnt_conf_t      *conf       = NULL;
+        clnt_args_t      *args       = NULL;
+        gfs3_xattrop_req  req        = {{0,},};
+        int               ret        = 0;
+        int               op_errno   = ESTALE;
+        int               count      = 0;
+        clnt_local_t   *local      = NULL;
+        struct iobref    *rsp_iobref = NULL;
+        struct iobuf     *rsp_iobuf  = NULL;
+        struct iovec     *rsphdr     = NULL;
+        struct iovec      vector[MAX_IOVEC] = {{0}, };
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        if (!(args->loc && args->loc->inode))
+                goto unwind;
+
+        local = mem_get0 (this->local_pool);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        frame->local = local;
+
+        rsp_iobref = iobref_new ();
+        if (rsp_iobref == NULL) {
                 op_errno = ENOMEM;
                 goto unwind;
         }
@@ -4825,14 +5400,26 @@ client3_3_xattrop (call_frame_t *frame, xlator_t *this,
         GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
                                     req.xdata.xdata_len, op_errno, unwind);
 
-        ret = client_submit_request (this, &req, frame, conf->fops,
-                                     GFS3_OP_XATTROP,
-                                     client3_3_xattrop_cbk, NULL,
-                                     rsphdr, count,
-                                     NULL, 0, local->iobref,
-                                     (xdrproc_t)xdr_gfs3_xattrop_req);
-        if (ret) {
-                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        if (client_xattrop_batchable (args->xdata) &&
+            !client3_3_xattrop_batch_queue (this, frame, GF_FOP_XATTROP,
+                                            req.gfid, -1, req.flags,
+                                            req.dict.dict_val,
+                                            req.dict.dict_len,
+                                            req.xdata.xdata_val,
+                                            req.xdata.xdata_len)) {
+                req.dict.dict_val   = NULL;
+                req.xdata.xdata_val = NULL;
+        } else {
+                ret = client_submit_request (this, &req, frame, conf->fops,
+                                             GFS3_OP_XATTROP,
+                                             client3_3_xattrop_cbk, NULL,
+                                             rsphdr, count,
+                                             NULL, 0, local->iobref,
+                                             (xdrproc_t)xdr_gfs3_xattrop_req);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to send the fop");
+                }
         }
 
         GF_FREE (req.dict.dict_val);
@@ -4934,14 +5521,26 @@ client3_3_fxattrop (call_frame_t *frame, xlator_t *this,
         GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
                                     req.xdata.xdata_len, op_errno, unwind);
 
-        ret = client_submit_request (this, &req, frame, conf->fops,
-                                     GFS3_OP_FXATTROP,
-                                     client3_3_fxattrop_cbk, NULL,
-                                     rsphdr, count,
-                                     NULL, 0, local->iobref,
-                                     (xdrproc_t)xdr_gfs3_fxattrop_req);
-        if (ret) {
-                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        if (client_xattrop_batchable (args->xdata) &&
+            !client3_3_xattrop_batch_queue (this, frame, GF_FOP_FXATTROP,
+                                            req.gfid, req.fd, req.flags,
+                                            req.dict.dict_val,
+                                            req.dict.dict_len,
+                                            req.xdata.xdata_val,
+                                            req.xdata.xdata_len)) {
+                req.dict.dict_val   = NULL;
+                req.xdata.xdata_val = NULL;
+        } else {
+                ret = client_submit_request (this, &req, frame, conf->fops,
+                                             GFS3_OP_FXATTROP,
+                                             client3_3_fxattrop_cbk, NULL,
+                                             rsphdr, count,
+                                             NULL, 0, local->iobref,
+                                             (xdrproc_t)xdr_gfs3_fxattrop_req);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to send the fop");
+                }
         }
 
         GF_FREE (req.dict.dict_val);
@@ -5795,6 +6394,250 @@ unwind:
 }
 
 
+int32_t
+client3_3_fallocate (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args      = NULL;
+        int64_t             remote_fd = -1;
+        clnt_conf_t        *conf      = NULL;
+        gfs3_fallocate_req  req       = {{0,},};
+        int                 op_errno  = EINVAL;
+        int                 ret       = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_REMOTE_FD (this, args->fd, DEFAULT_REMOTE_FD,
+                              remote_fd, op_errno, unwind);
+
+        req.fd     = remote_fd;
+        req.flags  = args->flags;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FALLOCATE,
+                                     client3_3_fallocate_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_fallocate_req);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        }
+
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+unwind:
+        CLIENT_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL, NULL);
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+}
+
+int32_t
+client3_3_discard (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args      = NULL;
+        int64_t             remote_fd = -1;
+        clnt_conf_t        *conf      = NULL;
+        gfs3_discard_req    req       = {{0,},};
+        int                 op_errno  = EINVAL;
+        int                 ret       = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_REMOTE_FD (this, args->fd, DEFAULT_REMOTE_FD,
+                              remote_fd, op_errno, unwind);
+
+        req.fd     = remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_DISCARD,
+                                     client3_3_discard_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_discard_req);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        }
+
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+unwind:
+        CLIENT_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL, NULL);
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+}
+
+int32_t
+client3_3_zerofill (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args      = NULL;
+        int64_t             remote_fd = -1;
+        clnt_conf_t        *conf      = NULL;
+        gfs3_zerofill_req   req       = {{0,},};
+        int                 op_errno  = EINVAL;
+        int                 ret       = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_REMOTE_FD (this, args->fd, DEFAULT_REMOTE_FD,
+                              remote_fd, op_errno, unwind);
+
+        req.fd     = remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_ZEROFILL,
+                                     client3_3_zerofill_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_zerofill_req);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        }
+
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+unwind:
+        CLIENT_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL, NULL);
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+}
+
+int32_t
+client3_3_seek (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args      = NULL;
+        int64_t             remote_fd = -1;
+        clnt_conf_t        *conf      = NULL;
+        gfs3_seek_req       req       = {{0,},};
+        int                 op_errno  = EINVAL;
+        int                 ret       = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_REMOTE_FD (this, args->fd, DEFAULT_REMOTE_FD,
+                              remote_fd, op_errno, unwind);
+
+        req.fd     = remote_fd;
+        req.offset = args->offset;
+        req.what   = args->what;
+        memcpy (req.gfid, args->fd->inode->gfid, 16);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_SEEK,
+                                     client3_3_seek_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_seek_req);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        }
+
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+unwind:
+        CLIENT_STACK_UNWIND (seek, frame, -1, op_errno, 0, NULL);
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+}
+
+int32_t
+client3_3_copy_file_range (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t              *args       = NULL;
+        int64_t                   remote_fd1 = -1;
+        int64_t                   remote_fd2 = -1;
+        clnt_conf_t              *conf       = NULL;
+        gfs3_copy_file_range_req  req        = {{0,},};
+        int                       op_errno   = EINVAL;
+        int                       ret        = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        CLIENT_GET_REMOTE_FD (this, args->fd, DEFAULT_REMOTE_FD,
+                              remote_fd1, op_errno, unwind);
+        CLIENT_GET_REMOTE_FD (this, args->fd_out, DEFAULT_REMOTE_FD,
+                              remote_fd2, op_errno, unwind);
+
+        req.fd_in   = remote_fd1;
+        req.fd_out  = remote_fd2;
+        req.off_in  = args->offset;
+        req.off_out = args->off_out;
+        req.size    = min (args->size, (size_t)GF_COPY_FILE_RANGE_MAX);
+        req.flags   = args->flags;
+        memcpy (req.gfid1, args->fd->inode->gfid, 16);
+        memcpy (req.gfid2, args->fd_out->inode->gfid, 16);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_COPY_FILE_RANGE,
+                                     client3_3_copy_file_range_cbk, NULL,
+                                     NULL, 0, NULL, 0, NULL,
+                                     (xdrproc_t)xdr_gfs3_copy_file_range_req);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+        }
+
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+unwind:
+        CLIENT_STACK_UNWIND (copy_file_range, frame, -1, op_errno, NULL,
+                             NULL, NULL, NULL);
+        GF_FREE (req.xdata.xdata_val);
+
+        return 0;
+}
+
 
 /* Table Specific to FOPS */
 
@@ -5845,6 +6688,11 @@ rpc_clnt_procedure_t clnt3_3_fop_actors[GF_FOP_MAXVALUE] = {
         [GF_FOP_RELEASEDIR]  = { "RELEASEDIR",  client3_3_releasedir },
         [GF_FOP_GETSPEC]     = { "GETSPEC",     client3_getspec },
         [GF_FOP_FREMOVEXATTR] = { "FREMOVEXATTR", client3_3_fremovexattr },
+        [GF_FOP_FALLOCATE]   = { "FALLOCATE",   client3_3_fallocate },
+        [GF_FOP_DISCARD]     = { "DISCARD",     client3_3_discard },
+        [GF_FOP_ZEROFILL]    = { "ZEROFILL",    client3_3_zerofill },
+        [GF_FOP_SEEK]        = { "SEEK",        client3_3_seek },
+        [GF_FOP_COPY_FILE_RANGE] = { "COPY_FILE_RANGE", client3_3_copy_file_range },
 };
 
 /* Used From RPC-CLNT library to log proper name of procedure based on number */
@@ -5893,6 +6741,12 @@ char *clnt3_3_fop_names[GFS3_OP_MAXVALUE] = {
         [GFS3_OP_RELEASE]     = "RELEASE",
         [GFS3_OP_RELEASEDIR]  = "RELEASEDIR",
         [GFS3_OP_FREMOVEXATTR] = "FREMOVEXATTR",
+        [GFS3_OP_FALLOCATE]   = "FALLOCATE",
+        [GFS3_OP_DISCARD]     = "DISCARD",
+        [GFS3_OP_ZEROFILL]    = "ZEROFILL",
+        [GFS3_OP_SEEK]        = "SEEK",
+        [GFS3_OP_COPY_FILE_RANGE] = "COPY_FILE_RANGE",
+        [GFS3_OP_XATTROP_BATCH] = "XATTROP_BATCH",
 };
 
 rpc_clnt_prog_t clnt3_3_fop_prog = {
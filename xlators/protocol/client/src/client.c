@@ -1961,6 +1961,188 @@ out:
 	return 0;
 }
 
+int32_t
+client_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len,
+                  dict_t *xdata)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.flags  = keep_size;
+        args.offset = offset;
+        args.size   = len;
+        args.xdata  = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_FALLOCATE];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_FALLOCATE]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, ENOTCONN, NULL, NULL,
+                                     NULL);
+
+	return 0;
+}
+
+int32_t
+client_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len, dict_t *xdata)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+        args.xdata  = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_DISCARD];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_DISCARD]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (discard, frame, -1, ENOTCONN, NULL, NULL,
+                                     NULL);
+
+	return 0;
+}
+
+int32_t
+client_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len, dict_t *xdata)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+        args.xdata  = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_ZEROFILL];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_ZEROFILL]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (zerofill, frame, -1, ENOTCONN, NULL, NULL,
+                                     NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_seek (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, gf_seek_what_t what, dict_t *xdata)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.what   = what;
+        args.xdata  = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_SEEK];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_SEEK]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (seek, frame, -1, ENOTCONN, 0, NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                        off_t off_in, fd_t *fd_out, off_t off_out,
+                        size_t len, uint32_t flags, dict_t *xdata)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd      = fd_in;
+        args.offset  = off_in;
+        args.fd_out  = fd_out;
+        args.off_out = off_out;
+        args.size    = len;
+        args.flags   = flags;
+        args.xdata   = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_COPY_FILE_RANGE];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_COPY_FILE_RANGE]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (copy_file_range, frame, -1, ENOTCONN,
+                                     NULL, NULL, NULL, NULL);
+
+	return 0;
+}
+
 
 int32_t
 client_getspec (call_frame_t *frame, xlator_t *this, const char *key,
@@ -2431,6 +2613,7 @@ init (xlator_t *this)
 
         pthread_mutex_init (&conf->lock, NULL);
         INIT_LIST_HEAD (&conf->saved_fds);
+        INIT_LIST_HEAD (&conf->xattrop_queue);
 
         /* Initialize parameters for lock self healing*/
         conf->lk_version         = 1;
@@ -2666,6 +2849,11 @@ struct xlator_fops fops = {
         .setattr     = client_setattr,
         .fsetattr    = client_fsetattr,
         .getspec     = client_getspec,
+        .fallocate   = client_fallocate,
+        .discard     = client_discard,
+        .zerofill    = client_zerofill,
+        .seek        = client_seek,
+        .copy_file_range = client_copy_file_range,
 };
 
 
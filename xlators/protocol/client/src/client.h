@@ -116,6 +116,10 @@ typedef struct clnt_conf {
 						*/
         gf_boolean_t           filter_o_direct; /* if set, filter O_DIRECT from
                                                    the flags list of open() */
+        struct list_head       xattrop_queue; /* batchable xattrops waiting
+                                                 for the XATTROP_BATCH in
+                                                 flight, under 'lock' */
+        gf_boolean_t           xattrop_inflight;
 } clnt_conf_t;
 
 typedef struct _client_fd_ctx {
@@ -164,9 +168,20 @@ typedef struct client_local {
         gf_boolean_t         attempt_reopen;
 } clnt_local_t;
 
+/* largest number of xattrops merged into one XATTROP_BATCH request */
+#define CLIENT_XATTROP_BATCH_MAX 64
+
+typedef struct client_xattrop_batch {
+        struct list_head          list;
+        call_frame_t             *frame;
+        glusterfs_fop_t           fop;
+        gfs3_xattrop_batch_entry  req;
+} clnt_xattrop_batch_t;
+
 typedef struct client_args {
         loc_t              *loc;
         fd_t               *fd;
+        fd_t               *fd_out;
         const char         *linkname;
         struct iobref      *iobref;
         struct iovec       *vector;
@@ -179,6 +194,7 @@ typedef struct client_args {
         const char         *volume;
         const char         *basename;
         off_t               offset;
+        off_t               off_out;
         int32_t             mask;
         int32_t             cmd;
         size_t              size;
@@ -192,6 +208,7 @@ typedef struct client_args {
         gf_xattrop_flags_t  optype;
         int32_t             valid;
         int32_t             len;
+        gf_seek_what_t      what;
 
         mode_t              umask;
         dict_t             *xdata;
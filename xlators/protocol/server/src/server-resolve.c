@@ -408,7 +408,10 @@ resolve_anonfd_simple (call_frame_t *frame)
 
         ret = 0;
 
-        state->fd = fd_anonymous (inode);
+        if (resolve == &state->resolve2)
+                state->fd_out = fd_anonymous (inode);
+        else
+                state->fd = fd_anonymous (inode);
 out:
         if (inode)
                 inode_unref (inode);
@@ -453,6 +456,7 @@ server_resolve_fd (call_frame_t *frame)
         server_resolve_t     *resolve = NULL;
         server_connection_t  *conn = NULL;
         uint64_t              fd_no = -1;
+        fd_t                 *fd = NULL;
 
         state = CALL_STATE (frame);
         resolve = state->resolve_now;
@@ -465,9 +469,15 @@ server_resolve_fd (call_frame_t *frame)
                 return 0;
         }
 
-        state->fd = gf_fd_fdptr_get (conn->fdtable, fd_no);
+        fd = gf_fd_fdptr_get (conn->fdtable, fd_no);
 
-        if (!state->fd) {
+        /* the second fd of a two fd fop (copy_file_range) */
+        if (resolve == &state->resolve2)
+                state->fd_out = fd;
+        else
+                state->fd = fd;
+
+        if (!fd) {
                 gf_log ("", GF_LOG_INFO, "fd not found in context");
                 resolve->op_ret   = -1;
                 resolve->op_errno = EBADF;
@@ -1834,6 +1834,282 @@ out:
 }
 
 
+int
+server_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno,
+                      struct iatt *statpre, struct iatt *statpost, dict_t *xdata)
+{
+        gfs3_fallocate_rsp rsp   = {0,};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req = frame->local;
+        state  = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (op_ret) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": FALLOCATE %"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        gf_stat_from_iatt (&rsp.statpre, statpre);
+        gf_stat_from_iatt (&rsp.statpost, statpost);
+
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_fallocate_rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+
+int
+server_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno,
+                    struct iatt *statpre, struct iatt *statpost, dict_t *xdata)
+{
+        gfs3_discard_rsp rsp   = {0,};
+        server_state_t   *state = NULL;
+        rpcsvc_request_t *req   = NULL;
+
+        req = frame->local;
+        state  = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (op_ret) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": DISCARD %"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        gf_stat_from_iatt (&rsp.statpre, statpre);
+        gf_stat_from_iatt (&rsp.statpost, statpost);
+
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_discard_rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+
+int
+server_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno,
+                     struct iatt *statpre, struct iatt *statpost, dict_t *xdata)
+{
+        gfs3_zerofill_rsp rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+
+        req = frame->local;
+        state  = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (op_ret) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": ZEROFILL %"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        gf_stat_from_iatt (&rsp.statpre, statpre);
+        gf_stat_from_iatt (&rsp.statpost, statpost);
+
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_zerofill_rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+int
+server_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, off_t offset,
+                 dict_t *xdata)
+{
+        gfs3_seek_rsp     rsp   = {0,};
+        server_state_t   *state = NULL;
+        rpcsvc_request_t *req   = NULL;
+
+        req = frame->local;
+        state  = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (op_ret) {
+                /* ENXIO only says there is nothing more to find */
+                gf_log (this->name,
+                        (op_errno == ENXIO) ? GF_LOG_DEBUG : GF_LOG_INFO,
+                        "%"PRId64": SEEK %"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        rsp.offset = offset;
+
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_seek_rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+int
+server_copy_file_range_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            struct iatt *stbuf, struct iatt *prebuf_dst,
+                            struct iatt *postbuf_dst, dict_t *xdata)
+{
+        gfs3_copy_file_range_rsp rsp = {0,};
+        server_state_t   *state = NULL;
+        rpcsvc_request_t *req   = NULL;
+
+        req = frame->local;
+        state  = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COPY_FILE_RANGE %"PRId64" (%s) -> "
+                        "%"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        state->resolve2.fd_no,
+                        uuid_utoa (state->resolve2.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        gf_stat_from_iatt (&rsp.stat, stbuf);
+        gf_stat_from_iatt (&rsp.prestat, prebuf_dst);
+        gf_stat_from_iatt (&rsp.poststat, postbuf_dst);
+
+out:
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_copy_file_range_rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+static void
+server_xattrop_batch_done (server_xattrop_batch_t *batch)
+{
+        int   pending = 0;
+        u_int i       = 0;
+
+        LOCK (&batch->lock);
+        {
+                pending = --batch->pending;
+        }
+        UNLOCK (&batch->lock);
+
+        if (pending)
+                return;
+
+        server_submit_reply (NULL, batch->req, &batch->rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_xattrop_batch_rsp);
+
+        for (i = 0; i < batch->rsp.entries.entries_len; i++) {
+                GF_FREE (batch->rsp.entries.entries_val[i].dict.dict_val);
+                GF_FREE (batch->rsp.entries.entries_val[i].xdata.xdata_val);
+        }
+        GF_FREE (batch->rsp.entries.entries_val);
+
+        LOCK_DESTROY (&batch->lock);
+        GF_FREE (batch);
+}
+
+/* one entry of an XATTROP_BATCH finished; @cookie is its index */
+int
+server_xattrop_batch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, dict_t *dict,
+                          dict_t *xdata)
+{
+        gfs3_xattrop_rsp       *rsp   = NULL;
+        server_state_t         *state = NULL;
+        server_xattrop_batch_t *batch = NULL;
+
+        batch = frame->local;
+        state = CALL_STATE (frame);
+        rsp   = &batch->rsp.entries.entries_val[(long) cookie];
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp->xdata.xdata_val),
+                                    rsp->xdata.xdata_len, op_errno, out);
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": XATTROP_BATCH %"PRId64" (%s) ==> (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        uuid_utoa (state->resolve.gfid),
+                        strerror (op_errno));
+                goto out;
+        }
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, dict, (&rsp->dict.dict_val),
+                                    rsp->dict.dict_len, op_errno, out);
+
+out:
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        /* the reply goes out once for the whole batch */
+        frame->local = NULL;
+        free_state (state);
+        if (frame->root->trans)
+                server_conn_unref (frame->root->trans);
+        STACK_DESTROY (frame->root);
+
+        server_xattrop_batch_done (batch);
+
+        return 0;
+}
+
 int
 server_xattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, dict_t *dict,
@@ -2505,6 +2781,34 @@ err:
         return 0;
 }
 
+int
+server_xattrop_batch_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        if (state->fd)
+                STACK_WIND_COOKIE (frame, server_xattrop_batch_cbk,
+                                   frame->cookie, bound_xl,
+                                   bound_xl->fops->fxattrop, state->fd,
+                                   state->flags, state->dict, state->xdata);
+        else
+                STACK_WIND_COOKIE (frame, server_xattrop_batch_cbk,
+                                   frame->cookie, bound_xl,
+                                   bound_xl->fops->xattrop, &state->loc,
+                                   state->flags, state->dict, state->xdata);
+        return 0;
+err:
+        server_xattrop_batch_cbk (frame, frame->cookie, frame->this,
+                                  state->resolve.op_ret,
+                                  state->resolve.op_errno, NULL, NULL);
+        return 0;
+}
+
 int
 server_fsetxattr_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
@@ -2810,130 +3114,552 @@ server_readlink_resume (call_frame_t *frame, xlator_t *bound_xl)
 
         state = CALL_STATE (frame);
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_readlink_cbk,
+                    bound_xl, bound_xl->fops->readlink,
+                    &state->loc, state->size, state->xdata);
+        return 0;
+err:
+        server_readlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL, NULL);
+        return 0;
+}
+
+
+int
+server_fsetattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fsetattr_cbk,
+                    bound_xl, bound_xl->fops->fsetattr,
+                    state->fd, &state->stbuf, state->valid, state->xdata);
+        return 0;
+err:
+        server_fsetattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_fallocate_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fallocate_cbk,
+                    bound_xl, bound_xl->fops->fallocate,
+                    state->fd, state->flags, state->offset,
+                    state->size, state->xdata);
+        return 0;
+err:
+        server_fallocate_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                      state->resolve.op_errno, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_discard_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_discard_cbk,
+                    bound_xl, bound_xl->fops->discard,
+                    state->fd, state->offset, state->size,
+                    state->xdata);
+        return 0;
+err:
+        server_discard_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                    state->resolve.op_errno, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_zerofill_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_zerofill_cbk,
+                    bound_xl, bound_xl->fops->zerofill,
+                    state->fd, state->offset, state->size,
+                    state->xdata);
+        return 0;
+err:
+        server_zerofill_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                     state->resolve.op_errno, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_seek_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_seek_cbk,
+                    bound_xl, bound_xl->fops->seek,
+                    state->fd, state->offset, state->what,
+                    state->xdata);
+        return 0;
+err:
+        server_seek_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, 0, NULL);
+
+        return 0;
+}
+
+
+int
+server_copy_file_range_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+        int             op_ret = 0;
+        int             op_errno = 0;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0) {
+                op_ret   = state->resolve.op_ret;
+                op_errno = state->resolve.op_errno;
+                goto err;
+        }
+
+        if (state->resolve2.op_ret != 0) {
+                op_ret   = state->resolve2.op_ret;
+                op_errno = state->resolve2.op_errno;
+                goto err;
+        }
+
+        STACK_WIND (frame, server_copy_file_range_cbk,
+                    bound_xl, bound_xl->fops->copy_file_range,
+                    state->fd, state->offset, state->fd_out,
+                    state->off_out, state->size, state->flags,
+                    state->xdata);
+        return 0;
+err:
+        server_copy_file_range_cbk (frame, NULL, frame->this, op_ret,
+                                    op_errno, NULL, NULL, NULL, NULL);
+
+        return 0;
+}
+
+int
+server_setattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_setattr_cbk,
+                    bound_xl, bound_xl->fops->setattr,
+                    &state->loc, &state->stbuf, state->valid, state->xdata);
+        return 0;
+err:
+        server_setattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_stat_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_stat_cbk,
+                    bound_xl, bound_xl->fops->stat, &state->loc, state->xdata);
+        return 0;
+err:
+        server_stat_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, NULL, NULL);
+        return 0;
+}
+
+int
+server_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        if (!state->loc.inode)
+                state->loc.inode = inode_new (state->itable);
+        else
+                state->is_revalidate = 1;
+
+        STACK_WIND (frame, server_lookup_cbk,
+                    bound_xl, bound_xl->fops->lookup,
+                    &state->loc, state->xdata);
+
+        return 0;
+err:
+        server_lookup_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                           state->resolve.op_errno, NULL, NULL, NULL, NULL);
+
+        return 0;
+}
+
+
+
+
+/* Fop section */
+
+int
+server3_3_stat (rpcsvc_request_t *req)
+{
+        server_state_t *state    = NULL;
+        call_frame_t   *frame    = NULL;
+        gfs3_stat_req   args     = {{0,},};
+        int             ret      = -1;
+        int             op_errno = 0;
+
+        if (!req)
+                return 0;
+
+        /* Initialize args first, then decode */
+
+        ret = xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_stat_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_STAT;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type  = RESOLVE_MUST;
+        memcpy (state->resolve.gfid, args.gfid, 16);
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
+                                      (args.xdata.xdata_val),
+                                      (args.xdata.xdata_len), ret,
+                                      op_errno, out);
+
+
+        ret = 0;
+        resolve_and_resume (frame, server_stat_resume);
+
+out:
+        free (args.xdata.xdata_val);
+
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
+
+        return ret;
+}
+
+
+int
+server3_3_setattr (rpcsvc_request_t *req)
+{
+        server_state_t   *state                 = NULL;
+        call_frame_t     *frame                 = NULL;
+        gfs3_setattr_req  args                  = {{0,},};
+        int               ret                   = -1;
+        int               op_errno = 0;
+
+        if (!req)
+                return 0;
+
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_setattr_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_SETATTR;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type  = RESOLVE_MUST;
+        memcpy (state->resolve.gfid, args.gfid, 16);
+
+        gf_stat_to_iatt (&args.stbuf, &state->stbuf);
+        state->valid = args.valid;
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
+                                      (args.xdata.xdata_val),
+                                      (args.xdata.xdata_len), ret,
+                                      op_errno, out);
+
+        ret = 0;
+        resolve_and_resume (frame, server_setattr_resume);
+
+out:
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
+
+        free (args.xdata.xdata_val);
+
+        return ret;
+}
+
+
+int
+server3_3_fsetattr (rpcsvc_request_t *req)
+{
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_fsetattr_req  args  = {0,};
+        int                ret   = -1;
+        int                op_errno = 0;
+
+        if (!req)
+                return ret;
+
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_fsetattr_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FSETATTR;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        gf_stat_to_iatt (&args.stbuf, &state->stbuf);
+        state->valid = args.valid;
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
+                                      (args.xdata.xdata_val),
+                                      (args.xdata.xdata_len), ret,
+                                      op_errno, out);
+
+        ret = 0;
+        resolve_and_resume (frame, server_fsetattr_resume);
+
+out:
+        free (args.xdata.xdata_val);
+
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
 
-        STACK_WIND (frame, server_readlink_cbk,
-                    bound_xl, bound_xl->fops->readlink,
-                    &state->loc, state->size, state->xdata);
-        return 0;
-err:
-        server_readlink_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                             state->resolve.op_errno, NULL, NULL, NULL);
-        return 0;
+        return ret;
 }
 
 
 int
-server_fsetattr_resume (call_frame_t *frame, xlator_t *bound_xl)
+server3_3_fallocate (rpcsvc_request_t *req)
 {
-        server_state_t *state = NULL;
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_fallocate_req  args  = {{0,},};
+        int                 ret   = -1;
+        int                 op_errno = 0;
 
-        state = CALL_STATE (frame);
+        if (!req)
+                return ret;
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_fallocate_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
 
-        STACK_WIND (frame, server_fsetattr_cbk,
-                    bound_xl, bound_xl->fops->fsetattr,
-                    state->fd, &state->stbuf, state->valid, state->xdata);
-        return 0;
-err:
-        server_fsetattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                             state->resolve.op_errno, NULL, NULL, NULL);
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FALLOCATE;
 
-        return 0;
-}
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
 
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
 
-int
-server_setattr_resume (call_frame_t *frame, xlator_t *bound_xl)
-{
-        server_state_t *state = NULL;
+        state->flags  = args.flags;
+        state->offset = args.offset;
+        state->size   = args.size;
+        memcpy (state->resolve.gfid, args.gfid, 16);
 
-        state = CALL_STATE (frame);
+        GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
+                                      (args.xdata.xdata_val),
+                                      (args.xdata.xdata_len), ret,
+                                      op_errno, out);
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+        ret = 0;
+        resolve_and_resume (frame, server_fallocate_resume);
 
-        STACK_WIND (frame, server_setattr_cbk,
-                    bound_xl, bound_xl->fops->setattr,
-                    &state->loc, &state->stbuf, state->valid, state->xdata);
-        return 0;
-err:
-        server_setattr_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                            state->resolve.op_errno, NULL, NULL, NULL);
+out:
+        free (args.xdata.xdata_val);
 
-        return 0;
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
+
+        return ret;
 }
 
 
 int
-server_stat_resume (call_frame_t *frame, xlator_t *bound_xl)
+server3_3_discard (rpcsvc_request_t *req)
 {
-        server_state_t *state = NULL;
-
-        state = CALL_STATE (frame);
+        server_state_t   *state = NULL;
+        call_frame_t     *frame = NULL;
+        gfs3_discard_req  args  = {{0,},};
+        int               ret   = -1;
+        int               op_errno = 0;
 
-        if (state->resolve.op_ret != 0)
-                goto err;
+        if (!req)
+                return ret;
 
-        STACK_WIND (frame, server_stat_cbk,
-                    bound_xl, bound_xl->fops->stat, &state->loc, state->xdata);
-        return 0;
-err:
-        server_stat_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                         state->resolve.op_errno, NULL, NULL);
-        return 0;
-}
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_discard_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
 
-int
-server_lookup_resume (call_frame_t *frame, xlator_t *bound_xl)
-{
-        server_state_t    *state = NULL;
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_DISCARD;
 
         state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
 
-        if (state->resolve.op_ret != 0)
-                goto err;
-
-        if (!state->loc.inode)
-                state->loc.inode = inode_new (state->itable);
-        else
-                state->is_revalidate = 1;
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
 
-        STACK_WIND (frame, server_lookup_cbk,
-                    bound_xl, bound_xl->fops->lookup,
-                    &state->loc, state->xdata);
+        state->offset = args.offset;
+        state->size   = args.size;
+        memcpy (state->resolve.gfid, args.gfid, 16);
 
-        return 0;
-err:
-        server_lookup_cbk (frame, NULL, frame->this, state->resolve.op_ret,
-                           state->resolve.op_errno, NULL, NULL, NULL, NULL);
+        GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
+                                      (args.xdata.xdata_val),
+                                      (args.xdata.xdata_len), ret,
+                                      op_errno, out);
 
-        return 0;
-}
+        ret = 0;
+        resolve_and_resume (frame, server_discard_resume);
 
+out:
+        free (args.xdata.xdata_val);
 
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
 
+        return ret;
+}
 
-/* Fop section */
 
 int
-server3_3_stat (rpcsvc_request_t *req)
+server3_3_zerofill (rpcsvc_request_t *req)
 {
-        server_state_t *state    = NULL;
-        call_frame_t   *frame    = NULL;
-        gfs3_stat_req   args     = {{0,},};
-        int             ret      = -1;
-        int             op_errno = 0;
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_zerofill_req  args  = {{0,},};
+        int                ret   = -1;
+        int                op_errno = 0;
 
         if (!req)
-                return 0;
-
-        /* Initialize args first, then decode */
+                return ret;
 
-        ret = xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_stat_req);
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_zerofill_req);
         if (ret < 0) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
@@ -2946,7 +3672,7 @@ server3_3_stat (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_STAT;
+        frame->root->op = GF_FOP_ZEROFILL;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -2955,7 +3681,11 @@ server3_3_stat (rpcsvc_request_t *req)
                 goto out;
         }
 
-        state->resolve.type  = RESOLVE_MUST;
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        state->offset = args.offset;
+        state->size   = args.size;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
         GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
@@ -2963,9 +3693,8 @@ server3_3_stat (rpcsvc_request_t *req)
                                       (args.xdata.xdata_len), ret,
                                       op_errno, out);
 
-
         ret = 0;
-        resolve_and_resume (frame, server_stat_resume);
+        resolve_and_resume (frame, server_zerofill_resume);
 
 out:
         free (args.xdata.xdata_val);
@@ -2978,19 +3707,19 @@ out:
 
 
 int
-server3_3_setattr (rpcsvc_request_t *req)
+server3_3_seek (rpcsvc_request_t *req)
 {
-        server_state_t   *state                 = NULL;
-        call_frame_t     *frame                 = NULL;
-        gfs3_setattr_req  args                  = {{0,},};
-        int               ret                   = -1;
-        int               op_errno = 0;
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_seek_req      args  = {{0,},};
+        int                ret   = -1;
+        int                op_errno = 0;
 
         if (!req)
-                return 0;
+                return ret;
 
         ret = xdr_to_generic (req->msg[0], &args,
-                              (xdrproc_t)xdr_gfs3_setattr_req);
+                              (xdrproc_t)xdr_gfs3_seek_req);
         if (ret < 0) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
@@ -3003,7 +3732,7 @@ server3_3_setattr (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_SETATTR;
+        frame->root->op = GF_FOP_SEEK;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -3012,11 +3741,12 @@ server3_3_setattr (rpcsvc_request_t *req)
                 goto out;
         }
 
-        state->resolve.type  = RESOLVE_MUST;
-        memcpy (state->resolve.gfid, args.gfid, 16);
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
 
-        gf_stat_to_iatt (&args.stbuf, &state->stbuf);
-        state->valid = args.valid;
+        state->offset = args.offset;
+        state->what   = args.what;
+        memcpy (state->resolve.gfid, args.gfid, 16);
 
         GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
                                       (args.xdata.xdata_val),
@@ -3024,32 +3754,32 @@ server3_3_setattr (rpcsvc_request_t *req)
                                       op_errno, out);
 
         ret = 0;
-        resolve_and_resume (frame, server_setattr_resume);
+        resolve_and_resume (frame, server_seek_resume);
 
 out:
+        free (args.xdata.xdata_val);
+
         if (op_errno)
                 req->rpc_err = GARBAGE_ARGS;
 
-        free (args.xdata.xdata_val);
-
         return ret;
 }
 
 
 int
-server3_3_fsetattr (rpcsvc_request_t *req)
+server3_3_copy_file_range (rpcsvc_request_t *req)
 {
-        server_state_t    *state = NULL;
-        call_frame_t      *frame = NULL;
-        gfs3_fsetattr_req  args  = {0,};
-        int                ret   = -1;
-        int                op_errno = 0;
+        server_state_t           *state = NULL;
+        call_frame_t             *frame = NULL;
+        gfs3_copy_file_range_req  args  = {{0,},};
+        int                       ret   = -1;
+        int                       op_errno = 0;
 
         if (!req)
                 return ret;
 
         ret = xdr_to_generic (req->msg[0], &args,
-                              (xdrproc_t)xdr_gfs3_fsetattr_req);
+                              (xdrproc_t)xdr_gfs3_copy_file_range_req);
         if (ret < 0) {
                 //failed to decode msg;
                 req->rpc_err = GARBAGE_ARGS;
@@ -3062,7 +3792,7 @@ server3_3_fsetattr (rpcsvc_request_t *req)
                 req->rpc_err = GARBAGE_ARGS; /* TODO */
                 goto out;
         }
-        frame->root->op = GF_FOP_FSETATTR;
+        frame->root->op = GF_FOP_COPY_FILE_RANGE;
 
         state = CALL_STATE (frame);
         if (!state->conn->bound_xl) {
@@ -3072,10 +3802,17 @@ server3_3_fsetattr (rpcsvc_request_t *req)
         }
 
         state->resolve.type   = RESOLVE_MUST;
-        state->resolve.fd_no  = args.fd;
+        state->resolve.fd_no  = args.fd_in;
+        memcpy (state->resolve.gfid, args.gfid1, 16);
 
-        gf_stat_to_iatt (&args.stbuf, &state->stbuf);
-        state->valid = args.valid;
+        state->resolve2.type  = RESOLVE_MUST;
+        state->resolve2.fd_no = args.fd_out;
+        memcpy (state->resolve2.gfid, args.gfid2, 16);
+
+        state->offset  = args.off_in;
+        state->off_out = args.off_out;
+        state->size    = args.size;
+        state->flags   = args.flags;
 
         GF_PROTOCOL_DICT_UNSERIALIZE (state->conn->bound_xl, state->xdata,
                                       (args.xdata.xdata_val),
@@ -3083,7 +3820,7 @@ server3_3_fsetattr (rpcsvc_request_t *req)
                                       op_errno, out);
 
         ret = 0;
-        resolve_and_resume (frame, server_fsetattr_resume);
+        resolve_and_resume (frame, server_copy_file_range_resume);
 
 out:
         free (args.xdata.xdata_val);
@@ -4179,6 +4916,130 @@ out:
 }
 
 
+/* XATTROP_BATCH: runs every entry as its own (f)xattrop down the brick
+   graph, an entry with fd -1 being a loc based xattrop on its gfid, and
+   answers all of them in one reply */
+int
+server3_3_xattrop_batch (rpcsvc_request_t *req)
+{
+        server_connection_t     *conn     = NULL;
+        server_state_t          *state    = NULL;
+        call_frame_t            *frame    = NULL;
+        server_xattrop_batch_t  *batch    = NULL;
+        gfs3_xattrop_batch_req   args     = {{0,},};
+        gfs3_xattrop_batch_entry *entry   = NULL;
+        dict_t                  *dict     = NULL;
+        int32_t                  ret      = -1;
+        int32_t                  op_errno = 0;
+        u_int                    i        = 0;
+
+        if (!req)
+                return ret;
+
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_xattrop_batch_req);
+        if (ret < 0) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        conn = req->trans->xl_private;
+        if (!conn || !conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                ret = -1;
+                goto out;
+        }
+
+        batch = GF_CALLOC (1, sizeof (*batch), gf_server_mt_xattrop_batch_t);
+        if (!batch) {
+                req->rpc_err = GARBAGE_ARGS;
+                ret = -1;
+                goto out;
+        }
+
+        batch->rsp.entries.entries_len = args.entries.entries_len;
+        if (args.entries.entries_len) {
+                batch->rsp.entries.entries_val =
+                        GF_CALLOC (args.entries.entries_len,
+                                   sizeof (gfs3_xattrop_rsp),
+                                   gf_server_mt_xattrop_batch_t);
+                if (!batch->rsp.entries.entries_val) {
+                        GF_FREE (batch);
+                        req->rpc_err = GARBAGE_ARGS;
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        LOCK_INIT (&batch->lock);
+        batch->req = req;
+        /* the extra count keeps the reply back until every entry is
+           wound */
+        batch->pending = args.entries.entries_len + 1;
+
+        for (i = 0; i < args.entries.entries_len; i++) {
+                entry = &args.entries.entries_val[i];
+
+                frame = get_frame_from_request (req);
+                if (!frame) {
+                        batch->rsp.entries.entries_val[i].op_ret = -1;
+                        batch->rsp.entries.entries_val[i].op_errno =
+                                gf_errno_to_error (ENOMEM);
+                        server_xattrop_batch_done (batch);
+                        continue;
+                }
+
+                frame->root->op = (entry->fd == -1) ? GF_FOP_XATTROP
+                                                    : GF_FOP_FXATTROP;
+                frame->local  = batch;
+                frame->cookie = (void *)(long) i;
+
+                state = CALL_STATE (frame);
+                state->resolve.type  = RESOLVE_MUST;
+                state->resolve.fd_no = entry->fd;
+                state->flags         = entry->flags;
+                memcpy (state->resolve.gfid, entry->gfid, 16);
+
+                dict = NULL;
+                op_errno = 0;
+                GF_PROTOCOL_DICT_UNSERIALIZE (conn->bound_xl, dict,
+                                              (entry->dict.dict_val),
+                                              (entry->dict.dict_len), ret,
+                                              op_errno, bad_entry);
+                state->dict = dict;
+
+                GF_PROTOCOL_DICT_UNSERIALIZE (conn->bound_xl, state->xdata,
+                                              (entry->xdata.xdata_val),
+                                              (entry->xdata.xdata_len), ret,
+                                              op_errno, bad_entry);
+
+                resolve_and_resume (frame, server_xattrop_batch_resume);
+                continue;
+
+        bad_entry:
+                if (dict && !state->dict)
+                        dict_unref (dict);
+                server_xattrop_batch_cbk (frame, frame->cookie, frame->this,
+                                          -1, op_errno ? op_errno : ENOMEM,
+                                          NULL, NULL);
+        }
+
+        server_xattrop_batch_done (batch);
+        ret = 0;
+out:
+        for (i = 0; i < args.entries.entries_len; i++) {
+                free (args.entries.entries_val[i].dict.dict_val);
+                free (args.entries.entries_val[i].xdata.xdata_val);
+        }
+        free (args.entries.entries_val);
+        free (args.xdata.xdata_val);
+
+        return ret;
+}
+
+
 int
 server3_3_getxattr (rpcsvc_request_t *req)
 {
@@ -5751,6 +6612,12 @@ rpcsvc_actor_t glusterfs3_3_fop_actors[] = {
         [GFS3_OP_RELEASE]     = { "RELEASE",    GFS3_OP_RELEASE, server3_3_release, NULL, 0},
         [GFS3_OP_RELEASEDIR]  = { "RELEASEDIR", GFS3_OP_RELEASEDIR, server3_3_releasedir, NULL, 0},
         [GFS3_OP_FREMOVEXATTR] = { "FREMOVEXATTR", GFS3_OP_FREMOVEXATTR, server3_3_fremovexattr, NULL, 0},
+        [GFS3_OP_FALLOCATE]   = { "FALLOCATE",  GFS3_OP_FALLOCATE, server3_3_fallocate, NULL, 0},
+        [GFS3_OP_DISCARD]     = { "DISCARD",    GFS3_OP_DISCARD, server3_3_discard, NULL, 0},
+        [GFS3_OP_ZEROFILL]    = { "ZEROFILL",   GFS3_OP_ZEROFILL, server3_3_zerofill, NULL, 0},
+        [GFS3_OP_SEEK]        = { "SEEK",       GFS3_OP_SEEK, server3_3_seek, NULL, 0},
+        [GFS3_OP_COPY_FILE_RANGE] = { "COPY_FILE_RANGE", GFS3_OP_COPY_FILE_RANGE, server3_3_copy_file_range, NULL, 0},
+        [GFS3_OP_XATTROP_BATCH] = { "XATTROP_BATCH", GFS3_OP_XATTROP_BATCH, server3_3_xattrop_batch, NULL, 0},
 };
 
 
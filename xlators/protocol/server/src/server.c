@@ -27,6 +27,12 @@
 #include "authenticate.h"
 #include "rpcsvc.h"
 
+rpcsvc_cbk_program_t server_cbk_prog = {
+        .progname  = "Gluster Callback",
+        .prognum   = GLUSTER_CBK_PROGRAM,
+        .progver   = GLUSTER_CBK_VERSION,
+};
+
 void
 grace_time_handler (void *data)
 {
@@ -1198,11 +1204,164 @@ fini (xlator_t *this)
         return;
 }
 
+/* asks the client holding an inodelk to give it up; the locks xlator
+ * hands us the connection (frame->root->trans) which owns the lock.
+ */
+static int
+server_inodelk_recall (xlator_t *this, gf_upcall_recall_t *recall)
+{
+        server_conf_t           *conf  = NULL;
+        rpc_transport_t         *xprt  = NULL;
+        rpc_transport_t         *trans = NULL;
+        gfs3_inodelk_recall_req  req   = {{0,},};
+        struct iobuf            *iob   = NULL;
+        struct iovec             iov   = {0,};
+        ssize_t                  len   = 0;
+        int                      ret   = -1;
+
+        conf = this->private;
+        if (!conf || !recall->client)
+                goto out;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                list_for_each_entry (xprt, &conf->xprt_list, list) {
+                        if (xprt->xl_private == recall->client) {
+                                trans = rpc_transport_ref (xprt);
+                                break;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        if (!trans) {
+                gf_log (this->name, GF_LOG_DEBUG, "lock holder of %s is not "
+                        "connected, not sending recall",
+                        uuid_utoa (recall->gfid));
+                goto out;
+        }
+
+        memcpy (req.gfid, recall->gfid, 16);
+        req.domain = (char *)recall->domain;
+        req.lk_owner.lk_owner_len = recall->owner.len;
+        req.lk_owner.lk_owner_val = recall->owner.data;
+
+        len = xdr_sizeof ((xdrproc_t)xdr_gfs3_inodelk_recall_req, &req);
+        iob = iobuf_get2 (this->ctx->iobuf_pool, len);
+        if (!iob)
+                goto out;
+
+        iobuf_to_iovec (iob, &iov);
+        len = xdr_serialize_generic (iov, &req,
+                                     (xdrproc_t)xdr_gfs3_inodelk_recall_req);
+        if (len == -1)
+                goto out;
+
+        iov.iov_len = len;
+
+        ret = rpcsvc_callback_submit (conf->rpc, trans, &server_cbk_prog,
+                                      GF_CBK_INODELK_RECALL, &iov, 1);
+        if (ret)
+                gf_log (this->name, GF_LOG_WARNING, "failed to send inodelk "
+                        "recall for %s to %s", uuid_utoa (recall->gfid),
+                        trans->peerinfo.identifier);
+out:
+        if (iob)
+                iobuf_unref (iob);
+
+        if (trans)
+                rpc_transport_unref (trans);
+
+        return ret;
+}
+
+/* sends the usage of the brick to every connected client; the transports
+ * are referenced under the lock and written to after dropping it.
+ */
+static int
+server_statfs_push (xlator_t *this, gf_statfs_push_t *push)
+{
+        server_conf_t     *conf   = NULL;
+        rpc_transport_t   *xprt   = NULL;
+        rpc_transport_t  **trans  = NULL;
+        struct gf_statfs   req    = {0,};
+        struct iobuf      *iob    = NULL;
+        struct iovec       iov    = {0,};
+        ssize_t            len    = 0;
+        int                count  = 0;
+        int                i      = 0;
+        int                ret    = -1;
+
+        conf = this->private;
+        if (!conf)
+                goto out;
+
+        gf_statfs_from_statfs (&req, &push->buf);
+
+        len = xdr_sizeof ((xdrproc_t)xdr_gf_statfs, &req);
+        iob = iobuf_get2 (this->ctx->iobuf_pool, len);
+        if (!iob)
+                goto out;
+
+        iobuf_to_iovec (iob, &iov);
+        len = xdr_serialize_generic (iov, &req, (xdrproc_t)xdr_gf_statfs);
+        if (len == -1)
+                goto out;
+
+        iov.iov_len = len;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                list_for_each_entry (xprt, &conf->xprt_list, list)
+                        count++;
+
+                if (count)
+                        trans = GF_CALLOC (count, sizeof (*trans),
+                                           gf_server_mt_xprt_array_t);
+                if (trans) {
+                        i = 0;
+                        list_for_each_entry (xprt, &conf->xprt_list, list)
+                                trans[i++] = rpc_transport_ref (xprt);
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        if (!trans)
+                goto out;
+
+        for (i = 0; i < count; i++) {
+                if (rpcsvc_callback_submit (conf->rpc, trans[i],
+                                            &server_cbk_prog,
+                                            GF_CBK_STATFS_PUSH, &iov, 1))
+                        gf_log (this->name, GF_LOG_DEBUG, "failed to push "
+                                "statfs to %s",
+                                trans[i]->peerinfo.identifier);
+                rpc_transport_unref (trans[i]);
+        }
+
+        ret = 0;
+out:
+        GF_FREE (trans);
+
+        if (iob)
+                iobuf_unref (iob);
+
+        return ret;
+}
+
 int
 notify (xlator_t *this, int32_t event, void *data, ...)
 {
         int          ret = 0;
         switch (event) {
+        case GF_EVENT_UPCALL:
+                if (data)
+                        server_inodelk_recall (this, data);
+                break;
+        case GF_EVENT_STATFS_PUSH:
+                if (data)
+                        server_statfs_push (this, data);
+                break;
         default:
                 default_notify (this, event, data);
                 break;
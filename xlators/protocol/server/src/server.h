@@ -163,6 +163,7 @@ struct _server_state {
         int               valid;
 
         fd_t             *fd;
+        fd_t             *fd_out;
         dict_t           *params;
         int32_t           flags;
         int               wbflags;
@@ -173,6 +174,8 @@ struct _server_state {
 
         size_t            size;
         off_t             offset;
+        off_t             off_out;
+        gf_seek_what_t    what;
         mode_t            mode;
         dev_t             dev;
         size_t            nr_count;
@@ -192,6 +195,14 @@ struct _server_state {
         mode_t            umask;
 };
 
+/* an XATTROP_BATCH request, answered when its last entry is done */
+typedef struct server_xattrop_batch {
+        rpcsvc_request_t        *req;
+        gf_lock_t                lock;
+        int                      pending;
+        gfs3_xattrop_batch_rsp   rsp;
+} server_xattrop_batch_t;
+
 extern struct rpcsvc_program gluster_handshake_prog;
 extern struct rpcsvc_program glusterfs3_3_fop_prog;
 extern struct rpcsvc_program gluster_ping_prog;
@@ -198,7 +198,8 @@ posix_aio_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
                 goto err;
         }
 
-        iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+        iobuf = iobuf_get_page_aligned (this->ctx->iobuf_pool, size,
+                                        GF_IOBUF_PAGE_ALIGN_SIZE);
         if (!iobuf) {
                 op_errno = ENOMEM;
                 goto err;
@@ -757,6 +757,7 @@ janitor_walker (const char *fpath, const struct stat *sb,
 {
         struct iatt  stbuf        = {0, };
         xlator_t     *this = NULL;
+        int           fd   = -1;
 
         this = THIS;
         posix_pstat (this, NULL, fpath, &stbuf);
@@ -769,9 +770,15 @@ janitor_walker (const char *fpath, const struct stat *sb,
         case S_IFSOCK:
                 gf_log (THIS->name, GF_LOG_TRACE,
                         "unlinking %s", fpath);
+                /* hand big regular files over to the unlink threads so
+                   that their blocks are released in chunks */
+                if (S_ISREG (sb->st_mode))
+                        fd = open (fpath, O_RDONLY);
                 unlink (fpath);
                 if (stbuf.ia_nlink == 1)
                         posix_handle_unset (this, stbuf.ia_gfid, NULL);
+                if ((fd != -1) && posix_unlink_enqueue (this, fd))
+                        close (fd);
                 break;
 
         case S_IFDIR:
@@ -900,6 +907,359 @@ unlock:
         UNLOCK (&priv->lock);
 }
 
+static void
+posix_unlink_throttle (xlator_t *this, uint64_t bytes)
+{
+        struct posix_private *priv  = NULL;
+        struct timeval        now   = {0, };
+        struct timeval        start = {0, };
+        struct timeval        delay = {0, };
+        struct timeval        wait  = {0, };
+        uint64_t              usecs = 0;
+
+        priv = this->private;
+
+        if (!priv->unlink_rate_limit || !bytes)
+                return;
+
+        usecs = (uint64_t) (((double) bytes / priv->unlink_rate_limit)
+                            * 1000000);
+        delay.tv_sec  = usecs / 1000000;
+        delay.tv_usec = usecs % 1000000;
+
+        /* reserve the next free slot of the shared budget, so that all
+           unlink threads together stay within the configured rate */
+        pthread_mutex_lock (&priv->unlink_lock);
+        {
+                gettimeofday (&now, NULL);
+                if (timercmp (&priv->unlink_next_slot, &now, <))
+                        priv->unlink_next_slot = now;
+                start = priv->unlink_next_slot;
+                timeradd (&start, &delay, &priv->unlink_next_slot);
+        }
+        pthread_mutex_unlock (&priv->unlink_lock);
+
+        if (timercmp (&start, &now, >)) {
+                timersub (&start, &now, &wait);
+                usleep (wait.tv_sec * 1000000 + wait.tv_usec);
+        }
+}
+
+
+static void
+posix_unlink_release_blocks (xlator_t *this, int fd)
+{
+        struct posix_private *priv  = NULL;
+        struct stat           stbuf = {0, };
+        off_t                 size  = 0;
+        uint64_t              chunk = 0;
+        uint64_t              held  = 0;
+        uint64_t              freed = 0;
+
+        priv = this->private;
+
+        if (fstat (fd, &stbuf) == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "fstat on unlinked fd=%d failed: %s", fd,
+                        strerror (errno));
+                return;
+        }
+
+        /* never touch the data of a file which is still linked
+           elsewhere in the backend */
+        if (!S_ISREG (stbuf.st_mode) || stbuf.st_nlink)
+                return;
+
+        size  = stbuf.st_size;
+        held  = (uint64_t) stbuf.st_blocks * 512;
+        chunk = priv->unlink_chunk_size;
+
+        while (chunk && (held > chunk) && (size > chunk)) {
+                posix_unlink_throttle (this, chunk);
+
+                size -= chunk;
+                if (ftruncate (fd, size) == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "truncating unlinked fd=%d to %"PRId64
+                                " failed: %s", fd, (int64_t) size,
+                                strerror (errno));
+                        break;
+                }
+
+                if (fstat (fd, &stbuf) == -1)
+                        break;
+
+                if (held > (uint64_t) stbuf.st_blocks * 512)
+                        freed += held - (uint64_t) stbuf.st_blocks * 512;
+                held = (uint64_t) stbuf.st_blocks * 512;
+        }
+
+        /* whatever is left goes away with the final close */
+        posix_unlink_throttle (this, held);
+        freed += held;
+
+        LOCK (&priv->lock);
+        {
+                priv->unlink_bytes += freed;
+        }
+        UNLOCK (&priv->lock);
+}
+
+
+static struct posix_unlink_item *
+posix_unlink_get_next (xlator_t *this)
+{
+        struct posix_private     *priv = NULL;
+        struct posix_unlink_item *item = NULL;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->unlink_lock);
+        {
+                while (list_empty (&priv->unlink_queue))
+                        pthread_cond_wait (&priv->unlink_cond,
+                                           &priv->unlink_lock);
+
+                item = list_entry (priv->unlink_queue.next,
+                                   struct posix_unlink_item, list);
+                list_del_init (&item->list);
+                priv->unlink_queue_len--;
+        }
+        pthread_mutex_unlock (&priv->unlink_lock);
+
+        return item;
+}
+
+
+static void *
+posix_unlink_thread_proc (void *data)
+{
+        xlator_t                 *this = NULL;
+        struct posix_private     *priv = NULL;
+        struct posix_unlink_item *item = NULL;
+
+        this = data;
+        priv = this->private;
+
+        THIS = this;
+
+        while (1) {
+                item = posix_unlink_get_next (this);
+
+                gf_log (this->name, GF_LOG_TRACE,
+                        "releasing blocks of unlinked fd=%d", item->fd);
+
+                posix_unlink_release_blocks (this, item->fd);
+                close (item->fd);
+
+                LOCK (&priv->lock);
+                {
+                        priv->unlink_files++;
+                }
+                UNLOCK (&priv->lock);
+
+                GF_FREE (item);
+        }
+
+        return NULL;
+}
+
+
+/* queue an already unlinked fd for block release. fails (and leaves
+   closing the fd to the caller) when the queue is full, so that a burst
+   of deletes never blocks the fop path */
+int
+posix_unlink_enqueue (xlator_t *this, int fd)
+{
+        struct posix_private     *priv = NULL;
+        struct posix_unlink_item *item = NULL;
+        int                       ret  = -1;
+
+        priv = this->private;
+
+        if (!priv->unlink_threads)
+                goto out;
+
+        item = GF_CALLOC (1, sizeof (*item), gf_posix_mt_unlink_item);
+        if (!item)
+                goto out;
+
+        item->fd = fd;
+        INIT_LIST_HEAD (&item->list);
+
+        pthread_mutex_lock (&priv->unlink_lock);
+        {
+                if (priv->unlink_queue_len < priv->unlink_queue_size) {
+                        list_add_tail (&item->list, &priv->unlink_queue);
+                        priv->unlink_queue_len++;
+                        pthread_cond_signal (&priv->unlink_cond);
+                        ret = 0;
+                } else {
+                        priv->unlink_overflows++;
+                }
+        }
+        pthread_mutex_unlock (&priv->unlink_lock);
+
+        if (ret) {
+                gf_log (this->name, GF_LOG_DEBUG, "unlink queue full (%d), "
+                        "releasing fd=%d inline", priv->unlink_queue_size,
+                        fd);
+                GF_FREE (item);
+        }
+out:
+        return ret;
+}
+
+
+int
+posix_spawn_unlink_threads (xlator_t *this)
+{
+        struct posix_private *priv    = NULL;
+        pthread_t            *threads = NULL;
+        int                   i       = 0;
+        int                   ret     = -1;
+
+        priv = this->private;
+
+        threads = GF_CALLOC (priv->unlink_thread_count, sizeof (pthread_t),
+                             gf_posix_mt_pthread_t);
+        if (!threads)
+                goto out;
+
+        for (i = 0; i < priv->unlink_thread_count; i++) {
+                ret = pthread_create (&threads[i], NULL,
+                                      posix_unlink_thread_proc, this);
+                if (ret != 0) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "spawning unlink thread %d failed: %s", i,
+                                strerror (ret));
+                        break;
+                }
+        }
+
+        if (i == 0) {
+                GF_FREE (threads);
+                ret = -1;
+                goto out;
+        }
+
+        priv->unlink_thread_count = i;
+        priv->unlink_threads = threads;
+        ret = 0;
+out:
+        return ret;
+}
+
+static gf_boolean_t
+posix_statfs_push_due (struct posix_private *priv, struct statvfs *buf)
+{
+        struct statvfs *last  = &priv->statfs_pushed;
+        double          delta = 0;
+
+        if ((buf->f_blocks != last->f_blocks) ||
+            (buf->f_frsize != last->f_frsize) ||
+            (buf->f_files != last->f_files))
+                return _gf_true;
+
+        if (buf->f_blocks) {
+                delta = (double) buf->f_bavail - (double) last->f_bavail;
+                if (delta < 0)
+                        delta = -delta;
+                if ((delta * 100 / buf->f_blocks) >=
+                    priv->statfs_push_threshold)
+                        return _gf_true;
+        }
+
+        if (buf->f_files) {
+                delta = (double) buf->f_ffree - (double) last->f_ffree;
+                if (delta < 0)
+                        delta = -delta;
+                if ((delta * 100 / buf->f_files) >=
+                    priv->statfs_push_threshold)
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+static void *
+posix_statfs_push_thread_proc (void *data)
+{
+        xlator_t             *this = NULL;
+        struct posix_private *priv = NULL;
+        gf_statfs_push_t      push = {0,};
+        int32_t               interval = 0;
+
+        this = data;
+        priv = this->private;
+
+        THIS = this;
+
+        while (1) {
+                interval = priv->statfs_push_interval;
+                if (!interval) {
+                        /* push everything once it is turned back on */
+                        memset (&priv->statfs_pushed, 0,
+                                sizeof (priv->statfs_pushed));
+                        sleep (1);
+                        continue;
+                }
+
+                sleep (interval);
+
+                if (statvfs (priv->base_path, &push.buf) == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "statvfs failed on %s: %s", priv->base_path,
+                                strerror (errno));
+                        continue;
+                }
+
+                if (!priv->export_statfs) {
+                        push.buf.f_blocks = 0;
+                        push.buf.f_bfree  = 0;
+                        push.buf.f_bavail = 0;
+                        push.buf.f_files  = 0;
+                        push.buf.f_ffree  = 0;
+                        push.buf.f_favail = 0;
+                }
+
+                if (!posix_statfs_push_due (priv, &push.buf))
+                        continue;
+
+                gf_log (this->name, GF_LOG_TRACE, "pushing statfs: "
+                        "%"PRIu64" of %"PRIu64" blocks available",
+                        (uint64_t) push.buf.f_bavail,
+                        (uint64_t) push.buf.f_blocks);
+
+                priv->statfs_pushed = push.buf;
+                default_notify (this, GF_EVENT_STATFS_PUSH, &push);
+        }
+
+        return NULL;
+}
+
+
+int
+posix_spawn_statfs_push_thread (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   ret  = -1;
+
+        priv = this->private;
+
+        ret = pthread_create (&priv->statfs_push_thread, NULL,
+                              posix_statfs_push_thread_proc, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "spawning statfs push thread failed: %s",
+                        strerror (ret));
+                ret = -1;
+        }
+
+        return ret;
+}
+
 int
 posix_acl_xattr_set (xlator_t *this, const char *path, dict_t *xattr_req)
 {
@@ -1063,3 +1423,287 @@ posix_fd_ctx_get (fd_t *fd, xlator_t *this, struct posix_fd **pfd)
 
         return ret;
 }
+
+
+/* The brick crawl: a virtual directory (posix_crawl_gfid) whose entries are
+ * the paths, relative to the brick, of every directory and data file of the
+ * brick, walked locally. Each directory is followed by its files and then
+ * by its subdirectories, so that the parent of a file is always the last
+ * directory listed before it. Entries can only be read in sequence; an
+ * offset of 0 starts the walk over.
+ */
+const uuid_t posix_crawl_gfid = {0x71, 0xd6, 0x4f, 0x5c, 0xc2, 0x4e, 0x4b, 0xa9,
+                                 0x8a, 0x5e, 0x6d, 0x1b, 0x2c, 0x3f, 0x9e, 0x07};
+
+struct posix_crawl_level {
+        DIR     *dir;
+        int      len;        /* of 'path' at this directory */
+        char   **subdirs;    /* walked once the files are listed */
+        int      nsubdirs;
+        int      next;
+};
+
+struct posix_crawl {
+        struct posix_crawl_level *levels;
+        int                       depth;
+        int                       max;
+        char                      path[PATH_MAX];
+        int                       pending;  /* 'path' did not fit last time */
+        struct iatt               stbuf;
+        uint64_t                  seq;      /* d_off of the last entry */
+};
+
+
+static int
+posix_crawl_real_path (xlator_t *this, struct posix_crawl *crawl, char *buf)
+{
+        int len = 0;
+
+        len = snprintf (buf, PATH_MAX, "%s%s", POSIX_BASE_PATH (this),
+                        crawl->path);
+        if (len >= PATH_MAX) {
+                errno = ENAMETOOLONG;
+                return -1;
+        }
+        return 0;
+}
+
+
+static void
+posix_crawl_pop (struct posix_crawl *crawl)
+{
+        struct posix_crawl_level *level = NULL;
+        int                       i     = 0;
+
+        level = &crawl->levels[--crawl->depth];
+        if (level->dir)
+                closedir (level->dir);
+        for (i = 0; i < level->nsubdirs; i++)
+                GF_FREE (level->subdirs[i]);
+        GF_FREE (level->subdirs);
+        memset (level, 0, sizeof (*level));
+
+        crawl->path[(crawl->depth) ? crawl->levels[crawl->depth - 1].len : 0]
+                = '\0';
+}
+
+
+static int
+posix_crawl_push (xlator_t *this, struct posix_crawl *crawl, const char *name)
+{
+        struct posix_crawl_level *levels = NULL;
+        char                      real_path[PATH_MAX] = {0,};
+        int                       len    = 0;
+
+        if (crawl->depth == crawl->max) {
+                levels = GF_REALLOC (crawl->levels, (crawl->max + 16) *
+                                     sizeof (*levels));
+                if (!levels)
+                        return -1;
+                memset (&levels[crawl->max], 0, 16 * sizeof (*levels));
+                crawl->levels = levels;
+                crawl->max += 16;
+        }
+
+        len = strlen (crawl->path);
+        if (name) {
+                if (len + strlen (name) + 2 > sizeof (crawl->path)) {
+                        errno = ENAMETOOLONG;
+                        return -1;
+                }
+                crawl->path[len++] = '/';
+                strcpy (&crawl->path[len], name);
+                len += strlen (name);
+        }
+
+        if (!posix_crawl_real_path (this, crawl, real_path))
+                crawl->levels[crawl->depth].dir = opendir (real_path);
+        if (!crawl->levels[crawl->depth].dir) {
+                gf_log (this->name, GF_LOG_WARNING, "crawl: opendir of %s "
+                        "failed (%s)", real_path, strerror (errno));
+                /* walk it as an empty directory */
+        }
+        crawl->levels[crawl->depth].len = len;
+        crawl->depth++;
+
+        return 0;
+}
+
+
+/* Step to the next entry of the walk, left in crawl->path and
+ * crawl->stbuf. Returns 1 for an entry, 0 at the end, -1 on errors. */
+static int
+posix_crawl_next (xlator_t *this, struct posix_crawl *crawl)
+{
+        struct posix_crawl_level *level    = NULL;
+        struct dirent            *entry    = NULL;
+        char                      real_path[PATH_MAX] = {0,};
+        char                    **subdirs  = NULL;
+        struct stat               st       = {0,};
+        int                       len      = 0;
+
+        while (crawl->depth) {
+                level = &crawl->levels[crawl->depth - 1];
+
+                if (!level->dir) {
+                        if (level->next == level->nsubdirs) {
+                                posix_crawl_pop (crawl);
+                                continue;
+                        }
+                        crawl->path[level->len] = '\0';
+                        if (posix_crawl_push (this, crawl,
+                                              level->subdirs[level->next++])) {
+                                if (errno == ENAMETOOLONG)
+                                        continue;
+                                return -1;
+                        }
+                        if (posix_crawl_real_path (this, crawl, real_path))
+                                continue;
+                        if (posix_pstat (this, NULL, real_path, &crawl->stbuf))
+                                continue;
+                        return 1;
+                }
+
+                /* the walk is serialized by the lock of the fd */
+                errno = 0;
+                entry = readdir (level->dir);
+                if (!entry) {
+                        closedir (level->dir);
+                        level->dir = NULL;
+                        continue;
+                }
+
+                if (!strcmp (entry->d_name, ".") ||
+                    !strcmp (entry->d_name, ".."))
+                        continue;
+                if ((crawl->depth == 1) &&
+                    !strcmp (entry->d_name, GF_HIDDEN_PATH))
+                        continue;
+
+                len = level->len;
+                if (len + strlen (entry->d_name) + 2 > sizeof (crawl->path))
+                        continue;
+                crawl->path[len++] = '/';
+                strcpy (&crawl->path[len], entry->d_name);
+
+                if (posix_crawl_real_path (this, crawl, real_path) ||
+                    lstat (real_path, &st)) {
+                        crawl->path[level->len] = '\0';
+                        continue;
+                }
+
+                if (S_ISDIR (st.st_mode)) {
+                        crawl->path[level->len] = '\0';
+                        subdirs = GF_REALLOC (level->subdirs,
+                                              (level->nsubdirs + 1) *
+                                              sizeof (*subdirs));
+                        if (!subdirs)
+                                return -1;
+                        level->subdirs = subdirs;
+                        subdirs[level->nsubdirs] = gf_strdup (entry->d_name);
+                        if (!subdirs[level->nsubdirs])
+                                return -1;
+                        level->nsubdirs++;
+                        continue;
+                }
+
+                /* dht link files, their data is on another brick */
+                if (((st.st_mode & ~S_IFMT) == S_ISVTX) && !st.st_size) {
+                        crawl->path[level->len] = '\0';
+                        continue;
+                }
+
+                if (posix_pstat (this, NULL, real_path, &crawl->stbuf)) {
+                        crawl->path[level->len] = '\0';
+                        continue;
+                }
+                return 1;
+        }
+
+        return 0;
+}
+
+
+void
+posix_crawl_destroy (struct posix_crawl *crawl)
+{
+        if (!crawl)
+                return;
+
+        while (crawl->depth)
+                posix_crawl_pop (crawl);
+        GF_FREE (crawl->levels);
+        GF_FREE (crawl);
+}
+
+
+struct posix_crawl *
+posix_crawl_new (void)
+{
+        return GF_CALLOC (1, sizeof (struct posix_crawl),
+                          gf_posix_mt_crawl_t);
+}
+
+
+int
+posix_crawl_fill (xlator_t *this, struct posix_crawl *crawl, off_t off,
+                  size_t size, gf_dirent_t *entries)
+{
+        gf_dirent_t *this_entry = NULL;
+        size_t       filled     = 0;
+        int32_t      this_size  = 0;
+        int          count      = 0;
+        int          ret        = 0;
+
+        if (!off) {
+                while (crawl->depth)
+                        posix_crawl_pop (crawl);
+                crawl->path[0] = '\0';
+                crawl->pending = 0;
+                crawl->seq = 0;
+                if (posix_crawl_push (this, crawl, NULL))
+                        return -1;
+        } else if (off != crawl->seq) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        for (;;) {
+                if (!crawl->pending) {
+                        ret = posix_crawl_next (this, crawl);
+                        if (ret < 0)
+                                return -1;
+                        if (!ret) {
+                                /* Indicate EOF */
+                                errno = ENOENT;
+                                break;
+                        }
+                        crawl->pending = 1;
+                }
+
+                /* 'path' starts with a '/', the names do not */
+                this_size = max (sizeof (gf_dirent_t),
+                                 sizeof (gfs3_dirplist))
+                        + strlen (crawl->path);
+                if (this_size + filled > size) {
+                        errno = 0;
+                        break;
+                }
+
+                this_entry = gf_dirent_for_name (crawl->path + 1);
+                if (!this_entry)
+                        return -1;
+                this_entry->d_off = ++crawl->seq;
+                this_entry->d_ino = crawl->stbuf.ia_ino;
+                this_entry->d_type = IA_ISDIR (crawl->stbuf.ia_type) ?
+                                     DT_DIR : DT_REG;
+                this_entry->d_stat = crawl->stbuf;
+                list_add_tail (&this_entry->list, &entries->list);
+
+                crawl->pending = 0;
+                filled += this_size;
+                count++;
+        }
+
+        return count;
+}
@@ -107,6 +107,22 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, out);
         VALIDATE_OR_GOTO (loc, out);
 
+        if (POSIX_IS_CRAWL_GFID (loc->gfid) ||
+            (loc->inode && POSIX_IS_CRAWL_GFID (loc->inode->gfid))) {
+                /* the brick crawl directory, see posix_crawl_fill() */
+                if (!POSIX_CRAWL_ALLOWED (frame)) {
+                        op_errno = ENOENT;
+                        goto out;
+                }
+                op_ret = posix_pstat (this, (unsigned char *)posix_crawl_gfid,
+                                      POSIX_BASE_PATH (this), &buf);
+                op_errno = errno;
+                if (!op_ret)
+                        /* no xattrs, but callers expect a dict */
+                        xattr = get_new_dict ();
+                goto out;
+        }
+
         /* The Hidden directory should be for housekeeping purpose and it
            should not get any gfid on it */
         if (__is_root_gfid (loc->pargfid) &&
@@ -580,6 +596,33 @@ posix_opendir (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (fd, out);
 
         SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        if (POSIX_IS_CRAWL_GFID (fd->inode->gfid)) {
+                if (!POSIX_CRAWL_ALLOWED (frame)) {
+                        op_errno = ENOENT;
+                        goto out;
+                }
+                pfd = GF_CALLOC (1, sizeof (*pfd), gf_posix_mt_posix_fd);
+                if (!pfd) {
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                pfd->fd = -1;
+                pfd->crawl = posix_crawl_new ();
+                if (!pfd->crawl) {
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                op_ret = fd_ctx_set (fd, this, (uint64_t)(long)pfd);
+                if (op_ret) {
+                        posix_crawl_destroy (pfd->crawl);
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                goto out;
+        }
+
         MAKE_INODE_HANDLE (real_path, this, loc, NULL);
 
         op_ret = -1;
@@ -657,6 +700,12 @@ posix_releasedir (xlator_t *this,
         }
 
         pfd = (struct posix_fd *)(long)tmp_pfd;
+        if (pfd->crawl) {
+                posix_crawl_destroy (pfd->crawl);
+                GF_FREE (pfd);
+                goto out;
+        }
+
         if (!pfd->dir) {
                 gf_log (this->name, GF_LOG_WARNING,
                         "pfd->dir is NULL for fd=%p", fd);
@@ -1096,7 +1145,7 @@ out:
         STACK_UNWIND_STRICT (unlink, frame, op_ret, op_errno,
                              &preparent, &postparent, NULL);
 
-        if (fd != -1) {
+        if ((fd != -1) && posix_unlink_enqueue (this, fd)) {
                 close (fd);
         }
 
@@ -1925,7 +1974,9 @@ posix_readv (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+        /* aligned, so that O_DIRECT fds read straight into the reply */
+        iobuf = iobuf_get_page_aligned (this->ctx->iobuf_pool, size,
+                                        ALIGN_SIZE);
         if (!iobuf) {
                 op_errno = ENOMEM;
                 goto out;
@@ -2045,16 +2096,23 @@ __posix_writev (int fd, struct iovec *vector, int count, off_t startoff,
         char            *buf = NULL;
         char            *alloc_buf = NULL;
         off_t           internal_off = 0;
+        int             aligned = 1;
 
         /* Check for the O_DIRECT flag during open() */
         if (!odirect)
                 return __posix_pwritev (fd, vector, count, startoff);
 
         for (idx = 0; idx < count; idx++) {
+                if ((unsigned long) vector[idx].iov_base % ALIGN_SIZE)
+                        aligned = 0;
                 if (max_buf_size < vector[idx].iov_len)
                         max_buf_size = vector[idx].iov_len;
         }
 
+        /* payloads arrive in page aligned iobufs, no bounce needed */
+        if (aligned)
+                return __posix_pwritev (fd, vector, count, startoff);
+
         alloc_buf = _page_aligned_alloc (max_buf_size, &buf);
         if (!alloc_buf) {
                 op_ret = -errno;
@@ -2188,6 +2246,7 @@ posix_statfs (call_frame_t *frame, xlator_t *this,
         int32_t                op_errno  = 0;
         struct statvfs         buf       = {0, };
         struct posix_private * priv      = NULL;
+        dict_t               * rsp_xdata = NULL;
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
@@ -2217,10 +2276,26 @@ posix_statfs (call_frame_t *frame, xlator_t *this,
                 buf.f_favail = 0;
         }
 
+        /* tell the client it may rely on our pushes instead of asking */
+        if (priv->statfs_push_interval) {
+                rsp_xdata = dict_new ();
+                if (rsp_xdata &&
+                    dict_set_int32 (rsp_xdata, GF_STATFS_PUSH_KEY,
+                                    priv->statfs_push_interval)) {
+                        dict_unref (rsp_xdata);
+                        rsp_xdata = NULL;
+                }
+        }
+
         op_ret = 0;
 
 out:
-        STACK_UNWIND_STRICT (statfs, frame, op_ret, op_errno, &buf, NULL);
+        STACK_UNWIND_STRICT (statfs, frame, op_ret, op_errno, &buf,
+                             rsp_xdata);
+
+        if (rsp_xdata)
+                dict_unref (rsp_xdata);
+
         return 0;
 }
 
@@ -2630,6 +2705,19 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                 goto done;
         }
 
+        if (name && (strcmp (name, GF_XATTR_BRICK_CRAWL_GFID) == 0) &&
+            POSIX_CRAWL_ALLOWED (frame)) {
+                ret = dict_set_static_bin (dict, (char *)name,
+                                           (void *)posix_crawl_gfid,
+                                           sizeof (uuid_t));
+                if (ret < 0) {
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                size = sizeof (uuid_t);
+                goto done;
+        }
+
         if (loc->inode && name &&
             (strcmp (name, GFID_TO_PATH_KEY) == 0)) {
                 ret = inode_path (loc->inode, NULL, &path);
@@ -3557,6 +3645,422 @@ out:
 }
 
 
+static int32_t
+__posix_zerofill (int fd, off_t offset, size_t len)
+{
+        int32_t          op_ret    = -1;
+        char            *alloc_buf = NULL;
+        char            *buf       = NULL;
+        size_t           bufsize   = 0;
+        size_t           written   = 0;
+        ssize_t          retval    = 0;
+
+        /* zerofill behaves like a write of zeroes, so the file may grow */
+        op_ret = sys_fallocate (fd, FALLOC_FL_ZERO_RANGE, offset, len);
+        if (op_ret == 0)
+                goto out;
+        if ((errno != EOPNOTSUPP) && (errno != ENOSYS) && (errno != EINVAL))
+                goto out;
+
+        /* a punched hole which is allocated again reads back as zeroes */
+        op_ret = sys_fallocate (fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                                offset, len);
+        if (op_ret == 0) {
+                op_ret = sys_fallocate (fd, 0, offset, len);
+                if (op_ret == 0)
+                        goto out;
+        }
+        if ((errno != EOPNOTSUPP) && (errno != ENOSYS))
+                goto out;
+
+        /* no help from the filesystem, write the zeroes ourselves. the
+           buffer is page aligned so that O_DIRECT fds work as well */
+        bufsize = min (len, (size_t)GF_UNIT_MB);
+        alloc_buf = _page_aligned_alloc (bufsize, &buf);
+        if (!alloc_buf) {
+                op_ret = -1;
+                errno = ENOMEM;
+                goto out;
+        }
+
+        while (written < len) {
+                retval = pwrite (fd, buf, min (bufsize, len - written),
+                                 offset + written);
+                if (retval == -1) {
+                        op_ret = -1;
+                        goto out;
+                }
+                written += retval;
+        }
+
+        op_ret = 0;
+out:
+        GF_FREE (alloc_buf);
+
+        return op_ret;
+}
+
+
+static int32_t
+posix_do_fallocate (call_frame_t *frame, xlator_t *this, glusterfs_fop_t fop,
+                    fd_t *fd, int32_t mode, off_t offset, size_t len,
+                    struct iatt *preop, struct iatt *postop, int32_t *op_errno)
+{
+        int32_t               op_ret   = -1;
+        int                   _fd      = -1;
+        struct posix_fd      *pfd      = NULL;
+        int                   ret      = -1;
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                *op_errno = -ret;
+                goto out;
+        }
+
+        _fd = pfd->fd;
+
+        op_ret = posix_fdstat (this, _fd, preop);
+        if (op_ret == -1) {
+                *op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pre-operation fstat failed on fd=%p: %s", fd,
+                        strerror (*op_errno));
+                goto out;
+        }
+
+        if (fop == GF_FOP_ZEROFILL)
+                op_ret = __posix_zerofill (_fd, offset, len);
+        else
+                op_ret = sys_fallocate (_fd, mode, offset, len);
+
+        if (op_ret == -1) {
+                *op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s failed on fd=%p (%"PRId64", %"GF_PRI_SIZET"): %s",
+                        gf_fop_list[fop], fd, offset, len,
+                        strerror (*op_errno));
+                goto out;
+        }
+
+        op_ret = posix_fdstat (this, _fd, postop);
+        if (op_ret == -1) {
+                *op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        fd, strerror (*op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        return op_ret;
+}
+
+
+int32_t
+posix_glfallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        int32_t               mode     = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        if (keep_size)
+                mode = FALLOC_FL_KEEP_SIZE;
+
+        op_ret = posix_do_fallocate (frame, this, GF_FOP_FALLOCATE, fd, mode,
+                                     offset, len, &preop, &postop, &op_errno);
+out:
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, &preop,
+                             &postop, NULL);
+
+        return 0;
+}
+
+
+int32_t
+posix_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+               size_t len, dict_t *xdata)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_fallocate (frame, this, GF_FOP_DISCARD, fd,
+                                     FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                                     offset, len, &preop, &postop, &op_errno);
+out:
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, &preop,
+                             &postop, NULL);
+
+        return 0;
+}
+
+
+int32_t
+posix_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                size_t len, dict_t *xdata)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_fallocate (frame, this, GF_FOP_ZEROFILL, fd, 0,
+                                     offset, len, &preop, &postop, &op_errno);
+out:
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, &preop,
+                             &postop, NULL);
+
+        return 0;
+}
+
+
+/* Copy len bytes inside the brick, cheapest way first: share the extents
+ * (reflink), then let the kernel copy, then copy through a buffer. Returns
+ * the number of bytes copied, which is short only at EOF of the source. */
+static ssize_t
+__posix_copy_file_range (int fd_in, off_t off_in, int fd_out, off_t off_out,
+                         size_t len)
+{
+        ssize_t          copied    = 0;
+        ssize_t          retval    = 0;
+        char            *alloc_buf = NULL;
+        char            *buf       = NULL;
+        size_t           bufsize   = 0;
+
+        if (sys_clone_range (fd_in, off_in, fd_out, off_out, len) == 0)
+                return len;
+
+        while ((size_t)copied < len) {
+                retval = sys_copy_file_range (fd_in, &off_in, fd_out, &off_out,
+                                              len - copied, 0);
+                if (retval == 0)
+                        goto out;
+                if (retval < 0)
+                        break;
+                copied += retval;
+        }
+        if ((size_t)copied == len)
+                goto out;
+
+        /* EXDEV and EINVAL are what older kernels return for a
+           copy they cannot do, anything else is a real error */
+        if ((errno != ENOSYS) && (errno != EOPNOTSUPP) &&
+            (errno != EXDEV) && (errno != EINVAL)) {
+                copied = -1;
+                goto out;
+        }
+
+        bufsize = min (len - copied, (size_t)GF_UNIT_MB);
+        alloc_buf = _page_aligned_alloc (bufsize, &buf);
+        if (!alloc_buf) {
+                errno = ENOMEM;
+                copied = -1;
+                goto out;
+        }
+
+        while ((size_t)copied < len) {
+                retval = pread (fd_in, buf, min (bufsize, len - copied),
+                                off_in);
+                if (retval <= 0) {
+                        if (retval < 0)
+                                copied = -1;
+                        goto out;
+                }
+                retval = pwrite (fd_out, buf, retval, off_out);
+                if (retval < 0) {
+                        copied = -1;
+                        goto out;
+                }
+                off_in  += retval;
+                off_out += retval;
+                copied  += retval;
+        }
+out:
+        GF_FREE (alloc_buf);
+
+        return copied;
+}
+
+
+int32_t
+posix_copy_file_range (call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                       off_t off_in, fd_t *fd_out, off_t off_out, size_t len,
+                       uint32_t flags, dict_t *xdata)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct posix_fd      *pfd_in   = NULL;
+        struct posix_fd      *pfd_out  = NULL;
+        struct iatt           stbuf    = {0,};
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+        ssize_t               copied   = 0;
+        int                   ret      = -1;
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd_in, out);
+        VALIDATE_OR_GOTO (fd_out, out);
+
+        /* no flags are defined yet, as for copy_file_range(2) */
+        if (flags) {
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        /* op_ret carries the count, a short copy tells the caller to loop */
+        if (len > GF_COPY_FILE_RANGE_MAX)
+                len = GF_COPY_FILE_RANGE_MAX;
+
+        ret = posix_fd_ctx_get (fd_in, this, &pfd_in);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd_in);
+                op_errno = -ret;
+                goto out;
+        }
+
+        ret = posix_fd_ctx_get (fd_out, this, &pfd_out);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd_out);
+                op_errno = -ret;
+                goto out;
+        }
+
+        op_ret = posix_fdstat (this, pfd_out->fd, &preop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pre-operation fstat failed on fd=%p: %s", fd_out,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        copied = __posix_copy_file_range (pfd_in->fd, off_in, pfd_out->fd,
+                                          off_out, len);
+        if (copied < 0) {
+                op_ret = -1;
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "copy from fd=%p (%"PRId64") to fd=%p (%"PRId64") "
+                        "failed: %s", fd_in, off_in, fd_out, off_out,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = posix_fdstat (this, pfd_in->fd, &stbuf);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%p: %s", fd_in,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = posix_fdstat (this, pfd_out->fd, &postop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s", fd_out,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = copied;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (copy_file_range, frame, op_ret, op_errno, &stbuf,
+                             &preop, &postop, NULL);
+
+        return 0;
+}
+
+
+int32_t
+posix_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            gf_seek_what_t what, dict_t *xdata)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        int                   whence   = 0;
+        off_t                 ret_off  = -1;
+        struct posix_fd      *pfd      = NULL;
+        int                   ret      = -1;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        switch (what) {
+        case GF_SEEK_DATA:
+                whence = SEEK_DATA;
+                break;
+        case GF_SEEK_HOLE:
+                whence = SEEK_HOLE;
+                break;
+        default:
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                op_errno = -ret;
+                goto out;
+        }
+
+        /* pfd->fd is shared by every caller of this fd_t, so only the
+           returned offset matters, not where the file position ends up */
+        ret_off = lseek (pfd->fd, offset, whence);
+        if (ret_off == -1) {
+                op_errno = errno;
+                /* ENXIO: no more data (or holes) after offset */
+                if (op_errno != ENXIO)
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "seek failed on fd=%p (offset=%"PRId64"): %s",
+                                fd, offset, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, ret_off, NULL);
+
+        return 0;
+}
+
+
 int32_t
 posix_fstat (call_frame_t *frame, xlator_t *this,
              fd_t *fd, dict_t *xdata)
@@ -3906,6 +4410,23 @@ posix_do_readdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (pfd->crawl) {
+                if (!POSIX_CRAWL_ALLOWED (frame)) {
+                        op_errno = EPERM;
+                        goto out;
+                }
+                LOCK (&fd->lock);
+                {
+                        count = posix_crawl_fill (this, pfd->crawl, off, size,
+                                                  &entries);
+                }
+                UNLOCK (&fd->lock);
+
+                op_errno = errno;
+                op_ret = count;
+                goto out;
+        }
+
         dir = pfd->dir;
 
         if (!dir) {
@@ -3996,6 +4517,15 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write("max_read","%d", priv->read_value);
         gf_proc_dump_write("max_write","%d", priv->write_value);
         gf_proc_dump_write("nr_files","%ld", priv->nr_files);
+        gf_proc_dump_write("unlink_thread_count", "%d",
+                           priv->unlink_thread_count);
+        gf_proc_dump_write("unlink_queue_len", "%d", priv->unlink_queue_len);
+        gf_proc_dump_write("unlink_queue_size", "%d",
+                           priv->unlink_queue_size);
+        gf_proc_dump_write("unlink_overflows", "%"PRIu64,
+                           priv->unlink_overflows);
+        gf_proc_dump_write("unlink_files", "%"PRIu64, priv->unlink_files);
+        gf_proc_dump_write("unlink_bytes", "%"PRIu64, priv->unlink_bytes);
 
         return 0;
 }
@@ -4019,15 +4549,18 @@ posix_rchecksum (call_frame_t *frame, xlator_t *this,
         int                     op_errno        = 0;
         int                     ret             = 0;
         int32_t                 weak_checksum   = 0;
-        unsigned char           strong_checksum[MD5_DIGEST_LENGTH] = {0};
+        unsigned char           strong_checksum[GF_RSYNC_STRONG_CHECKSUM_LENGTH] = {0};
         struct posix_private    *priv           = NULL;
+        void                    *key            = NULL;
+        int                     key_len         = 0;
+        dict_t                  *rsp_xdata      = NULL;
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
         VALIDATE_OR_GOTO (fd, out);
 
         priv = this->private;
-        memset (strong_checksum, 0, MD5_DIGEST_LENGTH);
+        memset (strong_checksum, 0, GF_RSYNC_STRONG_CHECKSUM_LENGTH);
 
         alloc_buf = _page_aligned_alloc (len, &buf);
         if (!alloc_buf) {
@@ -4066,14 +4599,31 @@ posix_rchecksum (call_frame_t *frame, xlator_t *this,
                 goto out;
 
         weak_checksum = gf_rsync_weak_checksum ((unsigned char *) buf, (size_t) len);
-        gf_rsync_strong_checksum ((unsigned char *) buf, (size_t) len, (unsigned char *) strong_checksum);
+
+        if (xdata && !dict_get_ptr_and_len (xdata, GF_RCHECKSUM_KEY,
+                                            &key, &key_len) &&
+            key_len == GF_RSYNC_CHECKSUM_KEY_LENGTH)
+                rsp_xdata = dict_new ();
+
+        if (rsp_xdata && !dict_set_int32 (rsp_xdata, GF_RCHECKSUM_KEY, 1)) {
+                gf_rsync_keyed_checksum (key, (unsigned char *) buf,
+                                         (size_t) len, strong_checksum);
+        } else {
+                gf_rsync_strong_checksum ((unsigned char *) buf, (size_t) len, (unsigned char *) strong_checksum);
+                if (rsp_xdata) {
+                        dict_unref (rsp_xdata);
+                        rsp_xdata = NULL;
+                }
+        }
 
         op_ret = 0;
 out:
         STACK_UNWIND_STRICT (rchecksum, frame, op_ret, op_errno,
-                             weak_checksum, strong_checksum, NULL);
+                             weak_checksum, strong_checksum, rsp_xdata);
 
         GF_FREE (alloc_buf);
+        if (rsp_xdata)
+                dict_unref (rsp_xdata);
 
         return 0;
 }
@@ -4175,6 +4725,17 @@ reconfigure (xlator_t *this, dict_t *options)
 	else
 		posix_aio_off (this);
 
+        GF_OPTION_RECONF ("background-unlink", priv->background_unlink,
+                          options, bool, out);
+        GF_OPTION_RECONF ("background-unlink-chunk-size",
+                          priv->unlink_chunk_size, options, size, out);
+        GF_OPTION_RECONF ("background-unlink-rate-limit",
+                          priv->unlink_rate_limit, options, size, out);
+        GF_OPTION_RECONF ("statfs-push-interval",
+                          priv->statfs_push_interval, options, int32, out);
+        GF_OPTION_RECONF ("statfs-push-threshold",
+                          priv->statfs_push_threshold, options, percent, out);
+
 	ret = 0;
 out:
 	return ret;
@@ -4537,6 +5098,34 @@ init (xlator_t *this)
 		}
 	}
 
+        GF_OPTION_INIT ("background-unlink-thread-count",
+                        _private->unlink_thread_count, int32, out);
+        GF_OPTION_INIT ("background-unlink-queue-size",
+                        _private->unlink_queue_size, int32, out);
+        GF_OPTION_INIT ("background-unlink-chunk-size",
+                        _private->unlink_chunk_size, size, out);
+        GF_OPTION_INIT ("background-unlink-rate-limit",
+                        _private->unlink_rate_limit, size, out);
+
+        pthread_mutex_init (&_private->unlink_lock, NULL);
+        pthread_cond_init (&_private->unlink_cond, NULL);
+        INIT_LIST_HEAD (&_private->unlink_queue);
+
+        op_ret = posix_spawn_unlink_threads (this);
+        if (op_ret == -1)
+                gf_log (this->name, GF_LOG_WARNING, "no unlink threads, "
+                        "unlinked files will be released inline");
+
+        GF_OPTION_INIT ("statfs-push-interval",
+                        _private->statfs_push_interval, int32, out);
+        GF_OPTION_INIT ("statfs-push-threshold",
+                        _private->statfs_push_threshold, percent, out);
+
+        op_ret = posix_spawn_statfs_push_thread (this);
+        if (op_ret == -1)
+                gf_log (this->name, GF_LOG_WARNING, "clients will not be "
+                        "told about changes of disk usage");
+
         pthread_mutex_init (&_private->janitor_lock, NULL);
         pthread_cond_init (&_private->janitor_cond, NULL);
         INIT_LIST_HEAD (&_private->janitor_fds);
@@ -4607,6 +5196,11 @@ struct xlator_fops fops = {
         .fxattrop    = posix_fxattrop,
         .setattr     = posix_setattr,
         .fsetattr    = posix_fsetattr,
+        .fallocate   = posix_glfallocate,
+        .discard     = posix_discard,
+        .zerofill    = posix_zerofill,
+        .seek        = posix_seek,
+        .copy_file_range = posix_copy_file_range,
 };
 
 struct xlator_cbks cbks = {
@@ -4630,6 +5224,50 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL },
         { .key  = {"janitor-sleep-duration"},
           .type = GF_OPTION_TYPE_INT },
+        { .key  = {"background-unlink-thread-count"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 32,
+          .default_value = "2",
+          .description = "Number of threads releasing the data blocks of "
+          "unlinked files in the background"
+        },
+        { .key  = {"background-unlink-queue-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 65536,
+          .default_value = "1024",
+          .description = "Maximum number of unlinked files waiting for "
+          "their blocks to be released. Beyond this, unlinks release "
+          "blocks inline"
+        },
+        { .key  = {"background-unlink-chunk-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "1GB",
+          .description = "Huge unlinked files are truncated in steps of "
+          "this size before being closed. 0 disables chunking"
+        },
+        { .key  = {"background-unlink-rate-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Maximum bytes per second released by the unlink "
+          "threads together. 0 means unlimited"
+        },
+        { .key  = {"statfs-push-interval"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 3600,
+          .default_value = "5",
+          .description = "Seconds between checks of the disk usage of the "
+          "brick. Clients are sent the usage when it changed noticeably, "
+          "so they need not ask for it. 0 disables the pushes"
+        },
+        { .key  = {"statfs-push-threshold"},
+          .type = GF_OPTION_TYPE_PERCENT,
+          .default_value = "1%",
+          .description = "Change of free space or free inodes, in percent "
+          "of the total, after which the usage is pushed to the clients"
+        },
         { .key  = {"volume-id"},
           .type = GF_OPTION_TYPE_ANY },
         { .key  = {"glusterd-uuid"},
@@ -53,12 +53,25 @@
  * posix_fd - internal structure common to file and directory fd's
  */
 
+struct posix_crawl;
+
 struct posix_fd {
 	int     fd;      /* fd returned by the kernel */
 	int32_t flags;   /* flags for open/creat      */
 	DIR *   dir;     /* handle returned by the kernel */
         int     odirect;
         struct list_head list; /* to add to the janitor list */
+        struct posix_crawl *crawl; /* walk of the brick crawl directory */
+};
+
+/**
+ * posix_unlink_item - an unlinked, still open file waiting for the unlink
+ *                     threads to release its data blocks
+ */
+
+struct posix_unlink_item {
+        int              fd;
+        struct list_head list;
 };
 
 
@@ -105,6 +118,35 @@ struct posix_private {
 */
         gf_boolean_t    background_unlink;
 
+/*
+   pipeline which releases the data blocks of background unlinks. huge
+   files are truncated a chunk at a time (optionally rate limited) so that
+   freeing them does not stall the backend filesystem's journal.
+*/
+        struct list_head  unlink_queue;
+        pthread_mutex_t   unlink_lock;
+        pthread_cond_t    unlink_cond;
+        int32_t           unlink_queue_len;
+        int32_t           unlink_queue_size;
+        int32_t           unlink_thread_count;
+        pthread_t        *unlink_threads;
+        uint64_t          unlink_chunk_size;
+        uint64_t          unlink_rate_limit;   /* bytes per second */
+        struct timeval    unlink_next_slot;
+        uint64_t          unlink_files;
+        uint64_t          unlink_bytes;
+        uint64_t          unlink_overflows;
+
+/*
+   usage of the brick pushed to the clients. it is checked every
+   statfs_push_interval seconds and sent when free blocks or inodes moved
+   by statfs_push_threshold percent since the last push.
+*/
+        int32_t           statfs_push_interval;
+        double            statfs_push_threshold;
+        struct statvfs    statfs_pushed;
+        pthread_t         statfs_push_thread;
+
 /* janitor thread which cleans up /.trash (created by replicate) */
         pthread_t       janitor;
         gf_boolean_t    janitor_present;
@@ -157,6 +199,9 @@ int posix_handle_pair (xlator_t *this, const char *real_path, char *key,
 int posix_fhandle_pair (xlator_t *this, int fd, char *key, data_t *value,
                         int flags);
 void posix_spawn_janitor_thread (xlator_t *this);
+int posix_spawn_unlink_threads (xlator_t *this);
+int posix_unlink_enqueue (xlator_t *this, int fd);
+int posix_spawn_statfs_push_thread (xlator_t *this);
 int posix_get_file_contents (xlator_t *this, uuid_t pargfid,
                              const char *name, char **contents);
 int posix_set_file_contents (xlator_t *this, const char *path, char *key,
@@ -174,4 +219,15 @@ gf_boolean_t posix_special_xattr (char **pattern, char *key);
 void
 __posix_fd_set_odirect (fd_t *fd, struct posix_fd *pfd, int opflags,
 			off_t offset, size_t size);
+
+extern const uuid_t posix_crawl_gfid;
+#define POSIX_IS_CRAWL_GFID(gfid) (!uuid_compare (gfid, posix_crawl_gfid))
+/* the crawl lists the whole brick as root, only rebalance gets to see it */
+#define POSIX_CRAWL_ALLOWED(frame) \
+        ((frame)->root->pid == GF_CLIENT_PID_DEFRAG)
+
+struct posix_crawl *posix_crawl_new (void);
+void posix_crawl_destroy (struct posix_crawl *crawl);
+int posix_crawl_fill (xlator_t *this, struct posix_crawl *crawl, off_t off,
+                      size_t size, gf_dirent_t *entries);
 #endif /* _POSIX_H */